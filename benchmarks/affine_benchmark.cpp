@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <vector>
+
+#include "affine.h"
+#include "benchmark_helpers.h"
+#include "mat4.h"
+#include "mat4_simd.h"
+
+using namespace mym;
+
+// what a scene node transform costs to compose (parent * local) and invert (every raycast) as a
+// Mat4 against an Affine. build with the benchmarks flags
+
+constexpr size_t TRANSFORM_COUNT = 4096;
+constexpr int PASSES = 256;
+constexpr double CALLS = static_cast<double>(TRANSFORM_COUNT) * PASSES;
+
+int main() {
+
+    std::vector<Mat4> matrices(TRANSFORM_COUNT);
+    std::vector<Affine> affines(TRANSFORM_COUNT);
+    for (size_t i = 0; i < TRANSFORM_COUNT; i++) {
+        const float f = static_cast<float>(i);
+        matrices[i] = scaled(fromPositionAndEuler((Vec3){ .x = f, .y = -f, .z = 0.5f * f },
+                                                  (Vec3){ .x = 0.01f * f, .y = 0.02f * f, .z = 0.03f * f }), 1.f, 2.f, 0.5f);
+        affines[i] = toAffine(matrices[i]);
+    }
+    std::vector<Mat4> matrix_out(TRANSFORM_COUNT);
+    std::vector<Affine> affine_out(TRANSFORM_COUNT);
+
+    printf("%zu bytes per Mat4, %zu per Affine\n\n", sizeof(Mat4), sizeof(Affine));
+    printf("%-36s %11s %12s %9s\n", "per call", "time", "throughput", "speedup");
+
+    // chained like parent * local down a hierarchy
+    const double compose_matrix = bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++)
+            for (size_t i = 1; i < TRANSFORM_COUNT; i++) matrix_out[i] = multiplied(matrix_out[i - 1], matrices[i]);
+        sink = sink + matrix_out.back().m30;
+    });
+    reportPerItem("compose Mat4", compose_matrix, CALLS, compose_matrix);
+    reportPerItem("compose Mat4 inline simd", bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++)
+            for (size_t i = 1; i < TRANSFORM_COUNT; i++) matrix_out[i] = simd::multiplied(matrix_out[i - 1], matrices[i]);
+        sink = sink + matrix_out.back().m30;
+    }), CALLS, compose_matrix);
+    reportPerItem("compose Affine", bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++)
+            for (size_t i = 1; i < TRANSFORM_COUNT; i++) affine_out[i] = multiplied(affine_out[i - 1], affines[i]);
+        sink = sink + affine_out.back().m30;
+    }), CALLS, compose_matrix);
+
+    // siblings under one parent, nothing waits on the previous result
+    const double siblings_matrix = bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++)
+            for (size_t i = 0; i < TRANSFORM_COUNT; i++) matrix_out[i] = multiplied(matrices[0], matrices[i]);
+        sink = sink + matrix_out.back().m30;
+    });
+    reportPerItem("compose siblings Mat4", siblings_matrix, CALLS, siblings_matrix);
+    reportPerItem("compose siblings Mat4 inline simd", bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++)
+            for (size_t i = 0; i < TRANSFORM_COUNT; i++) matrix_out[i] = simd::multiplied(matrices[0], matrices[i]);
+        sink = sink + matrix_out.back().m30;
+    }), CALLS, siblings_matrix);
+    reportPerItem("compose siblings Affine", bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++)
+            for (size_t i = 0; i < TRANSFORM_COUNT; i++) affine_out[i] = multiplied(affines[0], affines[i]);
+        sink = sink + affine_out.back().m30;
+    }), CALLS, siblings_matrix);
+
+    const double inverse_matrix = bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++)
+            for (size_t i = 0; i < TRANSFORM_COUNT; i++) matrix_out[i] = inverse(matrices[i]);
+        sink = sink + matrix_out.back().m30;
+    });
+    reportPerItem("inverse Mat4", inverse_matrix, CALLS, inverse_matrix);
+    reportPerItem("inverse Mat4 scalar cofactors", bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++)
+            for (size_t i = 0; i < TRANSFORM_COUNT; i++) matrix_out[i] = scalar::inverse(matrices[i]);
+        sink = sink + matrix_out.back().m30;
+    }), CALLS, inverse_matrix);
+    reportPerItem("affineInverse Mat4 inline simd", bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++)
+            for (size_t i = 0; i < TRANSFORM_COUNT; i++) matrix_out[i] = simd::affineInverse(matrices[i]);
+        sink = sink + matrix_out.back().m30;
+    }), CALLS, inverse_matrix);
+    reportPerItem("inverse Affine", bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++)
+            for (size_t i = 0; i < TRANSFORM_COUNT; i++) affine_out[i] = inverse(affines[i]);
+        sink = sink + affine_out.back().m30;
+    }), CALLS, inverse_matrix);
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <float.h>
+#include <vector>
+
+#include "benchmark_helpers.h"
+#include "bounds.h"
+#include "mat4.h"
+
+using namespace mym;
+
+// the bounds primitives in isolation: a frustum and a ray against a field of boxes, one box per call
+// against the structure of arrays batch calls. about 60% of the boxes are visible and a few hit.
+// build with the benchmarks flags
+
+constexpr size_t BOX_COUNT = 64 * 1024;
+constexpr int PASSES = 32;
+constexpr double BOXES_TESTED = static_cast<double>(BOX_COUNT) * PASSES;
+
+int main() {
+
+    std::vector<Aabb> boxes(BOX_COUNT);
+    std::vector<Sphere> spheres(BOX_COUNT);
+    std::vector<float> min_x(BOX_COUNT), min_y(BOX_COUNT), min_z(BOX_COUNT);
+    std::vector<float> max_x(BOX_COUNT), max_y(BOX_COUNT), max_z(BOX_COUNT);
+    unsigned int seed = 1;
+    const auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+    };
+    for (size_t i = 0; i < BOX_COUNT; i++) {
+        const Vec3 center = { .x = next() * 100.f - 50.f, .y = next() * 100.f - 50.f, .z = next() * 100.f - 90.f };
+        const float half = 0.1f + next();
+        boxes[i] = (Aabb){
+            .min = (Vec3){ .x = center.x - half, .y = center.y - half, .z = center.z - half },
+            .max = (Vec3){ .x = center.x + half, .y = center.y + half, .z = center.z + half },
+        };
+        spheres[i] = boundingSphere(boxes[i]);
+        min_x[i] = boxes[i].min.x;
+        min_y[i] = boxes[i].min.y;
+        min_z[i] = boxes[i].min.z;
+        max_x[i] = boxes[i].max.x;
+        max_y[i] = boxes[i].max.y;
+        max_z[i] = boxes[i].max.z;
+    }
+    const AabbArrays arrays = { min_x.data(), min_y.data(), min_z.data(), max_x.data(), max_y.data(), max_z.data() };
+
+    const Mat4 view = inverse(lookAt((Vec3){ .x = 0.f, .y = 0.f, .z = 10.f }, (Vec3){ .x = 0.f, .y = 0.f, .z = 0.f },
+                                     (Vec3){ .x = 0.f, .y = 1.f, .z = 0.f }));
+    const Frustum frustum = frustumFromViewProjection(multiplied(perspective(1.2f, 16.f / 9.f, 0.1f, 100.f), view));
+    const Vec3 origin = { .x = 0.f, .y = 0.f, .z = 10.f };
+    const Vec3 inverse_direction = inverseDirection(normalize((Vec3){ .x = 0.05f, .y = -0.02f, .z = -1.f }));
+
+    std::vector<uint32_t> visible(BOX_COUNT);
+    std::vector<float> distances(BOX_COUNT);
+    size_t visible_count = 0;
+
+    printf("%zu boxes\n", BOX_COUNT);
+    printf("%-36s %11s %12s %9s\n", "per box", "time", "throughput", "speedup");
+
+    const double frustum_single = bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++) {
+            visible_count = 0;
+            for (size_t i = 0; i < BOX_COUNT; i++) {
+                if (isVisible(frustum, boxes[i])) visible[visible_count++] = static_cast<uint32_t>(i);
+            }
+        }
+        sink = sink + static_cast<float>(visible_count);
+    });
+    reportPerItem("frustum isVisible per box", frustum_single, BOXES_TESTED, frustum_single);
+
+    reportPerItem("frustum isVisible per sphere", bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++) {
+            visible_count = 0;
+            for (size_t i = 0; i < BOX_COUNT; i++) {
+                if (isVisible(frustum, spheres[i])) visible[visible_count++] = static_cast<uint32_t>(i);
+            }
+        }
+        sink = sink + static_cast<float>(visible_count);
+    }), BOXES_TESTED, frustum_single);
+
+    reportPerItem("frustum cullAabbs soa", bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++) {
+            visible_count = cullAabbs(frustum, arrays, BOX_COUNT, visible.data());
+        }
+        sink = sink + static_cast<float>(visible_count);
+    }), BOXES_TESTED, frustum_single);
+    printf("  %zu of %zu visible\n", visible_count, BOX_COUNT);
+
+    const double ray_single = bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++) {
+            for (size_t i = 0; i < BOX_COUNT; i++) {
+                const FloatResult hit = rayIntersectsAabb(origin, inverse_direction, boxes[i]);
+                distances[i] = hit.valid ? hit.value : FLT_MAX;
+            }
+        }
+        sink = sink + distances.back();
+    });
+    reportPerItem("ray rayIntersectsAabb per box", ray_single, BOXES_TESTED, ray_single);
+
+    reportPerItem("ray rayAabbDistances soa", bestOf([&]() {
+        for (int pass = 0; pass < PASSES; pass++) {
+            rayAabbDistances(origin, inverse_direction, arrays, BOX_COUNT, distances.data());
+        }
+        sink = sink + distances.back();
+    }), BOXES_TESTED, ray_single);
+
+    size_t hits = 0;
+    for (size_t i = 0; i < BOX_COUNT; i++) hits += distances[i] != FLT_MAX;
+    printf("  %zu of %zu hit\n", hits, BOX_COUNT);
+
+    return 0;
+}
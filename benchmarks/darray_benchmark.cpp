@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "benchmark_helpers.h"
+#include "mystl.hpp"
+
+// DArray against std::vector on the patterns the renderer and importers actually use.
+// build with the benchmarks flags and compare the columns
+
+constexpr size_t FLOAT_COUNT = 10'000'000;
+constexpr size_t STRING_COUNT = 1'000'000;
+
+template<class Array>
+static void pushFloats() {
+    Array values;
+    for (size_t i = 0; i < FLOAT_COUNT; i++) {
+        values.push_back(static_cast<float>(i));
+    }
+    sink = sink + values[FLOAT_COUNT / 2];
+}
+
+template<class Array>
+static void reserveAndPushFloats() {
+    Array values;
+    values.reserve(FLOAT_COUNT);
+    for (size_t i = 0; i < FLOAT_COUNT; i++) {
+        values.push_back(static_cast<float>(i));
+    }
+    sink = sink + values[FLOAT_COUNT / 2];
+}
+
+template<class Array>
+static void sumFloats(const Array& values) {
+    double sum = 0.0;
+    for (size_t i = 0; i < values.size(); i++) {
+        sum += values[i];
+    }
+    sink = sink + sum;
+}
+
+template<class Array>
+static void copyFloats(const Array& values) {
+    Array copy = values;
+    sink = sink + copy[FLOAT_COUNT / 3];
+}
+
+template<class Array>
+static void emplaceStrings() {
+    Array strings;
+    for (size_t i = 0; i < STRING_COUNT; i++) {
+        strings.emplace_back("a string too long for the small string buffer");
+    }
+    sink = sink + strings[STRING_COUNT / 2].size();
+}
+
+int main() {
+
+    printf("%-30s %13s %13s %9s\n", "", "DArray", "std::vector", "speedup");
+
+    reportAgainst("push_back 10M floats",
+        bestOf([]() { pushFloats<DArray<float>>(); }),
+        bestOf([]() { pushFloats<std::vector<float>>(); }));
+
+    reportAgainst("reserve + push_back",
+        bestOf([]() { reserveAndPushFloats<DArray<float>>(); }),
+        bestOf([]() { reserveAndPushFloats<std::vector<float>>(); }));
+
+    DArray<float> darray_floats(FLOAT_COUNT, 1.f);
+    std::vector<float> vector_floats(FLOAT_COUNT, 1.f);
+
+    reportAgainst("indexed sum",
+        bestOf([&darray_floats]() { sumFloats(darray_floats); }),
+        bestOf([&vector_floats]() { sumFloats(vector_floats); }));
+
+    reportAgainst("copy",
+        bestOf([&darray_floats]() { copyFloats(darray_floats); }),
+        bestOf([&vector_floats]() { copyFloats(vector_floats); }));
+
+    reportAgainst("emplace_back 1M strings",
+        bestOf([]() { emplaceStrings<DArray<std::string>>(); }),
+        bestOf([]() { emplaceStrings<std::vector<std::string>>(); }));
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+#include "benchmark_helpers.h"
+#include "mystl.hpp"
+
+// HashMap against std::unordered_map and SlotMap against an unordered_map keyed by id, on integer
+// keys like node and mesh ids and string keys like texture paths. build with the benchmarks flags
+
+constexpr size_t KEY_COUNT = 1'000'000;
+constexpr size_t STRING_COUNT = 200'000;
+
+// scattered keys, the same sequence every run
+static DArray<uint64_t> randomKeys(const size_t count, uint64_t state) {
+    DArray<uint64_t> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        keys.push_back(state);
+    }
+    return keys;
+}
+
+static void findHashMap(const HashMap<uint64_t, uint64_t>& map, const DArray<uint64_t>& keys) {
+    uint64_t sum = 0;
+    for (const uint64_t key : keys) {
+        const uint64_t* value = map.find(key);
+        sum += value != nullptr ? *value : 1;
+    }
+    sink = sink + sum;
+}
+
+static void findUnorderedMap(const std::unordered_map<uint64_t, uint64_t>& map, const DArray<uint64_t>& keys) {
+    uint64_t sum = 0;
+    for (const uint64_t key : keys) {
+        const auto found = map.find(key);
+        sum += found != map.end() ? found->second : 1;
+    }
+    sink = sink + sum;
+}
+
+typedef struct Item {
+    float transform[16];
+    uint64_t id;
+} Item;
+
+int main() {
+
+    printf("%-30s %13s %13s %9s\n", "", "ours", "std", "speedup");
+
+    const DArray<uint64_t> keys = randomKeys(KEY_COUNT, 88172645463325252ull);
+    const DArray<uint64_t> missing = randomKeys(KEY_COUNT, 2463534242ull);
+
+    reportAgainst("insert 1M u64",
+        bestOf([&keys]() {
+            HashMap<uint64_t, uint64_t> map;
+            for (const uint64_t key : keys) {
+                map.insert(key, key);
+            }
+            sink = sink + map.size();
+        }),
+        bestOf([&keys]() {
+            std::unordered_map<uint64_t, uint64_t> map;
+            for (const uint64_t key : keys) {
+                map.emplace(key, key);
+            }
+            sink = sink + map.size();
+        }));
+
+    HashMap<uint64_t, uint64_t> hash_map;
+    std::unordered_map<uint64_t, uint64_t> unordered_map;
+    for (const uint64_t key : keys) {
+        hash_map.insert(key, key);
+        unordered_map.emplace(key, key);
+    }
+
+    reportAgainst("find 1M hits",
+        bestOf([&]() { findHashMap(hash_map, keys); }),
+        bestOf([&]() { findUnorderedMap(unordered_map, keys); }));
+
+    reportAgainst("find 1M misses",
+        bestOf([&]() { findHashMap(hash_map, missing); }),
+        bestOf([&]() { findUnorderedMap(unordered_map, missing); }));
+
+    reportAgainst("iterate 1M",
+        bestOf([&hash_map]() {
+            uint64_t sum = 0;
+            for (const auto& entry : hash_map) {
+                sum += entry.value;
+            }
+            sink = sink + sum;
+        }),
+        bestOf([&unordered_map]() {
+            uint64_t sum = 0;
+            for (const auto& entry : unordered_map) {
+                sum += entry.second;
+            }
+            sink = sink + sum;
+        }));
+
+    reportAgainst("copy + erase 1M",
+        bestOf([&]() {
+            HashMap<uint64_t, uint64_t> map = hash_map;
+            for (const uint64_t key : keys) {
+                map.erase(key);
+            }
+            sink = sink + map.size();
+        }),
+        bestOf([&]() {
+            std::unordered_map<uint64_t, uint64_t> map = unordered_map;
+            for (const uint64_t key : keys) {
+                map.erase(key);
+            }
+            sink = sink + map.size();
+        }));
+
+    // paths like the ones textures and assets are looked up by
+    DArray<std::string> paths;
+    for (size_t i = 0; i < STRING_COUNT; i++) {
+        paths.push_back("assets/textures/material_" + std::to_string(keys[i]) + ".png");
+    }
+
+    reportAgainst("insert + find 200k paths",
+        bestOf([&paths]() {
+            HashMap<std::string, size_t> map;
+            for (size_t i = 0; i < paths.size(); i++) {
+                map.insert(paths[i], i);
+            }
+            size_t sum = 0;
+            for (const std::string& path : paths) {
+                sum += *map.find(path);
+            }
+            sink = sink + sum;
+        }),
+        bestOf([&paths]() {
+            std::unordered_map<std::string, size_t> map;
+            for (size_t i = 0; i < paths.size(); i++) {
+                map.emplace(paths[i], i);
+            }
+            size_t sum = 0;
+            for (const std::string& path : paths) {
+                sum += map.find(path)->second;
+            }
+            sink = sink + sum;
+        }));
+
+    // churn: fill, drop every third item, refill, then walk everything like a per frame update
+    printf("\n%-30s %13s %13s %9s\n", "", "SlotMap", "unordered_map", "speedup");
+
+    reportAgainst("churn + iterate 1M items",
+        bestOf([]() {
+            SlotMap<Item> items;
+            DArray<SlotHandle> handles;
+            handles.reserve(KEY_COUNT);
+            for (size_t i = 0; i < KEY_COUNT; i++) {
+                handles.push_back(items.insert(Item{ .transform = {}, .id = i }));
+            }
+            for (size_t i = 0; i < KEY_COUNT; i += 3) {
+                items.erase(handles[i]);
+            }
+            for (size_t i = 0; i < KEY_COUNT; i += 3) {
+                handles[i] = items.insert(Item{ .transform = {}, .id = i });
+            }
+            uint64_t sum = 0;
+            for (const Item& item : items) {
+                sum += item.id;
+            }
+            for (size_t i = 0; i < KEY_COUNT; i += 7) {
+                sum += items.get(handles[i])->id;
+            }
+            sink = sink + sum;
+        }),
+        bestOf([]() {
+            std::unordered_map<uint64_t, Item> items;
+            for (size_t i = 0; i < KEY_COUNT; i++) {
+                items.emplace(i, Item{ .transform = {}, .id = i });
+            }
+            for (size_t i = 0; i < KEY_COUNT; i += 3) {
+                items.erase(i);
+            }
+            for (size_t i = 0; i < KEY_COUNT; i += 3) {
+                items.emplace(i, Item{ .transform = {}, .id = i });
+            }
+            uint64_t sum = 0;
+            for (const auto& item : items) {
+                sum += item.second.id;
+            }
+            for (size_t i = 0; i < KEY_COUNT; i += 7) {
+                sum += items.find(i)->second.id;
+            }
+            sink = sink + sum;
+        }));
+
+    return 0;
+}
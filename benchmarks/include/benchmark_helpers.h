@@ -0,0 +1,41 @@
+#ifndef BENCHMARK_HELPERS_H
+#define BENCHMARK_HELPERS_H
+
+#include <stdio.h>
+#include <chrono>
+
+// what every benchmark times with. each one is its own executable, always -O2 -DNDEBUG (see
+// add_benchmark in CMakeLists.txt), the numbers mean nothing otherwise
+
+typedef std::chrono::steady_clock Clock;
+
+constexpr int REPEATS = 5;
+
+// keeps the optimizer from dropping the work, add something the work computed to it
+static volatile double sink = 0.0;
+
+// best of REPEATS runs in milliseconds
+template<class Work>
+static double bestOf(Work work) {
+    double best = 1e30;
+    for (int i = 0; i < REPEATS; i++) {
+        const Clock::time_point start = Clock::now();
+        work();
+        const double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        best = elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+
+// ours against the standard library (or whatever we replaced) on the same work, in milliseconds
+static inline void reportAgainst(const char* name, const double ours, const double theirs) {
+    printf("%-30s %10.2f ms %10.2f ms %8.2fx\n", name, ours, theirs, theirs / ours);
+}
+
+// time per item and items per second, with the speedup over baseline (the first row of its group)
+static inline void reportPerItem(const char* name, const double milliseconds, const double items, const double baseline) {
+    printf("%-36s %8.2f ns %10.1f M/s %8.2fx\n", name, milliseconds * 1e6 / items, items / milliseconds / 1e3,
+           baseline / milliseconds);
+}
+
+#endif //BENCHMARK_HELPERS_H
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <vector>
+
+#include "benchmark_helpers.h"
+#include "mat4.h"
+#include "mat4_simd.h"
+
+using namespace mym;
+
+// the scalar Mat4 kernels against the inline simd ones and the out of line exported ones, on the
+// work the scene and raycasts do: world transforms, inverses and points. build with the benchmarks flags
+
+constexpr size_t MATRIX_COUNT = 4096;
+constexpr int PASSES = 256;
+
+// per call, so the rows compare across kernels
+static void report(const char* name, const double scalar, const double inlined, const double exported) {
+    const double calls = static_cast<double>(MATRIX_COUNT) * PASSES / 1e6;
+    printf("%-22s %9.2f ns %9.2f ns %9.2f ns %8.2fx\n",
+        name, scalar / calls, inlined / calls, exported / calls, scalar / inlined);
+}
+
+int main() {
+
+    std::vector<Mat4> matrices(MATRIX_COUNT);
+    std::vector<Vec3> points(MATRIX_COUNT);
+    for (size_t i = 0; i < MATRIX_COUNT; i++) {
+        const float f = static_cast<float>(i);
+        matrices[i] = fromPositionAndEuler((Vec3){ .x = f, .y = -f, .z = 0.5f * f }, (Vec3){ .x = 0.01f * f, .y = 0.02f * f, .z = 0.03f * f });
+        points[i] = (Vec3){ .x = f, .y = 1.f, .z = -f };
+    }
+    std::vector<Mat4> out(MATRIX_COUNT);
+
+    printf("simd level: %s\n\n", simdLevelName(simdLevel()));
+    printf("%-22s %12s %12s %12s %9s\n", "", "scalar", "inline simd", "exported", "speedup");
+
+    // chained like parent * local down a hierarchy
+    report("multiplied",
+        bestOf([&]() {
+            for (int pass = 0; pass < PASSES; pass++)
+                for (size_t i = 1; i < MATRIX_COUNT; i++) out[i] = scalar::multiplied(out[i - 1], matrices[i]);
+            sink = sink + out.back().m30;
+        }),
+        bestOf([&]() {
+            for (int pass = 0; pass < PASSES; pass++)
+                for (size_t i = 1; i < MATRIX_COUNT; i++) out[i] = simd::multiplied(out[i - 1], matrices[i]);
+            sink = sink + out.back().m30;
+        }),
+        bestOf([&]() {
+            for (int pass = 0; pass < PASSES; pass++)
+                for (size_t i = 1; i < MATRIX_COUNT; i++) out[i] = multiplied(out[i - 1], matrices[i]);
+            sink = sink + out.back().m30;
+        }));
+
+    report("inverse",
+        bestOf([&]() {
+            for (int pass = 0; pass < PASSES; pass++)
+                for (size_t i = 0; i < MATRIX_COUNT; i++) out[i] = scalar::inverse(matrices[i]);
+            sink = sink + out.back().m30;
+        }),
+        bestOf([&]() {
+            for (int pass = 0; pass < PASSES; pass++)
+                for (size_t i = 0; i < MATRIX_COUNT; i++) out[i] = simd::inverse(matrices[i]);
+            sink = sink + out.back().m30;
+        }),
+        bestOf([&]() {
+            for (int pass = 0; pass < PASSES; pass++)
+                for (size_t i = 0; i < MATRIX_COUNT; i++) out[i] = inverse(matrices[i]);
+            sink = sink + out.back().m30;
+        }));
+
+    report("affineInverse",
+        bestOf([&]() {
+            for (int pass = 0; pass < PASSES; pass++)
+                for (size_t i = 0; i < MATRIX_COUNT; i++) out[i] = scalar::affineInverse(matrices[i]);
+            sink = sink + out.back().m30;
+        }),
+        bestOf([&]() {
+            for (int pass = 0; pass < PASSES; pass++)
+                for (size_t i = 0; i < MATRIX_COUNT; i++) out[i] = simd::affineInverse(matrices[i]);
+            sink = sink + out.back().m30;
+        }),
+        bestOf([&]() {
+            for (int pass = 0; pass < PASSES; pass++)
+                for (size_t i = 0; i < MATRIX_COUNT; i++) out[i] = affineInverse(matrices[i]);
+            sink = sink + out.back().m30;
+        }));
+
+    report("positionMultiplied",
+        bestOf([&]() {
+            float sum = 0.f;
+            for (int pass = 0; pass < PASSES; pass++)
+                for (size_t i = 0; i < MATRIX_COUNT; i++) sum += scalar::positionMultiplied(points[i], matrices[i]).x;
+            sink = sink + sum;
+        }),
+        bestOf([&]() {
+            float sum = 0.f;
+            for (int pass = 0; pass < PASSES; pass++)
+                for (size_t i = 0; i < MATRIX_COUNT; i++) sum += simd::positionMultiplied(points[i], matrices[i]).x;
+            sink = sink + sum;
+        }),
+        bestOf([&]() {
+            float sum = 0.f;
+            for (int pass = 0; pass < PASSES; pass++)
+                for (size_t i = 0; i < MATRIX_COUNT; i++) sum += positionMultiplied(points[i], matrices[i]).x;
+            sink = sink + sum;
+        }));
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <math.h>
+
+#include "benchmark_helpers.h"
+#include "mesh.h"
+#include "mesh_geometry.h"
+#include "thread_pool.h"
+
+// normals and tangents for a textured grid of a few million triangles that came without either,
+// what importing a raw scan or a procedural mesh costs. build with the benchmarks flags
+
+constexpr size_t GRID = 1024; // quads per side, 2M triangles
+
+static Mesh texturedGrid(const size_t n) {
+
+    Mesh mesh = {
+        .vertices = { .vertex_count = (n + 1) * (n + 1), .index_count = n * n * 6 },
+    };
+    float* positions = mesh.vertices.positions.extend(mesh.vertices.vertex_count * 3);
+    float* uvs = mesh.vertices.uvs.extend(mesh.vertices.vertex_count * 2);
+    for (size_t z = 0; z <= n; z++) {
+        for (size_t x = 0; x <= n; x++) {
+            const size_t v = z * (n + 1) + x;
+            const float fx = static_cast<float>(x) / n;
+            const float fz = static_cast<float>(z) / n;
+            positions[v * 3] = fx;
+            positions[v * 3 + 1] = 0.05f * sinf(fx * 40.f) * cosf(fz * 27.f);
+            positions[v * 3 + 2] = fz;
+            uvs[v * 2] = fx;
+            uvs[v * 2 + 1] = fz;
+        }
+    }
+
+    unsigned int* indices = mesh.vertices.indices.extend(mesh.vertices.index_count);
+    const unsigned int row = static_cast<unsigned int>(n + 1);
+    for (size_t z = 0; z < n; z++) {
+        for (size_t x = 0; x < n; x++) {
+            const unsigned int i = static_cast<unsigned int>(z * row + x);
+            const unsigned int quad[6] = { i, i + row, i + 1, i + 1, i + row, i + row + 1 };
+            for (size_t k = 0; k < 6; k++) {
+                *indices++ = quad[k];
+            }
+        }
+    }
+    return mesh;
+}
+
+static void report(const char* name, const double milliseconds, const size_t triangles) {
+    printf("%-28s %9.1f ms %10.1f M triangles/s\n", name, milliseconds, triangles / milliseconds / 1e3);
+}
+
+int main() {
+
+    Mesh mesh = texturedGrid(GRID);
+    const size_t triangles = mesh.vertices.index_count / 3;
+    ThreadPool pool;
+    printf("%zu triangles, %zu vertices, %zu threads\n", triangles, mesh.vertices.vertex_count, pool.threadCount());
+
+    report("corner lists", bestOf([&]() {
+        const VertexCorners corners = vertexCorners(mesh.vertices.indices.begin(), mesh.vertices.index_count,
+                                                    mesh.vertices.vertex_count);
+        sink = sink + static_cast<float>(corners.corners[0]);
+    }), triangles);
+
+    report("normals, area weighted", bestOf([&]() {
+        generateNormals(mesh.vertices, NormalWeighting::Area, pool);
+        sink = sink + mesh.vertices.normals[1];
+    }), triangles);
+
+    report("normals, angle weighted", bestOf([&]() {
+        generateNormals(mesh.vertices, NormalWeighting::Angle, pool);
+        sink = sink + mesh.vertices.normals[1];
+    }), triangles);
+
+    report("tangents", bestOf([&]() {
+        generateTangents(mesh.vertices, pool);
+        sink = sink + mesh.vertices.tangents[0];
+    }), triangles);
+
+    report("both, as at import", bestOf([&]() {
+        mesh.vertices.normals = DArray<float>();
+        mesh.vertices.tangents = DArray<float>();
+        generateMissingVertexData(mesh, NormalWeighting::Angle, true, pool);
+        sink = sink + mesh.vertices.tangents[0];
+    }), triangles);
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+
+#include "benchmark_helpers.h"
+#include "mystl.hpp"
+
+// SmallArray against DArray for the short lists the scene graph and raycasts keep: child lists and
+// per-ray hit lists. counts heap allocations as well as time, build with the benchmarks flags (-O2 -DNDEBUG)
+
+constexpr size_t NODE_COUNT = 1'000'000;
+constexpr size_t RAY_COUNT = 1'000'000;
+
+static size_t allocations = 0;
+
+// malloc underneath like DArrayAllocator, but counted. no reallocate so both arrays grow the same way
+template<class T>
+struct CountedAllocator {
+    using value_type = T;
+
+    CountedAllocator() = default;
+    template<class U>
+    CountedAllocator(const CountedAllocator<U>&) {}
+
+    T* allocate(const size_t count) {
+        allocations++;
+        return static_cast<T*>(malloc(count * sizeof(T)));
+    }
+    void deallocate(T* memory, size_t) {
+        free(memory);
+    }
+
+    template<class U>
+    bool operator==(const CountedAllocator<U>&) const { return true; }
+    template<class U>
+    bool operator!=(const CountedAllocator<U>&) const { return false; }
+};
+
+template<template<class> class List>
+struct Node {
+    size_t id;
+    List<Node*> children;
+};
+
+template<class T>
+using DArrayList = DArray<T, CountedAllocator<T>>;
+template<class T>
+using SmallList = SmallArray<T, 4, CountedAllocator<T>>;
+
+// cheap deterministic numbers so both runs see the same shapes
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// a tree shaped like an imported asset, most nodes have a few children and some have many
+template<template<class> class List>
+static DArray<Node<List>*> buildTree() {
+    DArray<Node<List>*> nodes;
+    nodes.reserve(NODE_COUNT);
+    nodes.push_back(new Node<List>{ .id = 0 });
+
+    uint32_t state = 2463534242u;
+    size_t parent = 0;
+    while (nodes.size() < NODE_COUNT) {
+        const uint32_t roll = nextRandom(state) % 16;
+        const size_t children = roll < 12 ? roll % 4 + 1 : roll;
+        for (size_t i = 0; i < children && nodes.size() < NODE_COUNT; i++) {
+            Node<List>* child = new Node<List>{ .id = nodes.size() };
+            nodes[parent]->children.push_back(child);
+            nodes.push_back(child);
+        }
+        parent++;
+    }
+    return nodes;
+}
+
+template<template<class> class List>
+static size_t visit(const Node<List>* node) {
+    size_t sum = node->id;
+    for (const Node<List>* child : node->children) {
+        sum += visit(child);
+    }
+    return sum;
+}
+
+template<template<class> class List>
+static void freeTree(DArray<Node<List>*>& nodes) {
+    for (Node<List>* node : nodes) {
+        delete node;
+    }
+}
+
+typedef struct Hit {
+    float point[3];
+    size_t triangle;
+} Hit;
+
+// most rays hit nothing or a couple of triangles, a few graze a dense mesh
+template<class Hits>
+static void collectHits() {
+    uint32_t state = 88172645u;
+    double total = 0.0;
+    for (size_t ray = 0; ray < RAY_COUNT; ray++) {
+        Hits hits;
+        const uint32_t roll = nextRandom(state) % 64;
+        const size_t count = roll < 60 ? roll % 4 : 20;
+        for (size_t i = 0; i < count; i++) {
+            hits.push_back(Hit{ .point = { 0.f, 0.f, static_cast<float>(i) }, .triangle = i });
+        }
+        total += hits.size();
+    }
+    sink = sink + total;
+}
+
+// allocations made by one run of the work
+template<class Work>
+static size_t allocationsOf(Work work) {
+    const size_t before = allocations;
+    work();
+    return allocations - before;
+}
+
+template<template<class> class List>
+static void reportTree(const char* name) {
+    size_t built = 0;
+    const double build = bestOf([&built]() {
+        built = allocations;
+        DArray<Node<List>*> nodes = buildTree<List>();
+        built = allocations - built;
+        freeTree(nodes);
+    });
+
+    DArray<Node<List>*> nodes = buildTree<List>();
+    const double traverse = bestOf([&nodes]() { sink = sink + visit(nodes[0]); });
+    freeTree(nodes);
+
+    printf("%-30s %10zu %10.2f ms %10.2f ms\n", name, built, build, traverse);
+}
+
+template<class Hits>
+static void reportHits(const char* name) {
+    const size_t count = allocationsOf([]() { collectHits<Hits>(); });
+    const double time = bestOf([]() { collectHits<Hits>(); });
+    printf("%-30s %10zu %10.2f ms\n", name, count, time);
+}
+
+int main() {
+
+    printf("%-30s %10s %13s %13s\n", "1M node tree", "allocs", "build", "traverse");
+    reportTree<DArrayList>("DArray children");
+    reportTree<SmallList>("SmallArray<4> children");
+
+    printf("\n%-30s %10s %13s\n", "1M rays", "allocs", "collect");
+    reportHits<DArray<Hit, CountedAllocator<Hit>>>("DArray hits");
+    reportHits<SmallArray<Hit, 8, CountedAllocator<Hit>>>("SmallArray<8> hits");
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <vector>
+
+#include "benchmark_helpers.h"
+#include "mat4.h"
+#include "transform_batch.h"
+#include "thread_pool.h"
+
+using namespace mym;
+
+// a mesh worth of positions through one matrix: positionMultiplied per Vec3 against the batch calls,
+// packed, structure of arrays and split over a thread pool. GB/s counts the bytes read and written,
+// compare it with the machine's memory bandwidth. build with the benchmarks flags
+
+constexpr size_t POINT_COUNT = 4'000'000;
+constexpr size_t MIN_RANGE = 64 * 1024;
+
+static void report(const char* name, const double milliseconds, const double baseline) {
+    const double bytes = static_cast<double>(POINT_COUNT) * 3 * sizeof(float) * 2;
+    printf("%-30s %10.2f ms %8.2f GB/s %8.2fx\n", name, milliseconds, bytes / milliseconds / 1e6, baseline / milliseconds);
+}
+
+int main() {
+
+    std::vector<float> packed(POINT_COUNT * 3);
+    std::vector<float> xs(POINT_COUNT), ys(POINT_COUNT), zs(POINT_COUNT);
+    for (size_t i = 0; i < POINT_COUNT; i++) {
+        const float f = static_cast<float>(i) * 1e-3f;
+        packed[i * 3] = xs[i] = f;
+        packed[i * 3 + 1] = ys[i] = -f;
+        packed[i * 3 + 2] = zs[i] = 0.5f * f;
+    }
+    std::vector<float> out(POINT_COUNT * 3);
+    std::vector<float> out_xs(POINT_COUNT), out_ys(POINT_COUNT), out_zs(POINT_COUNT);
+
+    const Mat4 m = fromPositionAndEuler((Vec3){ .x = 1.f, .y = 2.f, .z = 3.f }, (Vec3){ .x = 0.3f, .y = 0.2f, .z = 0.1f });
+    ThreadPool pool;
+
+    printf("%-30s %13s %13s %9s\n", "4M positions", "time", "throughput", "speedup");
+
+    const double single = bestOf([&]() {
+        for (size_t i = 0; i < POINT_COUNT; i++) {
+            const Vec3 p = positionMultiplied((Vec3){ packed[i * 3], packed[i * 3 + 1], packed[i * 3 + 2] }, m);
+            out[i * 3] = p.x;
+            out[i * 3 + 1] = p.y;
+            out[i * 3 + 2] = p.z;
+        }
+        sink = sink + out.back();
+    });
+    report("positionMultiplied per point", single, single);
+
+    report("transformPositions packed", bestOf([&]() {
+        transformPositions(packed.data(), out.data(), POINT_COUNT, m);
+        sink = sink + out.back();
+    }), single);
+
+    report("projectPositions packed", bestOf([&]() {
+        projectPositions(packed.data(), out.data(), POINT_COUNT, m);
+        sink = sink + out.back();
+    }), single);
+
+    report("transformPositions soa", bestOf([&]() {
+        transformPositions((ConstVec3Arrays){ xs.data(), ys.data(), zs.data() },
+                           (Vec3Arrays){ out_xs.data(), out_ys.data(), out_zs.data() }, POINT_COUNT, m);
+        sink = sink + out_zs.back();
+    }), single);
+
+    char threaded[64];
+    snprintf(threaded, sizeof(threaded), "packed, %zu threads", pool.threadCount() + 1);
+    report(threaded, bestOf([&]() {
+        parallelFor(pool, POINT_COUNT, MIN_RANGE, [&](const size_t begin, const size_t end) {
+            transformPositions(packed.data() + begin * 3, out.data() + begin * 3, end - begin, m);
+        });
+        sink = sink + out.back();
+    }), single);
+
+    return 0;
+}
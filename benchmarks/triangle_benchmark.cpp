@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <float.h>
+#include <math.h>
+#include <vector>
+
+#include "benchmark_helpers.h"
+#include "vec.h"
+
+using namespace mym;
+
+// ray against triangle tests per second, the inner loop of a raycast. the test is the same one
+// rayIntersectsTriangle does, five subtracts, crosses and dots per triangle. built twice: against
+// the mym library (triangle_benchmark) and with every mym call inlined (triangle_benchmark_inline,
+// MYM_HEADER_ONLY). build with the benchmarks flags
+
+constexpr size_t TRIANGLE_COUNT = 1 << 16;
+constexpr int PASSES = 64;
+
+typedef struct Triangle {
+    Vec3 a, b, c;
+} Triangle;
+
+// distance along the ray, or -1 for a miss
+static float rayHitsTriangle(const Vec3 origin, const Vec3 direction, const Triangle& triangle) {
+    const Vec3 edge1 = subtractVectors(triangle.b, triangle.a);
+    const Vec3 edge2 = subtractVectors(triangle.c, triangle.a);
+    const Vec3 ray_cross_edge2 = cross(direction, edge2);
+    const float det = dot(edge1, ray_cross_edge2);
+    if (det > -FLT_EPSILON && det < FLT_EPSILON) return -1.f;
+
+    const float inv_det = 1.f / det;
+    const Vec3 s = subtractVectors(origin, triangle.a);
+    const float u = inv_det * dot(s, ray_cross_edge2);
+    if (u < 0.f || u > 1.f) return -1.f;
+
+    const Vec3 s_cross_edge1 = cross(s, edge1);
+    const float v = inv_det * dot(direction, s_cross_edge1);
+    if (v < 0.f || u + v > 1.f) return -1.f;
+
+    const float t = inv_det * dot(edge2, s_cross_edge1);
+    return t > FLT_EPSILON ? t : -1.f;
+}
+
+int main() {
+
+    // a bumpy grid under the ray, few hits but the misses drop out at different checks
+    std::vector<Triangle> triangles(TRIANGLE_COUNT);
+    for (size_t i = 0; i < TRIANGLE_COUNT; i++) {
+        const float x = static_cast<float>(i % 256) - 128.f;
+        const float z = static_cast<float>(i / 256) - 128.f;
+        const float y = 0.25f * sinf(x * 0.1f) * cosf(z * 0.1f);
+        triangles[i] = (Triangle){
+            .a = (Vec3){ .x = x, .y = y, .z = z },
+            .b = (Vec3){ .x = x + 1.f, .y = y, .z = z },
+            .c = (Vec3){ .x = x, .y = y + 0.1f, .z = z + 1.f },
+        };
+    }
+
+#ifdef MYM_HEADER_ONLY
+    const char* mode = "inlined (MYM_HEADER_ONLY)";
+#else
+    const char* mode = "mym library calls";
+#endif
+
+    int hits = 0;
+    const double milliseconds = bestOf([&]() {
+        hits = 0;
+        for (int pass = 0; pass < PASSES; pass++) {
+            const Vec3 origin = (Vec3){ .x = 0.01f * pass, .y = 10.f, .z = 0.f };
+            const Vec3 direction = normalize((Vec3){ .x = 0.3f, .y = -1.f, .z = 0.2f });
+            for (size_t i = 0; i < TRIANGLE_COUNT; i++) {
+                const float t = rayHitsTriangle(origin, direction, triangles[i]);
+                hits += t >= 0.f;
+                sink = sink + t;
+            }
+        }
+    });
+
+    const double tests = static_cast<double>(TRIANGLE_COUNT) * PASSES;
+    printf("%s: %.1f M triangle tests/s, %.2f ns per test, %d hits\n",
+           mode, tests / milliseconds / 1e3, milliseconds * 1e6 / tests, hits);
+
+    return 0;
+}
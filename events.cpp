@@ -6,6 +6,7 @@
 
 #include "events.h"
 #include "mat4.h"
+#include "material_table.h"
 #include "raycast.h"
 #include "tracy/Tracy.hpp"
 
@@ -123,8 +124,16 @@ void processEvents(WindowState& window, Camera& camera, InputState& input, Scene
                     for (auto& node: scene.nodes) {
                         if (node->name == "floor") {
                             const auto floor = node;
-                            if (std::holds_alternative<BasicColorMaterial>(clicked.meshIntersection.meshInfo.material)) {
-                                std::get<BasicColorMaterial>(floor->mesh.value().material).color = std::get<BasicColorMaterial>(clicked.meshIntersection.meshInfo.material).color;
+                            // materials are shared, the floor gets a material of its own with the new color
+                            MaterialTable& materials = materialTable();
+                            const std::optional<Material> hit_material = materials.material(clicked.meshIntersection.meshInfo.material);
+                            std::optional<Material> floor_material = materials.material(floor->mesh.value().material);
+                            if (hit_material.has_value() && std::holds_alternative<BasicColorMaterial>(hit_material.value()) &&
+                                floor_material.has_value() && std::holds_alternative<BasicColorMaterial>(floor_material.value())) {
+                                std::get<BasicColorMaterial>(floor_material.value()).color = std::get<BasicColorMaterial>(hit_material.value()).color;
+                                const MaterialHandle previous = floor->mesh.value().material;
+                                floor->mesh.value().material = materials.addMaterial(floor_material.value());
+                                materials.releaseMaterial(previous);
                             }
                             
                         }
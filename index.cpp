@@ -3,6 +3,9 @@
 #include "math_utils.h"
 #include "camera.h"
 #include "loaders.h"
+#include "material_table.h"
+#include "asset_streamer.h"
+#include "frame_arena.h"
 #include "gl_renderer.h"
 #include "scene.h"
 #include "events.h"
@@ -31,6 +34,9 @@ void updateScene(Scene& scene, float dt) {
 
 int main(int argc, char** argv)
 {
+    // time to first frame is measured from here
+    const Uint64 start_time = SDL_GetPerformanceCounter();
+
     AppState app_state;
 
     InputState input = {
@@ -60,6 +66,15 @@ int main(int argc, char** argv)
         .quadratic = 0.032f
     };
 
+    // glbs stream in on workers and nothing waits for them, until they're uploaded
+    // each one is stood in for by a grey box of roughly its size
+    ThreadPool asset_pool;
+    AssetStreamer streamer(asset_pool);
+    SceneNode* gorilla = streamer.request("assets/gorilla.glb", {}, "gorilla",
+        { -0.5f, 0.f, -0.5f }, { 0.5f, 1.f, 0.5f });
+    SceneNode* bowl = streamer.request("assets/bowl_from_nazca_culture_peru.glb", {}, "bowl",
+        { -0.1f, 0.f, -0.1f }, { 0.1f, 0.1f, 0.1f });
+
     // TODO do these need to be cleaned up?
     auto normals = read_csv("assets/normals.txt");
     auto positions = read_csv("assets/positions.txt");
@@ -85,7 +100,7 @@ int main(int argc, char** argv)
             (Vec3){  .x = 0.f, .y = PI / 2.f, .z = 0.f }),
             (Mesh){
                 .vertices =vertices,
-                .material = greenMaterial,
+                .material = materialTable().addMaterial(greenMaterial),
             },
             "green tree"
         );
@@ -101,7 +116,7 @@ int main(int argc, char** argv)
             (Vec3){  .x = 0.f, .y = PI / 2.f, .z = 0.f }),
             (Mesh){
                 .vertices =vertices,
-                .material = greyMaterial,
+                .material = materialTable().addMaterial(greyMaterial),
             },
             "grey tree"
         );
@@ -117,7 +132,7 @@ int main(int argc, char** argv)
             (Vec3){  .x = 0.f, .y = PI / 2.f, .z = 0.f }),
             (Mesh){
                 .vertices =vertices,
-                .material = blueMaterial,
+                .material = materialTable().addMaterial(blueMaterial),
             },
             "blue tree"
         );
@@ -164,7 +179,7 @@ int main(int argc, char** argv)
             (Vec3) { .x = 0.f, .y = 0.f, .z = 0.f }),
             (Mesh){
                 .vertices =floor_vertices,
-                .material = sandMaterial
+                .material = materialTable().addMaterial(sandMaterial)
             },
             "floor"
         );
@@ -177,23 +192,19 @@ int main(int argc, char** argv)
     // bowl_from_nazca_culture_peru.glb
     // gorila.glb
 
-    std::string gorilla_path = "assets/gorilla.glb";
-    SceneNode gorilla = load_glb(gorilla_path);
-    gorilla.name = "gorilla";
-    translate(gorilla.local_transform, -10.0f, 0.f, 0.f);
-    scale(gorilla.local_transform, 2.0f, 2.f, 2.f);
+    Mat4 gorilla_transform = toMat4(gorilla->local_transform);
+    translate(gorilla_transform, -10.0f, 0.f, 0.f);
+    scale(gorilla_transform, 2.0f, 2.f, 2.f);
 
-    updateWorldTransform(&gorilla);
-    scene_nodes.push_back(&gorilla);
+    updateTransform(gorilla, gorilla_transform);
+    scene_nodes.push_back(gorilla);
 
-    std::string bowl_path = "assets/bowl_from_nazca_culture_peru.glb";
-    SceneNode bowl = load_glb(bowl_path);
-    bowl.name = "bowl";
-    translate(bowl.local_transform, -10.0f, 0.35f, -3.f);
-    scale(bowl.local_transform, 10.f, 10.f, 10.f);
+    Mat4 bowl_transform = toMat4(bowl->local_transform);
+    translate(bowl_transform, -10.0f, 0.35f, -3.f);
+    scale(bowl_transform, 10.f, 10.f, 10.f);
 
-    updateWorldTransform(&bowl);
-    scene_nodes.push_back(&bowl);
+    updateTransform(bowl, bowl_transform);
+    scene_nodes.push_back(bowl);
 
 
     Scene scene =  {
@@ -235,6 +246,12 @@ int main(int argc, char** argv)
 
     Uint64 last_frame_time = now;
 
+    // start-up and hitch metrics, the first frame's delta is start-up so it isn't counted as a hitch
+    const double counter_milliseconds = 1000.0 / (double)SDL_GetPerformanceFrequency();
+    double time_to_first_frame = 0.0;
+    double worst_frame_time = 0.0;
+    bool first_frame = true;
+
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -254,6 +271,9 @@ int main(int argc, char** argv)
 
         const double deltaTime = ((now - last)*1000 / (double)SDL_GetPerformanceFrequency());
         last_frame_time = now;
+        if (!first_frame && deltaTime > worst_frame_time) {
+            worst_frame_time = deltaTime;
+        }
 
         // log errors
         const char* error = SDL_GetError();
@@ -263,6 +283,13 @@ int main(int argc, char** argv)
         }
 
 
+        // attach whatever finished loading, and drop the boxes of assets that are fully uploaded
+        streamer.poll();
+        for (SceneNode* retired : streamer.takeRetired()) {
+            renderer.releaseNode(retired);
+            delete retired;
+        }
+
         updateScene(scene, deltaTime);
 
         // even is forwarded to imgui in here
@@ -294,6 +321,50 @@ int main(int argc, char** argv)
         }
 
         ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+
+        const GeometryPoolStats pool_stats = renderer.geometryPoolStats();
+        ImGui::Text("Geometry pool: %zu pages, %zu/%zu vertices, %zu/%zu indices",
+            pool_stats.pages,
+            pool_stats.vertices_used, pool_stats.vertex_capacity,
+            pool_stats.indices_used, pool_stats.index_capacity);
+        ImGui::Text("Geometry pool fragmentation: vertices %.2f, indices %.2f",
+            pool_stats.vertex_fragmentation, pool_stats.index_fragmentation);
+
+        const DrawCounters draw_counters = renderer.drawCounters();
+        ImGui::Text("Last frame: %zu draw calls, %zu triangles, %zu texture binds", draw_counters.draw_calls,
+            draw_counters.triangles, draw_counters.texture_binds);
+
+        const TexturePoolStats texture_stats = renderer.texturePoolStats();
+        ImGui::Text("Texture pool: %zu pages, %zu/%zu layers, %.1f MiB (%.1f MiB in use of %.1f MiB budget, %zu shrunk)",
+            texture_stats.pages, texture_stats.layers_used, texture_stats.layers, texture_stats.bytes / (1024.0 * 1024.0),
+            texture_stats.used_bytes / (1024.0 * 1024.0), texture_stats.budget / (1024.0 * 1024.0), texture_stats.shrunk);
+        const PixelUploadRingStats& ring_stats = texture_stats.upload_ring;
+        ImGui::Text("Texture upload ring: %.1f/%.1f MiB over %zu frames in flight, %zu waits for room, %zu direct uploads",
+            ring_stats.in_flight / (1024.0 * 1024.0), ring_stats.capacity / (1024.0 * 1024.0), ring_stats.frames_in_flight,
+            ring_stats.full, ring_stats.direct_uploads);
+
+        ImGui::Text("Time to first frame %.1f ms, worst frame %.1f ms", time_to_first_frame, worst_frame_time);
+        const UploadStats upload_stats = renderer.uploadStats();
+        ImGui::Text("Streaming: %zu assets loading, %zu meshes waiting, last frame uploaded %zu meshes %zu textures (%.1f KiB, %.2f ms)",
+            streamer.pending(), upload_stats.waiting, upload_stats.meshes, upload_stats.textures,
+            upload_stats.bytes / 1024.0, upload_stats.milliseconds);
+        UploadBudget& upload_budget = renderer.uploadBudget();
+        ImGui::InputDouble("Upload budget (ms)", &upload_budget.milliseconds, 0.5, 2.0, "%.1f");
+
+        const MaterialTableStats material_stats = materialTable().stats();
+        ImGui::Text("Materials: %zu, textures: %zu (%zu on the gpu, %.1f KiB of pixels waiting, %zu trimmed)",
+            material_stats.materials, material_stats.textures, material_stats.uploaded_textures,
+            material_stats.pixel_bytes / 1024.0, material_stats.trimmed_textures);
+
+        const FrameArenaStats arena_stats = frameArena().stats();
+        ImGui::Text("Frame arena: %.1f KiB used, %.1f KiB high water of %.1f KiB, %zu heap allocations this frame",
+            arena_stats.used / 1024.0, arena_stats.high_water / 1024.0, arena_stats.capacity / 1024.0,
+            arena_stats.heap_allocations);
+
+        LodSettings& lod_settings = renderer.lodSettings();
+        ImGui::Checkbox("Mesh LODs", &lod_settings.enabled);
+        ImGui::SliderFloat("LOD pixel error", &lod_settings.max_pixel_error, 0.25f, 8.f);
+        ImGui::SliderFloat("Shadow LOD pixel error", &lod_settings.shadow_max_pixel_error, 0.25f, 16.f);
         ImGui::End();
 
         // Rendering
@@ -302,6 +373,15 @@ int main(int argc, char** argv)
 
         SDL_GL_SwapWindow(window.object);
 
+        if (first_frame) {
+            time_to_first_frame = (SDL_GetPerformanceCounter() - start_time) * counter_milliseconds;
+            printf("Time to first frame: %.1f ms\n", time_to_first_frame);
+            first_frame = false;
+        }
+
+        // nothing allocated from the arena this frame is used after this
+        frameArena().reset();
+
     }
 
     return 0;
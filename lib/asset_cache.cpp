@@ -0,0 +1,538 @@
+#include "asset_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <mutex>
+#include <type_traits>
+
+#include "material_table.h"
+#include "mesh_lod.h"
+#include "mystl.hpp"
+#include "texture_mips.h"
+
+constexpr size_t CACHE_ALIGNMENT = 64;
+constexpr char CACHE_MAGIC[8] = { 'N', 'R', 'C', 'A', 'C', 'H', 'E', '\0' };
+
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+// element offset and count of one blob
+typedef struct CacheArray {
+    uint64_t offset;
+    uint64_t count;
+} CacheArray;
+
+typedef struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t node_count;
+    uint64_t key;
+    uint64_t file_size;
+} CacheHeader;
+
+typedef struct CacheLod {
+    CacheArray indices;
+    float error;
+    uint32_t padding;
+} CacheLod;
+
+typedef struct CacheTexture {
+    int32_t width;
+    int32_t height;
+    int32_t channels;
+    uint32_t wrap_u;
+    uint32_t wrap_v;
+    int32_t levels;
+    uint64_t content_hash;
+    CacheArray source;
+    CacheArray pixels; // the whole mip chain, empty if the texture failed to decode
+} CacheTexture;
+
+enum CacheMaterial : uint32_t {
+    CACHE_MATERIAL_BASIC_COLOR = 0,
+    CACHE_MATERIAL_BASIC_TEXTURE = 1,
+};
+
+typedef struct CacheMesh {
+    uint64_t vertex_count;
+    uint64_t index_count;
+    CacheArray positions;
+    CacheArray normals;
+    CacheArray tangents;
+    CacheArray uvs;
+    CacheArray indices;
+
+    uint32_t compressed;
+    uint32_t normal_encoding;
+    float position_min[3];
+    float position_extent[3];
+    CacheArray compressed_positions;
+    CacheArray compressed_normals;
+    CacheArray compressed_uvs;
+
+    float lod_center[3];
+    float lod_radius;
+    CacheArray lods; // CacheLod records
+
+    uint32_t material;
+    float color[3];
+    float specular_color[3];
+    float shininess;
+    CacheTexture texture;
+} CacheMesh;
+
+typedef struct CacheNode {
+    int32_t parent; // index into the node records, -1 for the root
+    uint32_t has_mesh;
+    float local_transform[16];
+    CacheArray name;
+    CacheMesh mesh;
+} CacheNode;
+
+static_assert(std::is_trivially_copyable_v<CacheNode>, "cache records are written and read with memcpy");
+
+uint64_t hashBytes(const void* data, const size_t size, const uint64_t seed) {
+
+    // FNV-1a over 8 byte words, then the tail byte by byte
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    size_t i = 0;
+
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * FNV_PRIME;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+template<class T>
+static uint64_t hashValue(const T value, const uint64_t seed) {
+    return hashBytes(&value, sizeof(T), seed);
+}
+
+uint64_t assetCacheKey(const MappedFile& source, const ImportOptions& options) {
+
+    uint64_t key = hashValue(ASSET_CACHE_VERSION, FNV_OFFSET);
+    key = hashBytes(source.data(), source.size(), key);
+
+    // field by field, the struct has padding
+    key = hashValue(options.compress_vertices, key);
+    key = hashValue(static_cast<uint32_t>(options.normal_encoding), key);
+    key = hashValue(options.optimize_mesh, key);
+    key = hashValue(options.optimize_overdraw, key);
+    key = hashValue(options.generate_lods, key);
+    key = hashValue(static_cast<uint64_t>(options.max_lods), key);
+    key = hashValue(options.native_glb, key);
+    key = hashValue(options.generate_normals, key);
+    key = hashValue(static_cast<uint32_t>(options.normal_weighting), key);
+    key = hashValue(options.generate_tangents, key);
+    key = hashValue(static_cast<int64_t>(options.max_texture_size), key);
+
+    return key;
+}
+
+std::string assetCachePath(const std::string& cache_directory, const uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.nrc", static_cast<unsigned long long>(key));
+    return cache_directory + "/" + name;
+}
+
+//////// writing
+
+static CacheArray writeBlob(FILE* file, const void* data, const size_t element_size, const size_t count) {
+
+    static const unsigned char zeros[CACHE_ALIGNMENT] = {};
+
+    if (count == 0 || data == nullptr) {
+        return { 0, 0 };
+    }
+
+    const long position = ftell(file);
+    const size_t padding = (CACHE_ALIGNMENT - static_cast<size_t>(position) % CACHE_ALIGNMENT) % CACHE_ALIGNMENT;
+    fwrite(zeros, 1, padding, file);
+
+    const CacheArray array = { static_cast<uint64_t>(position) + padding, count };
+    fwrite(data, element_size, count, file);
+    return array;
+}
+
+template<class T>
+static CacheArray writeArray(FILE* file, const DArray<T>& array) {
+    return writeBlob(file, array.begin(), sizeof(T), array.size());
+}
+
+// nullopt if the mesh's material can't be written, its texture having been uploaded and its pixels freed
+// or trimmed by the pixel budget
+static std::optional<CacheMesh> writeMesh(FILE* file, const Mesh& mesh) {
+
+    const Vertices& vertices = mesh.vertices;
+    CacheMesh record = {};
+
+    record.vertex_count = vertices.vertex_count;
+    record.index_count = vertices.index_count;
+    record.positions = writeArray(file, vertices.positions);
+    record.normals = writeArray(file, vertices.normals);
+    record.tangents = writeArray(file, vertices.tangents);
+    record.uvs = writeArray(file, vertices.uvs);
+    record.indices = writeArray(file, vertices.indices);
+
+    if (vertices.compressed.has_value()) {
+        const CompressedVertices& compressed = vertices.compressed.value();
+        record.compressed = 1;
+        record.normal_encoding = static_cast<uint32_t>(compressed.normal_encoding);
+        memcpy(record.position_min, compressed.position_min.data, sizeof(float) * 3);
+        memcpy(record.position_extent, compressed.position_extent.data, sizeof(float) * 3);
+        record.compressed_positions = writeArray(file, compressed.positions);
+        record.compressed_normals = writeArray(file, compressed.normals);
+        record.compressed_uvs = writeArray(file, compressed.uvs);
+    }
+
+    memcpy(record.lod_center, mesh.lod.center.data, sizeof(float) * 3);
+    record.lod_radius = mesh.lod.radius;
+
+    DArray<CacheLod> lods;
+    for (const auto& level : mesh.lod.levels) {
+        lods.push_back({
+            .indices = writeArray(file, level.indices),
+            .error = level.error,
+            .padding = 0,
+        });
+    }
+    record.lods = writeArray(file, lods);
+
+    const std::optional<Material> material = materialTable().material(mesh.material);
+    if (!material.has_value()) {
+        return std::nullopt;
+    }
+
+    if (std::holds_alternative<BasicColorMaterial>(material.value())) {
+        const BasicColorMaterial& color = std::get<BasicColorMaterial>(material.value());
+        record.material = CACHE_MATERIAL_BASIC_COLOR;
+        memcpy(record.color, color.color.data, sizeof(float) * 3);
+        memcpy(record.specular_color, color.specular_color.data, sizeof(float) * 3);
+        record.shininess = color.shininess;
+        return record;
+    }
+
+    const BasicTextureMaterial& textured = std::get<BasicTextureMaterial>(material.value());
+    record.material = CACHE_MATERIAL_BASIC_TEXTURE;
+    record.shininess = textured.shininess;
+    record.texture.wrap_u = static_cast<uint32_t>(textured.wrap_u);
+    record.texture.wrap_v = static_cast<uint32_t>(textured.wrap_v);
+
+    // an untextured mesh has a null handle and writes no texture
+    bool writable = true;
+    materialTable().readTexture(textured.texture, [&](const TextureEntry& texture) {
+        if (texture.state == TextureState::Loading || texture.state == TextureState::Uploaded ||
+            texture.trimmed_levels > 0) {
+            writable = false;
+            return;
+        }
+        record.texture.content_hash = texture.content_hash;
+        record.texture.source = writeBlob(file, texture.source.data(), 1, texture.source.size());
+        if (texture.state == TextureState::Decoded) {
+            record.texture.width = texture.data.width;
+            record.texture.height = texture.data.height;
+            record.texture.channels = texture.data.channels;
+            record.texture.levels = texture.data.levels;
+            record.texture.pixels = writeBlob(file, texture.data.pixels, 1, mipChainBytes(texture.data));
+        }
+    });
+    if (!writable) {
+        return std::nullopt;
+    }
+
+    return record;
+}
+
+static void collectNodes(const SceneNode* node, const int32_t parent, DArray<const SceneNode*>& nodes, DArray<int32_t>& parents) {
+    const int32_t index = static_cast<int32_t>(nodes.size());
+    nodes.push_back(node);
+    parents.push_back(parent);
+
+    for (const SceneNode* child : node->children) {
+        collectNodes(child, index, nodes, parents);
+    }
+}
+
+bool writeAssetCache(const std::string& path, const SceneNode& root, const uint64_t key) {
+
+    // the cache lives next to the binary's working directory, make sure the folder is there
+    const size_t slash = path.find_last_of('/');
+    if (slash != std::string::npos) {
+        mkdir(path.substr(0, slash).c_str(), 0755);
+    }
+
+    const std::string temporary_path = path + ".tmp";
+    FILE* file = fopen(temporary_path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    DArray<const SceneNode*> nodes;
+    DArray<int32_t> parents;
+    collectNodes(&root, -1, nodes, parents);
+
+    // header and node records go first, they are rewritten once every blob offset is known
+    DArray<CacheNode> records(nodes.size(), CacheNode{});
+    CacheHeader header = {};
+    fwrite(&header, sizeof(CacheHeader), 1, file);
+    fwrite(records.begin(), sizeof(CacheNode), records.size(), file);
+
+    for (size_t i = 0; i < nodes.size(); i++) {
+        const SceneNode* node = nodes[i];
+        CacheNode& record = records[i];
+
+        record.parent = parents[i];
+        // records keep the full matrix, the format predates Affine
+        const Mat4 local_transform = toMat4(node->local_transform);
+        memcpy(record.local_transform, &local_transform.data[0][0], sizeof(float) * 16);
+
+        if (node->name.has_value()) {
+            record.name = writeBlob(file, node->name.value().data(), 1, node->name.value().size());
+        }
+
+        if (node->mesh.has_value()) {
+            const std::optional<CacheMesh> mesh = writeMesh(file, node->mesh.value());
+            if (!mesh.has_value()) {
+                fclose(file);
+                remove(temporary_path.c_str());
+                return false;
+            }
+            record.has_mesh = 1;
+            record.mesh = mesh.value();
+        }
+    }
+
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = ASSET_CACHE_VERSION;
+    header.node_count = static_cast<uint32_t>(nodes.size());
+    header.key = key;
+    header.file_size = static_cast<uint64_t>(ftell(file));
+
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(CacheHeader), 1, file);
+    fwrite(records.begin(), sizeof(CacheNode), records.size(), file);
+
+    const bool written = ferror(file) == 0;
+    fclose(file);
+
+    if (!written || rename(temporary_path.c_str(), path.c_str()) != 0) {
+        remove(temporary_path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+//////// reading
+
+// mappings that texture pixels point into, they live as long as the program does
+static DArray<MappedFile*> retained_mappings;
+static std::mutex retained_mappings_mutex; // scenes can be read on several loader threads
+
+static bool arrayFits(const MappedFile& file, const CacheArray array, const size_t element_size) {
+    return array.count == 0 ||
+        (array.offset <= file.size() && array.count <= (file.size() - array.offset) / element_size);
+}
+
+template<class T>
+static DArray<T> readArray(const MappedFile& file, const CacheArray array) {
+    if (array.count == 0) {
+        return DArray<T>();
+    }
+    return DArray<T>(reinterpret_cast<const T*>(file.data() + array.offset), array.count);
+}
+
+static bool meshFits(const MappedFile& file, const CacheMesh& record) {
+
+    if (!arrayFits(file, record.positions, sizeof(float)) || !arrayFits(file, record.normals, sizeof(float)) ||
+        !arrayFits(file, record.tangents, sizeof(float)) ||
+        !arrayFits(file, record.uvs, sizeof(float)) || !arrayFits(file, record.indices, sizeof(unsigned int)) ||
+        !arrayFits(file, record.compressed_positions, sizeof(uint16_t)) ||
+        !arrayFits(file, record.compressed_normals, 1) ||
+        !arrayFits(file, record.compressed_uvs, sizeof(uint16_t)) ||
+        !arrayFits(file, record.lods, sizeof(CacheLod)) ||
+        !arrayFits(file, record.texture.source, 1) || !arrayFits(file, record.texture.pixels, 1)) {
+        return false;
+    }
+
+    if (record.texture.pixels.count > 0) {
+        const CacheTexture& texture = record.texture;
+        if (texture.width <= 0 || texture.height <= 0 || texture.channels < 1 || texture.channels > 4 ||
+            texture.levels < 1 || texture.levels > mipLevelCount(texture.width, texture.height) ||
+            texture.pixels.count != mipLevelOffset(texture.width, texture.height, texture.channels, texture.levels)) {
+            return false;
+        }
+    }
+
+    // copied out like the node records, a corrupt offset could leave them unaligned
+    const DArray<CacheLod> lods = readArray<CacheLod>(file, record.lods);
+    for (size_t i = 0; i < lods.size(); i++) {
+        if (!arrayFits(file, lods[i].indices, sizeof(unsigned int))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static Mesh readMesh(const MappedFile& file, const CacheMesh& record, bool& uses_mapping) {
+
+    Mesh mesh = {
+        .vertices = {
+            .vertex_count = record.vertex_count,
+            .positions = readArray<float>(file, record.positions),
+            .normals = readArray<float>(file, record.normals),
+            .tangents = readArray<float>(file, record.tangents),
+            .uvs = readArray<float>(file, record.uvs),
+            .indices = readArray<unsigned int>(file, record.indices),
+            .index_count = record.index_count,
+        },
+    };
+
+    if (record.compressed) {
+        mesh.vertices.compressed = CompressedVertices{
+            .position_min = { record.position_min[0], record.position_min[1], record.position_min[2] },
+            .position_extent = { record.position_extent[0], record.position_extent[1], record.position_extent[2] },
+            .positions = readArray<uint16_t>(file, record.compressed_positions),
+            .normal_encoding = static_cast<NormalEncoding>(record.normal_encoding),
+            .normals = readArray<unsigned char>(file, record.compressed_normals),
+            .uvs = readArray<uint16_t>(file, record.compressed_uvs),
+        };
+    }
+
+    mesh.lod.center = { record.lod_center[0], record.lod_center[1], record.lod_center[2] };
+    mesh.lod.radius = record.lod_radius;
+
+    const DArray<CacheLod> lods = readArray<CacheLod>(file, record.lods);
+    for (size_t i = 0; i < lods.size(); i++) {
+        mesh.lod.levels.push_back({
+            .indices = readArray<unsigned int>(file, lods[i].indices),
+            .index_count = lods[i].indices.count,
+            .error = lods[i].error,
+            .first_index = 0,
+        });
+    }
+
+    MaterialTable& table = materialTable();
+
+    if (record.material == CACHE_MATERIAL_BASIC_COLOR) {
+        mesh.material = table.addMaterial(BasicColorMaterial{
+            .color = { record.color[0], record.color[1], record.color[2] },
+            .specular_color = { record.specular_color[0], record.specular_color[1], record.specular_color[2] },
+            .shininess = record.shininess,
+        });
+        return mesh;
+    }
+
+    BasicTextureMaterial material = {
+        .texture = {},
+        .wrap_u = static_cast<WrapMode>(record.texture.wrap_u),
+        .wrap_v = static_cast<WrapMode>(record.texture.wrap_v),
+        .shininess = record.shininess,
+    };
+
+    // a texture another scene or cache already brought in is shared, the pixels here go unused
+    if (record.texture.source.count > 0) {
+        const std::string source(reinterpret_cast<const char*>(file.data() + record.texture.source.offset),
+                                 record.texture.source.count);
+        bool created = false;
+        material.texture = table.acquireTexture(source, record.texture.content_hash, created);
+
+        if (created) {
+            TextureData pixels = {};
+            if (record.texture.pixels.count > 0) {
+                // zero copy, the renderer only ever reads the pixels
+                pixels = {
+                    .pixels = const_cast<unsigned char*>(file.data() + record.texture.pixels.offset),
+                    .width = record.texture.width,
+                    .height = record.texture.height,
+                    .channels = record.texture.channels,
+                    .levels = record.texture.levels,
+                    .needs_free = false,
+                };
+                uses_mapping = true;
+            }
+            table.setTexturePixels(material.texture, pixels);
+        }
+    }
+
+    mesh.material = table.addMaterial(material);
+    table.releaseTexture(material.texture);
+    return mesh;
+}
+
+std::optional<SceneNode> readAssetCache(const std::string& path, const uint64_t key) {
+
+    MappedFile* file = new MappedFile();
+    if (!file->open(path.c_str()) || file->size() < sizeof(CacheHeader)) {
+        delete file;
+        return std::nullopt;
+    }
+
+    CacheHeader header;
+    memcpy(&header, file->data(), sizeof(CacheHeader));
+
+    const size_t records_size = static_cast<size_t>(header.node_count) * sizeof(CacheNode);
+    if (memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != ASSET_CACHE_VERSION ||
+        header.key != key || header.file_size != file->size() || header.node_count == 0 ||
+        records_size > file->size() - sizeof(CacheHeader)) {
+        delete file;
+        return std::nullopt;
+    }
+
+    // the records sit straight after the 32 byte header, copy them out rather than trust their alignment
+    DArray<CacheNode> records(reinterpret_cast<const CacheNode*>(file->data() + sizeof(CacheHeader)), header.node_count);
+
+    for (const auto& record : records) {
+        if (!arrayFits(*file, record.name, 1) || (record.has_mesh && !meshFits(*file, record.mesh))) {
+            delete file;
+            return std::nullopt;
+        }
+    }
+
+    // parents come before their children, so every parent already exists when a child is made
+    DArray<SceneNode*> nodes;
+    bool uses_mapping = false;
+
+    for (const auto& record : records) {
+        Mat4 local;
+        memcpy(&local.data[0][0], record.local_transform, sizeof(float) * 16);
+
+        const std::string name(reinterpret_cast<const char*>(file->data() + record.name.offset), record.name.count);
+        SceneNode* node = new SceneNode(createSceneNode(local, std::nullopt, name));
+        // built in place, its streams were copied out of the mapping once already
+        if (record.has_mesh) {
+            node->mesh.emplace(readMesh(*file, record.mesh, uses_mapping));
+        }
+
+        if (record.parent >= 0 && static_cast<size_t>(record.parent) < nodes.size()) {
+            SceneNode* parent = nodes[record.parent];
+            node->parent = parent;
+            parent->children.push_back(node);
+        }
+
+        nodes.push_back(node);
+    }
+
+    if (uses_mapping) {
+        std::lock_guard<std::mutex> lock(retained_mappings_mutex);
+        retained_mappings.push_back(file);
+    } else {
+        delete file;
+    }
+
+    updateWorldTransform(nodes[0]);
+
+    // same as load_glb, the root is moved out and the children stay on the heap
+    SceneNode root = std::move(*nodes[0]);
+    delete nodes[0];
+    return root;
+}
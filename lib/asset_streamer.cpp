@@ -0,0 +1,244 @@
+#include "asset_streamer.h"
+
+#include <stdio.h>
+#include <chrono>
+#include <exception>
+
+#include "mat4.h"
+#include "material_table.h"
+
+using namespace mym;
+
+// more finished loads than this between two polls just makes the loaders wait
+constexpr size_t FINISHED_QUEUE_CAPACITY = 64;
+
+// flat shaded box, 4 vertices per face so every face gets its own normal
+static Mesh boundsBoxMesh(const Vec3 min, const Vec3 max) {
+
+    Mesh mesh = {
+        .vertices = { .vertex_count = 24, .index_count = 36 },
+        // every box shares the one grey material
+        .material = materialTable().addMaterial(BasicColorMaterial{
+            .color = { 0.35f, 0.35f, 0.35f },
+            .specular_color = { 0.f, 0.f, 0.f },
+            .shininess = 0.5f,
+        }),
+    };
+
+    // axis the face looks down, the sign of the normal, and the two axes spanning it
+    const size_t faces[6][3] = { { 0, 1, 2 }, { 0, 2, 1 }, { 1, 2, 0 }, { 1, 0, 2 }, { 2, 0, 1 }, { 2, 1, 0 } };
+    const float signs[2] = { 1.f, -1.f };
+
+    for (size_t face = 0; face < 6; face++) {
+        const size_t axis = faces[face][0];
+        const size_t u = faces[face][1];
+        const size_t v = faces[face][2];
+        const float sign = signs[face % 2];
+        const unsigned int first = static_cast<unsigned int>(face * 4);
+
+        for (size_t corner = 0; corner < 4; corner++) {
+            Vec3 position = {};
+            position.data[axis] = sign > 0.f ? max.data[axis] : min.data[axis];
+            position.data[u] = (corner == 1 || corner == 2) ? max.data[u] : min.data[u];
+            position.data[v] = (corner >= 2) ? max.data[v] : min.data[v];
+
+            for (size_t k = 0; k < 3; k++) {
+                mesh.vertices.positions.push_back(position.data[k]);
+                mesh.vertices.normals.push_back(k == axis ? sign : 0.f);
+            }
+        }
+
+        // wind both triangles to face outwards whichever way u x v points
+        const Vec3 u_axis = { u == 0 ? 1.f : 0.f, u == 1 ? 1.f : 0.f, u == 2 ? 1.f : 0.f };
+        const Vec3 v_axis = { v == 0 ? 1.f : 0.f, v == 1 ? 1.f : 0.f, v == 2 ? 1.f : 0.f };
+        const bool flip = cross(u_axis, v_axis).data[axis] * sign < 0.f;
+
+        const unsigned int quad[6] = { 0, 1, 2, 0, 2, 3 };
+        for (size_t i = 0; i < 6; i++) {
+            const unsigned int corner = flip ? quad[5 - i] : quad[i];
+            mesh.vertices.indices.push_back(first + corner);
+        }
+    }
+
+    return mesh;
+}
+
+bool isResident(const SceneNode* node) {
+
+    if (node->mesh.has_value()) {
+        const Mesh& mesh = node->mesh.value();
+        if (!mesh.id.has_value()) {
+            return false;
+        }
+        // a texture still decoding on another load, or decoded but not uploaded yet
+        const std::optional<Material> material = materialTable().material(mesh.material);
+        if (material.has_value() && std::holds_alternative<BasicTextureMaterial>(material.value())) {
+            const std::optional<TextureEntry> texture = materialTable().texture(
+                std::get<BasicTextureMaterial>(material.value()).texture);
+            if (texture.has_value() && (texture.value().state == TextureState::Loading ||
+                                        texture.value().state == TextureState::Decoded)) {
+                return false;
+            }
+        }
+    }
+
+    for (const SceneNode* child : node->children) {
+        if (!isResident(child)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+AssetStreamer::AssetStreamer(ThreadPool& pool)
+    : pool(pool), finished(FINISHED_QUEUE_CAPACITY), in_flight(0), closing(false) {}
+
+AssetStreamer::~AssetStreamer() {
+    {
+        std::unique_lock<std::mutex> lock(in_flight_mutex);
+        // loads waiting for room give up on the queue and free their scene themselves
+        closing = true;
+        space.notify_all();
+        idle.wait(lock, [&] { return in_flight == 0; });
+    }
+
+    // nothing polls any more, these were never attached to anything
+    while (std::optional<LoadedAsset> loaded = finished.tryPop()) {
+        if (loaded.value().root != nullptr) {
+            deleteSceneTree(loaded.value().root);
+        }
+    }
+}
+
+SceneNode* AssetStreamer::request(const std::string& path, const ImportOptions& options, const std::string& name,
+                                  const Vec3 bounds_min, const Vec3 bounds_max) {
+
+    const Mat4 identity = translation(0.f, 0.f, 0.f);
+    SceneNode* placeholder = new SceneNode(createSceneNode(identity, std::nullopt, name));
+    SceneNode* bounds_node = new SceneNode(createSceneNode(identity, boundsBoxMesh(bounds_min, bounds_max), name + " (loading)"));
+    setParent(*bounds_node, *placeholder);
+
+    const size_t index = requests.size();
+    requests.push_back({
+        .path = path,
+        .placeholder = placeholder,
+        .bounds_node = bounds_node,
+        .root = nullptr,
+        .resident = false,
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex);
+        in_flight++;
+    }
+    pool.submit([this, index, path, options]() {
+        // however the job ends, the destructor must hear about it
+        struct InFlightGuard {
+            AssetStreamer* streamer;
+            ~InFlightGuard() {
+                std::lock_guard<std::mutex> lock(streamer->in_flight_mutex);
+                streamer->in_flight--;
+                streamer->idle.notify_all();
+            }
+        } guard = { this };
+
+        const auto start = std::chrono::steady_clock::now();
+
+        // a failed load still reports back, its box would never retire otherwise
+        SceneNode* root = nullptr;
+        try {
+            root = new SceneNode(load_glb(path, options));
+        } catch (const char* message) {
+            printf("Failed to stream %s: %s\n", path.c_str(), message);
+        } catch (const std::exception& exception) {
+            printf("Failed to stream %s: %s\n", path.c_str(), exception.what());
+        } catch (...) {
+            printf("Failed to stream %s: unknown exception\n", path.c_str());
+        }
+
+        const LoadedAsset loaded = {
+            .request = index,
+            .root = root,
+            .load_milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+        };
+
+        // the GL thread drains the queue every frame, a full queue only means waiting for the next one
+        if (finished.tryPush(loaded)) {
+            return;
+        }
+        bool pushed = false;
+        {
+            std::unique_lock<std::mutex> lock(in_flight_mutex);
+            space.wait(lock, [&] {
+                pushed = finished.tryPush(loaded);
+                return pushed || closing;
+            });
+        }
+        if (!pushed && root != nullptr) {
+            deleteSceneTree(root);
+        }
+    });
+
+    return placeholder;
+}
+
+void AssetStreamer::poll() {
+
+    bool took_any = false;
+    while (std::optional<LoadedAsset> loaded = finished.tryPop()) {
+        took_any = true;
+        StreamRequest& request = requests[loaded.value().request];
+        request.root = loaded.value().root;
+
+        if (request.root == nullptr) {
+            // nothing is coming, stop showing the box
+            request.resident = true;
+            continue;
+        }
+
+        printf("Streamed %s in %.1f ms\n", request.path.c_str(), loaded.value().load_milliseconds);
+        setParent(*request.root, *request.placeholder);
+    }
+
+    if (took_any) {
+        // a load between its failed push and its wait holds the lock, taking it once means none misses this
+        {
+            std::lock_guard<std::mutex> lock(in_flight_mutex);
+        }
+        space.notify_all();
+    }
+
+    for (auto& request : requests) {
+        if (request.resident || request.root == nullptr || !isResident(request.root)) {
+            continue;
+        }
+
+        // swap the box out now that the real thing can be drawn in full
+        for (size_t i = 0; i < request.placeholder->children.size(); i++) {
+            if (request.placeholder->children[i] == request.bounds_node) {
+                request.placeholder->children.erase(i);
+                break;
+            }
+        }
+        request.bounds_node->parent = std::nullopt;
+        retired.push_back(request.bounds_node);
+        request.resident = true;
+    }
+}
+
+size_t AssetStreamer::pending() const {
+    size_t count = 0;
+    for (const auto& request : requests) {
+        if (!request.resident) {
+            count++;
+        }
+    }
+    return count;
+}
+
+DArray<SceneNode*> AssetStreamer::takeRetired() {
+    DArray<SceneNode*> taken = std::move(retired);
+    retired = DArray<SceneNode*>();
+    return taken;
+}
@@ -0,0 +1,127 @@
+#include "float_parser.h"
+
+#include <string.h>
+#include <algorithm>
+#include <charconv>
+#include <thread>
+#include <vector>
+
+// bytes per worker, keeps small files from being split over threads that cost more to start than to run
+constexpr size_t MIN_CHUNK_BYTES = 32 * 1024;
+
+static bool isSpace(const char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static size_t countCommas(const char* begin, const char* end) {
+    return static_cast<size_t>(std::count(begin, end, ','));
+}
+
+// parses every field in [begin, end) into out and returns how many were written.
+// begin has to be the start of a field, end either the end of the text or just past a comma
+static size_t parseRange(const char* begin, const char* end, float* out) {
+
+    const char* p = begin;
+    size_t count = 0;
+
+    while (p < end) {
+        while (p < end && isSpace(*p)) {
+            p++;
+        }
+        if (p == end) {
+            break; // trailing comma or whitespace
+        }
+
+        if (*p == '+') {
+            p++; // from_chars doesn't take a leading plus
+        }
+
+        float value = 0.f;
+        const char* field_end = p;
+        if (p < end && *p != ',') { // a lone plus can be the last thing in the text
+            const std::from_chars_result result = std::from_chars(p, end, value);
+            if (result.ec == std::errc()) {
+                field_end = result.ptr;
+            } else {
+                value = 0.f;
+            }
+        }
+        out[count++] = value;
+
+        const char* comma = static_cast<const char*>(memchr(field_end, ',', end - field_end));
+        if (comma == nullptr) {
+            break;
+        }
+        p = comma + 1;
+    }
+
+    return count;
+}
+
+DArray<float> parseFloats(const char* text, const size_t length) {
+
+    if (length == 0) {
+        return DArray<float>();
+    }
+
+    const char* end = text + length;
+
+    const size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t thread_count = length < PARALLEL_PARSE_MIN_BYTES
+        ? 1
+        : std::min(hardware_threads, length / MIN_CHUNK_BYTES);
+
+    // chunk boundaries sit just past a comma so every chunk starts on a field
+    std::vector<const char*> starts = { text };
+    for (size_t i = 1; i < thread_count; i++) {
+        const char* guess = std::max(text + length * i / thread_count, starts.back());
+        const char* comma = static_cast<const char*>(memchr(guess, ',', end - guess));
+        if (comma == nullptr) {
+            break;
+        }
+        starts.push_back(comma + 1);
+    }
+    starts.push_back(end);
+
+    const size_t chunk_count = starts.size() - 1;
+
+    // every field before a chunk is terminated by a comma, so the commas before it give its output offset
+    std::vector<size_t> offsets(chunk_count + 1, 0);
+    std::vector<size_t> written(chunk_count, 0);
+
+    auto forEachChunk = [&](auto work) {
+        if (chunk_count == 1) {
+            work(0);
+            return;
+        }
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < chunk_count; i++) {
+            workers.emplace_back(work, i);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    };
+
+    forEachChunk([&](const size_t i) {
+        offsets[i + 1] = countCommas(starts[i], starts[i + 1]);
+    });
+    for (size_t i = 0; i < chunk_count; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    // room for one more field after the last comma, trimmed below if it turns out to be empty
+    DArray<float> floats(offsets[chunk_count] + 1, 0.f);
+    float* out = floats.begin();
+
+    forEachChunk([&](const size_t i) {
+        written[i] = parseRange(starts[i], starts[i + 1], out + offsets[i]);
+    });
+
+    const size_t total = offsets[chunk_count - 1] + written[chunk_count - 1];
+    while (floats.size() > total) {
+        floats.pop_back();
+    }
+
+    return floats;
+}
@@ -0,0 +1,129 @@
+#include "frame_arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+
+static uintptr_t alignUp(const uintptr_t address, const size_t alignment) {
+    return (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+}
+
+FrameArena::FrameArena(const size_t initial_size)
+    : offset(0),
+      initial_size(initial_size),
+      last(nullptr),
+      last_bytes(0),
+      used(0),
+      high_water(0),
+      heap_allocations(0) {}
+
+FrameArena::~FrameArena() {
+    freeBlocks();
+}
+
+void FrameArena::addBlock(const size_t size) {
+    unsigned char* memory = static_cast<unsigned char*>(malloc(size));
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    blocks.push_back({ .memory = memory, .size = size });
+    offset = 0;
+    heap_allocations++;
+}
+
+void FrameArena::freeBlocks() {
+    for (const Block& block : blocks) {
+        free(block.memory);
+    }
+    blocks.clear();
+    offset = 0;
+}
+
+void* FrameArena::allocate(const size_t bytes, const size_t alignment) {
+
+    // nothing is allocated until the thread first asks, most threads never do
+    if (blocks.empty()) {
+        addBlock(std::max(initial_size, bytes + alignment));
+    }
+
+    Block* block = &blocks.back();
+    uintptr_t top = reinterpret_cast<uintptr_t>(block->memory) + offset;
+    uintptr_t start = alignUp(top, alignment);
+
+    if (start + bytes > reinterpret_cast<uintptr_t>(block->memory) + block->size) {
+        // the rest of this block is wasted until the reset folds the blocks together
+        addBlock(std::max(block->size * 2, bytes + alignment));
+        block = &blocks.back();
+        top = reinterpret_cast<uintptr_t>(block->memory);
+        start = alignUp(top, alignment);
+    }
+
+    const uintptr_t end = start + bytes;
+    used += end - top;
+    high_water = std::max(high_water, used);
+    offset = end - reinterpret_cast<uintptr_t>(block->memory);
+
+    last = reinterpret_cast<void*>(start);
+    last_bytes = bytes;
+    return last;
+}
+
+void* FrameArena::grow(void* memory, const size_t bytes, const size_t new_bytes, const size_t alignment) {
+
+    if (memory != nullptr && memory == last && bytes == last_bytes && new_bytes >= bytes) {
+        const Block& block = blocks.back();
+        const uintptr_t start = reinterpret_cast<uintptr_t>(memory);
+        if (start + new_bytes <= reinterpret_cast<uintptr_t>(block.memory) + block.size) {
+            used += new_bytes - bytes;
+            high_water = std::max(high_water, used);
+            offset = start + new_bytes - reinterpret_cast<uintptr_t>(block.memory);
+            last_bytes = new_bytes;
+            return memory;
+        }
+    }
+
+    void* grown = allocate(new_bytes, alignment);
+    if (memory != nullptr && bytes > 0) {
+        memcpy(grown, memory, std::min(bytes, new_bytes));
+    }
+    return grown;
+}
+
+void FrameArena::reset() {
+
+    // a frame that spilled into more blocks gets one block big enough for all of them next time
+    if (blocks.size() > 1) {
+        size_t total = 0;
+        for (const Block& block : blocks) {
+            total += block.size;
+        }
+        freeBlocks();
+        addBlock(total);
+    }
+
+    offset = 0;
+    last = nullptr;
+    last_bytes = 0;
+    used = 0;
+    heap_allocations = 0;
+}
+
+FrameArenaStats FrameArena::stats() const {
+    size_t capacity = 0;
+    for (const Block& block : blocks) {
+        capacity += block.size;
+    }
+    return {
+        .used = used,
+        .high_water = high_water,
+        .capacity = capacity,
+        .heap_allocations = heap_allocations,
+    };
+}
+
+FrameArena& frameArena() {
+    thread_local FrameArena arena;
+    return arena;
+}
@@ -0,0 +1,795 @@
+#include "glb_reader.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <future>
+
+#include "../third_party/stb_image.h"
+
+#include "affine.h"
+#include "asset_cache.h"
+#include "json.h"
+#include "mapped_file.h"
+#include "mat4.h"
+#include "material.h"
+#include "material_table.h"
+#include "texture_mips.h"
+
+using namespace mym;
+
+constexpr uint32_t GLB_MAGIC = 0x46546C67;       // "glTF"
+constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;  // "JSON"
+constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;   // "BIN\0"
+
+// accessor component types, same values as the GL enums
+constexpr uint32_t GLTF_BYTE = 5120;
+constexpr uint32_t GLTF_UNSIGNED_BYTE = 5121;
+constexpr uint32_t GLTF_SHORT = 5122;
+constexpr uint32_t GLTF_UNSIGNED_SHORT = 5123;
+constexpr uint32_t GLTF_UNSIGNED_INT = 5125;
+constexpr uint32_t GLTF_FLOAT = 5126;
+
+constexpr size_t GLTF_TRIANGLES = 4;
+
+// sampler wrap modes
+constexpr size_t GLTF_CLAMP_TO_EDGE = 33071;
+constexpr size_t GLTF_MIRRORED_REPEAT = 33648;
+
+// anything assimp can still read, readGlb turns it into nullopt
+typedef struct GlbUnsupported {
+    const char* reason;
+} GlbUnsupported;
+
+// the material table's textures for the images a base color texture samples
+typedef struct GlbImages {
+    DArray<std::optional<TextureHandle>> handles; // per image, nullopt for images nothing samples
+    DArray<std::shared_future<TextureData>> decoded;     // per image, valid where this read decodes
+} GlbImages;
+
+typedef struct GlbFile {
+    JsonDocument json;
+    const unsigned char* bin;
+    size_t bin_size;
+    JsonValues accessors;
+    JsonValues buffer_views;
+    JsonValues meshes;
+    JsonValues nodes;
+    JsonValues materials;
+    JsonValues textures;
+    JsonValues images;
+    JsonValues samplers;
+    GlbImages image_textures;
+} GlbFile;
+
+// where an accessor's elements are in the binary chunk
+typedef struct AccessorView {
+    const unsigned char* data; // nullptr for an accessor without a buffer view, which reads as zeros
+    size_t count;
+    size_t components;
+    uint32_t component_type;
+    size_t component_size;
+    size_t stride;
+    bool normalized;
+} AccessorView;
+
+static uint32_t readU32(const unsigned char* bytes) {
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static size_t componentSize(const uint32_t component_type) {
+    switch (component_type) {
+        case GLTF_BYTE:
+        case GLTF_UNSIGNED_BYTE:  return 1;
+        case GLTF_SHORT:
+        case GLTF_UNSIGNED_SHORT: return 2;
+        case GLTF_UNSIGNED_INT:
+        case GLTF_FLOAT:          return 4;
+        default: throw "glb accessor has an unknown component type";
+    }
+}
+
+static size_t componentCount(const JsonValue type) {
+    if (type.equals("SCALAR")) return 1;
+    if (type.equals("VEC2"))   return 2;
+    if (type.equals("VEC3"))   return 3;
+    if (type.equals("VEC4"))   return 4;
+    if (type.equals("MAT2"))   return 4;
+    if (type.equals("MAT3"))   return 9;
+    if (type.equals("MAT4"))   return 16;
+    throw "glb accessor has an unknown type";
+}
+
+static JsonValue element(const JsonValues& values, const size_t index, const char* error) {
+    if (index >= values.size()) {
+        throw error;
+    }
+    return values[index];
+}
+
+static AccessorView accessorView(const GlbFile& file, const size_t index) {
+
+    const JsonValue accessor = element(file.accessors, index, "glb accessor index out of range");
+
+    if (accessor["sparse"].isValid()) {
+        throw GlbUnsupported{ "sparse accessors" };
+    }
+
+    AccessorView view = {
+        .data = nullptr,
+        .count = accessor["count"].index(0),
+        .components = componentCount(accessor["type"]),
+        .component_type = static_cast<uint32_t>(accessor["componentType"].index(0)),
+        .component_size = 0,
+        .stride = 0,
+        .normalized = accessor["normalized"].boolean(false),
+    };
+    view.component_size = componentSize(view.component_type);
+    const size_t element_size = view.components * view.component_size;
+    view.stride = element_size;
+
+    if (!accessor["bufferView"].isValid()) {
+        return view;
+    }
+
+    const JsonValue buffer_view = element(file.buffer_views, accessor["bufferView"].index(SIZE_MAX),
+                                          "glb buffer view index out of range");
+    if (buffer_view["buffer"].index(SIZE_MAX) != 0) {
+        throw GlbUnsupported{ "buffers outside the binary chunk" };
+    }
+
+    const size_t view_offset = buffer_view["byteOffset"].index(0);
+    const size_t view_length = buffer_view["byteLength"].index(0);
+    const size_t accessor_offset = accessor["byteOffset"].index(0);
+    view.stride = buffer_view["byteStride"].index(element_size);
+
+    // every term against what's left rather than summed, the values come straight from the file and
+    // a sum can wrap past the checks
+    if (view.stride < element_size || view_offset > file.bin_size || view_length > file.bin_size - view_offset) {
+        throw "glb buffer view out of bounds";
+    }
+    if (view.count > 0 &&
+        (accessor_offset > view_length || element_size > view_length - accessor_offset ||
+         view.count - 1 > (view_length - accessor_offset - element_size) / view.stride)) {
+        throw "glb accessor out of bounds";
+    }
+
+    view.data = file.bin + view_offset + accessor_offset;
+    return view;
+}
+
+static float readComponent(const AccessorView& view, const unsigned char* bytes) {
+    switch (view.component_type) {
+        case GLTF_FLOAT: {
+            float value;
+            memcpy(&value, bytes, sizeof(value));
+            return value;
+        }
+        case GLTF_UNSIGNED_BYTE: {
+            const float value = bytes[0];
+            return view.normalized ? value / 255.f : value;
+        }
+        case GLTF_BYTE: {
+            const float value = static_cast<int8_t>(bytes[0]);
+            return view.normalized ? fmaxf(value / 127.f, -1.f) : value;
+        }
+        case GLTF_UNSIGNED_SHORT: {
+            uint16_t value;
+            memcpy(&value, bytes, sizeof(value));
+            return view.normalized ? value / 65535.f : value;
+        }
+        case GLTF_SHORT: {
+            int16_t value;
+            memcpy(&value, bytes, sizeof(value));
+            return view.normalized ? fmaxf(value / 32767.f, -1.f) : value;
+        }
+        default: {
+            uint32_t value;
+            memcpy(&value, bytes, sizeof(value));
+            return static_cast<float>(value);
+        }
+    }
+}
+
+// the first `components` components of every element as floats
+static DArray<float> readFloats(const AccessorView& view, const size_t components) {
+
+    if (view.data == nullptr) {
+        return DArray<float>(view.count * components, 0.f);
+    }
+
+    // the common case, the stream already has our layout and goes over in one copy
+    const bool packed = view.component_type == GLTF_FLOAT && view.components == components &&
+                        view.stride == components * sizeof(float) &&
+                        reinterpret_cast<uintptr_t>(view.data) % alignof(float) == 0;
+    if (packed) {
+        return DArray<float>(reinterpret_cast<const float*>(view.data), view.count * components);
+    }
+
+    // zeroed, missing components stay 0
+    DArray<float> values(view.count * components, 0.f);
+    float* out = values.begin();
+    const size_t available = components < view.components ? components : view.components;
+    for (size_t i = 0; i < view.count; i++) {
+        const unsigned char* item = view.data + i * view.stride;
+        for (size_t c = 0; c < available; c++) {
+            out[i * components + c] = readComponent(view, item + c * view.component_size);
+        }
+    }
+    return values;
+}
+
+static DArray<unsigned int> readIndices(const AccessorView& view) {
+
+    if (view.components != 1 || view.data == nullptr) {
+        throw "glb index accessor has to be scalar and backed by a buffer view";
+    }
+
+    const bool packed = view.component_type == GLTF_UNSIGNED_INT && view.stride == sizeof(unsigned int) &&
+                        reinterpret_cast<uintptr_t>(view.data) % alignof(unsigned int) == 0;
+    if (packed) {
+        return DArray<unsigned int>(reinterpret_cast<const unsigned int*>(view.data), view.count);
+    }
+
+    DArray<unsigned int> indices;
+    unsigned int* out = indices.extend(view.count);
+    for (size_t i = 0; i < view.count; i++) {
+        const unsigned char* item = view.data + i * view.stride;
+        switch (view.component_type) {
+            case GLTF_UNSIGNED_BYTE:
+                out[i] = item[0];
+                break;
+            case GLTF_UNSIGNED_SHORT: {
+                uint16_t index;
+                memcpy(&index, item, sizeof(index));
+                out[i] = index;
+                break;
+            }
+            case GLTF_UNSIGNED_INT:
+                memcpy(&out[i], item, sizeof(unsigned int));
+                break;
+            default:
+                throw "glb index accessor has a non integer component type";
+        }
+    }
+    return indices;
+}
+
+static WrapMode wrapMode(const size_t mode) {
+    switch (mode) {
+        case GLTF_CLAMP_TO_EDGE:    return WrapMode::Clamp;
+        case GLTF_MIRRORED_REPEAT:  return WrapMode::Mirror;
+        default:                    return WrapMode::Wrap;
+    }
+}
+
+// roughness is close to the blinn phong exponent 2 / roughness^4 - 2, kept in the range the shaders expect
+static float shininessFromRoughness(const float roughness) {
+    const float alpha_squared = fmaxf(roughness * roughness * roughness * roughness, 1e-4f);
+    return fminf(fmaxf(2.f / alpha_squared - 2.f, 0.5f), 256.f);
+}
+
+// image index of the material's base color texture, if it has one
+static std::optional<size_t> baseColorImage(const GlbFile& file, const JsonValue material) {
+    const JsonValue texture_info = material["pbrMetallicRoughness"]["baseColorTexture"];
+    if (!texture_info.isValid()) {
+        return std::nullopt;
+    }
+    const JsonValue texture = element(file.textures, texture_info["index"].index(SIZE_MAX), "glb texture index out of range");
+    if (!texture["source"].isValid()) {
+        return std::nullopt;
+    }
+    const size_t image = texture["source"].index(SIZE_MAX);
+    element(file.images, image, "glb image index out of range");
+    return image;
+}
+
+// the texture a material samples, if it has one
+static std::optional<TextureHandle> baseColorTexture(const GlbFile& file, const JsonValue material) {
+    const std::optional<size_t> image = baseColorImage(file, material);
+    return image.has_value() ? file.image_textures.handles[image.value()] : std::nullopt;
+}
+
+// material is Invalid for a primitive without one. Textured only if the primitive has uvs
+static MaterialHandle convertMaterial(const GlbFile& file, const JsonValue material, const bool has_uvs) {
+
+    if (!material.isValid()) {
+        return materialTable().addMaterial(BasicColorMaterial{
+            .color = { 1.f, 1.f, 1.f },
+            .specular_color = { 0.04f, 0.04f, 0.04f },
+            .shininess = 0.5f,
+        });
+    }
+
+    const JsonValue pbr = material["pbrMetallicRoughness"];
+    const JsonValue factor = pbr["baseColorFactor"];
+    const float metallic = static_cast<float>(pbr["metallicFactor"].number(1.0));
+    const float roughness = static_cast<float>(pbr["roughnessFactor"].number(1.0));
+    const float shininess = shininessFromRoughness(roughness);
+
+    const std::optional<TextureHandle> texture_handle = baseColorTexture(file, material);
+    if (texture_handle.has_value() && has_uvs) {
+        BasicTextureMaterial textured = {
+            .texture = texture_handle.value(),
+            .wrap_u = WrapMode::Wrap,
+            .wrap_v = WrapMode::Wrap,
+            .shininess = shininess,
+        };
+
+        const JsonValue texture = file.textures[pbr["baseColorTexture"]["index"].index(0)];
+        if (texture["sampler"].isValid()) {
+            const JsonValue sampler = element(file.samplers, texture["sampler"].index(SIZE_MAX), "glb sampler index out of range");
+            textured.wrap_u = wrapMode(sampler["wrapS"].index(0));
+            textured.wrap_v = wrapMode(sampler["wrapT"].index(0));
+        }
+        return materialTable().addMaterial(textured);
+    }
+
+    // dielectrics reflect about 4%, metals reflect their own color
+    Vec3 color = { 1.f, 1.f, 1.f };
+    for (size_t c = 0; c < 3; c++) {
+        color.data[c] = static_cast<float>(factor.at(c).number(1.0));
+    }
+    Vec3 specular;
+    for (size_t c = 0; c < 3; c++) {
+        specular.data[c] = 0.04f + (color.data[c] - 0.04f) * metallic;
+    }
+
+    return materialTable().addMaterial(BasicColorMaterial{
+        .color = color,
+        .specular_color = specular,
+        .shininess = shininess,
+    });
+}
+
+static std::optional<Mesh> convertPrimitive(const GlbFile& file, const JsonValue primitive, const std::string& name,
+                                            const ImportOptions& options) {
+
+    if (primitive["mode"].index(GLTF_TRIANGLES) != GLTF_TRIANGLES) {
+        printf("%s: skipping a primitive that isn't a triangle list\n", name.c_str());
+        return std::nullopt;
+    }
+
+    const JsonValue attributes = primitive["attributes"];
+    if (!attributes["POSITION"].isValid()) {
+        printf("%s: skipping a primitive without positions\n", name.c_str());
+        return std::nullopt;
+    }
+
+    const AccessorView positions = accessorView(file, attributes["POSITION"].index(SIZE_MAX));
+
+    Mesh mesh = {};
+    mesh.vertices.vertex_count = positions.count;
+    mesh.vertices.positions = readFloats(positions, 3);
+
+    if (attributes["NORMAL"].isValid()) {
+        const AccessorView normals = accessorView(file, attributes["NORMAL"].index(SIZE_MAX));
+        if (normals.count != positions.count) {
+            throw "glb normal count doesn't match the position count";
+        }
+        mesh.vertices.normals = readFloats(normals, 3);
+    }
+
+    // xyz and the bitangent sign in w, the layout Vertices keeps
+    if (attributes["TANGENT"].isValid()) {
+        const AccessorView tangents = accessorView(file, attributes["TANGENT"].index(SIZE_MAX));
+        if (tangents.count != positions.count) {
+            throw "glb tangent count doesn't match the position count";
+        }
+        mesh.vertices.tangents = readFloats(tangents, 4);
+    }
+
+    if (primitive["indices"].isValid()) {
+        mesh.vertices.indices = readIndices(accessorView(file, primitive["indices"].index(SIZE_MAX)));
+    } else {
+        // unindexed triangles, every three vertices make one
+        unsigned int* indices = mesh.vertices.indices.extend(positions.count);
+        for (size_t i = 0; i < positions.count; i++) {
+            indices[i] = static_cast<unsigned int>(i);
+        }
+    }
+    mesh.vertices.index_count = mesh.vertices.indices.size();
+
+    for (size_t i = 0; i < mesh.vertices.index_count; i++) {
+        if (mesh.vertices.indices[i] >= positions.count) {
+            throw "glb index out of range of the vertices";
+        }
+    }
+
+    const JsonValue material = primitive["material"].isValid()
+        ? element(file.materials, primitive["material"].index(SIZE_MAX), "glb material index out of range")
+        : JsonValue();
+
+    // glTF puts v = 0 at the top of the image, which is also the first row stb hands to GL,
+    // so neither the uvs nor the pixels need flipping
+    std::optional<DArray<float>> uvs;
+    const JsonValue texture_info = material["pbrMetallicRoughness"]["baseColorTexture"];
+    const std::string uv_attribute = "TEXCOORD_" + std::to_string(texture_info["texCoord"].index(0));
+    if (attributes[uv_attribute.c_str()].isValid()) {
+        const AccessorView uv_view = accessorView(file, attributes[uv_attribute.c_str()].index(SIZE_MAX));
+        if (uv_view.count != positions.count) {
+            throw "glb uv count doesn't match the position count";
+        }
+        uvs = readFloats(uv_view, 2);
+    }
+
+    // untextured meshes don't carry uvs to the gpu
+    const bool textured = uvs.has_value() && baseColorTexture(file, material).has_value();
+    if (textured) {
+        mesh.vertices.uvs = std::move(uvs.value());
+    }
+    mesh.id = std::nullopt;
+
+    processImportedMesh(mesh, name, options);
+
+    // only once nothing can throw, the mesh holds the material's user
+    mesh.material = convertMaterial(file, material, textured);
+    return mesh;
+}
+
+// the node's local transform, either a column major matrix or translation / rotation / scale
+static Affine nodeTransform(const JsonValue node) {
+
+    const JsonValue matrix = node["matrix"];
+    if (matrix.size() == 16) {
+        // column major with column vectors reads row by row as our row vector matrix
+        Mat4 m;
+        for (size_t i = 0; i < 16; i++) {
+            m.data[i / 4][i % 4] = static_cast<float>(matrix.at(i).number(i % 5 == 0 ? 1.0 : 0.0));
+        }
+        // gltf node matrices have to be affine
+        return toAffine(m);
+    }
+
+    const JsonValue t = node["translation"];
+    const JsonValue r = node["rotation"];
+    const JsonValue s = node["scale"];
+
+    return fromTranslationRotationScale(
+        (Vec3){
+            .x = static_cast<float>(t.at(0).number(0.0)),
+            .y = static_cast<float>(t.at(1).number(0.0)),
+            .z = static_cast<float>(t.at(2).number(0.0)),
+        },
+        (Vec4){
+            .x = static_cast<float>(r.at(0).number(0.0)),
+            .y = static_cast<float>(r.at(1).number(0.0)),
+            .z = static_cast<float>(r.at(2).number(0.0)),
+            .w = static_cast<float>(r.at(3).number(1.0)),
+        },
+        (Vec3){
+            .x = static_cast<float>(s.at(0).number(1.0)),
+            .y = static_cast<float>(s.at(1).number(1.0)),
+            .z = static_cast<float>(s.at(2).number(1.0)),
+        });
+}
+
+// nearly every gltf mesh has a single primitive
+typedef SmallArray<Mesh, 1> GlbPrimitives;
+
+// converted meshes per gltf mesh, kept until the last node that uses them takes them
+typedef struct GlbMeshes {
+    DArray<std::optional<GlbPrimitives>> converted;
+    DArray<size_t> remaining_uses;
+} GlbMeshes;
+
+static void releaseMaterials(GlbPrimitives& primitives) {
+    for (Mesh& mesh : primitives) {
+        materialTable().releaseMaterial(mesh.material);
+        mesh.material = {};
+    }
+}
+
+// meshes no node took, because their nodes aren't in the scene or the conversion stopped part way
+static void releaseUntakenMeshes(GlbMeshes& meshes) {
+    for (std::optional<GlbPrimitives>& primitives : meshes.converted) {
+        if (primitives.has_value()) {
+            releaseMaterials(primitives.value());
+        }
+    }
+    meshes.converted = DArray<std::optional<GlbPrimitives>>();
+}
+
+static GlbPrimitives takeMeshes(const GlbFile& file, GlbMeshes& meshes, const size_t index, const ImportOptions& options) {
+
+    const JsonValue mesh = element(file.meshes, index, "glb mesh index out of range");
+
+    if (!meshes.converted[index].has_value()) {
+        const std::string name = mesh["name"].string("mesh " + std::to_string(index));
+        GlbPrimitives primitives;
+        try {
+            for (const JsonValue& primitive : mesh["primitives"].elements()) {
+                std::optional<Mesh> converted = convertPrimitive(file, primitive, name, options);
+                if (converted.has_value()) {
+                    primitives.push_back(std::move(converted.value()));
+                }
+            }
+        } catch (...) {
+            // the primitives before the one that threw already hold their materials
+            releaseMaterials(primitives);
+            throw;
+        }
+        meshes.converted[index] = std::move(primitives);
+    }
+
+    // instanced meshes get copies, the last user takes the original
+    meshes.remaining_uses[index]--;
+    if (meshes.remaining_uses[index] == 0) {
+        GlbPrimitives taken = std::move(meshes.converted[index].value());
+        meshes.converted[index] = GlbPrimitives();
+        return taken;
+    }
+    GlbPrimitives copies;
+    for (const Mesh& original : meshes.converted[index].value()) {
+        copies.push_back(copyMesh(original));
+    }
+    return copies;
+}
+
+static SceneNode* convertGlbNode(const GlbFile& file, GlbMeshes& meshes, DArray<bool>& visited, const size_t index,
+                                 SceneNode* parent, const ImportOptions& options) {
+
+    const JsonValue json_node = element(file.nodes, index, "glb node index out of range");
+    if (visited[index]) {
+        throw "glb node hierarchy isn't a tree";
+    }
+    visited[index] = true;
+
+    const std::string name = json_node["name"].string("node " + std::to_string(index));
+    SceneNode* node = new SceneNode(createSceneNode(nodeTransform(json_node), std::nullopt, name));
+
+    if (parent) {
+        node->parent = parent;
+        parent->children.push_back(node);
+    }
+
+    if (json_node["mesh"].isValid()) {
+        GlbPrimitives primitives = takeMeshes(file, meshes, json_node["mesh"].index(SIZE_MAX), options);
+
+        if (primitives.size() == 1) {
+            node->mesh.emplace(std::move(primitives[0]));
+        } else {
+            // one child per primitive, each has its own material
+            for (size_t i = 0; i < primitives.size(); i++) {
+                SceneNode* child = new SceneNode(createSceneNode(translation(0.f, 0.f, 0.f), std::nullopt,
+                                                                 name + " primitive " + std::to_string(i)));
+                child->mesh.emplace(std::move(primitives[i]));
+                child->parent = node;
+                node->children.push_back(child);
+            }
+        }
+    }
+
+    for (const JsonValue& child : json_node["children"].elements()) {
+        convertGlbNode(file, meshes, visited, child.index(SIZE_MAX), node, options);
+    }
+
+    return node;
+}
+
+// acquires the texture of every image a base color texture samples and decodes the ones new to the
+// table straight from the mapped file, mip chains included. Fills file.image_textures as it goes, so a throw part way
+// still leaves finishGlbImages everything it has to give back
+static void acquireGlbImages(GlbFile& file, const std::string& path, const int max_texture_size, ThreadPool& decode_pool) {
+
+    GlbImages& images = file.image_textures;
+    images.handles = DArray<std::optional<TextureHandle>>(file.images.size(), std::nullopt);
+    images.decoded = DArray<std::shared_future<TextureData>>(file.images.size(), std::shared_future<TextureData>());
+
+    for (const JsonValue& material : file.materials) {
+        const std::optional<size_t> image_index = baseColorImage(file, material);
+        if (!image_index.has_value() || images.handles[image_index.value()].has_value()) {
+            continue;
+        }
+
+        const JsonValue image = file.images[image_index.value()];
+        if (!image["bufferView"].isValid()) {
+            throw GlbUnsupported{ "images outside the binary chunk" };
+        }
+
+        const JsonValue buffer_view = element(file.buffer_views, image["bufferView"].index(SIZE_MAX),
+                                              "glb buffer view index out of range");
+        const size_t offset = buffer_view["byteOffset"].index(0);
+        const size_t length = buffer_view["byteLength"].index(0);
+        // stb takes the length as an int
+        if (buffer_view["buffer"].index(SIZE_MAX) != 0 || offset > file.bin_size || length > file.bin_size - offset ||
+            length > INT_MAX) {
+            throw "glb image buffer view out of bounds";
+        }
+
+        const unsigned char* bytes = file.bin + offset;
+        bool created = false;
+        images.handles[image_index.value()] = materialTable().acquireTexture(
+            path + "*" + std::to_string(image_index.value()), hashBytes(bytes, length, 0), created);
+        if (!created) {
+            continue;
+        }
+
+        images.decoded[image_index.value()] = decode_pool.submit([bytes, length, max_texture_size]() {
+            TextureData texture = {};
+            stbi_set_flip_vertically_on_load_thread(false);
+            texture.pixels = stbi_load_from_memory(bytes, static_cast<int>(length),
+                                                   &texture.width, &texture.height, &texture.channels, 0);
+            texture.levels = 1;
+            texture.needs_free = texture.pixels != nullptr;
+            if (texture.pixels == nullptr) {
+                printf("Failed to decode glb image: %s\n", stbi_failure_reason());
+            }
+            return buildMipChain(texture, max_texture_size);
+        }).share();
+    }
+}
+
+// waits for decodes that are still reading the mapping, hands their pixels to the table and gives back
+// the read's own references. Runs on every way out of readGlb, a texture no material took goes away
+static void finishGlbImages(GlbImages& images) {
+    MaterialTable& table = materialTable();
+    for (size_t i = 0; i < images.handles.size(); i++) {
+        if (!images.handles[i].has_value()) {
+            continue;
+        }
+        if (images.decoded[i].valid()) {
+            table.setTexturePixels(images.handles[i].value(), images.decoded[i].get());
+        }
+        table.releaseTexture(images.handles[i].value());
+    }
+    images.handles = DArray<std::optional<TextureHandle>>();
+}
+
+// header and chunks, the json is parsed in place out of the mapping
+static void parseGlbContainer(const MappedFile& mapping, GlbFile& file) {
+
+    const unsigned char* bytes = mapping.data();
+    const size_t size = mapping.size();
+
+    if (size < 20 || readU32(bytes) != GLB_MAGIC) {
+        throw "not a glb file";
+    }
+    if (readU32(bytes + 4) != 2) {
+        throw GlbUnsupported{ "glb versions other than 2" };
+    }
+    const size_t total = readU32(bytes + 8);
+    if (total > size) {
+        throw "glb file is truncated";
+    }
+
+    const size_t json_length = readU32(bytes + 12);
+    if (readU32(bytes + 16) != GLB_CHUNK_JSON || 20 + json_length > total) {
+        throw "glb json chunk is missing or truncated";
+    }
+    if (!file.json.parse(reinterpret_cast<const char*>(bytes + 20), json_length)) {
+        throw "glb json chunk is malformed";
+    }
+
+    // chunks are 4 byte aligned, so is the binary chunk's data
+    file.bin = nullptr;
+    file.bin_size = 0;
+    const size_t bin_header = 20 + ((json_length + 3) & ~size_t(3));
+    if (bin_header + 8 <= total && readU32(bytes + bin_header + 4) == GLB_CHUNK_BIN) {
+        file.bin_size = readU32(bytes + bin_header);
+        file.bin = bytes + bin_header + 8;
+        if (bin_header + 8 + file.bin_size > total) {
+            throw "glb binary chunk is truncated";
+        }
+    }
+}
+
+// everything a readGlb that threw had converted, before it falls back or rethrows
+static void discardPartialScene(SceneNode* root, GlbMeshes& meshes) {
+    // a tree that didn't finish converting, nothing of it has been uploaded yet
+    if (root != nullptr) {
+        deleteSceneTree(root);
+    }
+    releaseUntakenMeshes(meshes);
+}
+
+std::optional<SceneNode> readGlb(const std::string& path, const ImportOptions& options, ThreadPool& decode_pool) {
+
+    MappedFile mapping;
+    if (!mapping.open(path.c_str())) {
+        printf("Failed to open %s\n", path.c_str());
+        throw "failed to open glb file";
+    }
+
+    GlbFile file;
+    // outside the try, a throw part way has to give back what was converted so far
+    GlbMeshes meshes = {};
+    SceneNode* root_ptr = nullptr;
+
+    try {
+        parseGlbContainer(mapping, file);
+
+        const JsonValue gltf = file.json.root();
+        if (gltf["asset"]["version"].string().compare(0, 1, "2") != 0) {
+            throw GlbUnsupported{ "glTF versions other than 2" };
+        }
+        if (gltf["extensionsRequired"].size() > 0) {
+            throw GlbUnsupported{ "required extensions" };
+        }
+        for (const JsonValue& buffer : gltf["buffers"].elements()) {
+            if (buffer["uri"].isValid()) {
+                throw GlbUnsupported{ "external or data uri buffers" };
+            }
+        }
+
+        file.accessors = gltf["accessors"].elements();
+        file.buffer_views = gltf["bufferViews"].elements();
+        file.meshes = gltf["meshes"].elements();
+        file.nodes = gltf["nodes"].elements();
+        file.materials = gltf["materials"].elements();
+        file.textures = gltf["textures"].elements();
+        file.images = gltf["images"].elements();
+        file.samplers = gltf["samplers"].elements();
+
+        // images decode on the pool while the meshes convert on this thread
+        acquireGlbImages(file, path, options.max_texture_size, decode_pool);
+
+        meshes = {
+            .converted = DArray<std::optional<GlbPrimitives>>(),
+            .remaining_uses = DArray<size_t>(file.meshes.size(), 0),
+        };
+        // all empty, meshes are move only so there is nothing to fill with copies of
+        meshes.converted.extend(file.meshes.size());
+        for (const JsonValue& node : file.nodes) {
+            if (node["mesh"].isValid()) {
+                const size_t mesh = node["mesh"].index(SIZE_MAX);
+                element(file.meshes, mesh, "glb mesh index out of range");
+                meshes.remaining_uses[mesh]++;
+            }
+        }
+
+        // the default scene, or every node nothing else parents if there is none
+        SmallArray<size_t, 4> roots;
+        const JsonValue scenes = gltf["scenes"];
+        if (scenes.size() > 0) {
+            const JsonValue scene = scenes.at(gltf["scene"].index(0));
+            for (const JsonValue& node : scene["nodes"].elements()) {
+                roots.push_back(node.index(SIZE_MAX));
+            }
+        } else {
+            DArray<bool> is_child(file.nodes.size(), false);
+            for (const JsonValue& node : file.nodes) {
+                for (const JsonValue& child : node["children"].elements()) {
+                    if (child.index(SIZE_MAX) < is_child.size()) {
+                        is_child[child.index(SIZE_MAX)] = true;
+                    }
+                }
+            }
+            for (size_t i = 0; i < file.nodes.size(); i++) {
+                if (!is_child[i]) {
+                    roots.push_back(i);
+                }
+            }
+        }
+
+        const std::string root_name = scenes.at(gltf["scene"].index(0))["name"].string("root");
+        root_ptr = new SceneNode(createSceneNode(translation(0.f, 0.f, 0.f), std::nullopt, root_name));
+
+        DArray<bool> visited(file.nodes.size(), false);
+        for (const size_t node : roots) {
+            convertGlbNode(file, meshes, visited, node, root_ptr, options);
+        }
+
+        releaseUntakenMeshes(meshes);
+        finishGlbImages(file.image_textures);
+
+        // children are heap nodes, updateWorldTransform on the returned root points them back at it
+        SceneNode root = std::move(*root_ptr);
+        delete root_ptr;
+        return root;
+
+    } catch (const GlbUnsupported& unsupported) {
+        discardPartialScene(root_ptr, meshes);
+        // decodes still running read from the mapping, let them finish before it goes away
+        finishGlbImages(file.image_textures);
+        printf("%s uses %s, falling back to assimp\n", path.c_str(), unsupported.reason);
+        return std::nullopt;
+    } catch (...) {
+        discardPartialScene(root_ptr, meshes);
+        finishGlbImages(file.image_textures);
+        throw;
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <optional>
+#include <string>
+
+#include "loaders.h"
+#include "mapped_file.h"
+#include "scene.h"
+
+// Binary cache of a converted scene, written after the first import and mmapped on the next one.
+//
+//   header   magic, version, node count, key, file size
+//   nodes    one fixed size record per node in depth first order, parents before children
+//   blobs    names, vertex streams exactly as the geometry pool uploads them, index buffers,
+//            lod index buffers and decoded texture mip chains, each starting on a 64 byte boundary
+//
+// The key hashes the source file and every import option that changes the output, so editing either
+// just misses the cache. Bump ASSET_CACHE_VERSION whenever the records change.
+constexpr uint32_t ASSET_CACHE_VERSION = 4;
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed);
+
+uint64_t assetCacheKey(const MappedFile& source, const ImportOptions& options);
+
+std::string assetCachePath(const std::string& cache_directory, uint64_t key);
+
+// writes to a temporary file and renames it over path, so a crash never leaves half a cache behind.
+// false as well if a texture the scene uses is already on the gpu, its pixels are gone by then, or if
+// the pixel budget trimmed its top levels (see MaterialTable::setPixelBudget)
+bool writeAssetCache(const std::string& path, const SceneNode& root, uint64_t key);
+
+// nullopt if the file is missing, from another version or doesn't match the key.
+// vertex and index streams are bulk copied out of the mapping. Materials and textures go into
+// materialTable(), textures it doesn't have yet point straight into the mapping (needs_free is false)
+// and the mapping stays alive for the rest of the program
+std::optional<SceneNode> readAssetCache(const std::string& path, uint64_t key);
+
+#endif //ASSET_CACHE_H
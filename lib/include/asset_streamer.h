@@ -0,0 +1,74 @@
+#ifndef ASSET_STREAMER_H
+#define ASSET_STREAMER_H
+
+#include <stddef.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+#include "concurrent_queue.hpp"
+#include "loaders.h"
+#include "mystl.hpp"
+#include "scene.h"
+#include "thread_pool.h"
+#include "vec.h"
+
+// a finished load on its way from a loader thread to the GL thread
+typedef struct LoadedAsset {
+    size_t request;
+    SceneNode* root; // nullptr if the load failed
+    double load_milliseconds;
+} LoadedAsset;
+
+typedef struct StreamRequest {
+    std::string path;
+    SceneNode* placeholder;  // what the caller positions and adds to the scene
+    SceneNode* bounds_node;  // grey box under the placeholder, shown until the asset is resident
+    SceneNode* root;         // loaded scene, nullptr until it arrives
+    bool resident;
+} StreamRequest;
+
+// Loads glb files in the background. Each request hands back a placeholder node straight away, with
+// a box of the expected bounds as its only child so there is something to look at. Finished scenes come
+// back over a lock free queue and are parented under their placeholder on the GL thread, and the box is
+// retired once every mesh and texture in the scene has been uploaded
+class AssetStreamer {
+
+    private:
+        ThreadPool& pool;
+        BoundedQueue<LoadedAsset> finished;
+        // loads that haven't pushed their result yet, the destructor waits on idle for them. A load
+        // finding the queue full waits on space, which poll signals once it has taken something out
+        std::mutex in_flight_mutex;
+        std::condition_variable idle;
+        std::condition_variable space;
+        size_t in_flight;
+        bool closing; // the destructor has started, nothing will make room in the queue any more
+        DArray<StreamRequest> requests;
+        DArray<SceneNode*> retired;
+
+    public:
+        explicit AssetStreamer(ThreadPool& pool);
+        // waits for loads still running, they push into this object's queue. Scenes nobody polled are freed
+        ~AssetStreamer();
+
+        AssetStreamer(const AssetStreamer&) = delete;
+        AssetStreamer& operator=(const AssetStreamer&) = delete;
+
+        SceneNode* request(const std::string& path, const ImportOptions& options, const std::string& name,
+                           mym::Vec3 bounds_min, mym::Vec3 bounds_max);
+
+        // GL thread, once a frame: attaches arrived scenes and retires the boxes of resident ones
+        void poll();
+
+        // requests whose box is still showing
+        size_t pending() const;
+
+        // boxes that are no longer in the scene, the renderer still has to release their geometry
+        DArray<SceneNode*> takeRetired();
+};
+
+// every mesh in the tree is in the geometry pool and every texture it samples has been created
+bool isResident(const SceneNode* node);
+
+#endif //ASSET_STREAMER_H
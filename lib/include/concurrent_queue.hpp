@@ -0,0 +1,100 @@
+#ifndef CONCURRENT_QUEUE_H
+#define CONCURRENT_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <optional>
+#include <stdexcept>
+
+// bounded lock free queue, any number of producers and consumers (Dmitry Vyukov's MPMC ring).
+// every slot carries a sequence number saying whether it is ready to be written or read, so
+// a push or pop is one compare and swap on the shared position plus a store on the slot
+template<class T>
+class BoundedQueue {
+    private:
+        struct Slot {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        // producers and consumers hammer different positions, keep them off each other's cache line
+        static constexpr size_t CACHE_LINE = 64;
+
+        Slot* slots;
+        size_t mask;
+        alignas(CACHE_LINE) std::atomic<size_t> enqueue_position;
+        alignas(CACHE_LINE) std::atomic<size_t> dequeue_position;
+
+    public:
+        // capacity has to be a power of two
+        explicit BoundedQueue(const size_t capacity)
+            : slots(new Slot[capacity]),
+              mask(capacity - 1),
+              enqueue_position(0),
+              dequeue_position(0)
+        {
+            if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+                delete[] slots;
+                throw std::invalid_argument("queue capacity must be a power of two");
+            }
+            for (size_t i = 0; i < capacity; i++) {
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ~BoundedQueue() {
+            delete[] slots;
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        // false if the queue is full
+        bool tryPush(const T& value) {
+            size_t position = enqueue_position.load(std::memory_order_relaxed);
+
+            while (true) {
+                Slot& slot = slots[position & mask];
+                const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+                if (difference == 0) {
+                    if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        slot.value = value;
+                        slot.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = enqueue_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // nullopt if the queue is empty
+        std::optional<T> tryPop() {
+            size_t position = dequeue_position.load(std::memory_order_relaxed);
+
+            while (true) {
+                Slot& slot = slots[position & mask];
+                const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+                if (difference == 0) {
+                    if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        T value = std::move(slot.value);
+                        slot.sequence.store(position + mask + 1, std::memory_order_release);
+                        return value;
+                    }
+                } else if (difference < 0) {
+                    return std::nullopt;
+                } else {
+                    position = dequeue_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+};
+
+#endif //CONCURRENT_QUEUE_H
@@ -0,0 +1,16 @@
+#ifndef FLOAT_PARSER_H
+#define FLOAT_PARSER_H
+
+#include <stddef.h>
+
+#include "mystl.hpp"
+
+// below this much text a single thread beats spinning up workers
+constexpr size_t PARALLEL_PARSE_MIN_BYTES = 64 * 1024;
+
+// parses comma separated floats, whitespace around them is ignored. An empty field reads as 0 (like atof)
+// and a trailing comma doesn't add a value. Big inputs are split at commas and parsed on several threads
+// straight into one pre-sized array
+DArray<float> parseFloats(const char* text, size_t length);
+
+#endif //FLOAT_PARSER_H
@@ -0,0 +1,91 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <stddef.h>
+
+#include "mystl.hpp"
+
+typedef struct FrameArenaStats {
+    size_t used;            // bytes handed out since the last reset, alignment padding included
+    size_t high_water;      // most bytes any frame has used
+    size_t capacity;        // bytes the arena holds across all its blocks
+    size_t heap_allocations; // blocks malloc'd since the last reset, 0 once the arena has warmed up
+} FrameArenaStats;
+
+// bump allocator for data that only lives until the end of the frame. allocating is a pointer bump,
+// nothing is freed on its own, reset() drops everything at once. when a frame outgrows the block the
+// extra blocks are merged into one on the next reset, so after a frame or two it stops touching the heap
+class FrameArena {
+
+    private:
+        typedef struct Block {
+            unsigned char* memory;
+            size_t size;
+        } Block;
+
+        DArray<Block> blocks; // the last one is the one being bumped
+        size_t offset;        // into the last block
+        size_t initial_size;
+        void* last;           // most recent allocation, the only one that can grow in place
+        size_t last_bytes;
+
+        size_t used;
+        size_t high_water;
+        size_t heap_allocations;
+
+        void addBlock(size_t size);
+        void freeBlocks();
+
+    public:
+        explicit FrameArena(size_t initial_size = 1024 * 1024);
+        ~FrameArena();
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        // never null, alignment has to be a power of two
+        void* allocate(size_t bytes, size_t alignment);
+
+        // grows an allocation to new_bytes, in place when nothing was allocated after it
+        void* grow(void* memory, size_t bytes, size_t new_bytes, size_t alignment);
+
+        // everything allocated so far is gone after this
+        void reset();
+
+        FrameArenaStats stats() const;
+};
+
+// the calling thread's arena. the render loop resets the main thread's one at the end of each frame
+FrameArena& frameArena();
+
+// hands DArray and SmallArray frame memory. deallocate does nothing, the memory goes with the frame,
+// so a container using it must not outlive the frame it was filled in
+template<class T>
+struct FrameAllocator {
+    using value_type = T;
+
+    FrameAllocator() = default;
+    template<class U>
+    FrameAllocator(const FrameAllocator<U>&) {}
+
+    T* allocate(const size_t count) {
+        return static_cast<T*>(frameArena().allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) {}
+
+    // only ever called for trivially copyable T, see DArray
+    T* reallocate(T* memory, const size_t count, const size_t new_count) {
+        return static_cast<T*>(frameArena().grow(memory, count * sizeof(T), new_count * sizeof(T), alignof(T)));
+    }
+
+    template<class U>
+    bool operator==(const FrameAllocator<U>&) const { return true; }
+    template<class U>
+    bool operator!=(const FrameAllocator<U>&) const { return false; }
+};
+
+template<class T>
+using FrameArray = DArray<T, FrameAllocator<T>>;
+
+#endif //FRAME_ARENA_H
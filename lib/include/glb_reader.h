@@ -0,0 +1,20 @@
+#ifndef GLB_READER_H
+#define GLB_READER_H
+
+#include <optional>
+#include <string>
+
+#include "mesh_import.h"
+#include "scene.h"
+#include "thread_pool.h"
+
+// Reads binary glTF 2.0 without going through assimp. The file is mmapped, the json chunk is tokenized
+// in place and accessors are read straight out of the binary chunk, tightly packed streams in a single
+// bulk copy each. Every primitive becomes its own mesh, a node with several gets one child per primitive.
+// Base color textures are decoded on decode_pool straight from the mapping while the meshes convert.
+//
+// nullopt if the file needs something only assimp can do: external or data uri buffers and images,
+// sparse accessors or a required extension. Throws on a malformed file
+std::optional<SceneNode> readGlb(const std::string& path, const ImportOptions& options, ThreadPool& decode_pool);
+
+#endif //GLB_READER_H
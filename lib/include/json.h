@@ -0,0 +1,89 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include "mystl.hpp"
+
+enum class JsonType : uint8_t {
+    Invalid, // a missing key or index, never produced by the parser
+    Null,
+    Bool,
+    Number,
+    String,
+    Array,
+    Object
+};
+
+// one value in document order, containers are followed by their children.
+// object members are a key token (a String) followed by the value's tokens
+typedef struct JsonToken {
+    JsonType type;
+    uint32_t start;  // byte range in the text, without the quotes for strings
+    uint32_t length;
+    uint32_t count;  // elements of an array, members of an object
+    uint32_t next;   // first token after this value and everything inside it
+} JsonToken;
+
+class JsonDocument;
+class JsonValue;
+
+// most gltf arrays (a node's children, a mesh's primitives, a vec3) are short enough to stay inline
+typedef SmallArray<JsonValue, 8> JsonValues;
+
+// view of one value in a parsed document, cheap to copy. looking up something that isn't
+// there gives an Invalid value instead of failing, so chains like gltf["nodes"].at(3)["mesh"] are safe
+class JsonValue {
+
+    private:
+        const JsonDocument* document;
+        size_t token;
+
+    public:
+        JsonValue();
+        JsonValue(const JsonDocument* document, size_t token);
+
+        JsonType type() const;
+        bool isValid() const { return type() != JsonType::Invalid; }
+
+        // elements of an array or members of an object, 0 for anything else
+        size_t size() const;
+
+        JsonValue operator[](const char* key) const;
+        // walks the array from the start, use elements() to visit all of them
+        JsonValue at(size_t index) const;
+        JsonValues elements() const;
+
+        // fallback for a missing value or one of the wrong type
+        double number(double fallback = 0.0) const;
+        // fallback as well for negative, fractional or too large numbers
+        size_t index(size_t fallback) const;
+        bool boolean(bool fallback = false) const;
+        // unescaped
+        std::string string(const std::string& fallback = "") const;
+        // compares the raw text of a string, only right for strings without escapes (like every gltf key)
+        bool equals(const char* text) const;
+};
+
+// parses in place, tokens point into the text so it has to outlive the document (an mmapped chunk is fine)
+class JsonDocument {
+
+    friend class JsonValue;
+
+    private:
+        const char* text;
+        size_t length;
+        DArray<JsonToken> tokens;
+
+    public:
+        JsonDocument();
+
+        // false on malformed input, the document is empty afterwards
+        bool parse(const char* text, size_t length);
+
+        JsonValue root() const;
+};
+
+#endif //JSON_H
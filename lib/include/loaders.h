@@ -1,13 +1,21 @@
 #ifndef LOADER_H
 #define LOADER_H
 
+#include <future>
+
+#include "mesh_import.h"
 #include "scene.h"
 #include "mystl.hpp"
+#include "thread_pool.h"
 
 char* get_shader_content(const char* fileName);
 
 DArray<float> read_csv(const char* filename);
 
-SceneNode load_glb(const std::string&);
+SceneNode load_glb(const std::string&, const ImportOptions& options = {});
+
+// load_glb on a pool worker with its own importer. No GL happens during loading, meshes and textures
+// are uploaded by the renderer's upload stage on the main thread
+std::future<SceneNode> load_glb_async(ThreadPool& pool, const std::string&, const ImportOptions& options = {});
 
 #endif //LOADER_H
\ No newline at end of file
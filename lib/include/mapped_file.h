@@ -0,0 +1,32 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+
+// read only mmap of a whole file, unmapped when the object goes away.
+// not copyable, anything pointing into data() has to outlive it
+class MappedFile {
+
+    private:
+        const unsigned char* _data;
+        size_t _size;
+
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        // false if the file can't be opened or is empty
+        bool open(const char* path);
+        void close();
+
+        bool isOpen() const { return _data != nullptr; }
+        const unsigned char* data() const { return _data; }
+        size_t size() const { return _size; }
+};
+
+#endif //MAPPED_FILE_H
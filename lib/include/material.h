@@ -4,7 +4,6 @@
 #include "vec.h"
 #include <variant>
 #include "mystl.hpp"
-#include <string>
 #include <GLES3/gl3.h>
 
 enum class WrapMode {
@@ -14,32 +13,38 @@ enum class WrapMode {
       Decal      // Decal/border
 };
 
+// decoded pixels on their way to the gpu
 struct TextureData {
-      unsigned char* pixels;  // pixel data (RGBA or RGB)
-      int width;
+      unsigned char* pixels;  // pixel data (RGBA or RGB), every mip level one after the other (see texture_mips.h)
+      int width;              // of the first level
       int height;
       int channels;           // number of color channels (3 for RGB, 4 for RGBA)
-      WrapMode wrapModeU;     // wrap mode for U coordinate
-      WrapMode wrapModeV;     // wrap mode for V coordinate
-      bool needs_free;        // whether pixels were allocated by stb_image and need to be freed
+      int levels;             // 1 for level 0 alone, the renderer generates the rest
+      bool needs_free;        // whether pixels were malloced (by stb_image or the mip builder) and need to be freed
 };
 
+// a texture in the material table (see material_table.h), shared by every material that samples the same image
+typedef SlotHandle TextureHandle;
+
 struct BasicColorMaterial {
       mym::Vec3 color;
       mym::Vec3 specular_color;
       float shininess;
 };
 
+// the uvs are vertex data and live in Vertices, the wrap modes are sampler state so one image can be
+// sampled both ways
 struct BasicTextureMaterial
 {
-      DArray<float> texture;
-      DArray<float> uvMap;
-      std::string texture_path; // path reported by Assimp (may be embedded like "*0")
-      TextureData texture_data; // loaded texture data (pixels, dimensions, etc.)
-      GLuint texture_id; // OpenGL texture ID once created by renderer
+      TextureHandle texture;
+      WrapMode wrap_u;
+      WrapMode wrap_v;
       float shininess;
 };
 
 using Material = std::variant<BasicColorMaterial, BasicTextureMaterial>;
 
-#endif
\ No newline at end of file
+// what a mesh holds instead of its material. handle.index is small and dense enough to sort draws by
+typedef SlotHandle MaterialHandle;
+
+#endif
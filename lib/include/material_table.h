@@ -0,0 +1,146 @@
+#ifndef MATERIAL_TABLE_H
+#define MATERIAL_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "material.h"
+#include "mystl.hpp"
+
+enum class TextureState {
+    Loading,  // the loader that added it is still decoding the pixels
+    Decoded,  // the pixels are waiting for the renderer
+    Uploaded, // on the gpu, the pixels have been released
+    Failed    // nothing to sample, materials using it draw untextured
+};
+
+// where an uploaded texture lives, a layer of one of the renderer's array textures (see texture_pool.h)
+typedef struct TextureLayer {
+    GLuint array; // 0 for no texture
+    uint32_t layer;
+} TextureLayer;
+
+typedef struct TextureEntry {
+    std::string source;    // file and image the pixels came from, e.g. "assets/ship.glb*3"
+    uint64_t content_hash; // of the encoded image bytes, 0 if unknown
+    TextureState state;
+    TextureData data;      // pixels only while Decoded, width, height and channels stay
+    TextureLayer gpu;      // array 0 until Uploaded
+    uint32_t users;        // loaders holding it plus materials sampling it
+    int trimmed_levels;    // top mips the pixel budget dropped before it was stored
+} TextureEntry;
+
+typedef struct MaterialTableStats {
+    size_t materials;
+    size_t textures;
+    size_t uploaded_textures;
+    size_t pixel_bytes; // decoded pixels still on the cpu, mips included
+    size_t pixel_budget;
+    size_t trimmed_textures;
+} MaterialTableStats;
+
+// Every material and texture the loaded scenes use, shared between the loader threads and the GL thread.
+// Equal materials get the same handle and textures are deduplicated by source and by the hash of their
+// encoded bytes, so an image several meshes, files or cache entries use is decoded and uploaded once.
+// Both are reference counted: a material counts the meshes holding its handle, a texture counts the
+// materials sampling it plus loaders between acquireTexture and releaseTexture. Everything locks, the
+// renderer looks materials up once per run of equal handles rather than once per mesh
+constexpr size_t DEFAULT_PIXEL_BUDGET = 512 * 1024 * 1024;
+// neither the pixel budget nor the texture pool's (see texture_pool.h) takes a texture below this on its longer side
+constexpr int MIN_TRIMMED_SIZE = 64;
+
+class MaterialTable {
+
+    private:
+        typedef struct MaterialEntry {
+            Material material;
+            uint64_t hash;
+            uint32_t users;
+        } MaterialEntry;
+
+        mutable std::mutex mutex;
+        SlotMap<MaterialEntry> materials;
+        SlotMap<TextureEntry> textures;
+        HashMap<uint64_t, MaterialHandle> materials_by_hash;
+        HashMap<std::string, TextureHandle> textures_by_source;
+        HashMap<uint64_t, TextureHandle> textures_by_content;
+        DArray<TextureLayer> released_layers;
+        size_t pixel_budget = DEFAULT_PIXEL_BUDGET;
+
+        void releaseTextureLocked(TextureHandle texture);
+        size_t pixelBytesLocked() const;
+
+    public:
+        MaterialTable() = default;
+        ~MaterialTable();
+
+        MaterialTable(const MaterialTable&) = delete;
+        MaterialTable& operator=(const MaterialTable&) = delete;
+
+        // the texture for an image, with one more user for the caller. If no texture has this source or
+        // content hash a Loading one is made and `created` is set, the caller then has to decode it and
+        // call setTexturePixels. Otherwise the image is already here or on its way and needs no decoding
+        TextureHandle acquireTexture(const std::string& source, uint64_t content_hash, bool& created);
+
+        // takes the decoded pixels of a texture acquireTexture created, null pixels mark it Failed. If they
+        // would take the decoded pixels waiting for the gpu past the pixel budget, the top mips are dropped
+        // until they fit, down to MIN_TRIMMED_SIZE
+        void setTexturePixels(TextureHandle texture, const TextureData& pixels);
+
+        // 0 for no limit. Pixels only wait here between decoding and upload, so this caps how much a big
+        // load can pile up rather than what stays resident
+        void setPixelBudget(size_t bytes);
+
+        void releaseTexture(TextureHandle texture);
+
+        // the handle of an equal material if there is one, otherwise a new one. Either way with one more
+        // user, a new texture material also becomes a user of its texture
+        MaterialHandle addMaterial(const Material& material);
+
+        // one more user of a handle that is being copied into another mesh
+        MaterialHandle retainMaterial(MaterialHandle material);
+
+        void releaseMaterial(MaterialHandle material);
+
+        // a copy, nullopt for a handle that has been released or was never handed out
+        std::optional<Material> material(MaterialHandle material) const;
+
+        // a copy without the pixels, nullopt for a released handle
+        std::optional<TextureEntry> texture(TextureHandle texture) const;
+
+        // calls read with the texture while holding the lock, so Decoded pixels can't be uploaded and
+        // freed underneath it. false for a released handle
+        template<class Read>
+        bool readTexture(const TextureHandle texture, Read read) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            const TextureEntry* entry = textures.get(texture);
+            if (entry == nullptr) {
+                return false;
+            }
+            read(*entry);
+            return true;
+        }
+
+        // GL thread: the pixels of a Decoded texture, they stay valid until textureUploaded
+        std::optional<TextureData> pixelsToUpload(TextureHandle texture) const;
+
+        // GL thread: the texture is on the gpu in layer, its cpu pixels are freed
+        void textureUploaded(TextureHandle texture, TextureLayer layer);
+
+        // GL thread: the texture pool moved an uploaded texture to another layer. false if no texture is in
+        // from any more, it was released and from is waiting in takeReleasedTextureLayers, to isn't used
+        bool textureMoved(TextureLayer from, TextureLayer to);
+
+        // GL thread: layers of uploaded textures nothing uses any more, for the texture pool to reuse
+        DArray<TextureLayer> takeReleasedTextureLayers();
+
+        MaterialTableStats stats() const;
+};
+
+// the table the loaders, the asset cache and the renderer share
+MaterialTable& materialTable();
+
+#endif //MATERIAL_TABLE_H
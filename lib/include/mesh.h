@@ -2,23 +2,76 @@
 #define MESH_H
 
 #include <optional>
+#include <stdint.h>
 #include <assert.h>
 #include "material.h"
 #include "mystl.hpp"
 
+enum class NormalEncoding {
+  Oct8,  // 2 x snorm8
+  Oct16  // 2 x snorm16
+};
+
+// quantized vertex streams, produced at import by compressVertices (see vertex_compression.h for the error bounds)
+struct CompressedVertices {
+  mym::Vec3 position_min;      // dequantized position = position_min + q * position_extent
+  mym::Vec3 position_extent;
+  DArray<uint16_t> positions;  // 4 unorm16 per vertex, the 4th is padding to keep the stride at 8 bytes
+  NormalEncoding normal_encoding;
+  DArray<unsigned char> normals; // 2 octahedron encoded snorm components per vertex, 1 or 2 bytes each
+  DArray<uint16_t> uvs;        // 2 half floats per vertex, empty if the mesh has no uvs
+};
+
 struct Vertices {
   size_t vertex_count;
-  DArray<float> positions;
-  DArray<float> normals;
+  DArray<float> positions;     // empty once the mesh has been compressed
+  DArray<float> normals;       // empty once the mesh has been compressed
+  DArray<float> tangents;      // 4 per vertex, w is the bitangent sign. Empty if the mesh has none, kept as floats by compression
+  DArray<float> uvs;           // 2 per vertex, empty if the mesh has none or once it has been compressed
+  DArray<unsigned int> indices;
+  size_t index_count;
+  std::optional<CompressedVertices> compressed;
+};
+
+
+// a coarser index buffer over the same vertices as the full mesh, built at import by generateMeshLods (see mesh_lod.h)
+struct MeshLod {
   DArray<unsigned int> indices;
   size_t index_count;
+  float error;        // object space distance the surface moved from the full mesh
+  size_t first_index; // where the indices live in the geometry pool once the mesh has been inited
+};
+
+struct MeshLodChain {
+  mym::Vec3 center;        // object space bounding sphere, lod distances are measured to its surface
+  float radius;
+  DArray<MeshLod> levels;  // finest first, empty if no lods were built
 };
 
+// where a mesh lives in the shared geometry pool once it has been inited
+struct GeometrySlice {
+  size_t page;
+  size_t base_vertex;
+  size_t first_index;
+};
+
+// a member that makes what holds it move only while it stays an aggregate, so designated initializers still work
+struct NotCopyable {
+  NotCopyable() = default;
+  NotCopyable(const NotCopyable&) = delete;
+  NotCopyable& operator=(const NotCopyable&) = delete;
+  NotCopyable(NotCopyable&&) = default;
+  NotCopyable& operator=(NotCopyable&&) = default;
+};
 
+// move only: a copy would share the one user of the material and be released twice, see copyMesh in scene.h
 struct Mesh {
   Vertices vertices;
-  Material material;
-  std::optional<int> id; // the vao id once the mesh has been inited
+  MaterialHandle material; // into materialTable() (see material_table.h), the mesh holds one user of it
+  std::optional<int> id; // the vao id once the mesh has been inited (shared by every mesh in the same pool page)
+  GeometrySlice slice;
+  MeshLodChain lod;
+  [[no_unique_address]] NotCopyable not_copyable;
 }; 
 
 
@@ -0,0 +1,44 @@
+#ifndef MESH_GEOMETRY_H
+#define MESH_GEOMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mesh.h"
+#include "mystl.hpp"
+#include "thread_pool.h"
+
+// normals and tangents for meshes whose source didn't have them.
+// Triangles are processed in parallel chunks, each writing only its own face records, and every vertex then
+// sums its corners in index buffer order. The sums never depend on how the work was split, so the result is
+// the same on any number of threads, bit for bit.
+
+enum class NormalWeighting {
+    Area,  // each face counts by its area, cheapest
+    Angle  // each face counts by its corner angle at the vertex, doesn't change when a face is split in two
+};
+
+// the triangle corners (index buffer positions) that use each vertex, in index buffer order.
+// corners[offsets[v]] to corners[offsets[v + 1]] belong to vertex v
+struct VertexCorners {
+    DArray<uint32_t> offsets; // vertex_count + 1
+    DArray<uint32_t> corners; // index_count
+};
+
+VertexCorners vertexCorners(const unsigned int* indices, size_t index_count, size_t vertex_count);
+
+// replaces vertices.normals (3 floats per vertex) with smooth normals of the indexed triangles.
+// vertices no triangle uses, or only degenerate ones, get 0, 1, 0
+void generateNormals(Vertices& vertices, NormalWeighting weighting, ThreadPool& pool);
+
+// replaces vertices.tangents (4 floats per vertex, w is the bitangent sign) with tangents along the uv u
+// direction. Needs the normals and uvs. MikkTSpace's per vertex result (angle weighted, orthogonalized against the
+// normal) for meshes without tangent seams; MikkTSpace would split a vertex whose faces mirror the uvs,
+// here they are averaged
+void generateTangents(Vertices& vertices, ThreadPool& pool);
+
+// normals if the mesh has none, then tangents if it has uvs but no tangents. Triangle lists only, other
+// meshes are left alone. Run it before optimizeMesh and compressVertices
+void generateMissingVertexData(Mesh& mesh, NormalWeighting weighting, bool generate_tangents, ThreadPool& pool);
+
+#endif //MESH_GEOMETRY_H
@@ -0,0 +1,38 @@
+#ifndef MESH_IMPORT_H
+#define MESH_IMPORT_H
+
+#include <string>
+
+#include "mesh.h"
+#include "mesh_geometry.h"
+#include "mesh_lod.h"
+
+struct ImportOptions {
+    // smooth normals for meshes without them, and tangents for textured meshes without them (see mesh_geometry.h)
+    bool generate_normals = true;
+    NormalWeighting normal_weighting = NormalWeighting::Angle;
+    bool generate_tangents = true;
+    // quantize positions/normals/uvs at import, roughly halves vertex memory (see vertex_compression.h)
+    bool compress_vertices = false;
+    NormalEncoding normal_encoding = NormalEncoding::Oct16;
+    // reorder indices and vertices for the vertex cache and fetch (see mesh_optimizer.h)
+    bool optimize_mesh = true;
+    // also sort triangle clusters to cut overdraw, may cost a little ACMR
+    bool optimize_overdraw = false;
+    // build a chain of simplified index buffers per mesh for distance based lod (see mesh_lod.h)
+    bool generate_lods = true;
+    size_t max_lods = DEFAULT_MAX_LODS;
+    // reuse the converted scene from an earlier run instead of importing it again (see asset_cache.h)
+    bool use_asset_cache = true;
+    std::string cache_directory = "cache";
+    // read .glb files with the native reader (see glb_reader.h), assimp is still used for anything else
+    bool native_glb = true;
+    // textures are scaled down by whole mip levels until they fit, 2048 is all GLES3 promises
+    int max_texture_size = 2048;
+};
+
+// everything an importer does to a freshly converted mesh: fill in normals and tangents, optimize, build lods, compress.
+// the order matters, see the comments in the definition
+void processImportedMesh(Mesh& mesh, const std::string& name, const ImportOptions& options);
+
+#endif //MESH_IMPORT_H
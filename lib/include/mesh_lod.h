@@ -0,0 +1,50 @@
+#ifndef MESH_LOD_H
+#define MESH_LOD_H
+
+#include <stddef.h>
+
+#include "affine.h"
+#include "mesh.h"
+#include "vec.h"
+
+constexpr size_t DEFAULT_MAX_LODS = 4;
+
+// quadric error edge collapse. Only the indices change, the result keeps using the original vertices.
+// Border vertices and seam vertices (several vertices sharing one position) never move, so a level
+// can't open cracks along uv or normal seams.
+// Stops at target_index_count or once the next collapse would move the surface further than target_error
+// (object space units). Writes the new indices to destination (needs index_count room), the error that
+// was reached to result_error, and returns the new index count
+size_t simplifyIndices(
+    const unsigned int* indices,
+    size_t index_count,
+    const float* positions,
+    size_t vertex_count,
+    size_t target_index_count,
+    float target_error,
+    unsigned int* destination,
+    float* result_error
+);
+
+// fills mesh.lod with up to max_lods levels, each aiming at half the triangles of the one before.
+// Stops early once a level can't shed another 10%. Needs the float positions, run it before compressVertices
+void generateMeshLods(Mesh& mesh, size_t max_lods);
+
+typedef struct LodSelection {
+    mym::Vec3 camera_position;
+    float projection_scale; // pixels covered by one unit at distance one
+    float max_pixel_error;  // below about a pixel switching levels can't be seen, 0 always picks the full mesh
+} LodSelection;
+
+LodSelection lodSelection(mym::Vec3 camera_position, float field_of_view_radians, size_t viewport_height, float max_pixel_error);
+
+// coarsest level whose error projects to at most max_pixel_error.
+// 0 is the full mesh, n is mesh.lod.levels[n - 1]
+size_t selectMeshLod(const Mesh& mesh, const mym::Affine& world_transform, const LodSelection& selection);
+
+size_t lodIndexCount(const Mesh& mesh, size_t lod);
+
+// the full mesh plus every level, what the geometry pool has to hold
+size_t totalIndexCount(const Mesh& mesh);
+
+#endif //MESH_LOD_H
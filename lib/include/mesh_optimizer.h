@@ -0,0 +1,37 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <stddef.h>
+
+#include "mesh.h"
+
+// post-transform cache sizes the stats are simulated with, a FIFO roughly the size of real hardware
+constexpr size_t DEFAULT_VERTEX_CACHE_SIZE = 16;
+
+typedef struct VertexCacheStats {
+    float acmr; // average cache miss ratio, vertex shader runs per triangle (0.5 is ideal for big grids, 3 is worst)
+    float atvr; // average transformed vertex ratio, vertex shader runs per referenced vertex (1 is ideal)
+} VertexCacheStats;
+
+typedef struct MeshOptimizationReport {
+    VertexCacheStats before;
+    VertexCacheStats after;
+} MeshOptimizationReport;
+
+VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t index_count, size_t vertex_count, size_t cache_size);
+
+// reorders triangles for the post-transform vertex cache (Forsyth's linear-speed algorithm)
+void optimizeVertexCache(unsigned int* indices, size_t index_count, size_t vertex_count);
+
+// reorders clusters of the cache optimized triangles so outward facing ones come first and occlude the
+// rest, keeps the new order only if the ACMR stays within `threshold` times the input ACMR
+void optimizeOverdraw(unsigned int* indices, size_t index_count, const float* positions, size_t vertex_count, float threshold);
+
+// reorders the vertex streams (positions, normals, tangents and uvs) into the order the
+// index buffer first uses them and remaps the indices to match
+void optimizeVertexFetch(Mesh& mesh);
+
+// vertex cache, optionally overdraw, then vertex fetch. Non-indexed and compressed meshes are left alone
+MeshOptimizationReport optimizeMesh(Mesh& mesh, bool optimize_overdraw);
+
+#endif //MESH_OPTIMIZER_H
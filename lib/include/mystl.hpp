@@ -1,39 +1,219 @@
 #ifndef MYSTL_H
 #define MYSTL_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
+// operator[] checks its index unless this is 0. defaults to checking in debug builds only,
+// release builds index straight into the buffer. at() always checks
+#ifndef DARRAY_CHECKED
+#ifdef NDEBUG
+#define DARRAY_CHECKED 0
+#else
+#define DARRAY_CHECKED 1
+#endif
+#endif
+
+// default DArray allocator, malloc/free underneath so trivially copyable items can grow with realloc,
+// which often extends the block in place instead of copying it
 template<class T>
+struct DArrayAllocator {
+    using value_type = T;
+
+    DArrayAllocator() = default;
+    template<class U>
+    DArrayAllocator(const DArrayAllocator<U>&) {}
+
+    T* allocate(const size_t count) {
+        if constexpr (alignof(T) > alignof(max_align_t)) {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignof(T))));
+        } else {
+            void* memory = malloc(count * sizeof(T));
+            if (memory == nullptr) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(memory);
+        }
+    }
+
+    void deallocate(T* memory, const size_t count) {
+        if constexpr (alignof(T) > alignof(max_align_t)) {
+            ::operator delete(memory, count * sizeof(T), std::align_val_t(alignof(T)));
+        } else {
+            free(memory);
+        }
+    }
+
+    // only ever called for trivially copyable T
+    T* reallocate(T* memory, const size_t count, const size_t new_count) {
+        if constexpr (alignof(T) > alignof(max_align_t)) {
+            T* moved = allocate(new_count);
+            if (count > 0) {
+                memcpy(static_cast<void*>(moved), memory, count * sizeof(T));
+            }
+            deallocate(memory, count);
+            return moved;
+        } else {
+            void* grown = realloc(memory, new_count * sizeof(T));
+            if (grown == nullptr) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(grown);
+        }
+    }
+
+    template<class U>
+    bool operator==(const DArrayAllocator<U>&) const { return true; }
+    template<class U>
+    bool operator!=(const DArrayAllocator<U>&) const { return false; }
+};
+
+// whether an allocator offers reallocate(memory, count, new_count) like DArrayAllocator
+template<class Allocator, class = void>
+struct HasReallocate : std::false_type {};
+
+template<class Allocator>
+struct HasReallocate<Allocator, std::void_t<decltype(std::declval<Allocator&>().reallocate(
+    std::declval<typename Allocator::value_type*>(), size_t(0), size_t(0)))>> : std::true_type {};
+
+// growable array. items are only constructed when they're added and are moved, not copied, when
+// the buffer grows. trivially copyable items are copied with memcpy and grown with realloc
+template<class T, class Allocator = DArrayAllocator<T>>
 class DArray {
     private:
+        using Traits = std::allocator_traits<Allocator>;
+
+        static constexpr bool TRIVIAL = std::is_trivially_copyable_v<T>;
+        static constexpr bool REALLOCATES = TRIVIAL && HasReallocate<Allocator>::value;
+
         size_t _capacity;
         size_t _size;
         T* data;
+        [[no_unique_address]] Allocator allocator;
 
-        void resize(const size_t new_capacity) {
-            T* new_data = new T[new_capacity];
-
-            for (size_t i = 0; i < _size; i++) {
-                new_data[i] = data[i];
+        // the buffer always holds _size constructed items followed by raw memory
+        void setCapacity(const size_t new_capacity) {
+            if constexpr (REALLOCATES) {
+                data = data ? allocator.reallocate(data, _capacity, new_capacity) : allocator.allocate(new_capacity);
+            } else {
+                T* new_data = Traits::allocate(allocator, new_capacity);
+                relocate(data, _size, new_data);
+                if (data) {
+                    Traits::deallocate(allocator, data, _capacity);
+                }
+                data = new_data;
             }
-            
-            // free old buffer and take ownership of new buffer
-            delete[] data;
-            data = new_data;
             _capacity = new_capacity;
         }
 
+        // moves count items into raw memory and destroys the originals
+        void relocate(T* from, const size_t count, T* to) {
+            if constexpr (TRIVIAL) {
+                if (count > 0) {
+                    memcpy(static_cast<void*>(to), from, count * sizeof(T));
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    Traits::construct(allocator, to + i, std::move_if_noexcept(from[i]));
+                    Traits::destroy(allocator, from + i);
+                }
+            }
+        }
+
+        // room for one more, growing geometrically
+        void growForOne() {
+            if (_size == _capacity) {
+                setCapacity(_capacity > 0 ? _capacity * 2 : 10);
+            }
+        }
+
+        void destroyItems(const size_t first, const size_t last) {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (size_t i = first; i < last; ++i) {
+                    Traits::destroy(allocator, data + i);
+                }
+            }
+        }
+
+        void copyFrom(const T* items, const size_t count) {
+            if constexpr (TRIVIAL) {
+                if (count > 0) {
+                    memcpy(static_cast<void*>(data), items, count * sizeof(T));
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    Traits::construct(allocator, data + i, items[i]);
+                }
+            }
+        }
+
+        void release() {
+            if (data) {
+                destroyItems(0, _size);
+                Traits::deallocate(allocator, data, _capacity);
+            }
+            data = nullptr;
+            _size = 0;
+            _capacity = 0;
+        }
+
+        [[noreturn]] static void outOfRange(const char* message) {
+            throw std::out_of_range(message);
+        }
+
     public:
-        DArray() : _capacity(0), _size(0), data(nullptr) {}
+        DArray() : _capacity(0), _size(0), data(nullptr), allocator() {}
 
-        // Copy constructor (deep copy)
+        explicit DArray(const Allocator& allocator) : _capacity(0), _size(0), data(nullptr), allocator(allocator) {}
+
+        // count copies of value
+        DArray(const size_t count, const T& value, const Allocator& allocator = Allocator())
+            : _capacity(count),
+              _size(count),
+              data(nullptr),
+              allocator(allocator)
+        {
+            if (count) {
+                data = Traits::allocate(this->allocator, count);
+                for (size_t i = 0; i < count; ++i) {
+                    Traits::construct(this->allocator, data + i, value);
+                }
+            }
+        }
+
+        // copies count items in one go
+        DArray(const T* items, const size_t count, const Allocator& allocator = Allocator())
+            : _capacity(count),
+              _size(count),
+              data(nullptr),
+              allocator(allocator)
+        {
+            if (count) {
+                data = Traits::allocate(this->allocator, count);
+                copyFrom(items, count);
+            }
+        }
+
+        // Copy constructor (deep copy), sized to fit
         DArray(const DArray& other)
-            : _capacity(other._capacity),
+            : _capacity(other._size),
               _size(other._size),
-              data(other._capacity ? new T[other._capacity] : nullptr)
+              data(nullptr),
+              allocator(Traits::select_on_container_copy_construction(other.allocator))
         {
-            for (size_t i = 0; i < _size; ++i)
-                data[i] = other.data[i];
+            if (_size) {
+                data = Traits::allocate(allocator, _size);
+                copyFrom(other.data, _size);
+            }
         }
 
         // Copy assignment (deep copy, strong exception safety)
@@ -45,15 +225,17 @@ class DArray {
                 std::swap(_capacity, temp._capacity);
                 std::swap(_size, temp._size);
                 std::swap(data, temp.data);
+                std::swap(allocator, temp.allocator);
             }
             return *this;
         }
 
-        // Move constructor - take ownership of other's buffer
+        // Move constructor - take ownership of other's buffer (and the allocator that owns it)
         DArray(DArray&& other) noexcept
             : _capacity(other._capacity),
               _size(other._size),
-              data(other.data)
+              data(other.data),
+              allocator(std::move(other.allocator))
         {
             // leave other in a valid empty state
             other._capacity = 0;
@@ -63,49 +245,475 @@ class DArray {
 
         // Move assignment - free current storage, take ownership of other's storage
         DArray& operator=(DArray&& other) noexcept {
-                if (this != &other) {
-                    delete[] data;
-                    _capacity = other._capacity;
-                    _size = other._size;
-                    data = other.data;
+            if (this != &other) {
+                release();
+                _capacity = other._capacity;
+                _size = other._size;
+                data = other.data;
+                allocator = std::move(other.allocator);
 
-                    other._capacity = 0;
-                    other._size = 0;
-                    other.data = nullptr;
-                }
-                return *this;
+                other._capacity = 0;
+                other._size = 0;
+                other.data = nullptr;
             }
+            return *this;
+        }
+
+        ~DArray() {
+            release();
+        }
 
         void erase(const size_t index) {
-                if (index >= _size) {
-                    throw std::out_of_range("erase index out of range");
+            if (index >= _size) {
+                outOfRange("erase index out of range");
+            }
+
+            // Move elements left by one
+            std::move(data + index + 1, data + _size, data + index);
+            pop_back();
+        }
+
+        void insert(const size_t index, const T& value) {
+            if (index > _size) {
+                outOfRange("insert index out of range");
+            }
+
+            // value may be one of our own items, push_back copies it before anything moves
+            push_back(value);
+            std::rotate(data + index, data + _size - 1, data + _size);
+        }
+
+        void push_back(const T& value) {
+            if (_size == _capacity) {
+                // value may live in the buffer that is about to go away
+                T copy(value);
+                growForOne();
+                Traits::construct(allocator, data + _size, std::move(copy));
+            } else {
+                Traits::construct(allocator, data + _size, value);
+            }
+            ++_size;
+        }
+
+        void push_back(T&& value) {
+            emplace_back(std::move(value));
+        }
+
+        // constructs the item in place
+        template<class... Args>
+        T& emplace_back(Args&&... args) {
+            if (_size == _capacity) {
+                T item(std::forward<Args>(args)...);
+                growForOne();
+                Traits::construct(allocator, data + _size, std::move(item));
+            } else {
+                Traits::construct(allocator, data + _size, std::forward<Args>(args)...);
+            }
+            return data[_size++];
+        }
+
+        void pop_back() {
+            if (_size > 0) {
+                --_size;
+                destroyItems(_size, _size + 1);
+            }
+        }
+
+        // room for at least capacity items, reserving the final size up front means no doubling copies
+        void reserve(const size_t capacity) {
+            if (capacity > _capacity) {
+                setCapacity(capacity);
+            }
+        }
+
+        // new items are copies of value, extra ones are destroyed
+        void resize(const size_t count, const T& value) {
+            if (count < _size) {
+                destroyItems(count, _size);
+            } else {
+                reserve(count);
+                for (size_t i = _size; i < count; ++i) {
+                    Traits::construct(allocator, data + i, value);
                 }
+            }
+            _size = count;
+        }
+
+        // new items are value initialized, zero for numbers
+        void resize(const size_t count) {
+            resize(count, T());
+        }
 
-                // Move elements left by one
-                for (size_t i = index; i < _size - 1; ++i) {
-                    data[i] = data[i + 1];
+        // grows by count items and returns the first of them so they can be filled in place.
+        // they're default initialized, numbers start out indeterminate
+        T* extend(const size_t count) {
+            if (_size + count > _capacity) {
+                // geometric growth so repeated small extends stay linear
+                setCapacity(std::max(_size + count, _capacity * 2));
+            }
+            T* first = data + _size;
+            for (size_t i = 0; i < count; ++i) {
+                ::new (static_cast<void*>(first + i)) T;
+            }
+            _size += count;
+            return first;
+        }
+
+        // copies count items onto the end, one memcpy for plain types
+        void append(const T* items, const size_t count) {
+            if (_size + count > _capacity) {
+                setCapacity(std::max(_size + count, _capacity * 2));
+            }
+            if constexpr (TRIVIAL) {
+                if (count > 0) {
+                    memcpy(static_cast<void*>(data + _size), items, count * sizeof(T));
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    Traits::construct(allocator, data + _size + i, items[i]);
                 }
+            }
+            _size += count;
+        }
 
-                --_size;
+        // drops every item but keeps the buffer
+        void clear() {
+            destroyItems(0, _size);
+            _size = 0;
+        }
+
+        T* begin() { return data; }
+        T* end()   { return data + _size; }
+        const T* begin() const { return data; }
+        const T* end()   const { return data + _size; }
+
+        T* addr(size_t index) {
+            return &data[index];
+        }
+
+        size_t size() const { return _size; }
+        size_t capacity() const { return _capacity; }
+        bool empty() const { return _size == 0; }
+
+        T& back() { return data[_size - 1]; }
+        const T& back() const { return data[_size - 1]; }
+
+        T& operator[](size_t index) {
+#if DARRAY_CHECKED
+            if (index >= _size) {
+                outOfRange("index out of range");
             }
+#endif
+            return data[index];
+        }
 
+        const T& operator[](size_t index) const {
+#if DARRAY_CHECKED
+            if (index >= _size) {
+                outOfRange("index out of range");
+            }
+#endif
+            return data[index];
+        }
 
-        void push_back(const T& value) {
+        // checked whatever DARRAY_CHECKED says
+        T& at(size_t index) {
+            if (index >= _size) {
+                outOfRange("index out of range");
+            }
+            return data[index];
+        }
+
+        const T& at(size_t index) const {
+            if (index >= _size) {
+                outOfRange("index out of range");
+            }
+            return data[index];
+        }
+};
+
+// array that keeps its first N items inline and only goes to the heap once it outgrows them.
+// meant for the many short lists (a node's children, the hits along one ray) where a DArray would
+// cost an allocation each. same interface as DArray, moving one that hasn't spilled moves its items
+template<class T, size_t N, class Allocator = DArrayAllocator<T>>
+class SmallArray {
+    static_assert(N > 0, "SmallArray needs room for at least one inline item");
+
+    private:
+        using Traits = std::allocator_traits<Allocator>;
+
+        static constexpr bool TRIVIAL = std::is_trivially_copyable_v<T>;
+        static constexpr bool REALLOCATES = TRIVIAL && HasReallocate<Allocator>::value;
+
+        size_t _capacity;
+        size_t _size;
+        T* data; // points at inline_items until the array spills
+        [[no_unique_address]] Allocator allocator;
+        alignas(T) unsigned char inline_items[N * sizeof(T)];
+
+        T* inlineData() { return reinterpret_cast<T*>(inline_items); }
+        const T* inlineData() const { return reinterpret_cast<const T*>(inline_items); }
+
+        // only ever grows past N, the inline buffer is never handed to the allocator
+        void setCapacity(const size_t new_capacity) {
+            if constexpr (REALLOCATES) {
+                if (spilled()) {
+                    data = allocator.reallocate(data, _capacity, new_capacity);
+                    _capacity = new_capacity;
+                    return;
+                }
+            }
+            T* new_data = Traits::allocate(allocator, new_capacity);
+            relocate(data, _size, new_data);
+            if (spilled()) {
+                Traits::deallocate(allocator, data, _capacity);
+            }
+            data = new_data;
+            _capacity = new_capacity;
+        }
+
+        // moves count items into raw memory and destroys the originals
+        void relocate(T* from, const size_t count, T* to) {
+            if constexpr (TRIVIAL) {
+                if (count > 0) {
+                    memcpy(static_cast<void*>(to), from, count * sizeof(T));
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    Traits::construct(allocator, to + i, std::move_if_noexcept(from[i]));
+                    Traits::destroy(allocator, from + i);
+                }
+            }
+        }
+
+        void growForOne() {
             if (_size == _capacity) {
-                size_t new_capacity = 10;
-                if ( _capacity > 0 ) {
-                    new_capacity = _capacity * 2;
+                setCapacity(_capacity * 2);
+            }
+        }
+
+        void destroyItems(const size_t first, const size_t last) {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (size_t i = first; i < last; ++i) {
+                    Traits::destroy(allocator, data + i);
                 }
-                resize(new_capacity);
+            }
+        }
+
+        void copyFrom(const T* items, const size_t count) {
+            if constexpr (TRIVIAL) {
+                if (count > 0) {
+                    memcpy(static_cast<void*>(data), items, count * sizeof(T));
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    Traits::construct(allocator, data + i, items[i]);
+                }
+            }
+        }
+
+        // back to empty and inline
+        void release() {
+            destroyItems(0, _size);
+            if (spilled()) {
+                Traits::deallocate(allocator, data, _capacity);
+            }
+            data = inlineData();
+            _size = 0;
+            _capacity = N;
+        }
+
+        // takes a spilled buffer as is, inline items have to be moved across one by one
+        void takeFrom(SmallArray& other) {
+            if (other.spilled()) {
+                data = other.data;
+                _capacity = other._capacity;
+                _size = other._size;
+                other.data = other.inlineData();
+                other._capacity = N;
+            } else {
+                relocate(other.data, other._size, data);
+                _size = other._size;
+            }
+            other._size = 0;
+        }
+
+        [[noreturn]] static void outOfRange(const char* message) {
+            throw std::out_of_range(message);
+        }
+
+    public:
+        SmallArray() : _capacity(N), _size(0), data(inlineData()), allocator() {}
+
+        explicit SmallArray(const Allocator& allocator) : _capacity(N), _size(0), data(inlineData()), allocator(allocator) {}
+
+        // count copies of value
+        SmallArray(const size_t count, const T& value, const Allocator& allocator = Allocator())
+            : SmallArray(allocator)
+        {
+            resize(count, value);
+        }
+
+        // copies count items in one go
+        SmallArray(const T* items, const size_t count, const Allocator& allocator = Allocator())
+            : SmallArray(allocator)
+        {
+            append(items, count);
+        }
+
+        SmallArray(const SmallArray& other)
+            : _capacity(N),
+              _size(0),
+              data(inlineData()),
+              allocator(Traits::select_on_container_copy_construction(other.allocator))
+        {
+            reserve(other._size);
+            copyFrom(other.data, other._size);
+            _size = other._size;
+        }
+
+        SmallArray& operator=(const SmallArray& other) {
+            if (this != &other) {
+                clear();
+                reserve(other._size);
+                copyFrom(other.data, other._size);
+                _size = other._size;
+            }
+            return *this;
+        }
+
+        SmallArray(SmallArray&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+            : _capacity(N),
+              _size(0),
+              data(inlineData()),
+              allocator(std::move(other.allocator))
+        {
+            takeFrom(other);
+        }
+
+        SmallArray& operator=(SmallArray&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+            if (this != &other) {
+                release();
+                allocator = std::move(other.allocator);
+                takeFrom(other);
+            }
+            return *this;
+        }
+
+        ~SmallArray() {
+            release();
+        }
+
+        // whether the items have moved out to the heap
+        bool spilled() const { return data != inlineData(); }
+
+        void erase(const size_t index) {
+            if (index >= _size) {
+                outOfRange("erase index out of range");
             }
 
-            data[_size++] = value;
+            std::move(data + index + 1, data + _size, data + index);
+            pop_back();
+        }
+
+        void insert(const size_t index, const T& value) {
+            if (index > _size) {
+                outOfRange("insert index out of range");
+            }
+
+            push_back(value);
+            std::rotate(data + index, data + _size - 1, data + _size);
+        }
+
+        void push_back(const T& value) {
+            if (_size == _capacity) {
+                // value may live in the buffer that is about to go away
+                T copy(value);
+                growForOne();
+                Traits::construct(allocator, data + _size, std::move(copy));
+            } else {
+                Traits::construct(allocator, data + _size, value);
+            }
+            ++_size;
+        }
+
+        void push_back(T&& value) {
+            emplace_back(std::move(value));
+        }
+
+        template<class... Args>
+        T& emplace_back(Args&&... args) {
+            if (_size == _capacity) {
+                T item(std::forward<Args>(args)...);
+                growForOne();
+                Traits::construct(allocator, data + _size, std::move(item));
+            } else {
+                Traits::construct(allocator, data + _size, std::forward<Args>(args)...);
+            }
+            return data[_size++];
         }
 
         void pop_back() {
             if (_size > 0) {
                 --_size;
+                destroyItems(_size, _size + 1);
+            }
+        }
+
+        void reserve(const size_t capacity) {
+            if (capacity > _capacity) {
+                setCapacity(capacity);
+            }
+        }
+
+        void resize(const size_t count, const T& value) {
+            if (count < _size) {
+                destroyItems(count, _size);
+            } else {
+                reserve(count);
+                for (size_t i = _size; i < count; ++i) {
+                    Traits::construct(allocator, data + i, value);
+                }
+            }
+            _size = count;
+        }
+
+        void resize(const size_t count) {
+            resize(count, T());
+        }
+
+        T* extend(const size_t count) {
+            if (_size + count > _capacity) {
+                setCapacity(std::max(_size + count, _capacity * 2));
+            }
+            T* first = data + _size;
+            for (size_t i = 0; i < count; ++i) {
+                ::new (static_cast<void*>(first + i)) T;
             }
+            _size += count;
+            return first;
+        }
+
+        void append(const T* items, const size_t count) {
+            if (_size + count > _capacity) {
+                setCapacity(std::max(_size + count, _capacity * 2));
+            }
+            if constexpr (TRIVIAL) {
+                if (count > 0) {
+                    memcpy(static_cast<void*>(data + _size), items, count * sizeof(T));
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    Traits::construct(allocator, data + _size + i, items[i]);
+                }
+            }
+            _size += count;
+        }
+
+        // drops every item but keeps the buffer, spilled or not
+        void clear() {
+            destroyItems(0, _size);
+            _size = 0;
         }
 
         T* begin() { return data; }
@@ -118,18 +726,545 @@ class DArray {
         }
 
         size_t size() const { return _size; }
+        size_t capacity() const { return _capacity; }
+        bool empty() const { return _size == 0; }
+
+        T& back() { return data[_size - 1]; }
+        const T& back() const { return data[_size - 1]; }
 
         T& operator[](size_t index) {
+#if DARRAY_CHECKED
             if (index >= _size) {
-                throw std::out_of_range("index out of range");
+                outOfRange("index out of range");
             }
+#endif
             return data[index];
         }
 
-        ~DArray() {
-            delete[] data;
+        const T& operator[](size_t index) const {
+#if DARRAY_CHECKED
+            if (index >= _size) {
+                outOfRange("index out of range");
+            }
+#endif
+            return data[index];
+        }
+
+        T& at(size_t index) {
+            if (index >= _size) {
+                outOfRange("index out of range");
+            }
+            return data[index];
+        }
+
+        const T& at(size_t index) const {
+            if (index >= _size) {
+                outOfRange("index out of range");
+            }
+            return data[index];
+        }
+};
+
+template<class K, class V>
+struct HashMapEntry {
+    K key; // don't change it through an iterator, the entry would be in the wrong place
+    V value;
+};
+
+// open addressing hash map with robin hood probing. entries live in one flat array next to a byte
+// of probe distance each, so a lookup is a short linear walk with no pointer chasing. an insert that
+// has probed further than the entry in its way takes that slot and the rest of the run moves along,
+// which keeps every probe sequence short. erase shifts the run back instead of leaving tombstones.
+// pointers and iterators are invalidated by any insert or erase
+template<class K, class V, class Hash = std::hash<K>, class KeyEqual = std::equal_to<K>>
+class HashMap {
+    public:
+        using Entry = HashMapEntry<K, V>;
+
+    private:
+        static constexpr size_t MIN_CAPACITY = 8;
+        // distance + 1 of the entry in each slot, 0 for an empty one. kept in a byte, the table grows
+        // before anything has to probe further than this
+        static constexpr unsigned MAX_DISTANCE = 255;
+
+        Entry* entries;
+        uint8_t* distances;
+        size_t _capacity; // a power of two, or 0 before the first insert
+        size_t _size;
+        unsigned shift;   // 64 - log2(_capacity)
+        [[no_unique_address]] Hash hasher;
+        [[no_unique_address]] KeyEqual equal;
+
+        // std::hash is the identity for integers on most standard libraries, fibonacci hashing
+        // spreads it over the top bits so sequential keys don't pile up
+        size_t home(const K& key) const {
+            return static_cast<size_t>((static_cast<uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ull) >> shift);
+        }
+
+        size_t indexOf(const K& key) const {
+            if (_size == 0) {
+                return SIZE_MAX;
+            }
+            const size_t mask = _capacity - 1;
+            size_t index = home(key);
+            for (unsigned distance = 1; distance <= distances[index]; distance++) {
+                if (distances[index] == distance && equal(entries[index].key, key)) {
+                    return index;
+                }
+                index = (index + 1) & mask;
+            }
+            return SIZE_MAX;
+        }
+
+        void allocate(const size_t capacity) {
+            entries = DArrayAllocator<Entry>().allocate(capacity);
+            distances = static_cast<uint8_t*>(calloc(capacity, 1));
+            if (distances == nullptr) {
+                DArrayAllocator<Entry>().deallocate(entries, capacity);
+                throw std::bad_alloc();
+            }
+            _capacity = capacity;
+            shift = 64;
+            for (size_t c = capacity; c > 1; c >>= 1) {
+                shift--;
+            }
+        }
+
+        void destroyAll() {
+            if constexpr (!std::is_trivially_destructible_v<Entry>) {
+                for (size_t i = 0; i < _capacity; i++) {
+                    if (distances[i] != 0) {
+                        entries[i].~Entry();
+                    }
+                }
+            }
+        }
+
+        void release() {
+            if (_capacity > 0) {
+                destroyAll();
+                DArrayAllocator<Entry>().deallocate(entries, _capacity);
+                free(distances);
+            }
+            entries = nullptr;
+            distances = nullptr;
+            _capacity = 0;
+            _size = 0;
+            shift = 64;
+        }
+
+        void rehash(const size_t capacity) {
+            Entry* old_entries = entries;
+            uint8_t* old_distances = distances;
+            const size_t old_capacity = _capacity;
+
+            allocate(capacity);
+            for (size_t i = 0; i < old_capacity; i++) {
+                if (old_distances[i] != 0) {
+                    place(std::move(old_entries[i]));
+                    old_entries[i].~Entry();
+                }
+            }
+
+            if (old_capacity > 0) {
+                DArrayAllocator<Entry>().deallocate(old_entries, old_capacity);
+                free(old_distances);
+            }
+        }
+
+        // grows once the table is 7/8 full
+        void growForOne() {
+            if (_capacity == 0 || (_size + 1) * 8 > _capacity * 7) {
+                rehash(_capacity > 0 ? _capacity * 2 : MIN_CAPACITY);
+            }
+        }
+
+        // the key must not be in the map yet. _size is the caller's business
+        void place(Entry&& entry) {
+            while (true) {
+                const size_t mask = _capacity - 1;
+                size_t index = home(entry.key);
+                unsigned distance = 1;
+
+                // robin hood: the entry goes in the first slot holding one closer to its home than it would be
+                while (distances[index] >= distance) {
+                    index = (index + 1) & mask;
+                    distance++;
+                }
+
+                // everything from there up to the next empty slot moves along by one
+                bool fits = distance <= MAX_DISTANCE;
+                size_t empty = index;
+                while (distances[empty] != 0) {
+                    fits = fits && distances[empty] < MAX_DISTANCE;
+                    empty = (empty + 1) & mask;
+                }
+
+                if (!fits) {
+                    // only a poor hash gets here and a bigger table spreads the keys out again. in a table
+                    // that's mostly empty it's 256 keys hashing to the same value, which no size fixes
+                    if (_size * 4 < _capacity) {
+                        throw std::length_error("hash map keys collide too often, check the hash");
+                    }
+                    rehash(_capacity * 2);
+                    continue;
+                }
+
+                if (empty == index) {
+                    ::new (static_cast<void*>(entries + index)) Entry(std::move(entry));
+                } else {
+                    size_t previous = (empty + mask) & mask;
+                    ::new (static_cast<void*>(entries + empty)) Entry(std::move(entries[previous]));
+                    distances[empty] = static_cast<uint8_t>(distances[previous] + 1);
+                    for (size_t i = previous; i != index; i = previous) {
+                        previous = (i + mask) & mask;
+                        entries[i] = std::move(entries[previous]);
+                        distances[i] = static_cast<uint8_t>(distances[previous] + 1);
+                    }
+                    entries[index] = std::move(entry);
+                }
+                distances[index] = static_cast<uint8_t>(distance);
+                return;
+            }
+        }
+
+        size_t insertNew(Entry&& entry) {
+            growForOne();
+            const K key = entry.key;
+            place(std::move(entry));
+            _size++;
+            return indexOf(key);
+        }
+
+    public:
+        template<bool Const>
+        class Iterator {
+            private:
+                using Map = std::conditional_t<Const, const HashMap, HashMap>;
+                Map* map;
+                size_t index;
+
+                void skipEmpty() {
+                    while (index < map->_capacity && map->distances[index] == 0) {
+                        index++;
+                    }
+                }
+
+            public:
+                using value_type = Entry;
+                using reference = std::conditional_t<Const, const Entry&, Entry&>;
+                using pointer = std::conditional_t<Const, const Entry*, Entry*>;
+                using difference_type = ptrdiff_t;
+                using iterator_category = std::forward_iterator_tag;
+
+                Iterator(Map* map, const size_t index) : map(map), index(index) { skipEmpty(); }
+
+                reference operator*() const { return map->entries[index]; }
+                pointer operator->() const { return &map->entries[index]; }
+
+                Iterator& operator++() {
+                    index++;
+                    skipEmpty();
+                    return *this;
+                }
+
+                bool operator==(const Iterator& other) const { return index == other.index; }
+                bool operator!=(const Iterator& other) const { return index != other.index; }
+        };
+
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        HashMap() : entries(nullptr), distances(nullptr), _capacity(0), _size(0), shift(64), hasher(), equal() {}
+
+        HashMap(const HashMap& other) : HashMap() {
+            hasher = other.hasher;
+            equal = other.equal;
+            if (other._size > 0) {
+                allocate(other._capacity);
+                for (size_t i = 0; i < other._capacity; i++) {
+                    if (other.distances[i] != 0) {
+                        ::new (static_cast<void*>(entries + i)) Entry(other.entries[i]);
+                        distances[i] = other.distances[i];
+                    }
+                }
+                _size = other._size;
+            }
+        }
+
+        HashMap& operator=(const HashMap& other) {
+            if (this != &other) {
+                HashMap temp(other);
+                swap(temp);
+            }
+            return *this;
+        }
+
+        HashMap(HashMap&& other) noexcept : HashMap() {
+            swap(other);
+        }
+
+        HashMap& operator=(HashMap&& other) noexcept {
+            if (this != &other) {
+                release();
+                swap(other);
+            }
+            return *this;
+        }
+
+        ~HashMap() {
+            release();
+        }
+
+        void swap(HashMap& other) noexcept {
+            std::swap(entries, other.entries);
+            std::swap(distances, other.distances);
+            std::swap(_capacity, other._capacity);
+            std::swap(_size, other._size);
+            std::swap(shift, other.shift);
+            std::swap(hasher, other.hasher);
+            std::swap(equal, other.equal);
+        }
+
+        // nullptr when the key isn't there
+        V* find(const K& key) {
+            const size_t index = indexOf(key);
+            return index != SIZE_MAX ? &entries[index].value : nullptr;
+        }
+
+        const V* find(const K& key) const {
+            const size_t index = indexOf(key);
+            return index != SIZE_MAX ? &entries[index].value : nullptr;
+        }
+
+        bool contains(const K& key) const {
+            return indexOf(key) != SIZE_MAX;
+        }
+
+        // false, and the map is left alone, if the key is already there
+        bool insert(const K& key, const V& value) {
+            if (indexOf(key) != SIZE_MAX) {
+                return false;
+            }
+            insertNew(Entry{ key, value });
+            return true;
+        }
+
+        bool insert(K&& key, V&& value) {
+            if (indexOf(key) != SIZE_MAX) {
+                return false;
+            }
+            insertNew(Entry{ std::move(key), std::move(value) });
+            return true;
+        }
+
+        // inserts or overwrites
+        V& assign(const K& key, const V& value) {
+            V& slot = (*this)[key];
+            slot = value;
+            return slot;
+        }
+
+        // value initializes a missing key, like std::unordered_map
+        V& operator[](const K& key) {
+            size_t index = indexOf(key);
+            if (index == SIZE_MAX) {
+                index = insertNew(Entry{ key, V() });
+            }
+            return entries[index].value;
+        }
+
+        // false if the key wasn't there
+        bool erase(const K& key) {
+            size_t index = indexOf(key);
+            if (index == SIZE_MAX) {
+                return false;
+            }
+
+            // shift the run after it back by one, every entry in it gets a step closer to home
+            const size_t mask = _capacity - 1;
+            size_t next = (index + 1) & mask;
+            while (distances[next] > 1) {
+                entries[index] = std::move(entries[next]);
+                distances[index] = static_cast<uint8_t>(distances[next] - 1);
+                index = next;
+                next = (next + 1) & mask;
+            }
+            entries[index].~Entry();
+            distances[index] = 0;
+            _size--;
+            return true;
+        }
+
+        // room for count entries without growing
+        void reserve(const size_t count) {
+            size_t capacity = MIN_CAPACITY;
+            while (count * 8 > capacity * 7) {
+                capacity *= 2;
+            }
+            if (capacity > _capacity) {
+                rehash(capacity);
+            }
+        }
+
+        // drops every entry but keeps the table
+        void clear() {
+            if (_capacity > 0) {
+                destroyAll();
+                memset(distances, 0, _capacity);
+            }
+            _size = 0;
+        }
+
+        size_t size() const { return _size; }
+        size_t capacity() const { return _capacity; }
+        bool empty() const { return _size == 0; }
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, _capacity); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, _capacity); }
+};
+
+// stable reference to an item in a SlotMap. stays valid until that item is erased, after which it
+// no longer finds anything, even once the slot has been reused
+typedef struct SlotHandle {
+    uint32_t index;
+    uint32_t generation;
+
+    bool operator==(const SlotHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+} SlotHandle;
+
+// items packed densely in a DArray for iteration, reached through handles that survive other items
+// coming and going. erasing moves the last item into the hole, so the order isn't stable
+template<class T>
+class SlotMap {
+    private:
+        typedef struct Slot {
+            uint32_t item;       // index into items, or the next free slot while this one is free
+            uint32_t generation; // bumped on erase so old handles stop matching
+        } Slot;
+
+        static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+        DArray<T> items;
+        DArray<uint32_t> item_slots; // items[i] belongs to slots[item_slots[i]]
+        DArray<Slot> slots;
+        uint32_t free_head;
+
+        SlotHandle claimSlot() {
+            uint32_t index;
+            if (free_head != NO_SLOT) {
+                index = free_head;
+                free_head = slots[index].item;
+            } else {
+                if (slots.size() >= NO_SLOT) {
+                    throw std::length_error("slot map is full");
+                }
+                index = static_cast<uint32_t>(slots.size());
+                // generations start at 1 so a zeroed handle never finds anything
+                slots.push_back({ .item = 0, .generation = 1 });
+            }
+            slots[index].item = static_cast<uint32_t>(items.size());
+            item_slots.push_back(index);
+            return { .index = index, .generation = slots[index].generation };
+        }
+
+        bool isLive(const SlotHandle handle) const {
+            return handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+        }
+
+    public:
+        SlotMap() : free_head(NO_SLOT) {}
+
+        SlotHandle insert(const T& item) {
+            const SlotHandle handle = claimSlot();
+            items.push_back(item);
+            return handle;
+        }
+
+        SlotHandle insert(T&& item) {
+            const SlotHandle handle = claimSlot();
+            items.push_back(std::move(item));
+            return handle;
+        }
+
+        template<class... Args>
+        SlotHandle emplace(Args&&... args) {
+            const SlotHandle handle = claimSlot();
+            items.emplace_back(std::forward<Args>(args)...);
+            return handle;
+        }
+
+        // nullptr for a handle whose item has been erased
+        T* get(const SlotHandle handle) {
+            return isLive(handle) ? items.addr(slots[handle.index].item) : nullptr;
+        }
+
+        const T* get(const SlotHandle handle) const {
+            return isLive(handle) ? &items[slots[handle.index].item] : nullptr;
+        }
+
+        bool contains(const SlotHandle handle) const {
+            return isLive(handle);
+        }
+
+        // false for a handle that's already gone
+        bool erase(const SlotHandle handle) {
+            if (!isLive(handle)) {
+                return false;
+            }
+
+            const uint32_t item = slots[handle.index].item;
+            const uint32_t last = static_cast<uint32_t>(items.size() - 1);
+            if (item != last) {
+                items[item] = std::move(items[last]);
+                item_slots[item] = item_slots[last];
+                slots[item_slots[item]].item = item;
+            }
+            items.pop_back();
+            item_slots.pop_back();
+
+            Slot& slot = slots[handle.index];
+            slot.generation++;
+            slot.item = free_head;
+            free_head = handle.index;
+            return true;
         }
-        
+
+        // handle of the item at a dense index, for when iterating needs to hand out handles
+        SlotHandle handleAt(const size_t index) const {
+            const uint32_t slot = item_slots[index];
+            return { .index = slot, .generation = slots[slot].generation };
+        }
+
+        void reserve(const size_t count) {
+            items.reserve(count);
+            item_slots.reserve(count);
+            slots.reserve(count);
+        }
+
+        // every handle handed out so far stops finding anything
+        void clear() {
+            for (size_t i = 0; i < item_slots.size(); i++) {
+                Slot& slot = slots[item_slots[i]];
+                slot.generation++;
+                slot.item = free_head;
+                free_head = item_slots[i];
+            }
+            items.clear();
+            item_slots.clear();
+        }
+
+        size_t size() const { return items.size(); }
+        bool empty() const { return items.empty(); }
+
+        // the dense items, in no particular order
+        T* begin() { return items.begin(); }
+        T* end()   { return items.end(); }
+        const T* begin() const { return items.begin(); }
+        const T* end()   const { return items.end(); }
 };
 
-#endif
\ No newline at end of file
+#endif
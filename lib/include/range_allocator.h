@@ -0,0 +1,40 @@
+#ifndef RANGE_ALLOCATOR_H
+#define RANGE_ALLOCATOR_H
+
+#include <stddef.h>
+#include <optional>
+
+#include "mystl.hpp"
+
+struct Range {
+    size_t offset;
+    size_t size;
+};
+
+// first-fit free-list allocator over [0, capacity). it only hands out offsets,
+// the caller owns whatever memory (or GPU buffer) the offsets index into.
+// free ranges are kept sorted by offset and merged with their neighbours on release
+class RangeAllocator {
+
+    private:
+        size_t _capacity;
+        size_t _used;
+        DArray<Range> free_ranges;
+
+    public:
+        RangeAllocator();
+        explicit RangeAllocator(size_t capacity);
+
+        std::optional<size_t> allocate(size_t size);
+        void release(size_t offset, size_t size);
+
+        size_t capacity() const { return _capacity; }
+        size_t used() const { return _used; }
+        size_t freeRangeCount() const { return free_ranges.size(); }
+        size_t largestFreeRange() const;
+
+        // 0 when all free space is one contiguous range, approaching 1 as it splinters
+        float fragmentation() const;
+};
+
+#endif //RANGE_ALLOCATOR_H
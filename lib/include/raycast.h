@@ -8,6 +8,7 @@
 #include "scene.h"
 #include "mystl.hpp"
 #include "camera.h"
+#include "frame_arena.h"
 
 
 struct Triangle {
@@ -22,7 +23,7 @@ struct Ray {
 };
 
 struct MeshInfo {
-    Material material;
+    MaterialHandle material;
     std::optional<int> id;
 };
 
@@ -42,16 +43,21 @@ struct NodeIntersection {
     MeshIntersection meshIntersection;
 };
 
+// a ray rarely hits more than a few triangles, these stay inline until it does and then spill into
+// the frame arena, so hold on to the results no longer than the frame that cast the ray
+typedef SmallArray<VertexIntersection, 8, FrameAllocator<VertexIntersection>> VertexIntersections;
+typedef SmallArray<NodeIntersection, 4, FrameAllocator<NodeIntersection>> NodeIntersections;
+
 Vec3Result rayIntersectsTriangle(Ray ray, Triangle triangle);
 
-DArray<VertexIntersection> rayIntersectsVertices(Ray ray, Vertices vertices);
+VertexIntersections rayIntersectsVertices(Ray ray, const Vertices& vertices);
 
-DArray<NodeIntersection> rayIntersectsSceneNode(Ray ray, const SceneNode& node);
+NodeIntersections rayIntersectsSceneNode(Ray ray, const SceneNode& node);
 
-DArray<NodeIntersection> rayIntersectsScene(const Ray &ray, const Scene& scene);
+NodeIntersections rayIntersectsScene(const Ray &ray, const Scene& scene);
 
 void sortBySceneDepth(
-    DArray<NodeIntersection>& intersections,
+    NodeIntersections& intersections,
     Camera camera
 );
 
@@ -8,6 +8,7 @@
 #include "mesh.h"
 #include "mystl.hpp"
 #include "mat4.h"
+#include "affine.h"
 
 
 struct Entity {
@@ -22,9 +23,9 @@ struct AppState {
 
 typedef struct SceneNode {
     size_t id;
-    Mat4 local_transform; 
-    Mat4 world_transform;
-    DArray<SceneNode *> children; // empty if no children
+    Affine local_transform; // see affine.h, every node transform is translation, rotation and scale
+    Affine world_transform;
+    SmallArray<SceneNode *, 4> children; // empty if no children, most nodes have a handful so they stay inline
     std::optional<Mesh> mesh; 
     std::optional<SceneNode *> parent;
     std::optional<std::string> name;
@@ -43,8 +44,18 @@ typedef struct Scene {
 
 void updateWorldTransform(SceneNode * node);
 
+void updateTransform(SceneNode * node, const Affine &transform);
+// for transforms built with the Mat4 helpers, they have to be affine
 void updateTransform(SceneNode * node, const Mat4 &transform);
 
-SceneNode createSceneNode(const Mat4 &transform, const std::optional<Mesh> &mesh, std::string name);
+// for a heap tree the renderer never got: gives back its meshes' materials and deletes every node
+void deleteSceneTree(SceneNode* node);
+
+// a deep copy of mesh with its own user of the material, for the same mesh in several nodes
+Mesh copyMesh(const Mesh& mesh);
+
+// the node takes the mesh over, move it in (or copyMesh it to keep the original)
+SceneNode createSceneNode(const Affine &transform, std::optional<Mesh> mesh, std::string name);
+SceneNode createSceneNode(const Mat4 &transform, std::optional<Mesh> mesh, std::string name);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef TEXTURE_MIPS_H
+#define TEXTURE_MIPS_H
+
+#include <stddef.h>
+
+#include "material.h"
+
+// Mip chains are built on the cpu when an image is decoded, so the GL thread uploads finished levels
+// instead of stalling on glGenerateMipmap. A chain lives in TextureData::pixels largest level first,
+// each level tightly packed right after the one above it, down to 1x1. Levels are a 2x2 box filter of
+// the one above, colour channels are averaged in linear space so they don't darken, alpha as it is
+
+// levels of a full chain for a level 0 of this size
+int mipLevelCount(int width, int height);
+
+// width or height of a level, never below 1
+int mipExtent(int size, int level);
+
+size_t mipLevelBytes(int width, int height, int channels, int level);
+
+// where a level starts in a chain whose level 0 is width x height
+size_t mipLevelOffset(int width, int height, int channels, int level);
+
+// every level data holds
+size_t mipChainBytes(const TextureData& data);
+
+// the chain of data's level 0, without the levels above max_size (0 keeps them all). The chain is
+// always allocated, data's pixels are freed if it owned them. Null pixels come back as they are
+TextureData buildMipChain(const TextureData& data, int max_size);
+
+// data without its first count levels, at least one is kept. Owned pixels are moved down and shrunk
+// in place, borrowed ones just point further in
+TextureData dropTopMips(const TextureData& data, int count);
+
+#endif //TEXTURE_MIPS_H
@@ -0,0 +1,95 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// fixed set of worker threads pulling jobs off one queue in submission order.
+// the destructor finishes every queued job before joining
+class ThreadPool {
+
+    private:
+        std::vector<std::thread> workers;
+        std::deque<std::function<void()>> jobs;
+        std::mutex mutex;
+        std::condition_variable job_available;
+        bool stopping;
+
+        void work();
+
+    public:
+        // 0 picks one worker per hardware thread
+        explicit ThreadPool(size_t thread_count = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t threadCount() const { return workers.size(); }
+
+        // runs job on a worker, exceptions it throws come out of the future's get()
+        template<class Job>
+        std::future<std::invoke_result_t<Job>> submit(Job job) {
+            using Result = std::invoke_result_t<Job>;
+
+            // std::function needs something copyable, the packaged task isn't
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::move(job));
+            std::future<Result> result = task->get_future();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                jobs.emplace_back([task]() { (*task)(); });
+            }
+            job_available.notify_one();
+
+            return result;
+        }
+};
+
+// splits [0, count) into about one range per worker, none shorter than min_range, and runs
+// job(begin, end) on each. the calling thread does the first range itself and returns once all are done.
+// don't call it from a job on the same pool, the waiting worker can't run the ranges it's waiting on
+template<class Job>
+void parallelFor(ThreadPool& pool, const size_t count, const size_t min_range, Job job) {
+
+    const size_t most_ranges = std::max<size_t>(1, count / std::max<size_t>(1, min_range));
+    const size_t ranges = std::min(pool.threadCount() + 1, most_ranges);
+    const size_t range = (count + ranges - 1) / ranges;
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(ranges);
+    for (size_t begin = range; begin < count; begin += range) {
+        const size_t end = std::min(count, begin + range);
+        pending.push_back(pool.submit([&job, begin, end]() { job(begin, end); }));
+    }
+
+    // every range has to finish before this returns, even when one throws, they all use job
+    std::exception_ptr failure;
+    try {
+        job(0, std::min(count, range));
+    } catch (...) {
+        failure = std::current_exception();
+    }
+    for (auto& result : pending) {
+        try {
+            result.get();
+        } catch (...) {
+            failure = failure ? failure : std::current_exception();
+        }
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+#endif //THREAD_POOL_H
@@ -0,0 +1,39 @@
+#ifndef VERTEX_COMPRESSION_H
+#define VERTEX_COMPRESSION_H
+
+#include <stdint.h>
+
+#include "mesh.h"
+#include "vec.h"
+
+// Compressed vertex layout, 16 bytes per vertex instead of 32 (14 with Oct8 normals):
+//
+//   position  4 x unorm16 relative to the mesh bounds (w is padding)
+//             error <= 0.5 / 65535 of the bounds extent per axis
+//   normal    octahedron encoded, 2 x snorm16 (Oct16) or 2 x snorm8 (Oct8)
+//             angular error < 0.01 degrees for Oct16 and < 0.7 degrees for Oct8
+//   uv        2 x half float
+//             relative error <= 2^-11, so <= 0.00049 absolute for uvs in [-1, 1]
+//
+// The error bounds are checked in tests/vertex_compression_tests.cpp.
+
+// replaces the float streams (positions, normals and uvs) with
+// the compressed layout. Does nothing if the mesh is already compressed
+void compressVertices(Mesh& mesh, NormalEncoding normal_encoding);
+
+bool hasCompressedVertices(const Mesh& mesh);
+
+// positions back to 3 floats per vertex, for cpu side users such as the raycaster
+DArray<float> decodePositions(const CompressedVertices& compressed, size_t vertex_count);
+// same, into vertex_count * 3 floats the caller owns
+void decodePositions(const CompressedVertices& compressed, size_t vertex_count, float* positions);
+
+void octahedronEncode(mym::Vec3 normal, NormalEncoding encoding, unsigned char* out);
+mym::Vec3 octahedronDecode(const unsigned char* encoded, NormalEncoding encoding);
+
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t half);
+
+size_t normalEncodingSize(NormalEncoding encoding); // bytes per vertex
+
+#endif //VERTEX_COMPRESSION_H
@@ -0,0 +1,428 @@
+#include "json.h"
+
+#include <math.h>
+#include <string.h>
+#include <charconv>
+
+// deep enough for any real document, shallow enough that hostile input can't blow the stack
+constexpr size_t MAX_JSON_DEPTH = 256;
+
+namespace {
+
+struct JsonParser {
+    const char* text;
+    size_t length;
+    size_t position;
+    DArray<JsonToken>& tokens;
+
+    void skipWhitespace() {
+        while (position < length) {
+            const char c = text[position];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                break;
+            }
+            position++;
+        }
+    }
+
+    size_t pushToken(const JsonType type, const size_t start, const size_t token_length) {
+        tokens.push_back({
+            .type = type,
+            .start = static_cast<uint32_t>(start),
+            .length = static_cast<uint32_t>(token_length),
+            .count = 0,
+            .next = static_cast<uint32_t>(tokens.size() + 1),
+        });
+        return tokens.size() - 1;
+    }
+
+    static bool isHex(const char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+
+    static bool isDigit(const char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    bool parseString() {
+        // opening quote
+        position++;
+        const size_t start = position;
+
+        while (position < length) {
+            const unsigned char c = static_cast<unsigned char>(text[position]);
+            if (c == '"') {
+                pushToken(JsonType::String, start, position - start);
+                position++;
+                return true;
+            }
+            if (c < 0x20) {
+                return false;
+            }
+            if (c == '\\') {
+                if (position + 1 >= length) {
+                    return false;
+                }
+                const char escaped = text[position + 1];
+                if (escaped == 'u') {
+                    if (position + 6 > length) {
+                        return false;
+                    }
+                    for (size_t i = 2; i < 6; i++) {
+                        if (!isHex(text[position + i])) {
+                            return false;
+                        }
+                    }
+                    position += 6;
+                    continue;
+                }
+                if (strchr("\"\\/bfnrt", escaped) == nullptr || escaped == '\0') {
+                    return false;
+                }
+                position += 2;
+                continue;
+            }
+            position++;
+        }
+        return false;
+    }
+
+    bool parseNumber() {
+        const size_t start = position;
+
+        if (position < length && text[position] == '-') {
+            position++;
+        }
+        if (position >= length || !isDigit(text[position])) {
+            return false;
+        }
+        if (text[position] == '0') {
+            position++;
+        } else {
+            while (position < length && isDigit(text[position])) {
+                position++;
+            }
+        }
+        if (position < length && text[position] == '.') {
+            position++;
+            if (position >= length || !isDigit(text[position])) {
+                return false;
+            }
+            while (position < length && isDigit(text[position])) {
+                position++;
+            }
+        }
+        if (position < length && (text[position] == 'e' || text[position] == 'E')) {
+            position++;
+            if (position < length && (text[position] == '+' || text[position] == '-')) {
+                position++;
+            }
+            if (position >= length || !isDigit(text[position])) {
+                return false;
+            }
+            while (position < length && isDigit(text[position])) {
+                position++;
+            }
+        }
+
+        pushToken(JsonType::Number, start, position - start);
+        return true;
+    }
+
+    bool parseLiteral(const char* word, const JsonType type) {
+        const size_t word_length = strlen(word);
+        if (position + word_length > length || memcmp(text + position, word, word_length) != 0) {
+            return false;
+        }
+        pushToken(type, position, word_length);
+        position += word_length;
+        return true;
+    }
+
+    // containers push their own token first and patch count and next once the children are in
+    bool parseContainer(const size_t depth, const bool object) {
+        const size_t container = pushToken(object ? JsonType::Object : JsonType::Array, position, 0);
+        const char close = object ? '}' : ']';
+        position++;
+
+        uint32_t count = 0;
+        skipWhitespace();
+        if (position < length && text[position] == close) {
+            position++;
+        } else {
+            while (true) {
+                skipWhitespace();
+                if (object) {
+                    if (position >= length || text[position] != '"' || !parseString()) {
+                        return false;
+                    }
+                    skipWhitespace();
+                    if (position >= length || text[position] != ':') {
+                        return false;
+                    }
+                    position++;
+                }
+                if (!parseValue(depth + 1)) {
+                    return false;
+                }
+                count++;
+
+                skipWhitespace();
+                if (position >= length) {
+                    return false;
+                }
+                if (text[position] == ',') {
+                    position++;
+                    continue;
+                }
+                if (text[position] == close) {
+                    position++;
+                    break;
+                }
+                return false;
+            }
+        }
+
+        tokens[container].count = count;
+        tokens[container].length = static_cast<uint32_t>(position - tokens[container].start);
+        tokens[container].next = static_cast<uint32_t>(tokens.size());
+        return true;
+    }
+
+    bool parseValue(const size_t depth) {
+        if (depth > MAX_JSON_DEPTH) {
+            return false;
+        }
+
+        skipWhitespace();
+        if (position >= length) {
+            return false;
+        }
+
+        switch (text[position]) {
+            case '{': return parseContainer(depth, true);
+            case '[': return parseContainer(depth, false);
+            case '"': return parseString();
+            case 't': return parseLiteral("true", JsonType::Bool);
+            case 'f': return parseLiteral("false", JsonType::Bool);
+            case 'n': return parseLiteral("null", JsonType::Null);
+            default:  return parseNumber();
+        }
+    }
+};
+
+// appends a code point as utf-8
+void appendUtf8(std::string& out, const uint32_t code_point) {
+    if (code_point < 0x80) {
+        out.push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else if (code_point < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+uint32_t parseHex4(const char* digits) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; i++) {
+        const char c = digits[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            value |= c - 'a' + 10;
+        } else {
+            value |= c - 'A' + 10;
+        }
+    }
+    return value;
+}
+
+} // namespace
+
+JsonDocument::JsonDocument() : text(nullptr), length(0) {}
+
+bool JsonDocument::parse(const char* json_text, const size_t json_length) {
+
+    text = json_text;
+    length = json_length;
+    tokens = DArray<JsonToken>();
+
+    // offsets are stored in 32 bits
+    if (json_length >= UINT32_MAX) {
+        return false;
+    }
+
+    JsonParser parser = { .text = json_text, .length = json_length, .position = 0, .tokens = tokens };
+    bool ok = parser.parseValue(0);
+    parser.skipWhitespace();
+
+    // glb pads the json chunk with spaces, anything else after the value is an error
+    ok = ok && parser.position == json_length;
+
+    if (!ok) {
+        tokens = DArray<JsonToken>();
+    }
+    return ok;
+}
+
+JsonValue JsonDocument::root() const {
+    return tokens.size() > 0 ? JsonValue(this, 0) : JsonValue();
+}
+
+JsonValue::JsonValue() : document(nullptr), token(0) {}
+
+JsonValue::JsonValue(const JsonDocument* document, const size_t token) : document(document), token(token) {}
+
+JsonType JsonValue::type() const {
+    return document != nullptr ? document->tokens[token].type : JsonType::Invalid;
+}
+
+size_t JsonValue::size() const {
+    const JsonType value_type = type();
+    if (value_type != JsonType::Array && value_type != JsonType::Object) {
+        return 0;
+    }
+    return document->tokens[token].count;
+}
+
+JsonValue JsonValue::operator[](const char* key) const {
+    if (type() != JsonType::Object) {
+        return JsonValue();
+    }
+
+    const size_t count = document->tokens[token].count;
+    size_t child = token + 1;
+    for (size_t i = 0; i < count; i++) {
+        const JsonValue member_key(document, child);
+        const size_t value = child + 1;
+        if (member_key.equals(key)) {
+            return JsonValue(document, value);
+        }
+        child = document->tokens[value].next;
+    }
+    return JsonValue();
+}
+
+JsonValue JsonValue::at(const size_t index) const {
+    if (type() != JsonType::Array || index >= document->tokens[token].count) {
+        return JsonValue();
+    }
+
+    size_t child = token + 1;
+    for (size_t i = 0; i < index; i++) {
+        child = document->tokens[child].next;
+    }
+    return JsonValue(document, child);
+}
+
+JsonValues JsonValue::elements() const {
+    JsonValues values;
+    values.reserve(size());
+    if (type() != JsonType::Array) {
+        return values;
+    }
+
+    const size_t count = document->tokens[token].count;
+    size_t child = token + 1;
+    for (size_t i = 0; i < count; i++) {
+        values.push_back(JsonValue(document, child));
+        child = document->tokens[child].next;
+    }
+    return values;
+}
+
+double JsonValue::number(const double fallback) const {
+    if (type() != JsonType::Number) {
+        return fallback;
+    }
+
+    const JsonToken& number_token = document->tokens[token];
+    const char* first = document->text + number_token.start;
+    double value = fallback;
+    std::from_chars(first, first + number_token.length, value);
+    return value;
+}
+
+size_t JsonValue::index(const size_t fallback) const {
+    const double value = number(-1.0);
+    // 2^64 and up don't fit, casting them (or nan) is undefined. nan fails every comparison
+    constexpr double INDEX_LIMIT = 18446744073709551616.0;
+    if (!(value >= 0.0 && value < INDEX_LIMIT) || value != floor(value)) {
+        return fallback;
+    }
+    return static_cast<size_t>(value);
+}
+
+bool JsonValue::boolean(const bool fallback) const {
+    if (type() != JsonType::Bool) {
+        return fallback;
+    }
+    return document->text[document->tokens[token].start] == 't';
+}
+
+std::string JsonValue::string(const std::string& fallback) const {
+    if (type() != JsonType::String) {
+        return fallback;
+    }
+
+    const JsonToken& string_token = document->tokens[token];
+    const char* raw = document->text + string_token.start;
+    const size_t raw_length = string_token.length;
+
+    std::string out;
+    out.reserve(raw_length);
+
+    // the parser already checked every escape
+    for (size_t i = 0; i < raw_length; i++) {
+        if (raw[i] != '\\') {
+            out.push_back(raw[i]);
+            continue;
+        }
+
+        i++;
+        switch (raw[i]) {
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                uint32_t code_point = parseHex4(raw + i + 1);
+                i += 4;
+                // a surrogate pair spells one code point above the basic plane
+                if (code_point >= 0xD800 && code_point < 0xDC00 && i + 6 < raw_length &&
+                    raw[i + 1] == '\\' && raw[i + 2] == 'u') {
+                    const uint32_t low = parseHex4(raw + i + 3);
+                    if (low >= 0xDC00 && low < 0xE000) {
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                appendUtf8(out, code_point);
+                break;
+            }
+            default: out.push_back(raw[i]); break;
+        }
+    }
+
+    return out;
+}
+
+bool JsonValue::equals(const char* text) const {
+    if (type() != JsonType::String) {
+        return false;
+    }
+
+    const JsonToken& string_token = document->tokens[token];
+    return strlen(text) == string_token.length &&
+           memcmp(document->text + string_token.start, text, string_token.length) == 0;
+}
@@ -1,6 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <optional>
+#include <string>
+#include <type_traits>
 
 #include <assimp/Importer.hpp>      // C++ importer interface
 #include <assimp/scene.h>           // Output data structure
@@ -9,10 +15,16 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "../third_party/stb_image.h"
 
+#include "asset_cache.h"
+#include "float_parser.h"
+#include "glb_reader.h"
 #include "loaders.h"
+#include "mapped_file.h"
 #include "mat4.h"
 #include "scene.h"
 #include "material.h"
+#include "material_table.h"
+#include "texture_mips.h"
 
 
 
@@ -40,52 +52,105 @@ char* get_shader_content(const char* fileName)
     return shaderContent;
 }
 
-// reads something that is not really a csv, because it has no line endings
+// binary sidecar next to a float text asset, "assets/positions.txt" -> "assets/positions.f32".
+// a FloatSidecarHeader followed by raw native float32s
+static std::string floatSidecarPath(const char* filename) {
+  std::string path(filename);
+  const size_t dot = path.find_last_of('.');
+  const size_t slash = path.find_last_of('/');
+  if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) {
+    path.erase(dot);
+  }
+  return path + ".f32";
+}
+
+constexpr char FLOAT_SIDECAR_MAGIC[8] = { 'N', 'R', 'F', 'L', 'O', 'A', 'T', '\0' };
+
+// says which text the floats were parsed from, a sidecar of any other version of it is parsed again
+typedef struct FloatSidecarHeader {
+  char magic[8];
+  uint64_t source_size;
+  int64_t source_mtime;
+  uint64_t float_count;
+} FloatSidecarHeader;
+
+// nullopt unless the sidecar was written, in full, from exactly this text
+static std::optional<DArray<float>> readFloatSidecar(const std::string& path, const struct stat& source) {
+  MappedFile sidecar;
+  if (!sidecar.open(path.c_str()) || sidecar.size() < sizeof(FloatSidecarHeader)) {
+    return std::nullopt;
+  }
+
+  FloatSidecarHeader header;
+  memcpy(&header, sidecar.data(), sizeof(FloatSidecarHeader));
+  const size_t float_bytes = sidecar.size() - sizeof(FloatSidecarHeader);
+  if (memcmp(header.magic, FLOAT_SIDECAR_MAGIC, sizeof(FLOAT_SIDECAR_MAGIC)) != 0 ||
+      header.source_size != static_cast<uint64_t>(source.st_size) ||
+      header.source_mtime != static_cast<int64_t>(source.st_mtime) ||
+      header.float_count != float_bytes / sizeof(float) || float_bytes % sizeof(float) != 0) {
+    return std::nullopt;
+  }
+
+  return DArray<float>(reinterpret_cast<const float*>(sidecar.data() + sizeof(FloatSidecarHeader)), header.float_count);
+}
+
+// into a temporary file renamed over the sidecar, so a reader never maps half of one. Loads of the same
+// asset can run at once, each writes its own temporary
+static bool writeFloatSidecar(const std::string& path, const struct stat& source, const DArray<float>& floats) {
+  static std::atomic<size_t> temporary_counter = 0;
+  const std::string temporary_path = path + "." + std::to_string(getpid()) + "." +
+                                     std::to_string(temporary_counter.fetch_add(1)) + ".tmp";
+  FILE* file = fopen(temporary_path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  FloatSidecarHeader header = {};
+  memcpy(header.magic, FLOAT_SIDECAR_MAGIC, sizeof(FLOAT_SIDECAR_MAGIC));
+  header.source_size = static_cast<uint64_t>(source.st_size);
+  header.source_mtime = static_cast<int64_t>(source.st_mtime);
+  header.float_count = floats.size();
+
+  bool written = fwrite(&header, sizeof(FloatSidecarHeader), 1, file) == 1 &&
+                 fwrite(floats.begin(), sizeof(float), floats.size(), file) == floats.size();
+  written = fclose(file) == 0 && written;
+
+  if (!written || rename(temporary_path.c_str(), path.c_str()) != 0) {
+    remove(temporary_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+// reads something that is not really a csv, because it has no line endings.
+// prefers the .f32 sidecar when it was written from this exact text, and writes one after parsing the text
 DArray<float> read_csv(const char* filename) {
 
-  FILE* fptr = fopen(filename, "r");
+  const std::string sidecar_path = floatSidecarPath(filename);
 
-  int read = 0;
-  int number_of_floats = 0;
-  while ((read = getc(fptr)) != EOF) {
-    if (read == ',') {
-      number_of_floats++;
-      }
-    }
-    
-  number_of_floats++;
-  const size_t number = number_of_floats;
-  DArray<float> floats;
-
-  size_t float_cursor = 0;
-  char number_string[10] = { 0 }; // it wont be longer than this
-  size_t digit_cursor = 0;
-  FILE* fptr2 = fopen(filename, "r");
-
-  while ((read = getc(fptr2)) != EOF) {
-    
-    if (read != ',') {
-        // add chars to number string
-        const char t = read;
-        number_string[digit_cursor] = t;
-        digit_cursor++;
-    } else {
-        // convert the number string into a float
-        floats.push_back(atof(number_string));
-        // zero the number string
-        memset(number_string,0,strlen(number_string));
-        // reset digit cusor
-        digit_cursor = 0;
-        // move onto the next float
-        float_cursor++; 
-    }
-   } 
+  struct stat source;
+  if (stat(filename, &source) != 0) {
+    printf("Failed to open float file %s\n", filename);
+    throw "failed to open float file";
+  }
 
-    // at EOF add the last float in
-    floats.push_back(atof(number_string));
+  std::optional<DArray<float>> cached = readFloatSidecar(sidecar_path, source);
+  if (cached.has_value()) {
+    return std::move(cached.value());
+  }
 
-    return floats;
+  MappedFile text;
+  if (!text.open(filename)) {
+    printf("Failed to open float file %s\n", filename);
+    throw "failed to open float file";
+  }
 
+  DArray<float> floats = parseFloats(reinterpret_cast<const char*>(text.data()), text.size());
+
+  // next run skips the parse, a read only asset folder just means we parse every time
+  writeFloatSidecar(sidecar_path, source, floats);
+
+  return floats;
 }
 
 // helper: convert Assimp matrix -> Mat4
@@ -116,7 +181,8 @@ static TextureData loadEmbeddedTexture(const aiTexture* aiTex) {
     if (aiTex->mHeight == 0) {
         // Compressed format (PNG, JPEG, etc.)
         // Flip vertically because glTF UVs have V=0 at top, but OpenGL textures have V=0 at bottom
-        stbi_set_flip_vertically_on_load(true);
+        // per thread, scenes can be decoded on several workers at once
+        stbi_set_flip_vertically_on_load_thread(true);
         pixels = stbi_load_from_memory(
             (unsigned char*)aiTex->pcData,
             aiTex->mWidth,  // size in bytes for compressed data
@@ -125,7 +191,7 @@ static TextureData loadEmbeddedTexture(const aiTexture* aiTex) {
             &channels,
             0
           );
-        stbi_set_flip_vertically_on_load(false);  // Reset for any future non-glTF loads
+        stbi_set_flip_vertically_on_load_thread(false);  // Reset for any future non-glTF loads
         needs_free = true;  // stbi allocated this memory
     } else {
         // Raw RGBA data - need to flip vertically for OpenGL
@@ -153,20 +219,142 @@ static TextureData loadEmbeddedTexture(const aiTexture* aiTex) {
     data.width = width;
     data.height = height;
     data.channels = channels;
+    data.levels = 1;
     data.needs_free = needs_free;
-    // Default wrap modes (will be set properly in convertAiMesh based on material settings)
-    data.wrapModeU = WrapMode::Wrap;
-    data.wrapModeV = WrapMode::Wrap;
 
     return data;
 }
 
+// decode jobs never wait on other jobs, so unlike a caller's pool this one can't deadlock when
+// load_glb_async fills every worker with scenes that are waiting on their textures
+static ThreadPool& textureDecodePool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// index of the embedded texture a material path like "*3" refers to
+static std::optional<size_t> embeddedTextureIndex(const std::string& path, const aiScene* scene) {
+    if (path.length() < 2 || path[0] != '*') {
+        return std::nullopt;
+    }
+    const int index = atoi(path.c_str() + 1);
+    if (index < 0 || index >= static_cast<int>(scene->mNumTextures)) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(index);
+}
+
+static size_t embeddedTextureBytes(const aiTexture* texture) {
+    // compressed textures keep their byte size in mWidth, raw ones are width x height texels
+    return texture->mHeight == 0
+        ? texture->mWidth
+        : static_cast<size_t>(texture->mWidth) * texture->mHeight * sizeof(aiTexel);
+}
+
+// the assimp path flips the pixels for GL, the native glb reader doesn't. Mixed into the content
+// hashes and the sources so the same image read both ways stays two textures
+constexpr uint64_t FLIPPED_TEXTURE_SEED = 0x9e3779b97f4a7c15ull;
+
+// the material table's textures for the embedded images a diffuse slot uses. Images the table hasn't
+// seen decode on the texture workers while the geometry is converted, the others are shared as they are
+typedef struct EmbeddedTextures {
+    DArray<std::optional<TextureHandle>> handles; // per texture index, nullopt for textures nothing samples
+    DArray<std::shared_future<TextureData>> decoded;     // per texture index, valid where this load decodes
+} EmbeddedTextures;
+
+static EmbeddedTextures acquireEmbeddedTextures(const aiScene* scene, const std::string& path, const int max_texture_size) {
+
+    const size_t count = scene->mNumTextures;
+    EmbeddedTextures textures;
+    textures.handles = DArray<std::optional<TextureHandle>>(count, std::nullopt);
+    textures.decoded = DArray<std::shared_future<TextureData>>(count, std::shared_future<TextureData>());
+
+    for (unsigned i = 0; i < scene->mNumMaterials; i++) {
+        aiString texture_path;
+        if (scene->mMaterials[i]->GetTexture(aiTextureType_DIFFUSE, 0, &texture_path) != AI_SUCCESS) {
+            continue;
+        }
+        const std::optional<size_t> index = embeddedTextureIndex(texture_path.C_Str(), scene);
+        if (!index.has_value() || textures.handles[index.value()].has_value()) {
+            continue;
+        }
+
+        // raw textures hash their height in too, the same bytes can be laid out differently
+        const aiTexture* texture = scene->mTextures[index.value()];
+        const uint64_t hash = hashBytes(texture->pcData, embeddedTextureBytes(texture),
+                                        FLIPPED_TEXTURE_SEED ^ texture->mHeight);
+        bool created = false;
+        textures.handles[index.value()] = materialTable().acquireTexture(
+            path + "*" + std::to_string(index.value()) + " flipped", hash, created);
+
+        if (created) {
+            // the mips are built right after decoding, still on the worker
+            textures.decoded[index.value()] = textureDecodePool().submit([texture, max_texture_size]() {
+                return buildMipChain(loadEmbeddedTexture(texture), max_texture_size);
+            }).share();
+        }
+    }
+
+    return textures;
+}
+
+// hands the decoded pixels to the table and gives back the load's own references, the materials
+// hold theirs. Also runs when the conversion throws, so no texture is left Loading for good
+static void finishEmbeddedTextures(EmbeddedTextures& textures) {
+    MaterialTable& table = materialTable();
+    for (size_t i = 0; i < textures.handles.size(); i++) {
+        if (!textures.handles[i].has_value()) {
+            continue;
+        }
+        if (textures.decoded[i].valid()) {
+            const TextureData decoded = textures.decoded[i].get();
+            if (decoded.pixels != nullptr) {
+                printf("Loaded embedded texture %zu data (%dx%d, %d channels, %d mip levels)\n",
+                       i, decoded.width, decoded.height, decoded.channels, decoded.levels);
+            } else {
+                printf("Failed to load embedded texture %zu\n", i);
+            }
+            table.setTexturePixels(textures.handles[i].value(), decoded);
+        }
+        table.releaseTexture(textures.handles[i].value());
+    }
+}
+
+// xyz floats straight out of an assimp array. aiVector3D is three packed ai_reals, so with the
+// default single precision build the whole stream is one memcpy and the copy runs at memory bandwidth
+static void appendAiVectors(DArray<float>& out, const aiVector3D* vectors, const size_t count) {
+    if constexpr (std::is_same_v<ai_real, float> && sizeof(aiVector3D) == 3 * sizeof(float)) {
+        out.append(reinterpret_cast<const float*>(vectors), count * 3);
+    } else {
+        // double precision assimp builds narrow component by component
+        float* values = out.extend(count * 3);
+        for (size_t i = 0; i < count; i++) {
+            values[i * 3 + 0] = static_cast<float>(vectors[i].x);
+            values[i * 3 + 1] = static_cast<float>(vectors[i].y);
+            values[i * 3 + 2] = static_cast<float>(vectors[i].z);
+        }
+    }
+}
+
+// u and v of every coordinate, assimp keeps a w we don't use
+static void appendAiTextureCoords(DArray<float>& out, const aiVector3D* coords, const size_t count) {
+    float* values = out.extend(count * 2);
+    for (size_t i = 0; i < count; i++) {
+        values[i * 2 + 0] = static_cast<float>(coords[i].x);
+        values[i * 2 + 1] = static_cast<float>(coords[i].y);
+    }
+}
+
   // Helper: convert aiMesh -> Mesh (fills Vertices.positions and Vertices.normals using DArray)
 // convert a single aiMesh into our Mesh representation
-Mesh convertAiMesh(const aiMesh* aMesh, const aiScene* scene) {
+Mesh convertAiMesh(const aiMesh* aMesh, const aiScene* scene, const EmbeddedTextures& textures, const ImportOptions& options) {
     Mesh m;
 
-    m.material = BasicTextureMaterial{
+    // an untextured mesh keeps a null texture handle and draws untextured
+    BasicTextureMaterial material = {
+        .texture = {},
+        .wrap_u = WrapMode::Wrap,
+        .wrap_v = WrapMode::Wrap,
         .shininess = 0.5f
     };
 
@@ -176,41 +364,49 @@ Mesh convertAiMesh(const aiMesh* aMesh, const aiScene* scene) {
     // initialize index count to 0
     m.vertices.index_count = 0;
 
+    // every stream is sized once up front, nothing grows a float at a time
     // fill positions (3 floats per vertex)
-    for (size_t i = 0; i < vcount; ++i) {
-      const aiVector3D &p = aMesh->mVertices[i];
-      m.vertices.positions.push_back(p.x);
-      m.vertices.positions.push_back(p.y);
-      m.vertices.positions.push_back(p.z);
-    }
+    appendAiVectors(m.vertices.positions, aMesh->mVertices, vcount);
 
     // fill normals if present
     if (aMesh->HasNormals()) {
-      for (size_t i = 0; i < vcount; ++i) {
-        const aiVector3D &n = aMesh->mNormals[i];
-        m.vertices.normals.push_back(n.x);
-        m.vertices.normals.push_back(n.y);
-        m.vertices.normals.push_back(n.z);
+      appendAiVectors(m.vertices.normals, aMesh->mNormals, vcount);
+    }
+
+    // aiProcess_CalcTangentSpace only fills these when the mesh has normals and uvs, the bitangent
+    // is folded into a sign the shader can rebuild it from
+    if (aMesh->HasNormals() && aMesh->HasTangentsAndBitangents()) {
+      float* tangents = m.vertices.tangents.extend(vcount * 4);
+      for (size_t i = 0; i < vcount; i++) {
+        const aiVector3D& n = aMesh->mNormals[i];
+        const aiVector3D& t = aMesh->mTangents[i];
+        const aiVector3D& b = aMesh->mBitangents[i];
+        tangents[i * 4] = t.x;
+        tangents[i * 4 + 1] = t.y;
+        tangents[i * 4 + 2] = t.z;
+        // dot(cross(n, t), b)
+        const float handedness = (n.y * t.z - n.z * t.y) * b.x + (n.z * t.x - n.x * t.z) * b.y + (n.x * t.y - n.y * t.x) * b.z;
+        tangents[i * 4 + 3] = handedness < 0.f ? -1.f : 1.f;
       }
     }
 
-    // fill texture coordinates (uv) into the material's uvMap
+    // fill texture coordinates (uv)
     if (aMesh->HasTextureCoords(0)) {
       // Assimp supports up to 3 components per UV, but we only take u,v
-      for (size_t i = 0; i < vcount; ++i) {
-        const aiVector3D &uv = aMesh->mTextureCoords[0][i];
-        auto &uvmap = std::get<BasicTextureMaterial>(m.material).uvMap;
-        uvmap.push_back(uv.x);
-        uvmap.push_back(uv.y);
-      }
+      appendAiTextureCoords(m.vertices.uvs, aMesh->mTextureCoords[0], vcount);
     }
-    // fill indices from faces
+    // fill indices from faces, counted first so the buffer is allocated once
     if (aMesh->mNumFaces > 0) {
+      size_t index_total = 0;
+      for (unsigned f = 0; f < aMesh->mNumFaces; ++f) {
+        index_total += aMesh->mFaces[f].mNumIndices;
+      }
+
+      unsigned int* indices = m.vertices.indices.extend(index_total);
       for (unsigned f = 0; f < aMesh->mNumFaces; ++f) {
         const aiFace &face = aMesh->mFaces[f];
-        for (unsigned j = 0; j < face.mNumIndices; ++j) {
-          m.vertices.indices.push_back(face.mIndices[j]);
-        }
+        memcpy(indices, face.mIndices, face.mNumIndices * sizeof(unsigned int));
+        indices += face.mNumIndices;
       }
       m.vertices.index_count = m.vertices.indices.size();
     }
@@ -228,40 +424,28 @@ Mesh convertAiMesh(const aiMesh* aMesh, const aiScene* scene) {
         aiTextureMapMode mapModes[2] = { aiTextureMapMode_Wrap, aiTextureMapMode_Wrap };
         if (aiMat->GetTexture(aiTextureType_DIFFUSE, 0, &texPath, &mapping, &uvIndex, &blend, &op, &mapModes[0]) == AI_SUCCESS) {
           std::string pathStr(texPath.C_Str());
-          std::get<BasicTextureMaterial>(m.material).texture_path = pathStr;
 
           // Debug mapping info
           printf("[DEBUG] Material diffuse mapping: mapping=%d uvIndex=%u mapU=%d mapV=%d\n", (int)mapping, uvIndex, (int)mapModes[0], (int)mapModes[1]);
 
           // Check if it's an embedded texture (path starts with "*")
-          if (pathStr.length() > 0 && pathStr[0] == '*') {
-            int texIndex = std::stoi(pathStr.substr(1));
-            if (texIndex >= 0 && texIndex < static_cast<int>(scene->mNumTextures)) {
-              TextureData texData = loadEmbeddedTexture(scene->mTextures[texIndex]);
-              if (texData.pixels != nullptr) {
-                // Map Assimp wrap modes to our WrapMode enum
-                auto convertWrapMode = [](aiTextureMapMode mode) -> WrapMode {
-                  switch (mode) {
-                    case aiTextureMapMode_Wrap:   return WrapMode::Wrap;
-                    case aiTextureMapMode_Clamp:  return WrapMode::Clamp;
-                    case aiTextureMapMode_Mirror: return WrapMode::Mirror;
-                    case aiTextureMapMode_Decal:  return WrapMode::Decal;
-                    default:                      return WrapMode::Wrap;
-                  }
-                };
-
-                texData.wrapModeU = convertWrapMode(mapModes[0]);
-                texData.wrapModeV = convertWrapMode(mapModes[1]);
-
-                // Store texture data on material (GL texture will be created later by renderer)
-                std::get<BasicTextureMaterial>(m.material).texture_data = texData;
-
-                printf("Loaded embedded texture %d data (%dx%d, %d channels)\n",
-                       texIndex, texData.width, texData.height, texData.channels);
-              } else {
-                printf("Failed to load embedded texture %d\n", texIndex);
+          const std::optional<size_t> index = embeddedTextureIndex(pathStr, scene);
+          if (index.has_value() && textures.handles[index.value()].has_value()) {
+            // Map Assimp wrap modes to our WrapMode enum
+            auto convertWrapMode = [](aiTextureMapMode mode) -> WrapMode {
+              switch (mode) {
+                case aiTextureMapMode_Wrap:   return WrapMode::Wrap;
+                case aiTextureMapMode_Clamp:  return WrapMode::Clamp;
+                case aiTextureMapMode_Mirror: return WrapMode::Mirror;
+                case aiTextureMapMode_Decal:  return WrapMode::Decal;
+                default:                      return WrapMode::Wrap;
               }
-            }
+            };
+
+            // the pixels may still be decoding, the material only needs the handle
+            material.texture = textures.handles[index.value()].value();
+            material.wrap_u = convertWrapMode(mapModes[0]);
+            material.wrap_v = convertWrapMode(mapModes[1]);
           } else {
             // external textures could be handled here (not currently used for embedded glb)
           }
@@ -269,14 +453,17 @@ Mesh convertAiMesh(const aiMesh* aMesh, const aiScene* scene) {
       }
     }
 
+    processImportedMesh(m, aMesh->mName.C_Str(), options);
 
-    // material / id left default (populate if you have material mapping)
+    // only once nothing can throw, the mesh holds the material's user
+    m.material = materialTable().addMaterial(material);
     m.id = std::nullopt;
     return m;
   };
 
   // Recursive conversion aiNode -> SceneNode (nodes allocated on heap)
-SceneNode* convertNode(const aiNode* ai_node, SceneNode* parent, const aiScene * scene ) {
+SceneNode* convertNode(const aiNode* ai_node, SceneNode* parent, const aiScene * scene, const EmbeddedTextures& textures,
+                       const ImportOptions& options) {
   
     Mat4 local = mat4FromAiMatrix(ai_node->mTransformation);
     SceneNode* node = new SceneNode(createSceneNode(local, std::nullopt, std::string(ai_node->mName.C_Str())));
@@ -287,16 +474,34 @@ SceneNode* convertNode(const aiNode* ai_node, SceneNode* parent, const aiScene *
       parent->children.push_back(node);
     }
 
-    // If this aiNode references meshes, convert the first mesh and move it into the node.
-    if (ai_node->mNumMeshes > 0 && scene->mNumMeshes > 0) {
-      const aiMesh* aMesh = scene->mMeshes[ ai_node->mMeshes[0] ];
-      Mesh converted = convertAiMesh(aMesh, scene);
-      node->mesh.emplace(std::move(converted));
-    }
+    try {
+      // a single mesh goes into the node, several get a child each (they have their own materials)
+      if (ai_node->mNumMeshes == 1) {
+        const aiMesh* aMesh = scene->mMeshes[ ai_node->mMeshes[0] ];
+        Mesh converted = convertAiMesh(aMesh, scene, textures, options);
+        node->mesh.emplace(std::move(converted));
+      } else {
+        for (unsigned i = 0; i < ai_node->mNumMeshes; ++i) {
+          const aiMesh* aMesh = scene->mMeshes[ ai_node->mMeshes[i] ];
+          SceneNode* child = new SceneNode(createSceneNode(translation(0.f, 0.f, 0.f), std::nullopt,
+                                                           std::string(aMesh->mName.C_Str())));
+          // linked before converting, so a throw finds it in the tree
+          child->parent = node;
+          node->children.push_back(child);
+          child->mesh.emplace(convertAiMesh(aMesh, scene, textures, options));
+        }
+      }
 
-    // recurse children
-    for (unsigned i = 0; i < ai_node->mNumChildren; ++i) {
-      convertNode(ai_node->mChildren[i], node, scene);
+      // recurse children
+      for (unsigned i = 0; i < ai_node->mNumChildren; ++i) {
+        convertNode(ai_node->mChildren[i], node, scene, textures, options);
+      }
+    } catch (...) {
+      // everything converted so far hangs off the root, only it can give the tree back
+      if (!parent) {
+        deleteSceneTree(node);
+      }
+      throw;
     }
 
     // update transforms for subtree
@@ -306,8 +511,38 @@ SceneNode* convertNode(const aiNode* ai_node, SceneNode* parent, const aiScene *
   };
 
  
-SceneNode load_glb(const std::string& pFile) {
+SceneNode load_glb(const std::string& pFile, const ImportOptions& options) {
+
+  // a warm start maps the converted scene straight out of the cache
+  std::string cache_path;
+  uint64_t cache_key = 0;
+
+  if (options.use_asset_cache) {
+    MappedFile source;
+    if (source.open(pFile.c_str())) {
+      cache_key = assetCacheKey(source, options);
+      cache_path = assetCachePath(options.cache_directory, cache_key);
+
+      std::optional<SceneNode> cached = readAssetCache(cache_path, cache_key);
+      if (cached.has_value()) {
+        printf("Loaded %s from asset cache %s\n", pFile.c_str(), cache_path.c_str());
+        return std::move(cached.value());
+      }
+    }
+  }
  
+  // glb files are read natively unless they use something only assimp understands
+  if (options.native_glb && pFile.size() >= 4 && pFile.compare(pFile.size() - 4, 4, ".glb") == 0) {
+    std::optional<SceneNode> native = readGlb(pFile, options, textureDecodePool());
+    if (native.has_value()) {
+      SceneNode root = std::move(native.value());
+      if (!cache_path.empty() && !writeAssetCache(cache_path, root, cache_key)) {
+        printf("Failed to write asset cache %s\n", cache_path.c_str());
+      }
+      return root;
+    }
+  }
+
   // Create an instance of the Importer class
   Assimp::Importer importer;
 
@@ -328,10 +563,34 @@ SceneNode load_glb(const std::string& pFile) {
     throw error_message;
   }
   
+  // textures decode on their own workers while the geometry is converted on this thread
+  EmbeddedTextures textures = acquireEmbeddedTextures(scene, pFile, options.max_texture_size);
+
   // convert aiScene into SceneNode here
-  SceneNode* root_ptr = convertNode(scene->mRootNode, nullptr, scene);
-  // return a moved copy of the root (children remain pointers to heap nodes)
+  SceneNode* root_ptr = nullptr;
+  try {
+    root_ptr = convertNode(scene->mRootNode, nullptr, scene, textures, options);
+  } catch (...) {
+    finishEmbeddedTextures(textures);
+    throw;
+  }
+  finishEmbeddedTextures(textures);
+  // return a moved copy of the root (children remain pointers to heap nodes,
+  // updateWorldTransform on the returned root points them back at it)
   SceneNode root = std::move(*root_ptr);
+  delete root_ptr;
+
+  if (!cache_path.empty() && !writeAssetCache(cache_path, root, cache_key)) {
+    printf("Failed to write asset cache %s\n", cache_path.c_str());
+  }
+
   return root;
 
-}
\ No newline at end of file
+}
+
+std::future<SceneNode> load_glb_async(ThreadPool& pool, const std::string& pFile, const ImportOptions& options) {
+  // copies, the caller's strings may be gone by the time a worker gets to the job
+  return pool.submit([pFile, options]() {
+    return load_glb(pFile, options);
+  });
+}
@@ -0,0 +1,303 @@
+#include "material_table.h"
+
+#include <algorithm>
+
+#include "../third_party/stb_image.h"
+
+#include "asset_cache.h"
+#include "texture_mips.h"
+
+constexpr uint64_t MATERIAL_HASH_SEED = 0xcbf29ce484222325ull;
+
+static void freePixels(TextureData& data) {
+    if (data.needs_free && data.pixels != nullptr) {
+        stbi_image_free(data.pixels);
+    }
+    data.pixels = nullptr;
+    data.needs_free = false;
+}
+
+// field by field, the structs have padding
+static uint64_t materialHash(const Material& material) {
+    uint64_t hash = hashBytes(&MATERIAL_HASH_SEED, sizeof(uint64_t), material.index());
+    if (std::holds_alternative<BasicColorMaterial>(material)) {
+        const BasicColorMaterial& color = std::get<BasicColorMaterial>(material);
+        hash = hashBytes(color.color.data, sizeof(float) * 3, hash);
+        hash = hashBytes(color.specular_color.data, sizeof(float) * 3, hash);
+        hash = hashBytes(&color.shininess, sizeof(float), hash);
+    } else {
+        const BasicTextureMaterial& texture = std::get<BasicTextureMaterial>(material);
+        hash = hashBytes(&texture.texture, sizeof(TextureHandle), hash);
+        const uint32_t wrap[2] = { static_cast<uint32_t>(texture.wrap_u), static_cast<uint32_t>(texture.wrap_v) };
+        hash = hashBytes(wrap, sizeof(wrap), hash);
+        hash = hashBytes(&texture.shininess, sizeof(float), hash);
+    }
+    return hash;
+}
+
+static bool materialsAreEqual(const Material& a, const Material& b) {
+    if (a.index() != b.index()) {
+        return false;
+    }
+    if (std::holds_alternative<BasicColorMaterial>(a)) {
+        const BasicColorMaterial& x = std::get<BasicColorMaterial>(a);
+        const BasicColorMaterial& y = std::get<BasicColorMaterial>(b);
+        return memcmp(x.color.data, y.color.data, sizeof(float) * 3) == 0 &&
+               memcmp(x.specular_color.data, y.specular_color.data, sizeof(float) * 3) == 0 &&
+               x.shininess == y.shininess;
+    }
+    const BasicTextureMaterial& x = std::get<BasicTextureMaterial>(a);
+    const BasicTextureMaterial& y = std::get<BasicTextureMaterial>(b);
+    return x.texture == y.texture && x.wrap_u == y.wrap_u && x.wrap_v == y.wrap_v && x.shininess == y.shininess;
+}
+
+MaterialTable::~MaterialTable() {
+    // the GL ids go with the context, only the cpu pixels are ours to free
+    for (TextureEntry& texture : textures) {
+        freePixels(texture.data);
+    }
+}
+
+TextureHandle MaterialTable::acquireTexture(const std::string& source, const uint64_t content_hash, bool& created) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const TextureHandle* existing = textures_by_source.find(source);
+    if (existing == nullptr && content_hash != 0) {
+        existing = textures_by_content.find(content_hash);
+    }
+    if (existing != nullptr) {
+        const TextureHandle handle = *existing;
+        textures.get(handle)->users++;
+        created = false;
+        return handle;
+    }
+
+    const TextureHandle handle = textures.insert({
+        .source = source,
+        .content_hash = content_hash,
+        .state = TextureState::Loading,
+        .data = {},
+        .gpu = {},
+        .users = 1,
+        .trimmed_levels = 0,
+    });
+    textures_by_source.insert(source, handle);
+    if (content_hash != 0) {
+        textures_by_content.insert(content_hash, handle);
+    }
+    created = true;
+    return handle;
+}
+
+size_t MaterialTable::pixelBytesLocked() const {
+    size_t bytes = 0;
+    for (const TextureEntry& texture : textures) {
+        if (texture.data.pixels != nullptr) {
+            bytes += mipChainBytes(texture.data);
+        }
+    }
+    return bytes;
+}
+
+void MaterialTable::setTexturePixels(const TextureHandle texture, const TextureData& pixels) {
+
+    // how many levels to drop is decided under the lock, the copy that drops them happens outside it.
+    // two loaders doing this at once can overshoot the budget by a texture, that's fine
+    int drop = 0;
+    if (pixels.pixels != nullptr) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const size_t waiting = pixelBytesLocked();
+        const size_t chain = mipChainBytes(pixels);
+        while (pixel_budget > 0 && drop < pixels.levels - 1 &&
+               std::max(mipExtent(pixels.width, drop), mipExtent(pixels.height, drop)) > MIN_TRIMMED_SIZE &&
+               waiting + chain - mipLevelOffset(pixels.width, pixels.height, pixels.channels, drop) > pixel_budget) {
+            drop++;
+        }
+    }
+    TextureData stored = dropTopMips(pixels, drop);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    TextureEntry* entry = textures.get(texture);
+    if (entry == nullptr || entry->state != TextureState::Loading) {
+        freePixels(stored);
+        return;
+    }
+    entry->data = stored;
+    entry->trimmed_levels = drop;
+    entry->state = stored.pixels != nullptr ? TextureState::Decoded : TextureState::Failed;
+}
+
+void MaterialTable::setPixelBudget(const size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pixel_budget = bytes;
+}
+
+void MaterialTable::releaseTextureLocked(const TextureHandle texture) {
+
+    TextureEntry* entry = textures.get(texture);
+    if (entry == nullptr || --entry->users > 0) {
+        return;
+    }
+
+    freePixels(entry->data);
+    if (entry->gpu.array != 0) {
+        released_layers.push_back(entry->gpu);
+    }
+    // a newer texture can have taken over the keys, only drop them if they are still ours
+    const TextureHandle* by_source = textures_by_source.find(entry->source);
+    if (by_source != nullptr && *by_source == texture) {
+        textures_by_source.erase(entry->source);
+    }
+    const TextureHandle* by_content = textures_by_content.find(entry->content_hash);
+    if (by_content != nullptr && *by_content == texture) {
+        textures_by_content.erase(entry->content_hash);
+    }
+    textures.erase(texture);
+}
+
+void MaterialTable::releaseTexture(const TextureHandle texture) {
+    std::lock_guard<std::mutex> lock(mutex);
+    releaseTextureLocked(texture);
+}
+
+MaterialHandle MaterialTable::addMaterial(const Material& material) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const uint64_t hash = materialHash(material);
+    const MaterialHandle* existing = materials_by_hash.find(hash);
+    if (existing != nullptr) {
+        MaterialEntry* entry = materials.get(*existing);
+        if (materialsAreEqual(entry->material, material)) {
+            entry->users++;
+            return *existing;
+        }
+        // a collision just means the material isn't shared
+    }
+
+    if (std::holds_alternative<BasicTextureMaterial>(material)) {
+        TextureEntry* texture = textures.get(std::get<BasicTextureMaterial>(material).texture);
+        if (texture != nullptr) {
+            texture->users++;
+        }
+    }
+
+    const MaterialHandle handle = materials.insert({ .material = material, .hash = hash, .users = 1 });
+    if (existing == nullptr) {
+        materials_by_hash.insert(hash, handle);
+    }
+    return handle;
+}
+
+MaterialHandle MaterialTable::retainMaterial(const MaterialHandle material) {
+    std::lock_guard<std::mutex> lock(mutex);
+    MaterialEntry* entry = materials.get(material);
+    if (entry != nullptr) {
+        entry->users++;
+    }
+    return material;
+}
+
+void MaterialTable::releaseMaterial(const MaterialHandle material) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    MaterialEntry* entry = materials.get(material);
+    if (entry == nullptr || --entry->users > 0) {
+        return;
+    }
+
+    if (std::holds_alternative<BasicTextureMaterial>(entry->material)) {
+        releaseTextureLocked(std::get<BasicTextureMaterial>(entry->material).texture);
+    }
+    const MaterialHandle* by_hash = materials_by_hash.find(entry->hash);
+    if (by_hash != nullptr && *by_hash == material) {
+        materials_by_hash.erase(entry->hash);
+    }
+    materials.erase(material);
+}
+
+std::optional<Material> MaterialTable::material(const MaterialHandle material) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const MaterialEntry* entry = materials.get(material);
+    if (entry == nullptr) {
+        return std::nullopt;
+    }
+    return entry->material;
+}
+
+std::optional<TextureEntry> MaterialTable::texture(const TextureHandle texture) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const TextureEntry* entry = textures.get(texture);
+    if (entry == nullptr) {
+        return std::nullopt;
+    }
+    TextureEntry copy = *entry;
+    copy.data.pixels = nullptr;
+    copy.data.needs_free = false;
+    return copy;
+}
+
+std::optional<TextureData> MaterialTable::pixelsToUpload(const TextureHandle texture) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const TextureEntry* entry = textures.get(texture);
+    if (entry == nullptr || entry->state != TextureState::Decoded) {
+        return std::nullopt;
+    }
+    return entry->data;
+}
+
+void MaterialTable::textureUploaded(const TextureHandle texture, const TextureLayer layer) {
+    std::lock_guard<std::mutex> lock(mutex);
+    TextureEntry* entry = textures.get(texture);
+    if (entry == nullptr) {
+        released_layers.push_back(layer);
+        return;
+    }
+    freePixels(entry->data);
+    entry->gpu = layer;
+    entry->state = TextureState::Uploaded;
+}
+
+bool MaterialTable::textureMoved(const TextureLayer from, const TextureLayer to) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // moves are rare, a scan beats keeping an index by layer up to date
+    for (TextureEntry& texture : textures) {
+        if (texture.state == TextureState::Uploaded && texture.gpu.array == from.array && texture.gpu.layer == from.layer) {
+            texture.gpu = to;
+            return true;
+        }
+    }
+    return false;
+}
+
+DArray<TextureLayer> MaterialTable::takeReleasedTextureLayers() {
+    std::lock_guard<std::mutex> lock(mutex);
+    DArray<TextureLayer> layers = std::move(released_layers);
+    released_layers = DArray<TextureLayer>();
+    return layers;
+}
+
+MaterialTableStats MaterialTable::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    MaterialTableStats stats = {
+        .materials = materials.size(),
+        .textures = textures.size(),
+        .uploaded_textures = 0,
+        .pixel_bytes = pixelBytesLocked(),
+        .pixel_budget = pixel_budget,
+        .trimmed_textures = 0,
+    };
+    for (const TextureEntry& texture : textures) {
+        stats.uploaded_textures += texture.state == TextureState::Uploaded;
+        stats.trimmed_textures += texture.trimmed_levels > 0;
+    }
+    return stats;
+}
+
+MaterialTable& materialTable() {
+    static MaterialTable table;
+    return table;
+}
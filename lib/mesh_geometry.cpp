@@ -0,0 +1,240 @@
+#include "mesh_geometry.h"
+
+#include <math.h>
+#include <string.h>
+
+// four floats in one register, gcc and clang turn the arithmetic into SSE2 or NEON. lane 3 is always 0
+typedef float Float4 __attribute__((vector_size(16)));
+
+constexpr size_t TRIANGLES_PER_RANGE = 16 * 1024;
+constexpr size_t VERTICES_PER_RANGE = 16 * 1024;
+
+// per triangle records, 4 floats each so a corner's contribution is one load
+constexpr size_t FACE_STRIDE = 4;
+
+static inline Float4 load3(const float* p) {
+    return (Float4){ p[0], p[1], p[2], 0.f };
+}
+
+static inline Float4 load4(const float* p) {
+    Float4 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store4(float* p, const Float4 v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+static inline float dot3(const Float4 a, const Float4 b) {
+    const Float4 products = a * b;
+    return products[0] + products[1] + products[2];
+}
+
+static inline Float4 cross3(const Float4 a, const Float4 b) {
+    return (Float4){ a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0], 0.f };
+}
+
+// v scaled to unit length, or zero if it has none
+static inline Float4 normalized3(const Float4 v) {
+    const float length = sqrtf(dot3(v, v));
+    return length > 0.f ? v / length : (Float4){ 0.f, 0.f, 0.f, 0.f };
+}
+
+static inline float angleBetween(const Float4 a, const Float4 b) {
+    const float cosine = dot3(a, b);
+    return acosf(cosine < -1.f ? -1.f : (cosine > 1.f ? 1.f : cosine));
+}
+
+// the angle at each corner, a, b, c in lanes 0 to 2
+static inline Float4 cornerAngles(const Float4 a, const Float4 b, const Float4 c) {
+    const Float4 ab = normalized3(b - a);
+    const Float4 bc = normalized3(c - b);
+    const Float4 ca = normalized3(a - c);
+    return (Float4){ angleBetween(ab, -ca), angleBetween(bc, -ab), angleBetween(ca, -bc), 0.f };
+}
+
+VertexCorners vertexCorners(const unsigned int* indices, const size_t index_count, const size_t vertex_count) {
+
+    VertexCorners result;
+    result.offsets = DArray<uint32_t>(vertex_count + 1, 0);
+    uint32_t* offsets = result.offsets.begin();
+
+    // counting sort by vertex, stable, so each vertex lists its corners in index buffer order
+    for (size_t i = 0; i < index_count; i++) {
+        offsets[indices[i] + 1]++;
+    }
+    for (size_t v = 0; v < vertex_count; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+
+    DArray<uint32_t> next(offsets, vertex_count);
+    uint32_t* corners = result.corners.extend(index_count);
+    for (size_t i = 0; i < index_count; i++) {
+        corners[next[indices[i]]++] = static_cast<uint32_t>(i);
+    }
+    return result;
+}
+
+static void generateNormals(Vertices& vertices, const VertexCorners& corners, const NormalWeighting weighting,
+                            ThreadPool& pool) {
+
+    const size_t vertex_count = vertices.vertex_count;
+    const size_t triangle_count = vertices.index_count / 3;
+    const unsigned int* indices = vertices.indices.begin();
+    const float* positions = vertices.positions.begin();
+
+    // the unit face normal and what each corner weighs
+    DArray<float> face_normals(triangle_count * FACE_STRIDE, 0.f);
+    DArray<float> face_weights(triangle_count * FACE_STRIDE, 0.f);
+
+    parallelFor(pool, triangle_count, TRIANGLES_PER_RANGE, [&](const size_t begin, const size_t end) {
+        for (size_t t = begin; t < end; t++) {
+            const Float4 a = load3(positions + indices[t * 3] * 3);
+            const Float4 b = load3(positions + indices[t * 3 + 1] * 3);
+            const Float4 c = load3(positions + indices[t * 3 + 2] * 3);
+
+            const Float4 normal = cross3(b - a, c - a);
+            const float double_area = sqrtf(dot3(normal, normal));
+            if (double_area == 0.f) {
+                continue; // degenerate, stays zero and adds nothing
+            }
+            store4(face_normals.addr(t * FACE_STRIDE), normal / double_area);
+
+            const float area = double_area * 0.5f;
+            store4(face_weights.addr(t * FACE_STRIDE),
+                   weighting == NormalWeighting::Area ? (Float4){ area, area, area, 0.f } : cornerAngles(a, b, c));
+        }
+    });
+
+    DArray<float> normals(vertex_count * 3, 0.f);
+    parallelFor(pool, vertex_count, VERTICES_PER_RANGE, [&](const size_t begin, const size_t end) {
+        for (size_t v = begin; v < end; v++) {
+            Float4 sum = { 0.f, 0.f, 0.f, 0.f };
+            for (uint32_t k = corners.offsets[v]; k < corners.offsets[v + 1]; k++) {
+                const uint32_t corner = corners.corners[k];
+                const size_t face = (corner / 3) * FACE_STRIDE;
+                sum += load4(face_normals.addr(face)) * face_weights[face + corner % 3];
+            }
+
+            Float4 normal = normalized3(sum);
+            if (dot3(normal, normal) == 0.f) {
+                normal = (Float4){ 0.f, 1.f, 0.f, 0.f };
+            }
+            normals[v * 3] = normal[0];
+            normals[v * 3 + 1] = normal[1];
+            normals[v * 3 + 2] = normal[2];
+        }
+    });
+
+    vertices.normals = std::move(normals);
+}
+
+static void generateTangents(Vertices& vertices, const VertexCorners& corners, ThreadPool& pool) {
+
+    const size_t vertex_count = vertices.vertex_count;
+    const size_t triangle_count = vertices.index_count / 3;
+    const unsigned int* indices = vertices.indices.begin();
+    const float* positions = vertices.positions.begin();
+    const float* normals = vertices.normals.begin();
+    const float* uvs = vertices.uvs.begin();
+
+    // the face's u and v directions, unnormalized, and its corner angles
+    DArray<float> face_tangents(triangle_count * FACE_STRIDE, 0.f);
+    DArray<float> face_bitangents(triangle_count * FACE_STRIDE, 0.f);
+    DArray<float> face_angles(triangle_count * FACE_STRIDE, 0.f);
+
+    parallelFor(pool, triangle_count, TRIANGLES_PER_RANGE, [&](const size_t begin, const size_t end) {
+        for (size_t t = begin; t < end; t++) {
+            const unsigned int ia = indices[t * 3], ib = indices[t * 3 + 1], ic = indices[t * 3 + 2];
+            const Float4 a = load3(positions + ia * 3);
+            const Float4 b = load3(positions + ib * 3);
+            const Float4 c = load3(positions + ic * 3);
+
+            const float du1 = uvs[ib * 2] - uvs[ia * 2], dv1 = uvs[ib * 2 + 1] - uvs[ia * 2 + 1];
+            const float du2 = uvs[ic * 2] - uvs[ia * 2], dv2 = uvs[ic * 2 + 1] - uvs[ia * 2 + 1];
+            const float determinant = du1 * dv2 - du2 * dv1;
+            if (fabsf(determinant) < 1e-20f) {
+                continue; // no uv area, no direction to take
+            }
+
+            // solve edge = du * tangent + dv * bitangent for both edges
+            const float r = 1.f / determinant;
+            const Float4 edge1 = b - a;
+            const Float4 edge2 = c - a;
+            store4(face_tangents.addr(t * FACE_STRIDE), (edge1 * dv2 - edge2 * dv1) * r);
+            store4(face_bitangents.addr(t * FACE_STRIDE), (edge2 * du1 - edge1 * du2) * r);
+            store4(face_angles.addr(t * FACE_STRIDE), cornerAngles(a, b, c));
+        }
+    });
+
+    DArray<float> tangents(vertex_count * 4, 0.f);
+    parallelFor(pool, vertex_count, VERTICES_PER_RANGE, [&](const size_t begin, const size_t end) {
+        for (size_t v = begin; v < end; v++) {
+            const Float4 normal = load3(normals + v * 3);
+
+            // like MikkTSpace: each face's tangent projected into the vertex's tangent plane, made unit
+            // length and weighted by the corner angle
+            Float4 tangent_sum = { 0.f, 0.f, 0.f, 0.f };
+            Float4 bitangent_sum = { 0.f, 0.f, 0.f, 0.f };
+            for (uint32_t k = corners.offsets[v]; k < corners.offsets[v + 1]; k++) {
+                const uint32_t corner = corners.corners[k];
+                const size_t face = (corner / 3) * FACE_STRIDE;
+                const float angle = face_angles[face + corner % 3];
+                const Float4 face_tangent = load4(face_tangents.addr(face));
+                tangent_sum += normalized3(face_tangent - normal * dot3(normal, face_tangent)) * angle;
+                bitangent_sum += load4(face_bitangents.addr(face)) * angle;
+            }
+
+            Float4 tangent = normalized3(tangent_sum - normal * dot3(normal, tangent_sum));
+            if (dot3(tangent, tangent) == 0.f) {
+                // no uv direction at all, anything in the tangent plane
+                const Float4 axis = fabsf(normal[0]) < 0.9f ? (Float4){ 1.f, 0.f, 0.f, 0.f } : (Float4){ 0.f, 1.f, 0.f, 0.f };
+                tangent = normalized3(axis - normal * dot3(normal, axis));
+            }
+            tangents[v * 4] = tangent[0];
+            tangents[v * 4 + 1] = tangent[1];
+            tangents[v * 4 + 2] = tangent[2];
+            tangents[v * 4 + 3] = dot3(cross3(normal, tangent), bitangent_sum) < 0.f ? -1.f : 1.f;
+        }
+    });
+
+    vertices.tangents = std::move(tangents);
+}
+
+void generateNormals(Vertices& vertices, const NormalWeighting weighting, ThreadPool& pool) {
+    const VertexCorners corners = vertexCorners(vertices.indices.begin(), vertices.index_count, vertices.vertex_count);
+    generateNormals(vertices, corners, weighting, pool);
+}
+
+void generateTangents(Vertices& vertices, ThreadPool& pool) {
+    const VertexCorners corners = vertexCorners(vertices.indices.begin(), vertices.index_count, vertices.vertex_count);
+    generateTangents(vertices, corners, pool);
+}
+
+void generateMissingVertexData(Mesh& mesh, const NormalWeighting weighting, const bool generate_tangents,
+                               ThreadPool& pool) {
+
+    Vertices& vertices = mesh.vertices;
+    const size_t vertex_count = vertices.vertex_count;
+    if (vertices.compressed.has_value() || vertices.index_count < 3 || vertices.index_count % 3 != 0 ||
+        vertices.positions.size() < vertex_count * 3) {
+        return;
+    }
+
+    const bool needs_normals = vertices.normals.size() < vertex_count * 3;
+    const bool needs_tangents = generate_tangents && vertices.uvs.size() >= vertex_count * 2 &&
+                                vertices.tangents.size() < vertex_count * 4;
+    if (!needs_normals && !needs_tangents) {
+        return;
+    }
+
+    // both passes walk the same corner lists
+    const VertexCorners corners = vertexCorners(vertices.indices.begin(), vertices.index_count, vertex_count);
+    if (needs_normals) {
+        generateNormals(vertices, corners, weighting, pool);
+    }
+    if (needs_tangents) {
+        generateTangents(vertices, corners, pool);
+    }
+}
@@ -0,0 +1,43 @@
+#include "mesh_import.h"
+
+#include <stdio.h>
+
+#include "mesh_geometry.h"
+#include "mesh_optimizer.h"
+#include "thread_pool.h"
+#include "vertex_compression.h"
+
+// meshes are imported on the caller's pool (load_glb_async fills it with scenes), so the chunks go to
+// a pool of their own whose jobs never wait on anything
+static ThreadPool& geometryPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void processImportedMesh(Mesh& mesh, const std::string& name, const ImportOptions& options) {
+
+    // first, everything after it permutes or compresses the streams these are built from. Tangents
+    // need normals, without generate_normals only meshes that came with them get tangents
+    const bool has_normals = mesh.vertices.normals.size() >= mesh.vertices.vertex_count * 3;
+    if (options.generate_normals || has_normals) {
+        generateMissingVertexData(mesh, options.normal_weighting, options.generate_tangents, geometryPool());
+    }
+
+    // has to run before compression, it permutes the float streams
+    if (options.optimize_mesh) {
+        const MeshOptimizationReport report = optimizeMesh(mesh, options.optimize_overdraw);
+        if (report.before.acmr > 0.f) {
+            printf("%s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", name.c_str(),
+                   report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr);
+        }
+    }
+
+    // after the vertex fetch reorder (lods share the vertices) and before compression (needs float positions)
+    if (options.generate_lods) {
+        generateMeshLods(mesh, options.max_lods);
+    }
+
+    if (options.compress_vertices) {
+        compressVertices(mesh, options.normal_encoding);
+    }
+}
@@ -0,0 +1,453 @@
+#include "mesh_lod.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <stdint.h>
+
+#include "mesh_optimizer.h"
+#include "affine.h"
+#include "mystl.hpp"
+
+using namespace mym;
+
+constexpr unsigned int NO_COLLAPSE = ~0u;
+
+// symmetric 4x4 plane quadric, Garland & Heckbert "Surface Simplification Using Quadric Error Metrics".
+// planes are area weighted, dividing by weight turns the error back into a squared distance
+typedef struct Quadric {
+    double a2, ab, ac, ad;
+    double b2, bc, bd;
+    double c2, cd;
+    double d2;
+    double weight;
+} Quadric;
+
+static Quadric planeQuadric(const double a, const double b, const double c, const double d, const double weight) {
+    return {
+        a * a * weight, a * b * weight, a * c * weight, a * d * weight,
+        b * b * weight, b * c * weight, b * d * weight,
+        c * c * weight, c * d * weight,
+        d * d * weight,
+        weight,
+    };
+}
+
+static void addQuadric(Quadric& q, const Quadric& other) {
+    q.a2 += other.a2; q.ab += other.ab; q.ac += other.ac; q.ad += other.ad;
+    q.b2 += other.b2; q.bc += other.bc; q.bd += other.bd;
+    q.c2 += other.c2; q.cd += other.cd;
+    q.d2 += other.d2;
+    q.weight += other.weight;
+}
+
+// squared distance of p from the planes in q
+static double quadricError(const Quadric& q, const float* p) {
+    const double x = p[0], y = p[1], z = p[2];
+
+    const double error =
+        q.a2 * x * x + 2.0 * q.ab * x * y + 2.0 * q.ac * x * z + 2.0 * q.ad * x +
+        q.b2 * y * y + 2.0 * q.bc * y * z + 2.0 * q.bd * y +
+        q.c2 * z * z + 2.0 * q.cd * z +
+        q.d2;
+
+    return q.weight > 0.0 ? fabs(error) / q.weight : 0.0;
+}
+
+static void triangleNormal(const float* a, const float* b, const float* c, double* normal) {
+    const double e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    const double e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+    normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+// locks every vertex whose position is shared with another vertex (uv/normal seams) and every vertex on an
+// open edge, edges are compared by position so seams don't count as open
+static DArray<bool> lockedVertices(const unsigned int* indices, const size_t index_count,
+                                   const float* positions, const size_t vertex_count) {
+
+    DArray<bool> locked(vertex_count, false);
+
+    DArray<unsigned int> by_position(vertex_count, 0);
+    for (size_t v = 0; v < vertex_count; v++) {
+        by_position[v] = static_cast<unsigned int>(v);
+    }
+    std::sort(by_position.begin(), by_position.end(), [positions](const unsigned int a, const unsigned int b) {
+        return memcmp(&positions[a * 3], &positions[b * 3], sizeof(float) * 3) < 0;
+    });
+
+    // first vertex with the same position, used as the position id
+    DArray<unsigned int> welded(vertex_count, 0);
+    for (size_t i = 0; i < vertex_count; i++) {
+        const unsigned int v = by_position[i];
+        welded[v] = v;
+
+        if (i > 0 && memcmp(&positions[v * 3], &positions[by_position[i - 1] * 3], sizeof(float) * 3) == 0) {
+            welded[v] = welded[by_position[i - 1]];
+            locked[v] = true;
+            locked[by_position[i - 1]] = true;
+        }
+    }
+
+    // undirected edges between position ids, an edge only one triangle uses is a border
+    DArray<uint64_t> edges;
+    for (size_t t = 0; t + 2 < index_count; t += 3) {
+        for (size_t k = 0; k < 3; k++) {
+            const uint64_t a = welded[indices[t + k]];
+            const uint64_t b = welded[indices[t + (k + 1) % 3]];
+            edges.push_back(a < b ? (a << 32) | b : (b << 32) | a);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    // a border edge's endpoints are position ids, lock every vertex at those positions
+    DArray<bool> border_position(vertex_count, false);
+    for (size_t i = 0; i < edges.size();) {
+        size_t run = 1;
+        while (i + run < edges.size() && edges[i + run] == edges[i]) {
+            run++;
+        }
+        if (run == 1) {
+            border_position[edges[i] >> 32] = true;
+            border_position[edges[i] & 0xffffffff] = true;
+        }
+        i += run;
+    }
+
+    for (size_t v = 0; v < vertex_count; v++) {
+        if (border_position[welded[v]]) {
+            locked[v] = true;
+        }
+    }
+
+    return locked;
+}
+
+// would moving `from` onto `to` flip or squash any triangle around `from`
+static bool collapseFlips(
+    const unsigned int* indices,
+    const unsigned int* adjacency,
+    const unsigned int* offsets,
+    const float* positions,
+    const unsigned int from,
+    const unsigned int to
+) {
+    for (unsigned int j = offsets[from]; j < offsets[from + 1]; j++) {
+        const unsigned int* tri = &indices[adjacency[j] * 3];
+
+        // triangles on the edge itself disappear
+        if (tri[0] == to || tri[1] == to || tri[2] == to) {
+            continue;
+        }
+
+        const float* corners[3];
+        const float* moved[3];
+        for (size_t k = 0; k < 3; k++) {
+            corners[k] = &positions[tri[k] * 3];
+            moved[k] = &positions[(tri[k] == from ? to : tri[k]) * 3];
+        }
+
+        double before[3], after[3];
+        triangleNormal(corners[0], corners[1], corners[2], before);
+        triangleNormal(moved[0], moved[1], moved[2], after);
+
+        const double d = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+        const double before_length = sqrt(before[0] * before[0] + before[1] * before[1] + before[2] * before[2]);
+        const double after_length = sqrt(after[0] * after[0] + after[1] * after[1] + after[2] * after[2]);
+
+        // anything turning more than ~75 degrees is as good as a flip
+        if (d < 0.25 * before_length * after_length) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t simplifyIndices(
+    const unsigned int* indices,
+    const size_t index_count,
+    const float* positions,
+    const size_t vertex_count,
+    const size_t target_index_count,
+    const float target_error,
+    unsigned int* destination,
+    float* result_error
+) {
+    size_t count = index_count - index_count % 3;
+    memcpy(destination, indices, sizeof(unsigned int) * count);
+    *result_error = 0.f;
+
+    if (count <= target_index_count || vertex_count == 0) {
+        return count;
+    }
+
+    const DArray<bool> locked = lockedVertices(destination, count, positions, vertex_count);
+
+    DArray<Quadric> quadrics(vertex_count, Quadric{});
+    for (size_t t = 0; t < count; t += 3) {
+        const unsigned int* tri = &destination[t];
+        double normal[3];
+        triangleNormal(&positions[tri[0] * 3], &positions[tri[1] * 3], &positions[tri[2] * 3], normal);
+
+        const double length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (length == 0.0) {
+            continue;
+        }
+
+        const double a = normal[0] / length, b = normal[1] / length, c = normal[2] / length;
+        const float* p = &positions[tri[0] * 3];
+        const Quadric q = planeQuadric(a, b, c, -(a * p[0] + b * p[1] + c * p[2]), length * 0.5);
+
+        for (size_t k = 0; k < 3; k++) {
+            addQuadric(quadrics[tri[k]], q);
+        }
+    }
+
+    const double max_error = static_cast<double>(target_error) * target_error;
+    double reached_error = 0.0;
+
+    DArray<unsigned int> offsets(vertex_count + 1, 0);
+    DArray<unsigned int> adjacency(count, 0);
+    DArray<unsigned int> fill(vertex_count, 0);
+    DArray<unsigned int> best_target(vertex_count, NO_COLLAPSE);
+    DArray<double> best_cost(vertex_count, 0.0);
+    DArray<unsigned int> collapse(vertex_count, NO_COLLAPSE);
+    DArray<bool> touched(vertex_count, false);
+    DArray<unsigned int> candidates;
+
+    // each pass collapses a batch of independent edges, cheapest first, then rebuilds the adjacency
+    while (count > target_index_count) {
+
+        memset(offsets.begin(), 0, sizeof(unsigned int) * (vertex_count + 1));
+        memset(fill.begin(), 0, sizeof(unsigned int) * vertex_count);
+        for (size_t i = 0; i < count; i++) {
+            offsets[destination[i] + 1]++;
+        }
+        for (size_t v = 0; v < vertex_count; v++) {
+            offsets[v + 1] += offsets[v];
+        }
+        for (size_t i = 0; i < count; i++) {
+            const unsigned int v = destination[i];
+            adjacency[offsets[v] + fill[v]++] = static_cast<unsigned int>(i / 3);
+        }
+
+        // cheapest edge out of every unlocked vertex
+        for (size_t v = 0; v < vertex_count; v++) {
+            best_target[v] = NO_COLLAPSE;
+            collapse[v] = NO_COLLAPSE;
+            touched[v] = false;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            const unsigned int from = destination[i];
+            if (locked[from]) {
+                continue;
+            }
+
+            const size_t first = i - i % 3;
+            for (size_t k = 1; k < 3; k++) {
+                const unsigned int to = destination[first + (i % 3 + k) % 3];
+
+                Quadric q = quadrics[from];
+                addQuadric(q, quadrics[to]);
+                const double cost = quadricError(q, &positions[to * 3]);
+
+                if (best_target[from] == NO_COLLAPSE || cost < best_cost[from]) {
+                    best_target[from] = to;
+                    best_cost[from] = cost;
+                }
+            }
+        }
+
+        candidates = DArray<unsigned int>();
+        for (size_t v = 0; v < vertex_count; v++) {
+            if (best_target[v] != NO_COLLAPSE && best_cost[v] <= max_error) {
+                candidates.push_back(static_cast<unsigned int>(v));
+            }
+        }
+        if (candidates.size() == 0) {
+            break;
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [&best_cost](const unsigned int a, const unsigned int b) {
+            return best_cost[a] < best_cost[b];
+        });
+
+        // every collapse takes roughly two triangles with it
+        const size_t triangles_to_remove = (count - target_index_count) / 3;
+        size_t collapsed = 0;
+
+        for (const unsigned int from : candidates) {
+            if (collapsed * 2 >= triangles_to_remove) {
+                break;
+            }
+
+            const unsigned int to = best_target[from];
+            if (touched[from] || touched[to]) {
+                continue;
+            }
+
+            if (collapseFlips(destination, adjacency.begin(), offsets.begin(), positions, from, to)) {
+                continue;
+            }
+
+            collapse[from] = to;
+            addQuadric(quadrics[to], quadrics[from]);
+            reached_error = std::max(reached_error, best_cost[from]);
+            collapsed++;
+
+            // everything around `from` changes shape, leave it alone until the next pass
+            for (unsigned int j = offsets[from]; j < offsets[from + 1]; j++) {
+                const unsigned int* tri = &destination[adjacency[j] * 3];
+                touched[tri[0]] = true;
+                touched[tri[1]] = true;
+                touched[tri[2]] = true;
+            }
+        }
+
+        if (collapsed == 0) {
+            break;
+        }
+
+        // apply the collapses and drop the triangles that became degenerate
+        size_t write = 0;
+        for (size_t t = 0; t < count; t += 3) {
+            unsigned int tri[3];
+            for (size_t k = 0; k < 3; k++) {
+                const unsigned int v = destination[t + k];
+                tri[k] = collapse[v] == NO_COLLAPSE ? v : collapse[v];
+            }
+
+            if (tri[0] != tri[1] && tri[1] != tri[2] && tri[0] != tri[2]) {
+                destination[write++] = tri[0];
+                destination[write++] = tri[1];
+                destination[write++] = tri[2];
+            }
+        }
+        count = write;
+    }
+
+    *result_error = static_cast<float>(sqrt(reached_error));
+    return count;
+}
+
+void generateMeshLods(Mesh& mesh, const size_t max_lods) {
+
+    const Vertices& vertices = mesh.vertices;
+    mesh.lod.levels = DArray<MeshLod>();
+
+    if (vertices.index_count < 3 || vertices.compressed.has_value() ||
+        vertices.positions.size() < vertices.vertex_count * 3) {
+        return;
+    }
+
+    // bounding sphere around the box center, good enough to measure distance against
+    Vec3 min = { vertices.positions[0], vertices.positions[1], vertices.positions[2] };
+    Vec3 max = min;
+    for (size_t v = 0; v < vertices.vertex_count; v++) {
+        for (size_t axis = 0; axis < 3; axis++) {
+            min.data[axis] = std::min(min.data[axis], vertices.positions[v * 3 + axis]);
+            max.data[axis] = std::max(max.data[axis], vertices.positions[v * 3 + axis]);
+        }
+    }
+
+    mesh.lod.center = scaleVector(addVectors(min, max), 0.5f);
+    mesh.lod.radius = 0.f;
+    for (size_t v = 0; v < vertices.vertex_count; v++) {
+        const Vec3 p = { vertices.positions[v * 3], vertices.positions[v * 3 + 1], vertices.positions[v * 3 + 2] };
+        mesh.lod.radius = std::max(mesh.lod.radius, length(subtractVectors(p, mesh.lod.center)));
+    }
+
+    // past a quarter of the radius the level is only ever picked when the mesh is a few pixels tall
+    const float target_error = mesh.lod.radius * 0.25f;
+
+    const unsigned int* source = vertices.indices.begin();
+    size_t source_count = vertices.index_count;
+    float error = 0.f;
+
+    for (size_t level = 0; level < max_lods; level++) {
+
+        DArray<unsigned int> indices(source_count, 0);
+        float level_error = 0.f;
+        const size_t target = (source_count / 6) * 3;
+        const size_t count = simplifyIndices(source, source_count, vertices.positions.begin(), vertices.vertex_count,
+                                             target, target_error, indices.begin(), &level_error);
+
+        if (count == 0 || count > source_count - source_count / 10) {
+            break;
+        }
+
+        // each level is simplified from the last one, so the errors stack
+        error += level_error;
+
+        DArray<unsigned int> trimmed(count, 0);
+        memcpy(trimmed.begin(), indices.begin(), sizeof(unsigned int) * count);
+        optimizeVertexCache(trimmed.begin(), count, vertices.vertex_count);
+
+        mesh.lod.levels.push_back({
+            .indices = std::move(trimmed),
+            .index_count = count,
+            .error = error,
+            .first_index = 0,
+        });
+
+        const MeshLod& last = mesh.lod.levels[mesh.lod.levels.size() - 1];
+        source = last.indices.begin();
+        source_count = last.index_count;
+    }
+}
+
+LodSelection lodSelection(const Vec3 camera_position, const float field_of_view_radians,
+                          const size_t viewport_height, const float max_pixel_error) {
+    return {
+        .camera_position = camera_position,
+        .projection_scale = static_cast<float>(viewport_height) / (2.f * tanf(field_of_view_radians * 0.5f)),
+        .max_pixel_error = max_pixel_error,
+    };
+}
+
+size_t selectMeshLod(const Mesh& mesh, const Affine& world_transform, const LodSelection& selection) {
+
+    const size_t level_count = mesh.lod.levels.size();
+    if (level_count == 0 || selection.max_pixel_error <= 0.f) {
+        return 0;
+    }
+
+    // largest axis scale, rows are the basis vectors
+    float scale = 0.f;
+    for (size_t row = 0; row < 3; row++) {
+        const Vec3 axis = { world_transform.data[row][0], world_transform.data[row][1], world_transform.data[row][2] };
+        scale = std::max(scale, length(axis));
+    }
+
+    const Vec3 center = positionMultiplied(mesh.lod.center, world_transform);
+    const float distance = length(subtractVectors(center, selection.camera_position)) - mesh.lod.radius * scale;
+
+    if (distance <= 0.f) {
+        return 0;
+    }
+
+    const float pixels_per_unit = scale * selection.projection_scale / distance;
+
+    for (size_t lod = level_count; lod > 0; lod--) {
+        if (mesh.lod.levels[lod - 1].error * pixels_per_unit <= selection.max_pixel_error) {
+            return lod;
+        }
+    }
+
+    return 0;
+}
+
+size_t lodIndexCount(const Mesh& mesh, const size_t lod) {
+    return lod == 0 ? mesh.vertices.index_count : mesh.lod.levels[lod - 1].index_count;
+}
+
+size_t totalIndexCount(const Mesh& mesh) {
+    size_t total = mesh.vertices.index_count;
+    for (const auto& level : mesh.lod.levels) {
+        total += level.index_count;
+    }
+    return total;
+}
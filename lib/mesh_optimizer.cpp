@@ -0,0 +1,398 @@
+#include "mesh_optimizer.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#include "mystl.hpp"
+
+constexpr unsigned int UNUSED = ~0u;
+
+VertexCacheStats analyzeVertexCache(
+    const unsigned int* indices,
+    const size_t index_count,
+    const size_t vertex_count,
+    const size_t cache_size
+) {
+    VertexCacheStats stats = { 0.f, 0.f };
+    if (index_count < 3 || vertex_count == 0) {
+        return stats;
+    }
+
+    // FIFO cache, each vertex remembers when it was last pushed
+    DArray<size_t> pushed_at(vertex_count, 0);
+    DArray<bool> referenced(vertex_count, false);
+    size_t* pushed = pushed_at.begin();
+    size_t misses = 0;
+    size_t unique = 0;
+
+    for (size_t i = 0; i < index_count; i++) {
+        const unsigned int v = indices[i];
+
+        if (!referenced[v]) {
+            referenced[v] = true;
+            unique++;
+        }
+
+        // pushed_at is 1 based so 0 means never, a vertex is a hit if fewer than cache_size pushes happened since
+        if (pushed[v] == 0 || misses - pushed[v] + 1 > cache_size) {
+            misses++;
+            pushed[v] = misses;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(index_count / 3);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(unique);
+    return stats;
+}
+
+//////// vertex cache, Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+
+constexpr int FORSYTH_CACHE_SIZE = 32;
+constexpr int FORSYTH_MAX_VALENCE = 32;
+
+typedef struct ForsythTables {
+    float cache[FORSYTH_CACHE_SIZE];
+    float valence[FORSYTH_MAX_VALENCE + 1];
+} ForsythTables;
+
+static ForsythTables forsythTables() {
+    ForsythTables tables;
+
+    for (int i = 0; i < FORSYTH_CACHE_SIZE; i++) {
+        if (i < 3) {
+            // the last triangle's vertices get a fixed score so the next triangle doesn't just reuse them
+            tables.cache[i] = 0.75f;
+        } else {
+            const float scaled = 1.f - static_cast<float>(i - 3) / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+            tables.cache[i] = powf(scaled, 1.5f);
+        }
+    }
+
+    // boost vertices with few triangles left so lone triangles aren't left behind
+    tables.valence[0] = 0.f;
+    for (int i = 1; i <= FORSYTH_MAX_VALENCE; i++) {
+        tables.valence[i] = 2.f / sqrtf(static_cast<float>(i));
+    }
+
+    return tables;
+}
+
+static float vertexScore(const ForsythTables& tables, const int cache_position, const unsigned int live_triangles) {
+    if (live_triangles == 0) {
+        return -1.f;
+    }
+
+    const float cache_score = cache_position >= 0 ? tables.cache[cache_position] : 0.f;
+    return cache_score + tables.valence[std::min<unsigned int>(live_triangles, FORSYTH_MAX_VALENCE)];
+}
+
+void optimizeVertexCache(unsigned int* indices, const size_t index_count, const size_t vertex_count) {
+
+    const size_t triangle_count = index_count / 3;
+    if (triangle_count == 0 || vertex_count == 0) {
+        return;
+    }
+
+    const ForsythTables tables = forsythTables();
+
+    // vertex -> triangles adjacency, packed
+    DArray<unsigned int> live_counts(vertex_count, 0);
+    unsigned int* live = live_counts.begin();
+    for (size_t i = 0; i < triangle_count * 3; i++) {
+        live[indices[i]]++;
+    }
+
+    DArray<unsigned int> adjacency_offsets(vertex_count + 1, 0);
+    unsigned int* offsets = adjacency_offsets.begin();
+    for (size_t v = 0; v < vertex_count; v++) {
+        offsets[v + 1] = offsets[v] + live[v];
+    }
+
+    DArray<unsigned int> adjacency_data(triangle_count * 3, 0);
+    DArray<unsigned int> fill_cursor(vertex_count, 0);
+    unsigned int* adjacency = adjacency_data.begin();
+    unsigned int* cursor = fill_cursor.begin();
+    for (size_t t = 0; t < triangle_count; t++) {
+        for (size_t k = 0; k < 3; k++) {
+            const unsigned int v = indices[t * 3 + k];
+            adjacency[offsets[v] + cursor[v]++] = static_cast<unsigned int>(t);
+        }
+    }
+
+    DArray<int> cache_positions(vertex_count, -1);
+    DArray<float> vertex_scores(vertex_count, 0.f);
+    int* cache_position = cache_positions.begin();
+    float* vscore = vertex_scores.begin();
+    for (size_t v = 0; v < vertex_count; v++) {
+        vscore[v] = vertexScore(tables, -1, live[v]);
+    }
+
+    DArray<float> triangle_scores(triangle_count, 0.f);
+    DArray<bool> emitted_flags(triangle_count, false);
+    float* tscore = triangle_scores.begin();
+    bool* emitted = emitted_flags.begin();
+    for (size_t t = 0; t < triangle_count; t++) {
+        tscore[t] = vscore[indices[t * 3]] + vscore[indices[t * 3 + 1]] + vscore[indices[t * 3 + 2]];
+    }
+
+    DArray<unsigned int> output(triangle_count * 3, 0);
+    unsigned int* out = output.begin();
+
+    // the cache can briefly hold 3 extra entries while a triangle is pushed
+    unsigned int cache[FORSYTH_CACHE_SIZE + 3];
+    unsigned int next_cache[FORSYTH_CACHE_SIZE + 3];
+    size_t cache_count = 0;
+
+    size_t best_triangle = 0;
+    size_t scan_cursor = 0;
+
+    for (size_t emitted_count = 0; emitted_count < triangle_count; emitted_count++) {
+
+        if (best_triangle == UNUSED) {
+            // nothing useful in the cache, carry on from the first triangle that hasn't been emitted
+            while (emitted[scan_cursor]) {
+                scan_cursor++;
+            }
+            best_triangle = scan_cursor;
+        }
+
+        const unsigned int* tri = &indices[best_triangle * 3];
+        memcpy(out + emitted_count * 3, tri, sizeof(unsigned int) * 3);
+        emitted[best_triangle] = true;
+
+        // drop the triangle from its vertices' live lists
+        for (size_t k = 0; k < 3; k++) {
+            const unsigned int v = tri[k];
+            unsigned int* begin = adjacency + offsets[v];
+            unsigned int* end = begin + live[v];
+            unsigned int* found = std::find(begin, end, static_cast<unsigned int>(best_triangle));
+            if (found != end) {
+                *found = *(end - 1);
+                live[v]--;
+            }
+        }
+
+        // new cache: the triangle's vertices at the front, then the old cache minus them
+        size_t next_count = 0;
+        for (size_t k = 0; k < 3; k++) {
+            next_cache[next_count++] = tri[k];
+        }
+        for (size_t i = 0; i < cache_count; i++) {
+            const unsigned int v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                next_cache[next_count++] = v;
+            }
+        }
+
+        // vertices pushed past the end fall out of the cache
+        for (size_t i = FORSYTH_CACHE_SIZE; i < next_count; i++) {
+            cache_position[next_cache[i]] = -1;
+            vscore[next_cache[i]] = vertexScore(tables, -1, live[next_cache[i]]);
+        }
+
+        cache_count = std::min<size_t>(next_count, FORSYTH_CACHE_SIZE);
+        for (size_t i = 0; i < cache_count; i++) {
+            cache[i] = next_cache[i];
+            cache_position[cache[i]] = static_cast<int>(i);
+            vscore[cache[i]] = vertexScore(tables, static_cast<int>(i), live[cache[i]]);
+        }
+
+        // rescore every live triangle touching the cache and pick the best of them next
+        best_triangle = UNUSED;
+        float best_score = -1.f;
+
+        for (size_t i = 0; i < cache_count; i++) {
+            const unsigned int v = cache[i];
+            for (unsigned int j = 0; j < live[v]; j++) {
+                const unsigned int t = adjacency[offsets[v] + j];
+                const float score = vscore[indices[t * 3]] + vscore[indices[t * 3 + 1]] + vscore[indices[t * 3 + 2]];
+                tscore[t] = score;
+                if (score > best_score) {
+                    best_score = score;
+                    best_triangle = t;
+                }
+            }
+        }
+    }
+
+    memcpy(indices, out, sizeof(unsigned int) * triangle_count * 3);
+}
+
+//////// overdraw, cluster sort in the spirit of Sander et al. "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+
+typedef struct TriangleCluster {
+    size_t first_triangle;
+    size_t triangle_count;
+    float sort_key;
+} TriangleCluster;
+
+void optimizeOverdraw(
+    unsigned int* indices,
+    const size_t index_count,
+    const float* positions,
+    const size_t vertex_count,
+    const float threshold
+) {
+    const size_t triangle_count = index_count / 3;
+    if (triangle_count < 2) {
+        return;
+    }
+
+    const VertexCacheStats input_stats = analyzeVertexCache(indices, index_count, vertex_count, DEFAULT_VERTEX_CACHE_SIZE);
+
+    // split at hard boundaries, triangles that miss on all 3 vertices start a new cluster
+    DArray<TriangleCluster> clusters;
+    DArray<size_t> pushed_at(vertex_count, 0);
+    size_t* pushed = pushed_at.begin();
+    size_t misses = 0;
+
+    for (size_t t = 0; t < triangle_count; t++) {
+        size_t triangle_misses = 0;
+        for (size_t k = 0; k < 3; k++) {
+            const unsigned int v = indices[t * 3 + k];
+            if (pushed[v] == 0 || misses - pushed[v] + 1 > DEFAULT_VERTEX_CACHE_SIZE) {
+                misses++;
+                pushed[v] = misses;
+                triangle_misses++;
+            }
+        }
+
+        if (t == 0 || triangle_misses == 3) {
+            clusters.push_back({ .first_triangle = t, .triangle_count = 0, .sort_key = 0.f });
+        }
+        clusters[clusters.size() - 1].triangle_count++;
+    }
+
+    if (clusters.size() < 2) {
+        return;
+    }
+
+    // mesh centroid
+    double centroid[3] = { 0.0, 0.0, 0.0 };
+    for (size_t v = 0; v < vertex_count; v++) {
+        for (size_t axis = 0; axis < 3; axis++) {
+            centroid[axis] += positions[v * 3 + axis];
+        }
+    }
+    for (size_t axis = 0; axis < 3; axis++) {
+        centroid[axis] /= static_cast<double>(vertex_count);
+    }
+
+    // clusters that face away from the centre sit on the outside of the mesh and are drawn first
+    for (auto& cluster : clusters) {
+        double cluster_centroid[3] = { 0.0, 0.0, 0.0 };
+        double cluster_normal[3] = { 0.0, 0.0, 0.0 };
+
+        for (size_t t = cluster.first_triangle; t < cluster.first_triangle + cluster.triangle_count; t++) {
+            const float* a = &positions[indices[t * 3] * 3];
+            const float* b = &positions[indices[t * 3 + 1] * 3];
+            const float* c = &positions[indices[t * 3 + 2] * 3];
+
+            const double e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            const double e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+
+            // area weighted normal
+            cluster_normal[0] += e1[1] * e2[2] - e1[2] * e2[1];
+            cluster_normal[1] += e1[2] * e2[0] - e1[0] * e2[2];
+            cluster_normal[2] += e1[0] * e2[1] - e1[1] * e2[0];
+
+            for (size_t axis = 0; axis < 3; axis++) {
+                cluster_centroid[axis] += (a[axis] + b[axis] + c[axis]) / 3.0;
+            }
+        }
+
+        double key = 0.0;
+        for (size_t axis = 0; axis < 3; axis++) {
+            key += (cluster_centroid[axis] / cluster.triangle_count - centroid[axis]) * cluster_normal[axis];
+        }
+        cluster.sort_key = static_cast<float>(key);
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](const TriangleCluster& a, const TriangleCluster& b) {
+        return a.sort_key > b.sort_key;
+    });
+
+    DArray<unsigned int> reordered(triangle_count * 3, 0);
+    size_t cursor = 0;
+    for (const auto& cluster : clusters) {
+        memcpy(reordered.addr(cursor), &indices[cluster.first_triangle * 3], sizeof(unsigned int) * cluster.triangle_count * 3);
+        cursor += cluster.triangle_count * 3;
+    }
+
+    const VertexCacheStats output_stats = analyzeVertexCache(reordered.begin(), index_count, vertex_count, DEFAULT_VERTEX_CACHE_SIZE);
+    if (output_stats.acmr <= input_stats.acmr * threshold) {
+        memcpy(indices, reordered.begin(), sizeof(unsigned int) * triangle_count * 3);
+    }
+}
+
+//////// vertex fetch
+
+template<class T>
+static void permuteStream(DArray<T>& stream, const unsigned int* remap, const size_t vertex_count, const size_t components) {
+    if (stream.size() < vertex_count * components) {
+        return;
+    }
+
+    DArray<T> permuted(vertex_count * components, T());
+    for (size_t v = 0; v < vertex_count; v++) {
+        memcpy(permuted.addr(remap[v] * components), stream.addr(v * components), sizeof(T) * components);
+    }
+    stream = std::move(permuted);
+}
+
+void optimizeVertexFetch(Mesh& mesh) {
+
+    Vertices& vertices = mesh.vertices;
+    const size_t vertex_count = vertices.vertex_count;
+    unsigned int* indices = vertices.indices.begin();
+
+    // first use order, vertices the index buffer never touches go at the end
+    DArray<unsigned int> remap_table(vertex_count, UNUSED);
+    unsigned int* remap = remap_table.begin();
+    unsigned int next = 0;
+
+    for (size_t i = 0; i < vertices.index_count; i++) {
+        if (remap[indices[i]] == UNUSED) {
+            remap[indices[i]] = next++;
+        }
+    }
+    for (size_t v = 0; v < vertex_count; v++) {
+        if (remap[v] == UNUSED) {
+            remap[v] = next++;
+        }
+    }
+
+    for (size_t i = 0; i < vertices.index_count; i++) {
+        indices[i] = remap[indices[i]];
+    }
+
+    permuteStream(vertices.positions, remap, vertex_count, 3);
+    permuteStream(vertices.normals, remap, vertex_count, 3);
+    permuteStream(vertices.tangents, remap, vertex_count, 4);
+    permuteStream(vertices.uvs, remap, vertex_count, 2);
+}
+
+MeshOptimizationReport optimizeMesh(Mesh& mesh, const bool optimize_overdraw) {
+
+    Vertices& vertices = mesh.vertices;
+    MeshOptimizationReport report = {};
+
+    if (vertices.index_count < 3 || vertices.compressed.has_value()) {
+        return report;
+    }
+
+    report.before = analyzeVertexCache(vertices.indices.begin(), vertices.index_count, vertices.vertex_count, DEFAULT_VERTEX_CACHE_SIZE);
+
+    optimizeVertexCache(vertices.indices.begin(), vertices.index_count, vertices.vertex_count);
+
+    if (optimize_overdraw) {
+        optimizeOverdraw(vertices.indices.begin(), vertices.index_count,
+                         vertices.positions.begin(), vertices.vertex_count, 1.05f);
+    }
+
+    optimizeVertexFetch(mesh);
+
+    report.after = analyzeVertexCache(vertices.indices.begin(), vertices.index_count, vertices.vertex_count, DEFAULT_VERTEX_CACHE_SIZE);
+    return report;
+}
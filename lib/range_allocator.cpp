@@ -0,0 +1,86 @@
+#include "range_allocator.h"
+
+RangeAllocator::RangeAllocator() : _capacity(0), _used(0) {}
+
+RangeAllocator::RangeAllocator(const size_t capacity) : _capacity(capacity), _used(0) {
+    if (capacity > 0) {
+        free_ranges.push_back({ .offset = 0, .size = capacity });
+    }
+}
+
+std::optional<size_t> RangeAllocator::allocate(const size_t size) {
+
+    if (size == 0) {
+        return std::nullopt;
+    }
+
+    for (size_t i = 0; i < free_ranges.size(); i++) {
+        Range& range = free_ranges[i];
+
+        if (range.size >= size) {
+            const size_t offset = range.offset;
+
+            if (range.size == size) {
+                free_ranges.erase(i);
+            } else {
+                range.offset += size;
+                range.size -= size;
+            }
+
+            _used += size;
+            return offset;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void RangeAllocator::release(const size_t offset, const size_t size) {
+
+    if (size == 0) {
+        return;
+    }
+
+    // find the first free range after the released one
+    size_t index = 0;
+    while (index < free_ranges.size() && free_ranges[index].offset < offset) {
+        index++;
+    }
+
+    const bool joins_previous = index > 0 &&
+        free_ranges[index - 1].offset + free_ranges[index - 1].size == offset;
+    const bool joins_next = index < free_ranges.size() &&
+        offset + size == free_ranges[index].offset;
+
+    if (joins_previous && joins_next) {
+        free_ranges[index - 1].size += size + free_ranges[index].size;
+        free_ranges.erase(index);
+    } else if (joins_previous) {
+        free_ranges[index - 1].size += size;
+    } else if (joins_next) {
+        free_ranges[index].offset = offset;
+        free_ranges[index].size += size;
+    } else {
+        free_ranges.insert(index, { .offset = offset, .size = size });
+    }
+
+    _used -= size;
+}
+
+size_t RangeAllocator::largestFreeRange() const {
+    size_t largest = 0;
+    for (const auto& range : free_ranges) {
+        if (range.size > largest) {
+            largest = range.size;
+        }
+    }
+    return largest;
+}
+
+float RangeAllocator::fragmentation() const {
+    const size_t free_total = _capacity - _used;
+    if (free_total == 0) {
+        return 0.f;
+    }
+    return 1.f - static_cast<float>(largestFreeRange()) / static_cast<float>(free_total);
+}
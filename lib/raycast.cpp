@@ -3,9 +3,10 @@
 #include "mesh.h"
 #include "vec.h"
 #include "scene.h"
-#include <stack>
 #include <algorithm>
 #include "mystl.hpp"
+#include "vertex_compression.h"
+#include "transform_batch.h"
 
 
 Vec3Result rayIntersectsTriangle(Ray ray, Triangle triangle) {
@@ -47,11 +48,19 @@ Vec3Result rayIntersectsTriangle(Ray ray, Triangle triangle) {
 }
 
 
-DArray<VertexIntersection> rayIntersectsVertices(Ray ray, Vertices vertices) {
+VertexIntersections rayIntersectsVertices(Ray ray, const Vertices& vertices) {
     
-    DArray<VertexIntersection> intersections;
+    VertexIntersections intersections;
 
-    float * positions = vertices.positions.begin();
+    const float * positions = vertices.positions.begin();
+
+    // compressed meshes drop their float positions, decode the quantized ones instead
+    FrameArray<float> decoded_positions;
+    if (vertices.compressed.has_value()) {
+        float * decoded = decoded_positions.extend(vertices.vertex_count * 3);
+        decodePositions(vertices.compressed.value(), vertices.vertex_count, decoded);
+        positions = decoded;
+    }
 
     for (size_t i = 0; i < vertices.vertex_count * 3; i += 9) {
         
@@ -80,18 +89,19 @@ DArray<VertexIntersection> rayIntersectsVertices(Ray ray, Vertices vertices) {
 }
 
 
-DArray<NodeIntersection> rayIntersectsSceneNode(Ray ray, const SceneNode& node) {
+NodeIntersections rayIntersectsSceneNode(Ray ray, const SceneNode& node) {
     
-    DArray<NodeIntersection> intersections;
-    std::stack<const SceneNode*> node_stack;
+    NodeIntersections intersections;
+    // a std::stack would allocate its deque on every ray, this only spills (into the frame arena) for deep or wide trees
+    SmallArray<const SceneNode*, 32, FrameAllocator<const SceneNode*>> node_stack;
     
     
-    node_stack.push(&node);
+    node_stack.push_back(&node);
 
     while (!node_stack.empty()) {
 
-        const SceneNode * nodeUnderTest = node_stack.top();
-        node_stack.pop();
+        const SceneNode * nodeUnderTest = node_stack.back();
+        node_stack.pop_back();
         
         if (nodeUnderTest->mesh) {
             // transform the ray into mesh space
@@ -115,13 +125,13 @@ DArray<NodeIntersection> rayIntersectsSceneNode(Ray ray, const SceneNode& node)
                 nodeUnderTest->mesh.value().vertices);
 
             if (rayNodeIntersections.size() > 0) {
-                for (const auto& intersection : rayNodeIntersections) {
-                    // transform the intersection back into world space
-                    auto worldSpaceIntersection = positionMultiplied(
-                        intersection.point, 
-                        nodeUnderTest->world_transform);
+                // transform the intersections back into world space, all of this node's in one go
+                static_assert(sizeof(VertexIntersection) % sizeof(float) == 0, "hits are strided in floats");
+                float* points = rayNodeIntersections[0].point.data;
+                transformPositions(points, points, rayNodeIntersections.size(), toMat4(nodeUnderTest->world_transform),
+                                   sizeof(VertexIntersection) / sizeof(float));
 
-                 
+                for (const auto& intersection : rayNodeIntersections) {
                     intersections.push_back((NodeIntersection){ 
                         .id = nodeUnderTest->id,
                         .nodeName = nodeUnderTest->name.value_or(""),
@@ -131,7 +141,7 @@ DArray<NodeIntersection> rayIntersectsSceneNode(Ray ray, const SceneNode& node)
                                 .id = nodeUnderTest->mesh.value().id
                             },
                             .vertexIntersection = {
-                                .point = worldSpaceIntersection, 
+                                .point = intersection.point, 
                                 .triangleIdx = intersection.triangleIdx,
                             }
                         }
@@ -141,15 +151,15 @@ DArray<NodeIntersection> rayIntersectsSceneNode(Ray ray, const SceneNode& node)
         }
         
         for (auto& child: nodeUnderTest->children) {
-            node_stack.push(child);
+            node_stack.push_back(child);
         }
     }
 
     return intersections;
 }
 
-DArray<NodeIntersection> rayIntersectsScene(const Ray &ray, const Scene& scene) {
-    DArray<NodeIntersection> intersections;
+NodeIntersections rayIntersectsScene(const Ray &ray, const Scene& scene) {
+    NodeIntersections intersections;
     
     for (const auto& node: scene.nodes) {
         auto rayNodeIntersections = rayIntersectsSceneNode(ray, *node);
@@ -165,20 +175,39 @@ DArray<NodeIntersection> rayIntersectsScene(const Ray &ray, const Scene& scene)
 
 
 void sortBySceneDepth(
-    DArray<NodeIntersection>& intersections,
+    NodeIntersections& intersections,
     Camera camera
 ) {
 
 
-    std::sort(intersections.begin(),intersections.end(), [camera](NodeIntersection &a, NodeIntersection &b){
-        const auto viewMatrix = inverse(camera.transform);
-        const auto projectionMatrix = getProjectionMatrix(camera);
-        const auto viewProj = multiplied(projectionMatrix, viewMatrix);
-        const auto glPosA = positionMultiplied(a.meshIntersection.vertexIntersection.point, viewProj);
-        const auto glPosB = positionMultiplied(b.meshIntersection.vertexIntersection.point, viewProj);
-
-        return   glPosA.z < glPosB.z;
+    const auto viewMatrix = inverse(camera.transform);
+    const auto projectionMatrix = getProjectionMatrix(camera);
+    const auto viewProj = multiplied(projectionMatrix, viewMatrix);
 
+    // project every hit once up front instead of two points per comparison
+    const size_t count = intersections.size();
+    FrameArray<float> projected;
+    float* points = projected.extend(count * 3);
+    for (size_t i = 0; i < count; i++) {
+        const Vec3& point = intersections[i].meshIntersection.vertexIntersection.point;
+        points[i * 3] = point.x;
+        points[i * 3 + 1] = point.y;
+        points[i * 3 + 2] = point.z;
+    }
+    projectPositions(points, points, count, viewProj);
 
+    FrameArray<size_t> order;
+    for (size_t i = 0; i < count; i++) {
+        order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [points](const size_t a, const size_t b) {
+        return points[a * 3 + 2] < points[b * 3 + 2];
     });
+
+    NodeIntersections sorted;
+    sorted.reserve(count);
+    for (const size_t i : order) {
+        sorted.push_back(std::move(intersections[i]));
+    }
+    intersections = std::move(sorted);
 }
\ No newline at end of file
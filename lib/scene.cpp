@@ -1,10 +1,15 @@
+#include <atomic>
+
 #include "scene.h"
 #include "mat4.h"
+#include "affine.h"
 #include "camera.h"
+#include "material_table.h"
 
 
 
-size_t sceneNodeCounter = 0;
+// loaders create nodes from worker threads
+std::atomic<size_t> sceneNodeCounter = 0;
 
 void setParent(SceneNode& node, SceneNode& parent) {
    
@@ -32,12 +37,12 @@ void setParent(SceneNode& node, SceneNode& parent) {
 void updateWorldTransform(SceneNode * node) {
 
    // n.b. this assumes the parent world transform is always up-to-date so we must keep it that way
-   Mat4 parentWorldTransform;
+   Affine parentWorldTransform;
 
    if (node->parent.has_value()) {
     parentWorldTransform = node->parent.value()->world_transform;
    } else {
-    parentWorldTransform = fromPositionAndEuler({0.f,0.f,0.f}, {0.f,0.f,0.f});
+    parentWorldTransform = identityAffine();
    }
    
    node->world_transform = multiplied(parentWorldTransform, node->local_transform);
@@ -49,22 +54,49 @@ void updateWorldTransform(SceneNode * node) {
 
 }
 
-void updateTransform(SceneNode * node, const Mat4 &transform) {
+void updateTransform(SceneNode * node, const Affine &transform) {
    node->local_transform = transform;
    updateWorldTransform(node);
 }
 
-SceneNode createSceneNode(const Mat4 &transform, const std::optional<Mesh> &mesh, std::string name) {
+void updateTransform(SceneNode * node, const Mat4 &transform) {
+   updateTransform(node, toAffine(transform));
+}
+
+void deleteSceneTree(SceneNode* node) {
+   if (node->mesh.has_value()) {
+    materialTable().releaseMaterial(node->mesh.value().material);
+   }
+   for (SceneNode* child : node->children) {
+    deleteSceneTree(child);
+   }
+   delete node;
+}
+
+Mesh copyMesh(const Mesh& mesh) {
+   return {
+   .vertices = mesh.vertices,
+   .material = materialTable().retainMaterial(mesh.material),
+   .id = mesh.id,
+   .slice = mesh.slice,
+   .lod = mesh.lod,
+};
+}
+
+SceneNode createSceneNode(const Affine &transform, std::optional<Mesh> mesh, std::string name) {
    SceneNode node = {
-   .id = sceneNodeCounter,
+   .id = sceneNodeCounter.fetch_add(1),
    .local_transform = transform,
    .world_transform = transform, // actually valid since there's no parent
-   .children = DArray<SceneNode*>(), // empty array if no children
-   .mesh = mesh,
+   .children = SmallArray<SceneNode*, 4>(), // empty array if no children
+   .mesh = std::move(mesh),
    .name = name
 };
 
-   sceneNodeCounter++;
    updateWorldTransform(&node);
    return node;
-}
\ No newline at end of file
+}
+
+SceneNode createSceneNode(const Mat4 &transform, std::optional<Mesh> mesh, std::string name) {
+   return createSceneNode(toAffine(transform), std::move(mesh), name);
+}
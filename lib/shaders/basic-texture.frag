@@ -1,5 +1,6 @@
     #version 300 es 
     precision highp float;  
+    precision mediump sampler2DArray;
 
     uniform vec3 u_view_position; 
 
@@ -34,7 +35,9 @@
     uniform AmbientLight u_ambient_light;
     uniform DirectionalLight u_directional_light; 
     uniform PointLight u_point_light; 
-    uniform sampler2D mesh_texture;                   
+    // every texture is a layer of an array texture (see texture_pool.h)
+    uniform sampler2DArray mesh_texture;
+    uniform float u_texture_layer;
                                                   
     in vec3 v_normal;     
     in vec3 frag_world_position;  
@@ -84,7 +87,7 @@
     void main()                                  
     {                
 
-        vec3 base_color = texture(mesh_texture, tex_coord).rgb;
+        vec3 base_color = texture(mesh_texture, vec3(tex_coord, u_texture_layer)).rgb;
         vec3 normal = normalize(v_normal);  
         vec3 view_dir = normalize(u_view_position - frag_world_position);
 
@@ -1,8 +1,38 @@
 #version 300 es
 precision highp float;
 
+#ifdef QUANTIZED_VERTICES
+// unorm16 positions relative to the mesh bounds and octahedron encoded normals, see vertex_compression.h
+layout(location = 0) in vec3 a_position;
+layout(location = 1) in vec2 a_normal;
+
+uniform vec3 u_position_min;
+uniform vec3 u_position_extent;
+
+vec3 decodePosition(vec3 quantized) {
+    return u_position_min + quantized * u_position_extent;
+}
+
+vec3 decodeNormal(vec2 encoded) {
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+#else
 layout(location = 0) in vec3 a_position;
 layout(location = 1) in vec3 a_normal;
+
+vec3 decodePosition(vec3 position) {
+    return position;
+}
+
+vec3 decodeNormal(vec3 normal) {
+    return normal;
+}
+#endif
+
 layout(location = 2) in vec2 a_texcoord;                      
                                                 
 uniform mat4 u_model;                           
@@ -15,8 +45,8 @@ out vec2 tex_coord;
                                                 
 void main()                                  
 {               
-    frag_world_position =  vec3(u_model * vec4(a_position, 1.0)); 
-    v_normal = mat3(transpose(inverse(u_model))) * a_normal;
+    frag_world_position =  vec3(u_model * vec4(decodePosition(a_position), 1.0)); 
+    v_normal = mat3(transpose(inverse(u_model))) * decodeNormal(a_normal);
     tex_coord = a_texcoord;
 
     gl_Position = u_projection * u_view * vec4(frag_world_position, 1.0); 
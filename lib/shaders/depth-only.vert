@@ -4,6 +4,20 @@ precision highp float;
 layout(location = 0) in vec3 a_position;
 uniform mat4 u_model;
 uniform mat4 u_lightViewProj;
+
+#ifdef QUANTIZED_VERTICES
+uniform vec3 u_position_min;
+uniform vec3 u_position_extent;
+
+vec3 decodePosition(vec3 quantized) {
+    return u_position_min + quantized * u_position_extent;
+}
+#else
+vec3 decodePosition(vec3 position) {
+    return position;
+}
+#endif
+
 void main() {
-    gl_Position = u_lightViewProj * u_model * vec4(a_position, 1.0);
+    gl_Position = u_lightViewProj * u_model * vec4(decodePosition(a_position), 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "texture_mips.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <array>
+
+#include "../third_party/stb_image.h"
+#include "mystl.hpp"
+
+// linear values are quantized this finely on the way back, enough that the darkest srgb steps survive
+constexpr int LINEAR_STEPS = 16384;
+
+static const float* srgbToLinear() {
+    static const std::array<float, 256> table = [] {
+        std::array<float, 256> values;
+        for (int i = 0; i < 256; i++) {
+            const float c = i / 255.f;
+            values[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return values;
+    }();
+    return table.data();
+}
+
+static const unsigned char* linearToSrgb() {
+    static const std::array<unsigned char, LINEAR_STEPS + 1> table = [] {
+        std::array<unsigned char, LINEAR_STEPS + 1> values;
+        for (int i = 0; i <= LINEAR_STEPS; i++) {
+            const float l = static_cast<float>(i) / LINEAR_STEPS;
+            const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.f / 2.4f) - 0.055f;
+            values[i] = static_cast<unsigned char>(std::clamp(c * 255.f + 0.5f, 0.f, 255.f));
+        }
+        return values;
+    }();
+    return table.data();
+}
+
+int mipLevelCount(const int width, const int height) {
+    int levels = 1;
+    for (int size = std::max(width, height); size > 1; size /= 2) {
+        levels++;
+    }
+    return levels;
+}
+
+int mipExtent(const int size, const int level) {
+    return std::max(size >> level, 1);
+}
+
+size_t mipLevelBytes(const int width, const int height, const int channels, const int level) {
+    return static_cast<size_t>(mipExtent(width, level)) * mipExtent(height, level) * channels;
+}
+
+size_t mipLevelOffset(const int width, const int height, const int channels, const int level) {
+    size_t offset = 0;
+    for (int i = 0; i < level; i++) {
+        offset += mipLevelBytes(width, height, channels, i);
+    }
+    return offset;
+}
+
+size_t mipChainBytes(const TextureData& data) {
+    return mipLevelOffset(data.width, data.height, data.channels, std::max(data.levels, 1));
+}
+
+// one level from the one above. Odd sizes repeat their last row or column rather than reading past it
+static void downsample(const unsigned char* source, const int source_width, const int source_height,
+                       unsigned char* target, const int target_width, const int target_height, const int channels) {
+
+    const float* to_linear = srgbToLinear();
+    const unsigned char* to_srgb = linearToSrgb();
+    // grey + alpha and rgba keep alpha in their last channel
+    const int alpha_channel = channels == 2 || channels == 4 ? channels - 1 : -1;
+    const size_t source_stride = static_cast<size_t>(source_width) * channels;
+
+    for (int y = 0; y < target_height; y++) {
+        const unsigned char* row0 = source + std::min(y * 2, source_height - 1) * source_stride;
+        const unsigned char* row1 = source + std::min(y * 2 + 1, source_height - 1) * source_stride;
+        unsigned char* out = target + static_cast<size_t>(y) * target_width * channels;
+
+        for (int x = 0; x < target_width; x++) {
+            const size_t x0 = static_cast<size_t>(std::min(x * 2, source_width - 1)) * channels;
+            const size_t x1 = static_cast<size_t>(std::min(x * 2 + 1, source_width - 1)) * channels;
+
+            for (int c = 0; c < channels; c++) {
+                if (c == alpha_channel) {
+                    const int sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                    out[x * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+                } else {
+                    const float linear = (to_linear[row0[x0 + c]] + to_linear[row0[x1 + c]] +
+                                          to_linear[row1[x0 + c]] + to_linear[row1[x1 + c]]) * 0.25f;
+                    out[x * channels + c] = to_srgb[static_cast<int>(linear * LINEAR_STEPS + 0.5f)];
+                }
+            }
+        }
+    }
+}
+
+TextureData buildMipChain(const TextureData& data, const int max_size) {
+
+    if (data.pixels == nullptr) {
+        return data;
+    }
+
+    const int levels = mipLevelCount(data.width, data.height);
+    int first = 0;
+    while (max_size > 0 && first < levels - 1 &&
+           (mipExtent(data.width, first) > max_size || mipExtent(data.height, first) > max_size)) {
+        first++;
+    }
+
+    const size_t skipped = mipLevelOffset(data.width, data.height, data.channels, first);
+    const size_t chain_bytes = mipLevelOffset(data.width, data.height, data.channels, levels) - skipped;
+
+    unsigned char* chain = nullptr;
+    // realloc takes data's block over, moved or not, so only a malloced chain leaves data's pixels to free
+    const bool reallocated = first == 0 && data.needs_free;
+    if (reallocated) {
+        // level 0 stays where it is, the rest goes after it
+        chain = static_cast<unsigned char*>(realloc(data.pixels, chain_bytes));
+        if (chain == nullptr) {
+            return data;
+        }
+    } else {
+        chain = static_cast<unsigned char*>(malloc(chain_bytes));
+        if (chain == nullptr) {
+            return data;
+        }
+        if (first == 0) {
+            memcpy(chain, data.pixels, mipLevelBytes(data.width, data.height, data.channels, 0));
+        }
+    }
+
+    // levels above the clamp are only ever read by the next one down, two scratch buffers take turns
+    DArray<unsigned char> scratch[2];
+    const unsigned char* previous = first == 0 ? chain : data.pixels;
+    for (int level = 1; level < levels; level++) {
+        unsigned char* target;
+        if (level >= first) {
+            target = chain + mipLevelOffset(data.width, data.height, data.channels, level) - skipped;
+        } else {
+            DArray<unsigned char>& buffer = scratch[level % 2];
+            buffer.resize(mipLevelBytes(data.width, data.height, data.channels, level));
+            target = buffer.begin();
+        }
+        downsample(previous, mipExtent(data.width, level - 1), mipExtent(data.height, level - 1),
+                   target, mipExtent(data.width, level), mipExtent(data.height, level), data.channels);
+        previous = target;
+    }
+
+    if (data.needs_free && !reallocated) {
+        stbi_image_free(data.pixels);
+    }
+
+    return {
+        .pixels = chain,
+        .width = mipExtent(data.width, first),
+        .height = mipExtent(data.height, first),
+        .channels = data.channels,
+        .levels = levels - first,
+        .needs_free = true,
+    };
+}
+
+TextureData dropTopMips(const TextureData& data, int count) {
+
+    count = std::min(count, std::max(data.levels, 1) - 1);
+    if (data.pixels == nullptr || count <= 0) {
+        return data;
+    }
+
+    const size_t offset = mipLevelOffset(data.width, data.height, data.channels, count);
+    const size_t bytes = mipChainBytes(data) - offset;
+
+    TextureData trimmed = data;
+    trimmed.width = mipExtent(data.width, count);
+    trimmed.height = mipExtent(data.height, count);
+    trimmed.levels = data.levels - count;
+
+    if (data.needs_free) {
+        memmove(data.pixels, data.pixels + offset, bytes);
+        // a failed shrink just keeps the larger block
+        unsigned char* shrunk = static_cast<unsigned char*>(realloc(data.pixels, bytes));
+        trimmed.pixels = shrunk != nullptr ? shrunk : data.pixels;
+    } else {
+        trimmed.pixels = data.pixels + offset;
+    }
+    return trimmed;
+}
@@ -0,0 +1,48 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(const size_t thread_count) : stopping(false) {
+
+    const size_t count = thread_count > 0
+        ? thread_count
+        : std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    for (size_t i = 0; i < count; i++) {
+        workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    job_available.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::work() {
+
+    while (true) {
+        std::function<void()> job;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job_available.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+            // drain the queue before stopping so nobody is left waiting on a future
+            if (jobs.empty()) {
+                return;
+            }
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        job();
+    }
+}
@@ -0,0 +1,249 @@
+#include "vertex_compression.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+using namespace mym;
+
+size_t normalEncodingSize(const NormalEncoding encoding) {
+    return encoding == NormalEncoding::Oct16 ? 4 : 2;
+}
+
+static float maxSnorm(const NormalEncoding encoding) {
+    return encoding == NormalEncoding::Oct16 ? 32767.f : 127.f;
+}
+
+static Vec3 decodeOctahedronCoords(const float x, const float y) {
+    Vec3 n = { x, y, 1.f - fabsf(x) - fabsf(y) };
+    const float t = std::max(-n.z, 0.f);
+    n.x += n.x >= 0.f ? -t : t;
+    n.y += n.y >= 0.f ? -t : t;
+    return normalize(n);
+}
+
+void octahedronEncode(const Vec3 normal, const NormalEncoding encoding, unsigned char* out) {
+
+    const float max_value = maxSnorm(encoding);
+
+    // project onto the octahedron and fold the lower half over the diagonals
+    const float l1 = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+    float x = l1 > 0.f ? normal.x / l1 : 0.f;
+    float y = l1 > 0.f ? normal.y / l1 : 0.f;
+
+    if (normal.z < 0.f) {
+        const float folded_x = (1.f - fabsf(y)) * (x >= 0.f ? 1.f : -1.f);
+        const float folded_y = (1.f - fabsf(x)) * (y >= 0.f ? 1.f : -1.f);
+        x = folded_x;
+        y = folded_y;
+    }
+
+    // rounding each component on its own isn't always the closest direction,
+    // so try the four neighbouring grid points and keep the best one
+    const float base_x = floorf(x * max_value);
+    const float base_y = floorf(y * max_value);
+    const Vec3 unit = normalize(normal);
+
+    float best_x = base_x;
+    float best_y = base_y;
+    float best_dot = -2.f;
+
+    for (int i = 0; i < 4; i++) {
+        const float qx = std::clamp(base_x + (i & 1), -max_value, max_value);
+        const float qy = std::clamp(base_y + (i >> 1), -max_value, max_value);
+        const float d = dot(unit, decodeOctahedronCoords(qx / max_value, qy / max_value));
+        if (d > best_dot) {
+            best_dot = d;
+            best_x = qx;
+            best_y = qy;
+        }
+    }
+
+    if (encoding == NormalEncoding::Oct16) {
+        const int16_t encoded[2] = { static_cast<int16_t>(best_x), static_cast<int16_t>(best_y) };
+        memcpy(out, encoded, sizeof(encoded));
+    } else {
+        const int8_t encoded[2] = { static_cast<int8_t>(best_x), static_cast<int8_t>(best_y) };
+        memcpy(out, encoded, sizeof(encoded));
+    }
+}
+
+Vec3 octahedronDecode(const unsigned char* encoded, const NormalEncoding encoding) {
+
+    const float max_value = maxSnorm(encoding);
+    float x, y;
+
+    if (encoding == NormalEncoding::Oct16) {
+        int16_t values[2];
+        memcpy(values, encoded, sizeof(values));
+        x = values[0];
+        y = values[1];
+    } else {
+        int8_t values[2];
+        memcpy(values, encoded, sizeof(values));
+        x = values[0];
+        y = values[1];
+    }
+
+    // same as the GL snorm conversion, max(c / max_value, -1)
+    return decodeOctahedronCoords(std::max(x / max_value, -1.f), std::max(y / max_value, -1.f));
+}
+
+uint16_t floatToHalf(const float value) {
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t float_exponent = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    // inf and nan
+    if (float_exponent == 0xff) {
+        return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+    }
+
+    const int32_t exponent = static_cast<int32_t>(float_exponent) - 127 + 15;
+
+    // too big, goes to inf
+    if (exponent >= 31) {
+        return sign | 0x7c00;
+    }
+
+    // denormal half (or zero)
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        const uint32_t shift = 14 - exponent;
+        uint32_t half_mantissa = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half_mantissa & 1))) {
+            half_mantissa++;
+        }
+        return sign | half_mantissa;
+    }
+
+    // round to nearest even, a carry out of the mantissa correctly bumps the exponent
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    const uint32_t remainder = mantissa & 0x1fff;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+        half++;
+    }
+    return half;
+}
+
+float halfToFloat(const uint16_t half) {
+
+    const uint32_t sign = (half & 0x8000u) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1f;
+    const uint32_t mantissa = half & 0x3ff;
+
+    if (exponent == 0) {
+        const float value = ldexpf(static_cast<float>(mantissa), -24);
+        return sign ? -value : value;
+    }
+
+    uint32_t bits;
+    if (exponent == 31) {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool hasCompressedVertices(const Mesh& mesh) {
+    return mesh.vertices.compressed.has_value();
+}
+
+void compressVertices(Mesh& mesh, const NormalEncoding normal_encoding) {
+
+    if (hasCompressedVertices(mesh)) {
+        return;
+    }
+
+    Vertices& vertices = mesh.vertices;
+    const size_t vcount = vertices.vertex_count;
+    const float* positions = vertices.positions.begin();
+
+    CompressedVertices compressed = {
+        .normal_encoding = normal_encoding
+    };
+
+    // bounds of the mesh, the quantization grid spans exactly these
+    Vec3 min = { 0.f, 0.f, 0.f };
+    Vec3 max = { 0.f, 0.f, 0.f };
+    if (vcount > 0) {
+        min = { positions[0], positions[1], positions[2] };
+        max = min;
+    }
+    for (size_t i = 0; i < vcount; i++) {
+        for (size_t axis = 0; axis < 3; axis++) {
+            min.data[axis] = std::min(min.data[axis], positions[i * 3 + axis]);
+            max.data[axis] = std::max(max.data[axis], positions[i * 3 + axis]);
+        }
+    }
+
+    compressed.position_min = min;
+    compressed.position_extent = subtractVectors(max, min);
+
+    for (size_t i = 0; i < vcount; i++) {
+        for (size_t axis = 0; axis < 3; axis++) {
+            const float extent = compressed.position_extent.data[axis];
+            const float t = extent > 0.f ? (positions[i * 3 + axis] - min.data[axis]) / extent : 0.f;
+            compressed.positions.push_back(static_cast<uint16_t>(lroundf(std::clamp(t, 0.f, 1.f) * 65535.f)));
+        }
+        compressed.positions.push_back(0);
+    }
+
+    // meshes without normals still get a (meaningless) normal stream so the layout stays fixed
+    const bool has_normals = vertices.normals.size() >= vcount * 3;
+    const size_t normal_size = normalEncodingSize(normal_encoding);
+    for (size_t i = 0; i < vcount; i++) {
+        unsigned char encoded[4] = { 0 };
+        if (has_normals) {
+            const float* n = vertices.normals.addr(i * 3);
+            octahedronEncode({ n[0], n[1], n[2] }, normal_encoding, encoded);
+        }
+        for (size_t b = 0; b < normal_size; b++) {
+            compressed.normals.push_back(encoded[b]);
+        }
+    }
+
+    if (vertices.uvs.size() >= vcount * 2) {
+        for (size_t i = 0; i < vcount * 2; i++) {
+            compressed.uvs.push_back(floatToHalf(vertices.uvs[i]));
+        }
+    }
+
+    vertices.uvs = DArray<float>();
+
+    vertices.positions = DArray<float>();
+    vertices.normals = DArray<float>();
+    vertices.compressed.emplace(std::move(compressed));
+}
+
+DArray<float> decodePositions(const CompressedVertices& compressed, const size_t vertex_count) {
+
+    DArray<float> positions;
+    decodePositions(compressed, vertex_count, positions.extend(vertex_count * 3));
+    return positions;
+}
+
+void decodePositions(const CompressedVertices& compressed, const size_t vertex_count, float* positions) {
+
+    const uint16_t* quantized = compressed.positions.begin();
+
+    for (size_t i = 0; i < vertex_count; i++) {
+        for (size_t axis = 0; axis < 3; axis++) {
+            positions[i * 3 + axis] = compressed.position_min.data[axis] +
+                compressed.position_extent.data[axis] * (quantized[i * 4 + axis] / 65535.f);
+        }
+    }
+}
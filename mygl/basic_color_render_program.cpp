@@ -1,16 +1,16 @@
 #include "render_program.h"
 #include "loaders.h"
+#include "vertex_compression.h"
 
-BasicColorRenderProgram initShader()
+BasicColorRenderProgram initShader(const bool quantized_vertices)
 {
 
     const GLchar* vertexSource = get_shader_content("./shaders/basic.vert");
     const GLchar* fragmentSource = get_shader_content("./shaders/basic.frag");
 
     // Create and compile vertex shader
-    const GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexSource, nullptr);
-    glCompileShader(vertexShader);
+    const GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource,
+        quantized_vertices ? "#define QUANTIZED_VERTICES\n" : "");
 
     // Create and compile fragment shader
     const GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
@@ -61,75 +61,35 @@ BasicColorRenderProgram initShader()
         .shadow_uniform = {
             .shadow_map_location = guaranteeUniformLocation(shader_program, "u_shadowMap"),
             .light_view_location = guaranteeUniformLocation(shader_program, "u_lightViewProj"),
-        }
+        },
+        .quantized_vertices = quantized_vertices,
+        .quantization_uniform = initQuantizationUniform(shader_program, quantized_vertices),
     }; 
 }
 
 
 
-void drawSceneNodeBasicColor(SceneNode* node, BasicColorRenderProgram render_program) {
+void bindBasicColorMaterial(const BasicColorMaterial& material, const BasicColorRenderProgram& render_program) {
+    glUniform3fv(render_program.material_uniform.color_location,1, material.color.data);
+    glUniform3fv(render_program.material_uniform.specular_color_location,1, material.specular_color.data);
+    glUniform1f(render_program.material_uniform.shininess_location, material.shininess);
+}
 
-    if (node->mesh.has_value()) {
-        
+void drawSceneNodeBasicColor(SceneNode* node, BasicColorRenderProgram render_program, GeometryPool& pool,
+                             const LodSelection& lod_selection) {
 
-        if (std::holds_alternative<BasicColorMaterial>(node->mesh.value().material)) {
+    // meshes that haven't been uploaded yet are skipped, GlRenderer::uploadPending gets to them
+    if (node->mesh.has_value() &&
+        hasCompressedVertices(node->mesh.value()) == render_program.quantized_vertices &&
+        node->mesh.value().id.has_value()) {
 
         Mesh &mesh = node->mesh.value();
-        BasicColorMaterial * material = &std::get<BasicColorMaterial>(mesh.material);
-
-        // check if the mesh has been initialized and init if not
-        if (mesh.id.has_value()) {
-
-            
-            // draw this mesh
-            glUseProgram(render_program.shader_program);
-        
-            glUniformMatrix4fv(render_program.world_matrix_uniform_location,1,0, &node->world_transform.data[0][0]);
-            
-            glUniform3fv(render_program.material_uniform.color_location,1, 
-                material->color.data);
-            glUniform3fv(render_program.material_uniform.specular_color_location,1, 
-                material->specular_color.data);
-            glUniform1f(render_program.material_uniform.shininess_location, 
-                material->shininess);
-
-
-            glBindVertexArray(mesh.id.value());
-            // Draw the vertex buffer using indices if available
-            if (mesh.vertices.index_count > 0) {
-                glDrawElements(GL_TRIANGLES, (GLsizei)mesh.vertices.index_count, GL_UNSIGNED_INT, 0);
-            } else {
-                glDrawArrays(GL_TRIANGLES, 0, mesh.vertices.vertex_count);
-            }
-        } else {
-            // Initialize the mesh 
-            initMesh(mesh);
-            // draw mesh
-            glUseProgram(render_program.shader_program);
-        
-            glUniformMatrix4fv(render_program.world_matrix_uniform_location,1,0, &node->world_transform.data[0][0]);
-            
-            glUniform3fv(render_program.material_uniform.color_location,1, 
-                material->color.data);
-            glUniform3fv(render_program.material_uniform.specular_color_location,1, 
-                material->specular_color.data);
-            glUniform1f(render_program.material_uniform.shininess_location, 
-                material->shininess);
-
-
-            glBindVertexArray(mesh.id.value());
-            // Draw the vertex buffer using indices if available
-            if (node->mesh.value().vertices.index_count > 0) {
-                glDrawElements(GL_TRIANGLES, (GLsizei)node->mesh.value().vertices.index_count, GL_UNSIGNED_INT, 0);
-            } else {
-                glDrawArrays(GL_TRIANGLES, 0, node->mesh.value().vertices.vertex_count);
-            }
-        }
-
-        }
-    }
-    
-    for (size_t i = 0; i < node->children.size(); i++) {
-               drawSceneNodeBasicColor(node->children[i], render_program);
+
+        const Mat4 world_matrix = toMat4(node->world_transform);
+        glUniformMatrix4fv(render_program.world_matrix_uniform_location,1,0, &world_matrix.data[0][0]);
+
+        setQuantizationUniforms(render_program.quantization_uniform, mesh);
+
+        drawPooledMesh(pool, mesh, selectMeshLod(mesh, node->world_transform, lod_selection));
     }
-}
\ No newline at end of file
+}
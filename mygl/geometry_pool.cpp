@@ -0,0 +1,293 @@
+#include "geometry_pool.h"
+
+#include <GLES3/gl32.h> // glDrawElementsBaseVertex
+#include <algorithm>
+#include <assert.h>
+#include <stdio.h>
+
+#include "mesh_lod.h"
+
+// default page size, meshes bigger than this get a page of their own
+constexpr size_t PAGE_VERTEX_CAPACITY = 1 << 18;
+constexpr size_t PAGE_INDEX_CAPACITY = 1 << 20;
+
+// per vertex layout of one attribute stream
+typedef struct AttributeLayout {
+    GLint components;
+    GLenum type;
+    GLboolean normalized;
+    size_t stride; // bytes per vertex
+} AttributeLayout;
+
+typedef struct PageLayout {
+    AttributeLayout position;
+    AttributeLayout normal;
+    AttributeLayout uv;
+} PageLayout;
+
+static PageLayout pageLayout(const VertexFormat format) {
+    switch (format) {
+        case VertexFormat::QuantizedOct8:
+            return {
+                .position = { 4, GL_UNSIGNED_SHORT, GL_TRUE, 8 },
+                .normal = { 2, GL_BYTE, GL_TRUE, 2 },
+                .uv = { 2, GL_HALF_FLOAT, GL_FALSE, 4 },
+            };
+        case VertexFormat::QuantizedOct16:
+            return {
+                .position = { 4, GL_UNSIGNED_SHORT, GL_TRUE, 8 },
+                .normal = { 2, GL_SHORT, GL_TRUE, 4 },
+                .uv = { 2, GL_HALF_FLOAT, GL_FALSE, 4 },
+            };
+        case VertexFormat::Float:
+        default:
+            return {
+                .position = { 3, GL_FLOAT, GL_FALSE, 12 },
+                .normal = { 3, GL_FLOAT, GL_FALSE, 12 },
+                .uv = { 2, GL_FLOAT, GL_FALSE, 8 },
+            };
+    }
+}
+
+VertexFormat vertexFormat(const Mesh& mesh) {
+    if (!mesh.vertices.compressed.has_value()) {
+        return VertexFormat::Float;
+    }
+    return mesh.vertices.compressed.value().normal_encoding == NormalEncoding::Oct8
+        ? VertexFormat::QuantizedOct8
+        : VertexFormat::QuantizedOct16;
+}
+
+static GLuint createAttributeBuffer(const GLuint location, const AttributeLayout layout, const size_t vertex_capacity) {
+    GLuint vbo;
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, layout.stride * vertex_capacity, nullptr, GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(location);
+    glVertexAttribPointer(location, layout.components, layout.type, layout.normalized, layout.stride, 0);
+
+    return vbo;
+}
+
+static void uploadAttribute(const GLuint vbo, const AttributeLayout layout, const size_t base_vertex,
+                            const size_t vertex_count, const void* data) {
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, layout.stride * base_vertex, layout.stride * vertex_count, data);
+}
+
+GeometryPool::GeometryPool() : bound_vao(0), counters({}) {}
+
+size_t GeometryPool::createPage(const VertexFormat format, const size_t vertex_capacity, const size_t index_capacity) {
+
+    const PageLayout layout = pageLayout(format);
+
+    GeometryPage page = {
+        .format = format,
+        .vertices = RangeAllocator(vertex_capacity),
+        .indices = RangeAllocator(index_capacity),
+    };
+
+    glGenVertexArrays(1, &page.vao);
+    glBindVertexArray(page.vao);
+
+    page.position_vbo = createAttributeBuffer(0, layout.position, vertex_capacity);
+    page.normal_vbo = createAttributeBuffer(1, layout.normal, vertex_capacity);
+    page.uv_vbo = createAttributeBuffer(2, layout.uv, vertex_capacity);
+
+    // the element buffer binding is vao state, so it stays with the page
+    glGenBuffers(1, &page.ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, page.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * index_capacity, nullptr, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    bound_vao = 0;
+
+    pages.push_back(page);
+    return pages.size() - 1;
+}
+
+void GeometryPool::upload(Mesh& mesh) {
+
+    if (mesh.id.has_value()) {
+        printf("mesh is already in the geometry pool, you shouldn't be trying to reupload it\n");
+        return;
+    }
+
+    const Vertices& vertices = mesh.vertices;
+    assert(vertices.vertex_count >= 3 && "vertex_count must be >= 3");
+
+    // the lod index buffers follow the full one in a single range
+    const size_t index_count = totalIndexCount(mesh);
+
+    const VertexFormat format = vertexFormat(mesh);
+
+    // first page of the right layout with room for both the vertices and the indices
+    size_t page_index = pages.size();
+    std::optional<size_t> base_vertex;
+    std::optional<size_t> first_index = 0;
+
+    for (size_t i = 0; i < pages.size(); i++) {
+        if (pages[i].format != format) {
+            continue;
+        }
+
+        base_vertex = pages[i].vertices.allocate(vertices.vertex_count);
+        if (!base_vertex.has_value()) {
+            continue;
+        }
+
+        if (index_count > 0) {
+            first_index = pages[i].indices.allocate(index_count);
+            if (!first_index.has_value()) {
+                pages[i].vertices.release(base_vertex.value(), vertices.vertex_count);
+                continue;
+            }
+        }
+
+        page_index = i;
+        break;
+    }
+
+    if (page_index == pages.size()) {
+        page_index = createPage(
+            format,
+            std::max(PAGE_VERTEX_CAPACITY, vertices.vertex_count),
+            std::max(PAGE_INDEX_CAPACITY, index_count));
+
+        base_vertex = pages[page_index].vertices.allocate(vertices.vertex_count);
+        first_index = index_count > 0 ? pages[page_index].indices.allocate(index_count) : 0;
+    }
+
+    const GeometryPage& page = pages[page_index];
+    const PageLayout layout = pageLayout(format);
+
+    if (vertices.compressed.has_value()) {
+        const CompressedVertices& compressed = vertices.compressed.value();
+
+        uploadAttribute(page.position_vbo, layout.position, base_vertex.value(), vertices.vertex_count,
+                        compressed.positions.begin());
+        uploadAttribute(page.normal_vbo, layout.normal, base_vertex.value(), vertices.vertex_count,
+                        compressed.normals.begin());
+        if (compressed.uvs.size() >= vertices.vertex_count * 2) {
+            uploadAttribute(page.uv_vbo, layout.uv, base_vertex.value(), vertices.vertex_count,
+                            compressed.uvs.begin());
+        }
+    } else {
+        uploadAttribute(page.position_vbo, layout.position, base_vertex.value(), vertices.vertex_count,
+                        vertices.positions.begin());
+
+        if (vertices.normals.size() >= vertices.vertex_count * 3) {
+            uploadAttribute(page.normal_vbo, layout.normal, base_vertex.value(), vertices.vertex_count,
+                            vertices.normals.begin());
+        }
+
+        if (vertices.uvs.size() >= vertices.vertex_count * 2) {
+            uploadAttribute(page.uv_vbo, layout.uv, base_vertex.value(), vertices.vertex_count,
+                            vertices.uvs.begin());
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (vertices.index_count > 0) {
+        // GL_ELEMENT_ARRAY_BUFFER is vao state, bind the page before touching it
+        glBindVertexArray(page.vao);
+        bound_vao = page.vao;
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * first_index.value(),
+                        sizeof(unsigned int) * vertices.index_count, vertices.indices.begin());
+
+        size_t lod_first_index = first_index.value() + vertices.index_count;
+        for (auto& level : mesh.lod.levels) {
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * lod_first_index,
+                            sizeof(unsigned int) * level.index_count, level.indices.begin());
+            level.first_index = lod_first_index;
+            lod_first_index += level.index_count;
+        }
+    }
+
+    mesh.slice = {
+        .page = page_index,
+        .base_vertex = base_vertex.value(),
+        .first_index = first_index.value(),
+    };
+    mesh.id = page.vao;
+}
+
+void GeometryPool::release(Mesh& mesh) {
+
+    if (!mesh.id.has_value()) {
+        return;
+    }
+
+    GeometryPage& page = pages[mesh.slice.page];
+    page.vertices.release(mesh.slice.base_vertex, mesh.vertices.vertex_count);
+    const size_t index_count = totalIndexCount(mesh);
+    if (index_count > 0) {
+        page.indices.release(mesh.slice.first_index, index_count);
+    }
+
+    mesh.id = std::nullopt;
+}
+
+void GeometryPool::bind(const Mesh& mesh) {
+    const GLuint vao = mesh.id.value();
+    if (vao != bound_vao) {
+        glBindVertexArray(vao);
+        bound_vao = vao;
+    }
+}
+
+void GeometryPool::resetBinding() {
+    bound_vao = 0;
+}
+
+void GeometryPool::countDraw(const size_t triangles) {
+    counters.draw_calls++;
+    counters.triangles += triangles;
+}
+
+void GeometryPool::resetDrawCounters() {
+    counters = {};
+}
+
+DrawCounters GeometryPool::drawCounters() const {
+    return counters;
+}
+
+GeometryPoolStats GeometryPool::stats() const {
+    GeometryPoolStats stats = {
+        .pages = pages.size(),
+    };
+
+    for (const auto& page : pages) {
+        stats.vertex_capacity += page.vertices.capacity();
+        stats.vertices_used += page.vertices.used();
+        stats.index_capacity += page.indices.capacity();
+        stats.indices_used += page.indices.used();
+        stats.vertex_fragmentation = std::max(stats.vertex_fragmentation, page.vertices.fragmentation());
+        stats.index_fragmentation = std::max(stats.index_fragmentation, page.indices.fragmentation());
+    }
+
+    return stats;
+}
+
+void drawPooledMesh(GeometryPool& pool, const Mesh& mesh, const size_t lod) {
+
+    pool.bind(mesh);
+
+    // Draw the vertex buffer using indices if available
+    if (mesh.vertices.index_count > 0) {
+        const size_t index_count = lodIndexCount(mesh, lod);
+        const size_t first_index = lod == 0 ? mesh.slice.first_index : mesh.lod.levels[lod - 1].first_index;
+
+        glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)index_count, GL_UNSIGNED_INT,
+            (const void*)(sizeof(unsigned int) * first_index),
+            (GLint)mesh.slice.base_vertex);
+        pool.countDraw(index_count / 3);
+    } else {
+        glDrawArrays(GL_TRIANGLES, (GLint)mesh.slice.base_vertex, (GLsizei)mesh.vertices.vertex_count);
+        pool.countDraw(mesh.vertices.vertex_count / 3);
+    }
+}
@@ -1,5 +1,13 @@
 #include "gl_renderer.h"
 
+#include <algorithm>
+#include <chrono>
+
+#include "frame_arena.h"
+#include "material_table.h"
+#include "texture_mips.h"
+#include "vertex_compression.h"
+
 using namespace mym;
 
 WindowState initWindow(const char* title)
@@ -51,23 +59,316 @@ WindowState initWindow(const char* title)
 
 GlRenderer::GlRenderer() {
         // Initialize shader and geometry
-        basic_color_render_program = initShader();
-        texture_render_program = initTextureShader();
+        basic_color_render_program = initShader(false);
+        texture_render_program = initTextureShader(false);
+
+        // variants for meshes imported with compressed vertices
+        quantized_basic_color_render_program = initShader(true);
+        quantized_texture_render_program = initTextureShader(true);
 
         // Shadow map setup
         shadow_map = createShadowMap();
-        shadow_render_program = initShadowRenderProgram();
+        shadow_render_program = initShadowRenderProgram(false);
+        quantized_shadow_render_program = initShadowRenderProgram(true);
+
+        lod_settings = {
+            .enabled = true,
+            .max_pixel_error = 1.f,
+            .shadow_max_pixel_error = 4.f,
+        };
+
+        upload_budget = {
+            .milliseconds = 2.0,
+            .bytes = 8 * 1024 * 1024,
+        };
+        upload_stats = {};
+        sampler_cache = {};
+        texture_binds = 0;
+    }
+
+// bytes the pool upload copies for this mesh, good enough to budget against
+static size_t meshUploadBytes(const Mesh& mesh) {
+    size_t vertex_stride = 0;
+    switch (vertexFormat(mesh)) {
+        case VertexFormat::Float:         vertex_stride = 8 * sizeof(float); break;
+        case VertexFormat::QuantizedOct8: vertex_stride = 8 + 2 + 4; break;
+        case VertexFormat::QuantizedOct16: vertex_stride = 8 + 4 + 4; break;
+    }
+    return mesh.vertices.vertex_count * vertex_stride + totalIndexCount(mesh) * sizeof(unsigned int);
+}
+
+static size_t textureUploadBytes(const TextureData& data) {
+    return mipChainBytes(data);
+}
+
+typedef std::chrono::steady_clock UploadClock;
+
+static double millisecondsSince(const UploadClock::time_point start) {
+    return std::chrono::duration<double, std::milli>(UploadClock::now() - start).count();
+}
+
+// false once this frame has done its share, the first upload of a frame always goes through
+static bool fitsUploadBudget(const UploadBudget& budget, const UploadStats& stats,
+                             const UploadClock::time_point start, const size_t bytes) {
+    if (stats.meshes == 0 && stats.textures == 0) {
+        return true;
+    }
+    return stats.bytes + bytes <= budget.bytes && millisecondsSince(start) < budget.milliseconds;
+}
+
+static void uploadSceneNode(SceneNode* node, GeometryPool& pool, TexturePool& texture_pool, const UploadBudget& budget,
+                            const UploadClock::time_point start, UploadStats& stats) {
+
+    if (node->mesh.has_value() && !node->mesh.value().id.has_value()) {
+        Mesh& mesh = node->mesh.value();
+
+        // the texture goes first, a mesh only counts as uploaded once it can be drawn properly.
+        // a texture other meshes share is only ever uploaded by the first of them
+        MaterialTable& table = materialTable();
+        const std::optional<Material> material = table.material(mesh.material);
+        bool texture_ready = material.has_value();
+        if (texture_ready && std::holds_alternative<BasicTextureMaterial>(material.value())) {
+            const TextureHandle texture = std::get<BasicTextureMaterial>(material.value()).texture;
+            const std::optional<TextureData> pixels = table.pixelsToUpload(texture);
+            if (pixels.has_value()) {
+                const size_t bytes = textureUploadBytes(pixels.value());
+                const std::optional<TextureLayer> layer = fitsUploadBudget(budget, stats, start, bytes)
+                    ? texture_pool.upload(pixels.value())
+                    : std::nullopt;
+                if (layer.has_value()) {
+                    table.textureUploaded(texture, layer.value());
+                    stats.textures++;
+                    stats.bytes += bytes;
+                } else {
+                    // over budget, or the gpu is still reading the upload ring
+                    texture_ready = false;
+                }
+            } else {
+                // still decoding on a loader thread
+                table.readTexture(texture, [&](const TextureEntry& entry) {
+                    texture_ready = entry.state != TextureState::Loading;
+                });
+            }
+        }
+
+        const size_t bytes = meshUploadBytes(mesh);
+        if (texture_ready && fitsUploadBudget(budget, stats, start, bytes)) {
+            initMesh(mesh, pool);
+            stats.meshes++;
+            stats.bytes += bytes;
+        } else {
+            stats.waiting++;
+        }
     }
 
+    for (size_t i = 0; i < node->children.size(); i++) {
+        uploadSceneNode(node->children[i], pool, texture_pool, budget, start, stats);
+    }
+}
+
+void GlRenderer::uploadPending(const Scene& scene) {
+
+    const UploadClock::time_point start = UploadClock::now();
+    upload_stats = {};
+
+    for (size_t i = 0; i < scene.nodes.size(); i++) {
+        uploadSceneNode(scene.nodes[i], geometry_pool, texture_pool, upload_budget, start, upload_stats);
+    }
+
+    // textures normally come with their mips, only pages that got one without them need generating
+    texture_pool.generatePendingMipmaps();
+    texture_pool.endUploads();
+
+    upload_stats.milliseconds = millisecondsSince(start);
+}
+
+// consecutive nodes of a draw pass that share a material, looked up in the material table once for all of them
+typedef struct MaterialRun {
+    Material material;
+    TextureLayer texture; // texture materials only, array 0 draws untextured
+    size_t first;         // into DrawPass::nodes
+    size_t count;
+} MaterialRun;
+
+typedef struct DrawPass {
+    FrameArray<SceneNode*> nodes;
+    FrameArray<MaterialRun> runs;
+} DrawPass;
+
+// the uploaded mesh nodes of one frame, split by the program that draws them and sorted by material
+// so each material is bound once. index 0 has float vertices, index 1 quantized ones
+typedef struct DrawList {
+    DrawPass color[2];
+    DrawPass texture[2];
+} DrawList;
+
+typedef struct DrawItem {
+    MaterialHandle material;
+    SceneNode* node;
+} DrawItem;
+
+// meshes that aren't on the gpu yet are left out, uploadPending gets to them
+static void collectDrawItems(SceneNode* node, FrameArray<DrawItem>& items) {
+
+    if (node->mesh.has_value() && node->mesh.value().id.has_value()) {
+        items.push_back({ .material = node->mesh.value().material, .node = node });
+    }
+
+    for (size_t i = 0; i < node->children.size(); i++) {
+        collectDrawItems(node->children[i], items);
+    }
+}
+
+static void appendMaterialRun(DrawPass& pass, const Material& material, const TextureLayer texture,
+                              const DrawItem* items, const size_t count, const size_t quantized) {
+    const size_t first = pass.nodes.size();
+    for (size_t i = 0; i < count; i++) {
+        if ((hasCompressedVertices(items[i].node->mesh.value()) ? 1 : 0) == quantized) {
+            pass.nodes.push_back(items[i].node);
+        }
+    }
+    if (pass.nodes.size() > first) {
+        pass.runs.push_back({ .material = material, .texture = texture, .first = first, .count = pass.nodes.size() - first });
+    }
+}
+
+static void collectDrawList(const Scene& scene, DrawList& draw_list) {
+
+    FrameArray<DrawItem> items;
+    for (size_t i = 0; i < scene.nodes.size(); i++) {
+        collectDrawItems(scene.nodes[i], items);
+    }
+
+    // handle indices are dense, equal handles end up next to each other
+    std::sort(items.begin(), items.end(), [](const DrawItem& a, const DrawItem& b) {
+        return a.material.index != b.material.index ? a.material.index < b.material.index
+                                                    : a.material.generation < b.material.generation;
+    });
+
+    MaterialTable& table = materialTable();
+    size_t first = 0;
+    while (first < items.size()) {
+        size_t end = first + 1;
+        while (end < items.size() && items[end].material == items[first].material) {
+            end++;
+        }
+
+        // a released material draws nothing, its meshes are on their way out
+        const std::optional<Material> material = table.material(items[first].material);
+        if (material.has_value()) {
+            const bool textured = std::holds_alternative<BasicTextureMaterial>(material.value());
+            TextureLayer texture = {};
+            if (textured) {
+                table.readTexture(std::get<BasicTextureMaterial>(material.value()).texture, [&](const TextureEntry& entry) {
+                    texture = entry.gpu;
+                });
+            }
+            for (size_t quantized = 0; quantized < 2; quantized++) {
+                DrawPass& pass = textured ? draw_list.texture[quantized] : draw_list.color[quantized];
+                appendMaterialRun(pass, material.value(), texture, items.addr(first), end - first, quantized);
+            }
+        }
+        first = end;
+    }
+
+    // textured runs that share an array page and wrap modes follow each other, so the page and the
+    // sampler are bound once for all of them and only the layer changes in between
+    for (size_t quantized = 0; quantized < 2; quantized++) {
+        FrameArray<MaterialRun>& runs = draw_list.texture[quantized].runs;
+        std::sort(runs.begin(), runs.end(), [](const MaterialRun& a, const MaterialRun& b) {
+            const BasicTextureMaterial& x = std::get<BasicTextureMaterial>(a.material);
+            const BasicTextureMaterial& y = std::get<BasicTextureMaterial>(b.material);
+            if (a.texture.array != b.texture.array) {
+                return a.texture.array < b.texture.array;
+            }
+            if (x.wrap_u != y.wrap_u) {
+                return x.wrap_u < y.wrap_u;
+            }
+            return x.wrap_v < y.wrap_v;
+        });
+    }
+}
+
+// camera, light and shadow uniforms shared by the basic color and texture programs
+template<class RenderProgram>
+static void setSceneUniforms(
+    const RenderProgram& render_program,
+    const Scene& scene,
+    const Mat4& view,
+    const Mat4& projection,
+    const Vec3& camera_position,
+    const Mat4& lightViewProj
+) {
+    glUseProgram(render_program.shader_program);
+
+    // shadow map is bound to texture unit 1
+    glUniform1i(render_program.shadow_uniform.shadow_map_location, 1);
+    glUniformMatrix4fv(render_program.shadow_uniform.light_view_location, 1,0, &lightViewProj.data[0][0]);
+
+    // update camera uniforms
+    glUniformMatrix4fv(render_program.view_uniform_location,1,0, &view.data[0][0]);  
+    glUniform3fv(render_program.view_position_uniform_location,1, &camera_position.data[0]); 
+    glUniformMatrix4fv(render_program.projection_uniform_location,1,0, &projection.data[0][0]);
+
+    // update light uniforms
+    // set ambient light
+    glUniform3fv(render_program.ambient_light_uniform.color_location,1,scene.ambient_light.color.data);
+
+    // set directional light
+    glUniform3fv(render_program.directional_light_uniform.color_location,1,scene.directional_light.color.data);
+    glUniform3fv(render_program.directional_light_uniform.direction_location,1,scene.directional_light.direction.data);
+
+    // set point light
+    glUniform3fv(render_program.point_light_uniform.color_location,1,scene.point_light.color.data);
+    glUniform3fv(render_program.point_light_uniform.position_location,1,scene.point_light.position.data);
+    glUniform1f(render_program.point_light_uniform.constant_location,scene.point_light.constant);
+    glUniform1f(render_program.point_light_uniform.linear_location,scene.point_light.linear);
+    glUniform1f(render_program.point_light_uniform.quadratic_location,scene.point_light.quadratic); 
+}
+
 
 void GlRenderer::drawGl(
     WindowState window, 
     Camera camera, 
-    Scene scene 
+    const Scene& scene 
 )
 {
     
 
+    // imgui and friends bind their own vaos between our frames
+    geometry_pool.resetBinding();
+    geometry_pool.resetDrawCounters();
+
+    // anything that streamed in since the last frame, a bit at a time
+    uploadPending(scene);
+
+    // layers whose last material went away since the last frame
+    MaterialTable& table = materialTable();
+    for (const TextureLayer& layer : table.takeReleasedTextureLayers()) {
+        texture_pool.release(layer);
+    }
+
+    // textures nothing has drawn for a while give up their top level while the pool is over budget.
+    // one whose material went away in the meantime is already queued under its old layer
+    for (const TextureMove& move : texture_pool.shrinkToBudget()) {
+        texture_pool.release(table.textureMoved(move.from, move.to) ? move.from : move.to);
+    }
+    texture_binds = 0;
+
+    // one walk of the tree, every pass below goes through the flat lists
+    DrawList draw_list;
+    collectDrawList(scene, draw_list);
+
+    const Mat4 projection = getProjectionMatrix(camera);
+    const Mat4 view = getViewMatrix(camera);
+    const Vec3 camera_position = getPosition(camera.transform);
+
+    // a zero pixel error draws every mesh at full resolution
+    const LodSelection lod_selection = lodSelection(camera_position, camera.field_of_view_radians, window.height,
+        lod_settings.enabled ? lod_settings.max_pixel_error : 0.f);
+    const LodSelection shadow_lod_selection = lodSelection(camera_position, camera.field_of_view_radians, window.height,
+        lod_settings.enabled ? lod_settings.shadow_max_pixel_error : 0.f);
+
     // draw shadows
     // 1. Render to shadow map
     glBindFramebuffer(GL_FRAMEBUFFER, shadow_map.framebuffer);
@@ -95,8 +396,15 @@ void GlRenderer::drawGl(
     Mat4 lightViewProj = multiplied(lightProj, lightView);
 
 
-    for (size_t i = 0; i < scene.nodes.size(); i++) {
-        drawSceneNodeShadow(scene.nodes[i], shadow_render_program, lightViewProj);
+    // every mesh casts, whatever its material
+    const ShadowRenderProgram* shadow_programs[2] = { &shadow_render_program, &quantized_shadow_render_program };
+    for (size_t quantized = 0; quantized < 2; quantized++) {
+        for (SceneNode* node : draw_list.color[quantized].nodes) {
+            drawSceneNodeShadow(node, *shadow_programs[quantized], lightViewProj, geometry_pool, shadow_lod_selection);
+        }
+        for (SceneNode* node : draw_list.texture[quantized].nodes) {
+            drawSceneNodeShadow(node, *shadow_programs[quantized], lightViewProj, geometry_pool, shadow_lod_selection);
+        }
     }
 
     
@@ -114,64 +422,90 @@ void GlRenderer::drawGl(
     // Bind shadow map texture to texture unit 1
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, shadow_map.depthTexture);
-    glUniform1i(basic_color_render_program.shadow_uniform.shadow_map_location, 1);
 
-    glUniformMatrix4fv(basic_color_render_program.shadow_uniform.light_view_location, 1,0, &lightViewProj.data[0][0]);
-
-    // update camera uniforms
-    const Mat4 projection = getProjectionMatrix(camera);
-    const Mat4 view = getViewMatrix(camera);
-    const Vec3 camera_position = getPosition(camera.transform);
-    glUniformMatrix4fv(basic_color_render_program.view_uniform_location,1,0, &view.data[0][0]);  
-    glUniform3fv(basic_color_render_program.view_position_uniform_location,1, &camera_position.data[0]); 
-    glUniformMatrix4fv(basic_color_render_program.projection_uniform_location,1,0, &projection.data[0][0]);
+    // Draw color material meshes, a material at a time
+    const BasicColorRenderProgram* color_programs[2] = { &basic_color_render_program, &quantized_basic_color_render_program };
+    for (size_t quantized = 0; quantized < 2; quantized++) {
+        const DrawPass& pass = draw_list.color[quantized];
+        setSceneUniforms(*color_programs[quantized], scene, view, projection, camera_position, lightViewProj);
+        for (const MaterialRun& run : pass.runs) {
+            bindBasicColorMaterial(std::get<BasicColorMaterial>(run.material), *color_programs[quantized]);
+            for (size_t i = run.first; i < run.first + run.count; i++) {
+                drawSceneNodeBasicColor(pass.nodes[i], *color_programs[quantized], geometry_pool, lod_selection);
+            }
+        }
+    }
 
-    // update light uniforms
-    // set ambient light
-    glUniform3fv(basic_color_render_program.ambient_light_uniform.color_location,1,scene.ambient_light.color.data);
+    // Draw texture material meshes
+    const TextureRenderProgram* texture_programs[2] = { &texture_render_program, &quantized_texture_render_program };
+    for (size_t quantized = 0; quantized < 2; quantized++) {
+        const DrawPass& pass = draw_list.texture[quantized];
+        setSceneUniforms(*texture_programs[quantized], scene, view, projection, camera_position, lightViewProj);
+        std::optional<GLuint> bound_array;
+        GLuint bound_sampler = 0;
+        for (const MaterialRun& run : pass.runs) {
+            const BasicTextureMaterial& material = std::get<BasicTextureMaterial>(run.material);
+            const GLuint sampler = samplerFor(sampler_cache, material.wrap_u, material.wrap_v);
+            if (bound_array != run.texture.array || bound_sampler != sampler) {
+                bindTextureArray(run.texture.array, sampler, *texture_programs[quantized]);
+                bound_array = run.texture.array;
+                bound_sampler = sampler;
+                texture_binds++;
+            }
+            bindTextureMaterial(material, run.texture.layer, *texture_programs[quantized]);
+            texture_pool.markUsed(run.texture);
+            for (size_t i = run.first; i < run.first + run.count; i++) {
+                drawSceneNodeTexture(pass.nodes[i], *texture_programs[quantized], geometry_pool, lod_selection);
+            }
+        }
+    }
 
-    // set directional light
-    glUniform3fv(basic_color_render_program.directional_light_uniform.color_location,1,scene.directional_light.color.data);
-    glUniform3fv(basic_color_render_program.directional_light_uniform.direction_location,1,scene.directional_light.direction.data);
+    // whatever draws after us (imgui) samples through unit 0 with its texture's own parameters
+    glBindSampler(0, 0);
+}
 
-    // set point light
-    glUniform3fv(basic_color_render_program.point_light_uniform.color_location,1,scene.point_light.color.data);
-    glUniform3fv(basic_color_render_program.point_light_uniform.position_location,1,scene.point_light.position.data);
-    glUniform1f(basic_color_render_program.point_light_uniform.constant_location,scene.point_light.constant);
-    glUniform1f(basic_color_render_program.point_light_uniform.linear_location,scene.point_light.linear);
-    glUniform1f(basic_color_render_program.point_light_uniform.quadratic_location,scene.point_light.quadratic); 
+GeometryPoolStats GlRenderer::geometryPoolStats() const {
+    return geometry_pool.stats();
+}
 
-    // Draw color material meshes
-    for (size_t i = 0; i < scene.nodes.size(); i++) {
-        drawSceneNodeBasicColor(scene.nodes[i], basic_color_render_program);
-    }
+DrawCounters GlRenderer::drawCounters() const {
+    DrawCounters counters = geometry_pool.drawCounters();
+    counters.texture_binds = texture_binds;
+    return counters;
+}
 
-    // Set up texture render program with same uniforms
-    glUseProgram(texture_render_program.shader_program);
-    glActiveTexture(GL_TEXTURE0);
-    glUniformMatrix4fv(texture_render_program.view_uniform_location,1,0, &view.data[0][0]);  
-    glUniform3fv(texture_render_program.view_position_uniform_location,1, &camera_position.data[0]); 
-    glUniformMatrix4fv(texture_render_program.projection_uniform_location,1,0, &projection.data[0][0]);
+TexturePoolStats GlRenderer::texturePoolStats() const {
+    return texture_pool.stats();
+}
 
-    glUniformMatrix4fv(texture_render_program.shadow_uniform.light_view_location, 1,0, &lightViewProj.data[0][0]);
-    glUniform1i(texture_render_program.shadow_uniform.shadow_map_location, 1);
+void GlRenderer::setTextureBudget(const size_t bytes) {
+    texture_pool.setBudget(bytes);
+}
 
-    glUniform3fv(texture_render_program.ambient_light_uniform.color_location,1,scene.ambient_light.color.data);
-    glUniform3fv(texture_render_program.directional_light_uniform.color_location,1,scene.directional_light.color.data);
-    glUniform3fv(texture_render_program.directional_light_uniform.direction_location,1,scene.directional_light.direction.data);
-    glUniform3fv(texture_render_program.point_light_uniform.color_location,1,scene.point_light.color.data);
-    glUniform3fv(texture_render_program.point_light_uniform.position_location,1,scene.point_light.position.data);
-    glUniform1f(texture_render_program.point_light_uniform.constant_location,scene.point_light.constant);
-    glUniform1f(texture_render_program.point_light_uniform.linear_location,scene.point_light.linear);
-    glUniform1f(texture_render_program.point_light_uniform.quadratic_location,scene.point_light.quadratic); 
+LodSettings& GlRenderer::lodSettings() {
+    return lod_settings;
+}
 
-    // Draw texture material meshes
-    for (size_t i = 0; i < scene.nodes.size(); i++) {
-        drawSceneNodeTexture(scene.nodes[i], texture_render_program);
-    }
+UploadBudget& GlRenderer::uploadBudget() {
+    return upload_budget;
+}
 
-   
+UploadStats GlRenderer::uploadStats() const {
+    return upload_stats;
 }
 
+void GlRenderer::releaseNode(SceneNode* node) {
+
+    if (node->mesh.has_value()) {
+        Mesh& mesh = node->mesh.value();
+        geometry_pool.release(mesh);
 
+        // a texture nothing else samples any more is deleted at the start of the next frame
+        materialTable().releaseMaterial(mesh.material);
+        mesh.material = {};
+    }
 
+    for (size_t i = 0; i < node->children.size(); i++) {
+        releaseNode(node->children[i]);
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef GEOMETRY_POOL_H
+#define GEOMETRY_POOL_H
+
+#include <GLES3/gl3.h>
+
+#include "mesh.h"
+#include "mystl.hpp"
+#include "range_allocator.h"
+
+// attribute layout of a page, meshes only share a page with meshes of the same layout
+enum class VertexFormat {
+    Float,          // 3 x float position, 3 x float normal, 2 x float uv
+    QuantizedOct8,  // 4 x unorm16 position, 2 x snorm8 normal, 2 x half uv
+    QuantizedOct16  // 4 x unorm16 position, 2 x snorm16 normal, 2 x half uv
+};
+
+VertexFormat vertexFormat(const Mesh& mesh);
+
+// one set of big attribute/index buffers behind a single vao.
+// every mesh allocated in the page is drawn with a base vertex and first index
+typedef struct GeometryPage {
+    VertexFormat format;
+    GLuint vao;
+    GLuint position_vbo;
+    GLuint normal_vbo;
+    GLuint uv_vbo;
+    GLuint ebo;
+    RangeAllocator vertices;
+    RangeAllocator indices;
+} GeometryPage;
+
+typedef struct GeometryPoolStats {
+    size_t pages;
+    size_t vertex_capacity;
+    size_t vertices_used;
+    size_t index_capacity;
+    size_t indices_used;
+    float vertex_fragmentation; // worst page
+    float index_fragmentation;  // worst page
+} GeometryPoolStats;
+
+// what was drawn out of the pool since the last resetDrawCounters
+typedef struct DrawCounters {
+    size_t draw_calls;
+    size_t triangles;
+    size_t texture_binds; // filled in by GlRenderer, the pool doesn't bind textures
+} DrawCounters;
+
+class GeometryPool {
+
+    private:
+        DArray<GeometryPage> pages;
+        GLuint bound_vao;
+        DrawCounters counters;
+
+        size_t createPage(VertexFormat format, size_t vertex_capacity, size_t index_capacity);
+
+    public:
+        GeometryPool();
+
+        // copies the mesh into the pool and sets mesh.id / mesh.slice
+        void upload(Mesh& mesh);
+        void release(Mesh& mesh);
+
+        // binds the page vao unless it is already bound
+        void bind(const Mesh& mesh);
+        // forget the cached binding, call whenever someone else may have touched the vao binding
+        void resetBinding();
+
+        GeometryPoolStats stats() const;
+
+        void countDraw(size_t triangles);
+        void resetDrawCounters();
+        DrawCounters drawCounters() const;
+};
+
+// draw the mesh out of its pool page, lod 0 is the full mesh and n is mesh.lod.levels[n - 1]
+void drawPooledMesh(GeometryPool& pool, const Mesh& mesh, size_t lod = 0);
+
+#endif //GEOMETRY_POOL_H
@@ -2,28 +2,87 @@
 #define GL_RENDERER_H
 
 #include "sdl_state.h"
+#include "texture_pool.h"
 
 WindowState initWindow(const char* title);
 
+typedef struct LodSettings {
+    bool enabled;
+    float max_pixel_error;        // screen space error the camera pass accepts before dropping a level
+    float shadow_max_pixel_error; // shadow casters can get away with coarser levels
+} LodSettings;
+
+// how much uploading a single frame may do, whatever is left over waits for the next frame.
+// at least one mesh or texture goes up every frame so a single big asset can't stall forever
+typedef struct UploadBudget {
+    double milliseconds;
+    size_t bytes;
+} UploadBudget;
+
+// what the upload stage did in the last frame
+typedef struct UploadStats {
+    size_t meshes;
+    size_t textures;
+    size_t bytes;
+    double milliseconds;
+    size_t waiting; // meshes still not on the gpu
+} UploadStats;
+
 class GlRenderer {  
       
     private:             
         BasicColorRenderProgram basic_color_render_program;
         TextureRenderProgram texture_render_program;
+        BasicColorRenderProgram quantized_basic_color_render_program;
+        TextureRenderProgram quantized_texture_render_program;
 
         // Shadow map setup
         ShadowMap shadow_map;
         ShadowRenderProgram shadow_render_program;
+        ShadowRenderProgram quantized_shadow_render_program;
+
+        // every mesh is sub-allocated out of these shared buffers
+        GeometryPool geometry_pool;
+        // and every texture is a layer of one of these array textures
+        TexturePool texture_pool;
+
+        LodSettings lod_settings;
+
+        UploadBudget upload_budget;
+        UploadStats upload_stats;
 
+        // materials only carry their wrap modes, the samplers for them are shared
+        SamplerCache sampler_cache;
+        size_t texture_binds; // last frame's
+
+        // uploads textures and meshes that aren't on the gpu yet, within upload_budget
+        void uploadPending(const Scene& scene);
 
     public:
         GlRenderer();
+        // per frame lists come out of the calling thread's frame arena, reset it once the frame is done
         void drawGl(
                 WindowState window, 
                 Camera camera, 
-                Scene scene 
+                const Scene& scene 
             );
 
+        GeometryPoolStats geometryPoolStats() const;
+        TexturePoolStats texturePoolStats() const;
+        // gpu memory the textures in use may take before idle ones lose their top level, 0 for no limit
+        void setTextureBudget(size_t bytes);
+
+        // draw calls, triangles and texture binds of the last frame
+        DrawCounters drawCounters() const;
+
+        LodSettings& lodSettings();
+
+        UploadBudget& uploadBudget();
+        UploadStats uploadStats() const;
+
+        // gives back the geometry and materials of a node tree that has been taken out of the scene
+        void releaseNode(SceneNode* node);
+
 };
 
 
@@ -0,0 +1,60 @@
+#ifndef PIXEL_UPLOAD_RING_H
+#define PIXEL_UPLOAD_RING_H
+
+#include <GLES3/gl3.h>
+#include <stddef.h>
+#include <optional>
+
+#include "mystl.hpp"
+
+typedef struct PixelUploadRingStats {
+    size_t capacity;
+    size_t in_flight;       // bytes the gpu may still be reading
+    size_t frames_in_flight;
+    size_t direct_uploads;  // too big for the ring, since the start
+    size_t full;            // uploads that had to wait because the ring was full, since the start
+} PixelUploadRingStats;
+
+// One GL_PIXEL_UNPACK_BUFFER used as a ring. Pixels are copied into a range of it and the texture
+// upload reads them from there, so glTexSubImage returns right away and the gpu pulls the data in
+// on its own time instead of the driver copying it out of our memory inside the call. Each frame's
+// ranges are fenced, a range is only handed out again once the gpu has passed its fence, and the
+// ring never waits: when it is full the caller tries again next frame
+class PixelUploadRing {
+
+    private:
+        typedef struct InFlight {
+            GLsync fence;
+            size_t end; // everything before this (since the last retired frame) is free once fence is
+        } InFlight;
+
+        GLuint buffer;
+        size_t capacity;
+        size_t head;  // where the next range starts
+        size_t tail;  // where the oldest range still in flight starts
+        size_t frame_bytes;
+        DArray<InFlight> in_flight;
+        size_t direct_uploads;
+        size_t full;
+
+        void retire();
+
+    public:
+        PixelUploadRing();
+
+        // copies bytes into the ring and leaves the buffer bound to GL_PIXEL_UNPACK_BUFFER, the returned
+        // offset goes where glTexSubImage wants its pixel pointer. nullopt if the ring has no room this
+        // frame, nothing is bound then
+        std::optional<size_t> stage(const void* data, size_t bytes);
+
+        // whether bytes could ever go through the ring, larger uploads have to be made directly
+        bool fits(size_t bytes) const;
+        void countDirectUpload();
+
+        // fences everything staged since the last call, once a frame after its uploads
+        void endFrame();
+
+        PixelUploadRingStats stats() const;
+};
+
+#endif //PIXEL_UPLOAD_RING_H
@@ -7,11 +7,24 @@
 #include "mesh.h"
 #include <string>
 #include "mystl.hpp"
+#include "geometry_pool.h"
+#include "mesh_lod.h"
 
 GLuint guaranteeUniformLocation(const GLuint program, const GLchar *name);
 
+// compiles a shader, injecting `defines` straight after its #version line
+GLuint compileShader(GLenum type, const GLchar *source, const char *defines);
+
 // Texture functions
-GLuint createGLTextureFromData(const TextureData& data);
+// textures are uploaded into layers of the TexturePool's array textures (see texture_pool.h),
+// the wrap modes aren't part of them, they are sampler state (see SamplerCache)
+
+// one GL sampler object per pair of wrap modes, made the first time a material asks for it
+typedef struct SamplerCache {
+      GLuint samplers[4][4];
+} SamplerCache;
+
+GLuint samplerFor(SamplerCache& cache, WrapMode wrap_u, WrapMode wrap_v);
 
 typedef struct MaterialUniform {
       GLuint color_location;
@@ -43,8 +56,15 @@ typedef struct ShadowUniform {
 
 typedef struct TextureUniform {
       GLuint sampler_location;
+      GLuint layer_location;
 } TextureUniform;
 
+// only present in the QUANTIZED_VERTICES shader variants
+typedef struct QuantizationUniform {
+      GLuint position_min_location;
+      GLuint position_extent_location;
+} QuantizationUniform;
+
 typedef struct BasicColorRenderProgram  {
     GLuint shader_program;
     GLuint world_matrix_uniform_location;
@@ -56,6 +76,8 @@ typedef struct BasicColorRenderProgram  {
     DirectionalLightUniform directional_light_uniform;
     PointLightUniform point_light_uniform;
     ShadowUniform shadow_uniform;
+    bool quantized_vertices;
+    QuantizationUniform quantization_uniform;
 } BasicColorRenderProgram;
 
 typedef struct TextureRenderProgram {
@@ -70,6 +92,8 @@ typedef struct TextureRenderProgram {
     PointLightUniform point_light_uniform;
     ShadowUniform shadow_uniform;
     TextureUniform texture_uniform;
+    bool quantized_vertices;
+    QuantizationUniform quantization_uniform;
 } TextureRenderProgram;
 
 typedef struct AttributeBinding {
@@ -77,16 +101,21 @@ typedef struct AttributeBinding {
       int location;
 } AttributeBinding;
 
-BasicColorRenderProgram initShader(void);
+BasicColorRenderProgram initShader(bool quantized_vertices);
+
+TextureRenderProgram initTextureShader(bool quantized_vertices);
 
-TextureRenderProgram initTextureShader(void);
+QuantizationUniform initQuantizationUniform(GLuint program, bool quantized_vertices);
+
+// sets the dequantization uniforms for a compressed mesh, does nothing for float meshes
+void setQuantizationUniforms(const QuantizationUniform& uniform, const Mesh& mesh);
 
 typedef struct GlState {
     DArray<GLuint> vaos;
 } GlState;
 
 
-void initMesh(Mesh &mesh);
+void initMesh(Mesh &mesh, GeometryPool &pool);
 
 typedef struct ShadowMap {
       GLuint depthTexture;
@@ -101,18 +130,36 @@ typedef struct ShadowRenderProgram {
         GLuint program;
         GLuint u_model;
         GLuint u_lightViewProj;
+        bool quantized_vertices;
+        QuantizationUniform quantization_uniform;
 } ShadowRenderProgram;
 
-ShadowRenderProgram initShadowRenderProgram();
+ShadowRenderProgram initShadowRenderProgram(bool quantized_vertices);
+
+// a material's uniforms, texture and sampler, set once for every mesh drawn with it. The program has to be in use
+void bindBasicColorMaterial(const BasicColorMaterial& material, const BasicColorRenderProgram& render_program);
+
+// the array texture and sampler a run of texture materials share, on unit 0. array 0 draws untextured
+void bindTextureArray(GLuint array, GLuint sampler, const TextureRenderProgram& render_program);
+
+// just uniforms, meshes sampling different layers of the bound array need no rebinding
+void bindTextureMaterial(const BasicTextureMaterial& material, uint32_t layer, const TextureRenderProgram& render_program);
+
+// these draw just the one node, not its children, with whatever material is bound.
+// GlRenderer::drawGl collects the nodes into a draw list sorted by material first
 
-void drawSceneNodeBasicColor(SceneNode* scene_node, BasicColorRenderProgram basic_color_render_program);
+void drawSceneNodeBasicColor(SceneNode* scene_node, BasicColorRenderProgram basic_color_render_program, GeometryPool& pool,
+                             const LodSelection& lod_selection);
 
-void drawSceneNodeTexture(SceneNode* scene_node, TextureRenderProgram basic_color_render_program);
+void drawSceneNodeTexture(SceneNode* scene_node, TextureRenderProgram basic_color_render_program, GeometryPool& pool,
+                          const LodSelection& lod_selection);
 
 void drawSceneNodeShadow(
     SceneNode* node,
     ShadowRenderProgram shadowProgram,
-    Mat4 lightViewProj
+    Mat4 lightViewProj,
+    GeometryPool& pool,
+    const LodSelection& lod_selection
 );
 
 #endif //RENDER_PROGRAM_H
\ No newline at end of file
@@ -0,0 +1,99 @@
+#ifndef TEXTURE_POOL_H
+#define TEXTURE_POOL_H
+
+#include <GLES3/gl3.h>
+#include <stdint.h>
+#include <optional>
+
+#include "material.h"
+#include "material_table.h"
+#include "mystl.hpp"
+#include "pixel_upload_ring.h"
+
+// one GL_TEXTURE_2D_ARRAY with immutable storage, every layer has the same size and format.
+// textures only share a page with textures of the same width, height and channel count
+typedef struct TexturePage {
+    GLuint array;
+    int width;
+    int height;
+    int channels;
+    GLsizei levels;
+    uint32_t layer_count;
+    uint32_t next_layer;          // layers from here on have never been handed out
+    DArray<uint32_t> free_layers; // released ones below next_layer
+    DArray<uint64_t> last_used;   // per layer, the frame it was last drawn in, LAYER_UNUSED for free ones
+    bool needs_mipmaps;           // got a layer without its mips since the last generatePendingMipmaps
+} TexturePage;
+
+typedef struct TexturePoolStats {
+    size_t pages;
+    size_t layers;
+    size_t layers_used;
+    size_t bytes;      // of every page's storage, mips included
+    size_t used_bytes; // of the layers in use, what the budget is held against
+    size_t budget;
+    size_t shrunk;     // layers moved down a level to stay within the budget, since the start
+    PixelUploadRingStats upload_ring;
+} TexturePoolStats;
+
+// a layer the pool moved a texture out of, and the layer it is in now
+typedef struct TextureMove {
+    TextureLayer from;
+    TextureLayer to;
+} TextureMove;
+
+// Every uploaded texture is a layer of an array texture, so the renderer binds a page once and meshes
+// sampling any of its layers only differ in a layer uniform. A format's first page is small and each
+// further one doubles, up to PAGE_MAX_LAYERS or PAGE_MAX_BYTES, so a lone texture doesn't reserve
+// room for dozens. Pages whose layers have all been released are deleted.
+//
+// Layers are immutable storage, so a texture over the budget loses its top level by moving: its
+// lower levels are blitted into a layer of the page half its size and the old layer is freed. Only
+// layers no draw has used for EVICT_AFTER_FRAMES frames go, least recently used first
+class TexturePool {
+
+    private:
+        DArray<TexturePage> pages;
+        size_t budget;
+        uint64_t frame;
+        size_t shrunk;
+        GLuint read_framebuffer;
+        GLuint draw_framebuffer;
+        // every upload that fits goes through it
+        PixelUploadRing upload_ring;
+
+        size_t createPage(int width, int height, int channels, uint32_t layer_count);
+        // a free layer in a page of this format, making a page if none has room
+        TextureLayer allocateLayer(int width, int height, int channels);
+        TexturePage* page(GLuint array);
+        TextureLayer shrink(TextureLayer layer);
+
+    public:
+        TexturePool();
+
+        // copies the pixels into a free layer of a page of their format, every level the data has.
+        // nullopt if the upload ring is full this frame, the texture has to wait for a later one
+        std::optional<TextureLayer> upload(const TextureData& data);
+        void release(TextureLayer layer);
+
+        // once a frame after its uploads, fences them so their part of the ring can be reused
+        void endUploads();
+
+        // mips of every page that got a layer without them since the last call, once per page
+        void generatePendingMipmaps();
+
+        // the layer is sampled this frame
+        void markUsed(TextureLayer layer);
+
+        // once a frame, moves the least recently used layers down a level while the layers in use
+        // are over the budget. The caller points the textures at the new layers and releases the
+        // old ones (see MaterialTable::textureMoved)
+        DArray<TextureMove> shrinkToBudget();
+
+        // 0 for no limit
+        void setBudget(size_t bytes);
+
+        TexturePoolStats stats() const;
+};
+
+#endif //TEXTURE_POOL_H
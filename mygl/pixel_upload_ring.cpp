@@ -0,0 +1,116 @@
+#include "pixel_upload_ring.h"
+
+#include <string.h>
+
+// a few frames of the default upload budget, and a 2048x2048 rgba texture with its mips in one go
+constexpr size_t RING_BYTES = 32 * 1024 * 1024;
+// ranges start here so the copy into them runs on aligned stores
+constexpr size_t RANGE_ALIGNMENT = 64;
+
+PixelUploadRing::PixelUploadRing()
+    : buffer(0), capacity(RING_BYTES), head(0), tail(0), frame_bytes(0), direct_uploads(0), full(0) {}
+
+void PixelUploadRing::retire() {
+    while (in_flight.size() > 0) {
+        const GLenum status = glClientWaitSync(in_flight[0].fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        tail = in_flight[0].end;
+        glDeleteSync(in_flight[0].fence);
+        in_flight.erase(0);
+    }
+
+    // nothing in flight or waiting to be fenced, start over at the front rather than wrapping later
+    if (in_flight.size() == 0 && frame_bytes == 0) {
+        head = 0;
+        tail = 0;
+    }
+}
+
+bool PixelUploadRing::fits(const size_t bytes) const {
+    // strictly less, a ring with head on tail reads as empty
+    return bytes + RANGE_ALIGNMENT < capacity;
+}
+
+void PixelUploadRing::countDirectUpload() {
+    direct_uploads++;
+}
+
+std::optional<size_t> PixelUploadRing::stage(const void* data, const size_t bytes) {
+
+    if (buffer == 0) {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    retire();
+
+    // free space is [head, capacity) and [0, tail) while head is ahead of tail, [head, tail) once it wrapped.
+    // head never catches up with tail, that only happens when the ring is empty
+    const size_t start = (head + RANGE_ALIGNMENT - 1) / RANGE_ALIGNMENT * RANGE_ALIGNMENT;
+    std::optional<size_t> offset;
+    if (head >= tail) {
+        if (start + bytes <= capacity) {
+            offset = start;
+        } else if (bytes < tail) {
+            // the end of the buffer goes unused this time round
+            offset = 0;
+        }
+    } else if (start + bytes < tail) {
+        offset = start;
+    }
+
+    if (!offset.has_value()) {
+        full++;
+        return std::nullopt;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    // unsynchronized, the fences already keep us off ranges the gpu is still reading
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, static_cast<GLintptr>(offset.value()),
+                                    static_cast<GLsizeiptr>(bytes),
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (mapped == nullptr) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return std::nullopt;
+    }
+    memcpy(mapped, data, bytes);
+    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+        // the contents got lost (a mode switch or similar), nothing was handed out, try again next frame
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return std::nullopt;
+    }
+
+    frame_bytes += bytes;
+    head = offset.value() + bytes;
+    return offset;
+}
+
+void PixelUploadRing::endFrame() {
+    if (frame_bytes == 0) {
+        return;
+    }
+    in_flight.push_back({
+        .fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0),
+        .end = head,
+    });
+    frame_bytes = 0;
+}
+
+PixelUploadRingStats PixelUploadRing::stats() const {
+    // head and tail only meet when nothing is in flight
+    size_t used = 0;
+    if (in_flight.size() > 0 || frame_bytes > 0) {
+        used = head > tail ? head - tail : capacity - tail + head;
+    }
+    return {
+        .capacity = capacity,
+        .in_flight = used,
+        .frames_in_flight = in_flight.size(),
+        .direct_uploads = direct_uploads,
+        .full = full,
+    };
+}
@@ -2,10 +2,12 @@
 #include "loaders.h"
 #include "mesh.h"
 #include "mystl.hpp"
+#include "vertex_compression.h"
 
 #include <stddef.h>
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 
 GLuint guaranteeUniformLocation(const GLuint program, const GLchar *name) {
@@ -14,78 +16,51 @@ GLuint guaranteeUniformLocation(const GLuint program, const GLchar *name) {
     return location;
 }
 
+GLuint compileShader(const GLenum type, const GLchar *source, const char *defines) {
 
+    // #version has to stay the first thing in the shader, so split the source after it
+    const char* version = strstr(source, "#version");
+    const char* body = version ? strchr(version, '\n') : nullptr;
+    body = body ? body + 1 : source;
 
-void initMesh(Mesh  &mesh) {
+    const GLchar* sources[3] = { source, defines, body };
+    const GLint lengths[3] = { static_cast<GLint>(body - source), -1, -1 };
 
-    if (mesh.id.has_value()) {
-        printf("mesh is already init, you shouldn't be trying to reinit it\n");
-        
-    } else {
-
-     // sanity check
-    assert(mesh.vertices.vertex_count >= 3 && "vertex_count must be >= 3");
-
-    // setup vao
-    GLuint vao;
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+    const GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 3, sources, lengths);
+    glCompileShader(shader);
 
+    return shader;
+}
 
-    // Create vertex buffer object and copy vertex data into it
-    GLuint vbo;
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float)*mesh.vertices.vertex_count*3, 
-                 mesh.vertices.positions.begin(), GL_STATIC_DRAW);
-
-    // Specify the layout of the shader vertex data (positions only, 3 floats)
-    GLint posAttrib = 0;
-    glEnableVertexAttribArray(posAttrib);
-    glVertexAttribPointer(posAttrib, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    GLuint vbo_norm;
-    glGenBuffers(1, &vbo_norm);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_norm);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float)*mesh.vertices.vertex_count*3, 
-                 mesh.vertices.normals.begin(), GL_STATIC_DRAW);
-
-    // Specify the layout of the shader vertex data (normals only, 3 floats)
-    
-    GLint normAttrib = 1;
-    glEnableVertexAttribArray(normAttrib);
-    glVertexAttribPointer(normAttrib, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    if (std::holds_alternative<BasicTextureMaterial>(mesh.material)) {
-        BasicTextureMaterial& texMat = std::get<BasicTextureMaterial>(mesh.material);
-        if (texMat.uvMap.size() > 0) {
-            GLuint vbo_uv;
-            glGenBuffers(1, &vbo_uv);
-            glBindBuffer(GL_ARRAY_BUFFER, vbo_uv);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(float) * texMat.uvMap.size(), 
-                        texMat.uvMap.begin(), GL_STATIC_DRAW);
-
-            GLint uvAttrib = 2;
-            glEnableVertexAttribArray(uvAttrib);
-            glVertexAttribPointer(uvAttrib, 2, GL_FLOAT, GL_FALSE, 0, 0);
-        }
+QuantizationUniform initQuantizationUniform(const GLuint program, const bool quantized_vertices) {
+    if (!quantized_vertices) {
+        // -1 locations are silently ignored by glUniform*
+        return { static_cast<GLuint>(-1), static_cast<GLuint>(-1) };
     }
+    return {
+        .position_min_location = guaranteeUniformLocation(program, "u_position_min"),
+        .position_extent_location = guaranteeUniformLocation(program, "u_position_extent"),
+    };
+}
 
-    // If we have indices, create an element array buffer bound to the VAO
-    if (mesh.vertices.index_count > 0) {
-        GLuint ebo;
-        glGenBuffers(1, &ebo);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * mesh.vertices.index_count,
-                     mesh.vertices.indices.begin(), GL_STATIC_DRAW);
+void setQuantizationUniforms(const QuantizationUniform& uniform, const Mesh& mesh) {
+    if (!hasCompressedVertices(mesh)) {
+        return;
     }
+    const CompressedVertices& compressed = mesh.vertices.compressed.value();
+    glUniform3fv(uniform.position_min_location, 1, compressed.position_min.data);
+    glUniform3fv(uniform.position_extent_location, 1, compressed.position_extent.data);
+}
 
-    // unbind array buffer (but keep EBO bound to VAO) and VAO to avoid accidental state changes
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
 
-    mesh.id = vao;
 
+void initMesh(Mesh &mesh, GeometryPool &pool) {
+
+    if (mesh.id.has_value()) {
+        printf("mesh is already init, you shouldn't be trying to reinit it\n");
+    } else {
+        pool.upload(mesh);
     }
 
 }
@@ -130,7 +105,7 @@ ShadowMap createShadowMap() {
     return { depthTexture, framebuffer, size };
 }
 
-ShadowRenderProgram initShadowRenderProgram() {
+ShadowRenderProgram initShadowRenderProgram(const bool quantized_vertices) {
 
     DArray<AttributeBinding> attribBindings;
     
@@ -140,9 +115,8 @@ ShadowRenderProgram initShadowRenderProgram() {
     const GLchar* fragmentSource = get_shader_content("./shaders/depth-only.frag");
 
     // Create and compile vertex shader
-    const GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexSource, nullptr);
-    glCompileShader(vertexShader);
+    const GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource,
+        quantized_vertices ? "#define QUANTIZED_VERTICES\n" : "");
 
     // Create and compile fragment shader
     const GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
@@ -172,55 +146,34 @@ ShadowRenderProgram initShadowRenderProgram() {
         .program = program,
         .u_model = guaranteeUniformLocation(program, "u_model"),
         .u_lightViewProj = guaranteeUniformLocation(program, "u_lightViewProj"),
+        .quantized_vertices = quantized_vertices,
+        .quantization_uniform = initQuantizationUniform(program, quantized_vertices),
     };
 }
 
 void drawSceneNodeShadow(
     SceneNode* node,
     const ShadowRenderProgram shadowProgram,
-    Mat4 lightViewProj
+    Mat4 lightViewProj,
+    GeometryPool& pool,
+    const LodSelection& lod_selection
 ) {
       
    
-    if (node->mesh.has_value()) {
+    if (node->mesh.has_value() && hasCompressedVertices(node->mesh.value()) == shadowProgram.quantized_vertices &&
+        node->mesh.value().id.has_value()) {
 
         Mesh &mesh = node->mesh.value();
-        // check if the mesh has been initialized and init if not
-        if (mesh.id.has_value()) {
-            // draw this mesh
-            glUseProgram(shadowProgram.program);
-        
-            glUniformMatrix4fv(shadowProgram.u_model,1,0, &node->world_transform.data[0][0]);
-            glUniformMatrix4fv(shadowProgram.u_lightViewProj,1,0, &lightViewProj.data[0][0]);
-
-            glBindVertexArray(mesh.id.value());
-            // Draw the vertex buffer using indices if available
-            if (mesh.vertices.index_count > 0) {
-                glDrawElements(GL_TRIANGLES, (GLsizei)mesh.vertices.index_count, GL_UNSIGNED_INT, 0);
-            } else {
-                glDrawArrays(GL_TRIANGLES, 0, mesh.vertices.vertex_count);
-            }
-        } else {
-            // Initialize the mesh and store it back in the node
-            initMesh(mesh);
-            // draw mesh
-            glUseProgram(shadowProgram.program);
-        
-            glUniformMatrix4fv(shadowProgram.u_model,1,0, &node->world_transform.data[0][0]);
-            glUniformMatrix4fv(shadowProgram.u_lightViewProj,1,0, &lightViewProj.data[0][0]);
-  
-            glBindVertexArray(mesh.id.value());
-            // Draw the vertex buffer using indices if available
-            if (mesh.vertices.index_count > 0) {
-                glDrawElements(GL_TRIANGLES, (GLsizei)mesh.vertices.index_count, GL_UNSIGNED_INT, 0);
-            } else {
-                glDrawArrays(GL_TRIANGLES, 0, mesh.vertices.vertex_count);
-            }
-        }
-    }
+
+        // draw this mesh
+        glUseProgram(shadowProgram.program);
     
-    for (size_t i = 0; i < node->children.size(); i++) {
-               drawSceneNodeShadow(node->children[i], shadowProgram, lightViewProj);
+        const Mat4 world_matrix = toMat4(node->world_transform);
+        glUniformMatrix4fv(shadowProgram.u_model,1,0, &world_matrix.data[0][0]);
+        glUniformMatrix4fv(shadowProgram.u_lightViewProj,1,0, &lightViewProj.data[0][0]);
+        setQuantizationUniforms(shadowProgram.quantization_uniform, mesh);
+
+        drawPooledMesh(pool, mesh, selectMeshLod(mesh, node->world_transform, lod_selection));
     }
 
 }
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include "texture_pool.h"
+
+#include <algorithm>
+#include <optional>
+#include <stdio.h>
+
+#include "texture_mips.h"
+
+// a format's first page, later ones double until they hit either cap
+constexpr uint32_t PAGE_FIRST_LAYERS = 4;
+constexpr uint32_t PAGE_MAX_LAYERS = 64; // GLES3 guarantees 256
+constexpr size_t PAGE_MAX_BYTES = 64 * 1024 * 1024;
+
+constexpr size_t DEFAULT_TEXTURE_BUDGET = 256 * 1024 * 1024;
+// a few seconds at 60 fps, long enough that looking away briefly doesn't cost a texture its top level
+constexpr uint64_t EVICT_AFTER_FRAMES = 300;
+// every move is a blit per level, a handful a frame keeps them from showing up as a hitch
+constexpr size_t MAX_SHRINKS_PER_FRAME = 2;
+constexpr uint64_t LAYER_UNUSED = UINT64_MAX;
+
+typedef struct PixelFormat {
+    GLenum internal_format;
+    GLenum format;
+} PixelFormat;
+
+static PixelFormat pixelFormat(const int channels) {
+    switch (channels) {
+        case 1: return { GL_R8, GL_RED };
+        case 2: return { GL_RG8, GL_RG };
+        case 3: return { GL_RGB8, GL_RGB };
+        case 4:
+        default: return { GL_RGBA8, GL_RGBA };
+    }
+}
+
+// level 0 and every mip below it
+static size_t layerBytes(const int width, const int height, const int channels) {
+    return mipLevelOffset(width, height, channels, mipLevelCount(width, height));
+}
+
+TexturePool::TexturePool() : budget(DEFAULT_TEXTURE_BUDGET), frame(0), shrunk(0), read_framebuffer(0), draw_framebuffer(0) {}
+
+TexturePage* TexturePool::page(const GLuint array) {
+    for (TexturePage& page : pages) {
+        if (page.array == array) {
+            return &page;
+        }
+    }
+    return nullptr;
+}
+
+size_t TexturePool::createPage(const int width, const int height, const int channels, const uint32_t layer_count) {
+
+    const PixelFormat format = pixelFormat(channels);
+
+    TexturePage page = {
+        .array = 0,
+        .width = width,
+        .height = height,
+        .channels = channels,
+        .levels = mipLevelCount(width, height),
+        .layer_count = layer_count,
+        .next_layer = 0,
+        .free_layers = {},
+        .last_used = DArray<uint64_t>(layer_count, LAYER_UNUSED),
+        .needs_mipmaps = false,
+    };
+
+    glGenTextures(1, &page.array);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, page.array);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, page.levels, format.internal_format, width, height, layer_count);
+
+    // the wrap modes and filtering come from the sampler a material binds
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // grey and grey + alpha images read as grey, not red
+    if (channels == 1 || channels == 2) {
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_G, GL_RED);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_B, GL_RED);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_A, channels == 2 ? GL_GREEN : GL_ONE);
+    }
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    pages.push_back(page);
+    return pages.size() - 1;
+}
+
+TextureLayer TexturePool::allocateLayer(const int width, const int height, const int channels) {
+
+    // first page of the format with a free layer, released ones before fresh ones
+    size_t page_index = pages.size();
+    uint32_t page_layers = 0;
+    for (size_t i = 0; i < pages.size(); i++) {
+        const TexturePage& page = pages[i];
+        if (page.width != width || page.height != height || page.channels != channels) {
+            continue;
+        }
+        page_layers = std::max(page_layers, page.layer_count);
+        if (page.free_layers.size() > 0 || page.next_layer < page.layer_count) {
+            page_index = i;
+            break;
+        }
+    }
+
+    if (page_index == pages.size()) {
+        const size_t bytes = layerBytes(width, height, channels);
+        const uint32_t by_bytes = static_cast<uint32_t>(std::max<size_t>(PAGE_MAX_BYTES / std::max<size_t>(bytes, 1), 1));
+        const uint32_t layer_count = std::min({ std::max(PAGE_FIRST_LAYERS, page_layers * 2), PAGE_MAX_LAYERS, by_bytes });
+        page_index = createPage(width, height, channels, layer_count);
+    }
+
+    TexturePage& page = pages[page_index];
+    uint32_t layer;
+    if (page.free_layers.size() > 0) {
+        layer = page.free_layers[page.free_layers.size() - 1];
+        page.free_layers.pop_back();
+    } else {
+        layer = page.next_layer++;
+    }
+    // a new layer counts as used, it's about to be drawn
+    page.last_used[layer] = frame;
+
+    return { .array = page.array, .layer = layer };
+}
+
+std::optional<TextureLayer> TexturePool::upload(const TextureData& data) {
+
+    if (data.pixels == nullptr) {
+        return TextureLayer{};
+    }
+
+    const int levels = std::min(std::max(data.levels, 1), mipLevelCount(data.width, data.height));
+    const size_t bytes = mipLevelOffset(data.width, data.height, data.channels, levels);
+
+    // staged before a layer is taken, so a full ring leaves nothing to undo. With the ring bound the
+    // pixel pointers below are offsets into it, a texture too big for it goes straight from our memory
+    std::optional<size_t> staged;
+    if (upload_ring.fits(bytes)) {
+        staged = upload_ring.stage(data.pixels, bytes);
+        if (!staged.has_value()) {
+            return std::nullopt;
+        }
+    } else {
+        upload_ring.countDirectUpload();
+    }
+    const uintptr_t source = staged.has_value() ? staged.value() : reinterpret_cast<uintptr_t>(data.pixels);
+
+    const TextureLayer layer = allocateLayer(data.width, data.height, data.channels);
+    TexturePage* target = page(layer.array);
+
+    const PixelFormat format = pixelFormat(data.channels);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, layer.array);
+    // rgb and grey rows aren't 4 byte aligned for most widths
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int level = 0; level < levels; level++) {
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, static_cast<GLint>(layer.layer),
+                        mipExtent(data.width, level), mipExtent(data.height, level), 1, format.format, GL_UNSIGNED_BYTE,
+                        reinterpret_cast<const void*>(source + mipLevelOffset(data.width, data.height, data.channels, level)));
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    // imgui uploads its font from client memory, it mustn't find the ring bound
+    if (staged.has_value()) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    // pixels that came without their mips. glGenerateMipmap redoes the whole page, the other layers'
+    // precomputed mips get replaced by the driver's, which is only a filtering difference
+    if (levels < target->levels) {
+        target->needs_mipmaps = true;
+    }
+    return layer;
+}
+
+void TexturePool::release(const TextureLayer layer) {
+
+    for (size_t i = 0; i < pages.size(); i++) {
+        TexturePage& page = pages[i];
+        if (page.array != layer.array) {
+            continue;
+        }
+
+        page.free_layers.push_back(layer.layer);
+        page.last_used[layer.layer] = LAYER_UNUSED;
+        if (page.free_layers.size() == page.next_layer) {
+            // nothing left in it, the memory goes back rather than waiting for a texture of this size
+            glDeleteTextures(1, &page.array);
+            pages.erase(i);
+        }
+        return;
+    }
+
+    printf("released a texture layer that isn't in the texture pool\n");
+}
+
+void TexturePool::endUploads() {
+    upload_ring.endFrame();
+}
+
+void TexturePool::generatePendingMipmaps() {
+    for (TexturePage& page : pages) {
+        if (page.needs_mipmaps) {
+            glBindTexture(GL_TEXTURE_2D_ARRAY, page.array);
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+            page.needs_mipmaps = false;
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TexturePool::markUsed(const TextureLayer layer) {
+    TexturePage* target = page(layer.array);
+    if (target != nullptr) {
+        target->last_used[layer.layer] = frame;
+    }
+}
+
+TextureLayer TexturePool::shrink(const TextureLayer layer) {
+
+    const TexturePage* source = page(layer.array);
+    const int width = source->width;
+    const int height = source->height;
+    const uint64_t last_used = source->last_used[layer.layer];
+
+    // can make a page and move the others around, source is looked up again after
+    const TextureLayer target = allocateLayer(mipExtent(width, 1), mipExtent(height, 1), source->channels);
+    TexturePage* destination = page(target.array);
+    destination->last_used[target.layer] = last_used;
+    // the old layer no longer counts against the budget, the caller releases it
+    page(layer.array)->last_used[layer.layer] = LAYER_UNUSED;
+
+    if (read_framebuffer == 0) {
+        glGenFramebuffers(1, &read_framebuffer);
+        glGenFramebuffers(1, &draw_framebuffer);
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, read_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw_framebuffer);
+
+    // level n + 1 of the old layer is level n of the new one, no pixels go through the cpu
+    for (GLsizei level = 0; level < destination->levels; level++) {
+        glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, layer.array, level + 1,
+                                  static_cast<GLint>(layer.layer));
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target.array, level,
+                                  static_cast<GLint>(target.layer));
+        const GLint level_width = mipExtent(width, level + 1);
+        const GLint level_height = mipExtent(height, level + 1);
+        glBlitFramebuffer(0, 0, level_width, level_height, 0, 0, level_width, level_height,
+                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+
+    glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, 0, 0, 0);
+    glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, 0, 0, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    return target;
+}
+
+DArray<TextureMove> TexturePool::shrinkToBudget() {
+
+    DArray<TextureMove> moves;
+
+    while (budget > 0 && moves.size() < MAX_SHRINKS_PER_FRAME && stats().used_bytes > budget) {
+        // least recently used layer that's been idle long enough and still has a level to lose
+        std::optional<TextureLayer> oldest;
+        uint64_t oldest_frame = LAYER_UNUSED;
+        for (const TexturePage& page : pages) {
+            if (std::max(page.width, page.height) <= MIN_TRIMMED_SIZE) {
+                continue;
+            }
+            for (uint32_t layer = 0; layer < page.next_layer; layer++) {
+                const uint64_t last_used = page.last_used[layer];
+                if (last_used != LAYER_UNUSED && last_used + EVICT_AFTER_FRAMES <= frame && last_used < oldest_frame) {
+                    oldest = TextureLayer{ .array = page.array, .layer = layer };
+                    oldest_frame = last_used;
+                }
+            }
+        }
+        if (!oldest.has_value()) {
+            break;
+        }
+
+        moves.push_back({ .from = oldest.value(), .to = shrink(oldest.value()) });
+        shrunk++;
+    }
+
+    frame++;
+    return moves;
+}
+
+void TexturePool::setBudget(const size_t bytes) {
+    budget = bytes;
+}
+
+TexturePoolStats TexturePool::stats() const {
+    TexturePoolStats stats = {
+        .pages = pages.size(),
+        .budget = budget,
+        .shrunk = shrunk,
+        .upload_ring = upload_ring.stats(),
+    };
+
+    for (const auto& page : pages) {
+        const size_t bytes = layerBytes(page.width, page.height, page.channels);
+        stats.layers += page.layer_count;
+        stats.layers_used += page.next_layer - page.free_layers.size();
+        stats.bytes += bytes * page.layer_count;
+        for (uint32_t layer = 0; layer < page.next_layer; layer++) {
+            stats.used_bytes += page.last_used[layer] != LAYER_UNUSED ? bytes : 0;
+        }
+    }
+
+    return stats;
+}
@@ -1,16 +1,16 @@
 #include "render_program.h"
 #include <loaders.h>
+#include "vertex_compression.h"
 
-TextureRenderProgram initTextureShader()
+TextureRenderProgram initTextureShader(const bool quantized_vertices)
 {
 
     const GLchar* vertexSource = get_shader_content("./shaders/basic-texture.vert");
     const GLchar* fragmentSource = get_shader_content("./shaders/basic-texture.frag");
 
     // Create and compile vertex shader
-    const GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexSource, nullptr);
-    glCompileShader(vertexShader);
+    const GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource,
+        quantized_vertices ? "#define QUANTIZED_VERTICES\n" : "");
 
     // Create and compile fragment shader
     const GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
@@ -56,134 +56,66 @@ TextureRenderProgram initTextureShader()
             .light_view_location = guaranteeUniformLocation(shader_program, "u_lightViewProj"),
         },
         .texture_uniform = {
-            .sampler_location = guaranteeUniformLocation(shader_program, "mesh_texture")
-        }
+            .sampler_location = guaranteeUniformLocation(shader_program, "mesh_texture"),
+            .layer_location = guaranteeUniformLocation(shader_program, "u_texture_layer"),
+        },
+        .quantized_vertices = quantized_vertices,
+        .quantization_uniform = initQuantizationUniform(shader_program, quantized_vertices),
     }; 
 }
 
 
-void drawSceneNodeTexture(SceneNode* node, TextureRenderProgram texture_render_program) {
-
-    if (node->mesh.has_value()) {
-
-        if (std::holds_alternative<BasicTextureMaterial>(node->mesh.value().material)) {
+void bindTextureArray(const GLuint array, const GLuint sampler, const TextureRenderProgram& texture_render_program) {
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+    glBindSampler(0, sampler);
+    glUniform1i(texture_render_program.texture_uniform.sampler_location, 0);
+}
 
-        Mesh &mesh = node->mesh.value();
-        BasicTextureMaterial * material = &std::get<BasicTextureMaterial>(mesh.material);
-
-        // Create GL texture from texture data if not yet created
-        if (material->texture_id == 0 && material->texture_data.pixels != nullptr) {
-            material->texture_id = createGLTextureFromData(material->texture_data);
-        }
-
-        // check if the mesh has been initialized and init if not
-        if (mesh.id.has_value()) {
-
-            // draw this mesh with texture
-            glUseProgram(texture_render_program.shader_program);
-
-            glUniformMatrix4fv(texture_render_program.world_matrix_uniform_location,1,0, &node->world_transform.data[0][0]);
-
-            glUniform1f(texture_render_program.material_shininess_location,
-                material->shininess);
-
-            // Bind texture if loaded
-            if (material->texture_id != 0) {
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, material->texture_id);
-                glUniform1i(texture_render_program.texture_uniform.sampler_location, 0);
-            } else {
-                // printf("[DEBUG] Warning: texture_id is 0, no texture will be bound\n");
-            }
-
-            glBindVertexArray(mesh.id.value());
-            // Draw the vertex buffer using indices if available
-            if (mesh.vertices.index_count > 0) {
-                glDrawElements(GL_TRIANGLES, (GLsizei)mesh.vertices.index_count, GL_UNSIGNED_INT, 0);
-            } else {
-                glDrawArrays(GL_TRIANGLES, 0, mesh.vertices.vertex_count);
-            }
-        } else {
-            // Initialize the mesh
-            initMesh(mesh);
-
-            // Create GL texture from texture data if not yet created
-            if (material->texture_id == 0 && material->texture_data.pixels != nullptr) {
-                material->texture_id = createGLTextureFromData(material->texture_data);
-            }
-
-            // draw mesh with texture
-            glUseProgram(texture_render_program.shader_program);
-
-            glUniformMatrix4fv(texture_render_program.world_matrix_uniform_location,1,0, &node->world_transform.data[0][0]);
-
-            glUniform1f(texture_render_program.material_shininess_location,
-                material->shininess);
-
-            // Bind texture if loaded
-            if (material->texture_id != 0) {
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, material->texture_id);
-                glUniform1i(texture_render_program.texture_uniform.sampler_location, 0);
-            } else {
-                // printf("[DEBUG] Warning: texture_id is 0 (init path), no texture will be bound\n");
-            }
-
-            glBindVertexArray(mesh.id.value());
-            // Draw the vertex buffer using indices if available
-            if (mesh.vertices.index_count > 0) {
-                glDrawElements(GL_TRIANGLES, (GLsizei)mesh.vertices.index_count, GL_UNSIGNED_INT, 0);
-            } else {
-                glDrawArrays(GL_TRIANGLES, 0, mesh.vertices.vertex_count);
-            }
-        }
-
-        }
-    }
-    
-    for (size_t i = 0; i < node->children.size(); i++) {
-               drawSceneNodeTexture(node->children[i], texture_render_program);
-    }
+void bindTextureMaterial(const BasicTextureMaterial& material, const uint32_t layer,
+                         const TextureRenderProgram& texture_render_program) {
+    glUniform1f(texture_render_program.material_shininess_location, material.shininess);
+    glUniform1f(texture_render_program.texture_uniform.layer_location, static_cast<float>(layer));
 }
 
-GLuint createGLTextureFromData(const TextureData& data) {
-    if (data.pixels == nullptr) {
-        return 0;
-    }
+void drawSceneNodeTexture(SceneNode* node, TextureRenderProgram texture_render_program, GeometryPool& pool,
+                          const LodSelection& lod_selection) {
 
-    // Map our WrapMode enum to GL constants
-    auto toGLWrapMode = [](WrapMode mode) -> GLenum {
-        switch (mode) {
-            case WrapMode::Wrap:   return GL_REPEAT;
-            case WrapMode::Clamp:  return GL_CLAMP_TO_EDGE;
-            case WrapMode::Mirror: return GL_MIRRORED_REPEAT;
-            case WrapMode::Decal:  return GL_CLAMP_TO_EDGE;  // GL_CLAMP_TO_BORDER not in GLES3
-            default:               return GL_REPEAT;
-        }
-    };
+    // the texture is created before the mesh is uploaded, so an uploaded mesh has everything it needs
+    if (node->mesh.has_value() &&
+        hasCompressedVertices(node->mesh.value()) == texture_render_program.quantized_vertices &&
+        node->mesh.value().id.has_value()) {
 
-    // Create OpenGL texture
-    GLuint textureId;
-    glGenTextures(1, &textureId);
-    glBindTexture(GL_TEXTURE_2D, textureId);
+        Mesh &mesh = node->mesh.value();
 
-    // Set texture wrap modes
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, toGLWrapMode(data.wrapModeU));
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, toGLWrapMode(data.wrapModeV));
+        const Mat4 world_matrix = toMat4(node->world_transform);
+        glUniformMatrix4fv(texture_render_program.world_matrix_uniform_location,1,0, &world_matrix.data[0][0]);
 
-    // Set texture filtering
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        setQuantizationUniforms(texture_render_program.quantization_uniform, mesh);
 
-    // Determine the correct format based on channels
-    GLenum format = (data.channels == 4) ? GL_RGBA : GL_RGB;
+        drawPooledMesh(pool, mesh, selectMeshLod(mesh, node->world_transform, lod_selection));
+    }
+}
 
-    // Upload texture data
-    glTexImage2D(GL_TEXTURE_2D, 0, format, data.width, data.height, 0, format, GL_UNSIGNED_BYTE, data.pixels);
-    glGenerateMipmap(GL_TEXTURE_2D);
+static GLenum toGLWrapMode(const WrapMode mode) {
+    switch (mode) {
+        case WrapMode::Wrap:   return GL_REPEAT;
+        case WrapMode::Clamp:  return GL_CLAMP_TO_EDGE;
+        case WrapMode::Mirror: return GL_MIRRORED_REPEAT;
+        case WrapMode::Decal:  return GL_CLAMP_TO_EDGE;  // GL_CLAMP_TO_BORDER not in GLES3
+        default:               return GL_REPEAT;
+    }
+}
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+GLuint samplerFor(SamplerCache& cache, const WrapMode wrap_u, const WrapMode wrap_v) {
 
-    return textureId;
+    GLuint& sampler = cache.samplers[static_cast<size_t>(wrap_u)][static_cast<size_t>(wrap_v)];
+    if (sampler == 0) {
+        glGenSamplers(1, &sampler);
+        glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, toGLWrapMode(wrap_u));
+        glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, toGLWrapMode(wrap_v));
+        glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    return sampler;
 }
-
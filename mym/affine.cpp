@@ -0,0 +1,2 @@
+#include "affine.h"
+#include "affine.inl"
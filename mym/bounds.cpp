@@ -0,0 +1,179 @@
+#include "bounds.h"
+#include "bounds.inl"
+#include "mat4_simd.h"
+
+namespace mym {
+
+static inline Aabb boxAt(const AabbArrays& boxes, const size_t i) {
+    return (Aabb){
+        .min = (Vec3){ .x = boxes.min_x[i], .y = boxes.min_y[i], .z = boxes.min_z[i] },
+        .max = (Vec3){ .x = boxes.max_x[i], .y = boxes.max_y[i], .z = boxes.max_z[i] },
+    };
+}
+
+// every index is written and only the visible ones advance n, no branch to mispredict on a
+// half visible scene
+static inline size_t appendVisible(uint32_t* visible, size_t n, const size_t first, const int lanes, const int visible_mask) {
+    for (int lane = 0; lane < lanes; lane++) {
+        visible[n] = static_cast<uint32_t>(first + lane);
+        n += (visible_mask >> lane) & 1;
+    }
+    return n;
+}
+
+static size_t cullTail(const Frustum& frustum, const AabbArrays& boxes, size_t i, const size_t count,
+                       uint32_t* visible, size_t n) {
+    for (; i < count; i++) {
+        n = appendVisible(visible, n, i, 1, isVisible(frustum, boxAt(boxes, i)) ? 1 : 0);
+    }
+    return n;
+}
+
+static void rayTail(const Vec3 origin, const Vec3 inverse_direction, const AabbArrays& boxes, size_t i,
+                    const size_t count, float* distances) {
+    for (; i < count; i++) {
+        const FloatResult hit = rayIntersectsAabb(origin, inverse_direction, boxAt(boxes, i));
+        distances[i] = hit.valid ? hit.value : FLT_MAX;
+    }
+}
+
+#if defined(MYM_SIMD_SSE) || defined(MYM_SIMD_NEON)
+
+// the arrays the corner furthest along each plane normal comes from, the same pick isVisible makes per box
+typedef struct FurthestCorners {
+    const float* x[6];
+    const float* y[6];
+    const float* z[6];
+} FurthestCorners;
+
+static FurthestCorners furthestCorners(const Frustum& frustum, const AabbArrays& boxes) {
+    FurthestCorners corners;
+    for (int i = 0; i < 6; i++) {
+        const Vec3 normal = frustum.planes[i].normal;
+        corners.x[i] = normal.x > 0.f ? boxes.max_x : boxes.min_x;
+        corners.y[i] = normal.y > 0.f ? boxes.max_y : boxes.min_y;
+        corners.z[i] = normal.z > 0.f ? boxes.max_z : boxes.min_z;
+    }
+    return corners;
+}
+
+#endif
+
+#if defined(MYM_SIMD_SSE)
+
+size_t cullAabbs(const Frustum& frustum, const AabbArrays boxes, const size_t count, uint32_t* visible) {
+    const FurthestCorners corners = furthestCorners(frustum, boxes);
+    __m128 nx[6], ny[6], nz[6], distance[6];
+    for (int p = 0; p < 6; p++) {
+        nx[p] = _mm_set1_ps(frustum.planes[p].normal.x);
+        ny[p] = _mm_set1_ps(frustum.planes[p].normal.y);
+        nz[p] = _mm_set1_ps(frustum.planes[p].normal.z);
+        distance[p] = _mm_set1_ps(frustum.planes[p].distance);
+    }
+
+    size_t n = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < 6; p++) {
+            // summed in signedDistance's order, a box touching a plane gets the same answer
+            const __m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], _mm_loadu_ps(corners.x[p] + i)),
+                                                              _mm_mul_ps(ny[p], _mm_loadu_ps(corners.y[p] + i))),
+                                                   _mm_mul_ps(nz[p], _mm_loadu_ps(corners.z[p] + i))),
+                                        distance[p]);
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(d, _mm_setzero_ps()));
+        }
+        n = appendVisible(visible, n, i, 4, ~_mm_movemask_ps(outside));
+    }
+    return cullTail(frustum, boxes, i, count, visible, n);
+}
+
+void rayAabbDistances(const Vec3 origin, const Vec3 inverse_direction, const AabbArrays boxes, const size_t count,
+                      float* distances) {
+    const __m128 o[3] = { _mm_set1_ps(origin.x), _mm_set1_ps(origin.y), _mm_set1_ps(origin.z) };
+    const __m128 inverse[3] = { _mm_set1_ps(inverse_direction.x), _mm_set1_ps(inverse_direction.y),
+                                _mm_set1_ps(inverse_direction.z) };
+    const float* mins[3] = { boxes.min_x, boxes.min_y, boxes.min_z };
+    const float* maxs[3] = { boxes.max_x, boxes.max_y, boxes.max_z };
+    const __m128 miss = _mm_set1_ps(FLT_MAX);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // same operand order as rayIntersectsAabb, so a nan lane drops out the same way
+        __m128 enter = _mm_setzero_ps();
+        __m128 exit = miss;
+        for (int axis = 0; axis < 3; axis++) {
+            const __m128 near = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(mins[axis] + i), o[axis]), inverse[axis]);
+            const __m128 far = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(maxs[axis] + i), o[axis]), inverse[axis]);
+            enter = _mm_max_ps(_mm_min_ps(near, far), enter);
+            exit = _mm_min_ps(_mm_max_ps(near, far), exit);
+        }
+        const __m128 hit = _mm_cmple_ps(enter, exit);
+        _mm_storeu_ps(distances + i, _mm_or_ps(_mm_and_ps(hit, enter), _mm_andnot_ps(hit, miss)));
+    }
+    rayTail(origin, inverse_direction, boxes, i, count, distances);
+}
+
+#elif defined(MYM_SIMD_NEON)
+
+size_t cullAabbs(const Frustum& frustum, const AabbArrays boxes, const size_t count, uint32_t* visible) {
+    const FurthestCorners corners = furthestCorners(frustum, boxes);
+
+    size_t n = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t outside = vdupq_n_u32(0);
+        for (int p = 0; p < 6; p++) {
+            const Plane& plane = frustum.planes[p];
+            float32x4_t d = vmulq_n_f32(vld1q_f32(corners.x[p] + i), plane.normal.x);
+            d = vmlaq_n_f32(d, vld1q_f32(corners.y[p] + i), plane.normal.y);
+            d = vmlaq_n_f32(d, vld1q_f32(corners.z[p] + i), plane.normal.z);
+            d = vaddq_f32(d, vdupq_n_f32(plane.distance));
+            outside = vorrq_u32(outside, vcltq_f32(d, vdupq_n_f32(0.f)));
+        }
+        const int visible_mask = (vgetq_lane_u32(outside, 0) ? 0 : 1) | (vgetq_lane_u32(outside, 1) ? 0 : 2) |
+                                 (vgetq_lane_u32(outside, 2) ? 0 : 4) | (vgetq_lane_u32(outside, 3) ? 0 : 8);
+        n = appendVisible(visible, n, i, 4, visible_mask);
+    }
+    return cullTail(frustum, boxes, i, count, visible, n);
+}
+
+void rayAabbDistances(const Vec3 origin, const Vec3 inverse_direction, const AabbArrays boxes, const size_t count,
+                      float* distances) {
+    const float* mins[3] = { boxes.min_x, boxes.min_y, boxes.min_z };
+    const float* maxs[3] = { boxes.max_x, boxes.max_y, boxes.max_z };
+    const float32x4_t miss = vdupq_n_f32(FLT_MAX);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t enter = vdupq_n_f32(0.f);
+        float32x4_t exit = miss;
+        for (int axis = 0; axis < 3; axis++) {
+            const float32x4_t o = vdupq_n_f32(origin.data[axis]);
+            const float32x4_t near = vmulq_n_f32(vsubq_f32(vld1q_f32(mins[axis] + i), o), inverse_direction.data[axis]);
+            const float32x4_t far = vmulq_n_f32(vsubq_f32(vld1q_f32(maxs[axis] + i), o), inverse_direction.data[axis]);
+            // vminq/vmaxq return nan for a nan lane where minps drops it, compare and select to match
+            const float32x4_t low = vbslq_f32(vcltq_f32(near, far), near, far);
+            const float32x4_t high = vbslq_f32(vcgtq_f32(near, far), near, far);
+            enter = vbslq_f32(vcgtq_f32(low, enter), low, enter);
+            exit = vbslq_f32(vcltq_f32(high, exit), high, exit);
+        }
+        vst1q_f32(distances + i, vbslq_f32(vcleq_f32(enter, exit), enter, miss));
+    }
+    rayTail(origin, inverse_direction, boxes, i, count, distances);
+}
+
+#else
+
+size_t cullAabbs(const Frustum& frustum, const AabbArrays boxes, const size_t count, uint32_t* visible) {
+    return cullTail(frustum, boxes, 0, count, visible, 0);
+}
+
+void rayAabbDistances(const Vec3 origin, const Vec3 inverse_direction, const AabbArrays boxes, const size_t count,
+                      float* distances) {
+    rayTail(origin, inverse_direction, boxes, 0, count, distances);
+}
+
+#endif
+
+}
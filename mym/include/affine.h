@@ -0,0 +1,52 @@
+#ifndef AFFINE_H
+#define AFFINE_H
+
+#include "vec.h"
+#include "mat4.h"
+#include "mym_config.h"
+
+namespace mym {
+
+// a Mat4 without its last column, which for translation, rotation and scale is always 0, 0, 0, 1.
+// same row vector layout: rows 0-2 are the basis, row 3 the translation. 48 bytes instead of 64,
+// and composing or inverting it skips everything that column would cost. scene nodes store these
+typedef union Affine {
+    struct {
+        float m00, m01, m02;
+        float m10, m11, m12;
+        float m20, m21, m22;
+        float m30, m31, m32;
+    };
+    float data[4][3];
+} Affine;
+
+MYM_FUNCTIONS_BEGIN
+
+MYM_CONSTEXPR Affine identityAffine();
+
+// m has to be affine, its last column is dropped
+MYM_API Affine toAffine(const Mat4& m);
+// for the gpu and anything else that wants a full matrix
+MYM_CONSTEXPR Mat4 toMat4(const Affine& a);
+
+// rotation is a unit quaternion (x, y, z, w), scale is applied before it, like a gltf node
+MYM_CONSTEXPR Affine fromTranslationRotationScale(Vec3 translation, Vec4 rotation, Vec3 scale);
+
+// same order as multiplied(Mat4, Mat4): multiplied(parent_world, local) is the child's world transform
+MYM_API Affine multiplied(const Affine& a, const Affine& b);
+MYM_API Affine inverse(const Affine& a);
+
+MYM_CONSTEXPR Vec3 getPosition(const Affine& transform);
+
+MYM_CONSTEXPR Vec3 positionMultiplied(const Vec3& v, const Affine& a);
+MYM_CONSTEXPR Vec3 directionMultiplied(const Vec3& v, const Affine& a);
+
+MYM_FUNCTIONS_END
+
+}
+
+#ifdef MYM_HEADER_ONLY
+#include "affine.inl"
+#endif
+
+#endif //AFFINE_H
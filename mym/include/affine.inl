@@ -0,0 +1,232 @@
+#ifndef AFFINE_INL
+#define AFFINE_INL
+
+// definitions for affine.h. affine.cpp compiles them into the library, with MYM_HEADER_ONLY affine.h
+// includes them instead (see mym_config.h)
+
+#include "vec.h"
+#include "mat4.h"
+#include "affine.h"
+#include "mat4_simd.h"
+
+namespace mym {
+MYM_FUNCTIONS_BEGIN
+
+
+MYM_CONSTEXPR Affine identityAffine() {
+    return (Affine){
+        1.f, 0.f, 0.f,
+        0.f, 1.f, 0.f,
+        0.f, 0.f, 1.f,
+        0.f, 0.f, 0.f,
+    };
+}
+
+MYM_API Affine toAffine(const Mat4& m) {
+    Affine a;
+    for (int row = 0; row < 4; row++) {
+        a.data[row][0] = m.data[row][0];
+        a.data[row][1] = m.data[row][1];
+        a.data[row][2] = m.data[row][2];
+    }
+    return a;
+}
+
+MYM_CONSTEXPR Mat4 toMat4(const Affine& a) {
+    return (Mat4){
+        a.m00, a.m01, a.m02, 0.f,
+        a.m10, a.m11, a.m12, 0.f,
+        a.m20, a.m21, a.m22, 0.f,
+        a.m30, a.m31, a.m32, 1.f,
+    };
+}
+
+MYM_CONSTEXPR Affine fromTranslationRotationScale(const Vec3 translation, const Vec4 rotation, const Vec3 scale) {
+    const float x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+
+    // rows are the rotated basis vectors, each scaled along its own axis
+    return (Affine){
+        (1.f - 2.f * (y * y + z * z)) * scale.x, 2.f * (x * y + z * w) * scale.x,         2.f * (x * z - y * w) * scale.x,
+        2.f * (x * y - z * w) * scale.y,         (1.f - 2.f * (x * x + z * z)) * scale.y, 2.f * (y * z + x * w) * scale.y,
+        2.f * (x * z + y * w) * scale.z,         2.f * (y * z - x * w) * scale.z,         (1.f - 2.f * (x * x + y * y)) * scale.z,
+        translation.x, translation.y, translation.z,
+    };
+}
+
+// the fallback without sse, the sse versions below do the same math
+#if !defined(MYM_SIMD_SSE)
+
+MYM_INTERNAL Affine multipliedScalar(const Affine& a, const Affine& b) {
+    // b's translation row has an implied 1 in the dropped column, which picks up a's translation
+    return (Affine){
+        b.m00 * a.m00 + b.m01 * a.m10 + b.m02 * a.m20,
+        b.m00 * a.m01 + b.m01 * a.m11 + b.m02 * a.m21,
+        b.m00 * a.m02 + b.m01 * a.m12 + b.m02 * a.m22,
+        b.m10 * a.m00 + b.m11 * a.m10 + b.m12 * a.m20,
+        b.m10 * a.m01 + b.m11 * a.m11 + b.m12 * a.m21,
+        b.m10 * a.m02 + b.m11 * a.m12 + b.m12 * a.m22,
+        b.m20 * a.m00 + b.m21 * a.m10 + b.m22 * a.m20,
+        b.m20 * a.m01 + b.m21 * a.m11 + b.m22 * a.m21,
+        b.m20 * a.m02 + b.m21 * a.m12 + b.m22 * a.m22,
+        b.m30 * a.m00 + b.m31 * a.m10 + b.m32 * a.m20 + a.m30,
+        b.m30 * a.m01 + b.m31 * a.m11 + b.m32 * a.m21 + a.m31,
+        b.m30 * a.m02 + b.m31 * a.m12 + b.m32 * a.m22 + a.m32,
+    };
+}
+
+MYM_INTERNAL Affine inverseScalar(const Affine& a) {
+
+    // the 3x3 inverse has the cross products of the rows as its columns, over the determinant
+    const float c00 = a.m11 * a.m22 - a.m12 * a.m21;
+    const float c01 = a.m12 * a.m20 - a.m10 * a.m22;
+    const float c02 = a.m10 * a.m21 - a.m11 * a.m20;
+    const float c10 = a.m21 * a.m02 - a.m22 * a.m01;
+    const float c11 = a.m22 * a.m00 - a.m20 * a.m02;
+    const float c12 = a.m20 * a.m01 - a.m21 * a.m00;
+    const float c20 = a.m01 * a.m12 - a.m02 * a.m11;
+    const float c21 = a.m02 * a.m10 - a.m00 * a.m12;
+    const float c22 = a.m00 * a.m11 - a.m01 * a.m10;
+    const float d = 1.f / (a.m00 * c00 + a.m01 * c01 + a.m02 * c02);
+
+    const float i00 = c00 * d, i01 = c10 * d, i02 = c20 * d;
+    const float i10 = c01 * d, i11 = c11 * d, i12 = c21 * d;
+    const float i20 = c02 * d, i21 = c12 * d, i22 = c22 * d;
+
+    // then undo the translation
+    return (Affine){
+        i00, i01, i02,
+        i10, i11, i12,
+        i20, i21, i22,
+        -(a.m30 * i00 + a.m31 * i10 + a.m32 * i20),
+        -(a.m30 * i01 + a.m31 * i11 + a.m32 * i21),
+        -(a.m30 * i02 + a.m31 * i12 + a.m32 * i22),
+    };
+}
+
+#endif
+
+#if defined(MYM_SIMD_SSE)
+
+#define MYM_SWIZZLE(a, x, y, z, w) _mm_shuffle_ps(a, a, _MM_SHUFFLE(w, z, y, x))
+
+// the 12 floats go in and out as three whole registers and the rows are shuffled out of them.
+// loading rows straight from 3 float offsets would read across two stores of the previous result,
+// which stalls a chain of composes waiting on store forwarding
+typedef struct Rows {
+    __m128 r0, r1, r2, r3; // lane 3 is junk
+} Rows;
+
+MYM_INTERNAL Rows loadRows(const Affine& a) {
+    const __m128 v0 = _mm_loadu_ps(&a.m00);
+    const __m128 v1 = _mm_loadu_ps(&a.m11);
+    const __m128 v2 = _mm_loadu_ps(&a.m22);
+    return (Rows){
+        .r0 = v0,
+        .r1 = _mm_shuffle_ps(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(0, 0, 3, 3)), v1, _MM_SHUFFLE(1, 1, 2, 0)),
+        .r2 = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(0, 0, 3, 2)),
+        .r3 = MYM_SWIZZLE(v2, 1, 2, 3, 3),
+    };
+}
+
+MYM_INTERNAL Affine storeRows(const Rows& rows) {
+    Affine result;
+    const __m128 t0 = _mm_shuffle_ps(rows.r0, rows.r1, _MM_SHUFFLE(0, 0, 2, 2));
+    const __m128 t2 = _mm_shuffle_ps(rows.r2, rows.r3, _MM_SHUFFLE(0, 0, 2, 2));
+    _mm_storeu_ps(&result.m00, _mm_shuffle_ps(rows.r0, t0, _MM_SHUFFLE(2, 0, 1, 0)));
+    _mm_storeu_ps(&result.m11, _mm_shuffle_ps(rows.r1, rows.r2, _MM_SHUFFLE(1, 0, 2, 1)));
+    _mm_storeu_ps(&result.m22, _mm_shuffle_ps(t2, rows.r3, _MM_SHUFFLE(2, 1, 2, 0)));
+    return result;
+}
+
+MYM_INTERNAL Affine multipliedSimd(const Affine& a, const Affine& b) {
+    const Rows rows = loadRows(a);
+
+    __m128 result[4];
+    for (int row = 0; row < 4; row++) {
+        result[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(b.data[row][0]), rows.r0),
+                                            _mm_mul_ps(_mm_set1_ps(b.data[row][1]), rows.r1)),
+                                 _mm_mul_ps(_mm_set1_ps(b.data[row][2]), rows.r2));
+    }
+    // b's translation row has an implied 1 in the dropped column, which picks up a's translation
+    result[3] = _mm_add_ps(result[3], rows.r3);
+    return storeRows((Rows){ result[0], result[1], result[2], result[3] });
+}
+
+// the same cross product inverse as simd::affineInverse, lane 3 is junk throughout and never kept
+MYM_INTERNAL Affine inverseSimd(const Affine& a) {
+    const Rows rows = loadRows(a);
+    const __m128 r0 = rows.r0;
+    const __m128 r1 = rows.r1;
+    const __m128 r2 = rows.r2;
+    const __m128 translation = rows.r3;
+
+    const __m128 c0 = _mm_sub_ps(_mm_mul_ps(MYM_SWIZZLE(r1, 1, 2, 0, 3), MYM_SWIZZLE(r2, 2, 0, 1, 3)),
+                                 _mm_mul_ps(MYM_SWIZZLE(r1, 2, 0, 1, 3), MYM_SWIZZLE(r2, 1, 2, 0, 3)));
+    const __m128 c1 = _mm_sub_ps(_mm_mul_ps(MYM_SWIZZLE(r2, 1, 2, 0, 3), MYM_SWIZZLE(r0, 2, 0, 1, 3)),
+                                 _mm_mul_ps(MYM_SWIZZLE(r2, 2, 0, 1, 3), MYM_SWIZZLE(r0, 1, 2, 0, 3)));
+    const __m128 c2 = _mm_sub_ps(_mm_mul_ps(MYM_SWIZZLE(r0, 1, 2, 0, 3), MYM_SWIZZLE(r1, 2, 0, 1, 3)),
+                                 _mm_mul_ps(MYM_SWIZZLE(r0, 2, 0, 1, 3), MYM_SWIZZLE(r1, 1, 2, 0, 3)));
+
+    const __m128 products = _mm_mul_ps(r0, c0);
+    const __m128 determinant = _mm_add_ps(_mm_add_ps(products, MYM_SWIZZLE(products, 1, 2, 0, 3)),
+                                          MYM_SWIZZLE(products, 2, 0, 1, 3));
+    const __m128 reciprocal = _mm_div_ps(_mm_set1_ps(1.f), MYM_SWIZZLE(determinant, 0, 0, 0, 0));
+
+    __m128 i0 = _mm_mul_ps(c0, reciprocal);
+    __m128 i1 = _mm_mul_ps(c1, reciprocal);
+    __m128 i2 = _mm_mul_ps(c2, reciprocal);
+    __m128 i3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(i0, i1, i2, i3);
+
+    __m128 inverse_translation = _mm_mul_ps(MYM_SWIZZLE(translation, 0, 0, 0, 0), i0);
+    inverse_translation = _mm_add_ps(inverse_translation, _mm_mul_ps(MYM_SWIZZLE(translation, 1, 1, 1, 1), i1));
+    inverse_translation = _mm_add_ps(inverse_translation, _mm_mul_ps(MYM_SWIZZLE(translation, 2, 2, 2, 2), i2));
+    inverse_translation = _mm_sub_ps(_mm_setzero_ps(), inverse_translation);
+
+    return storeRows((Rows){ i0, i1, i2, inverse_translation });
+}
+
+#undef MYM_SWIZZLE
+
+#endif
+
+MYM_API Affine multiplied(const Affine& a, const Affine& b) {
+#if defined(MYM_SIMD_SSE)
+    return multipliedSimd(a, b);
+#else
+    return multipliedScalar(a, b);
+#endif
+}
+
+MYM_API Affine inverse(const Affine& a) {
+#if defined(MYM_SIMD_SSE)
+    return inverseSimd(a);
+#else
+    return inverseScalar(a);
+#endif
+}
+
+MYM_CONSTEXPR Vec3 getPosition(const Affine& transform) {
+    return (Vec3){ .x = transform.m30, .y = transform.m31, .z = transform.m32 };
+}
+
+MYM_CONSTEXPR Vec3 positionMultiplied(const Vec3& v, const Affine& a) {
+    return (Vec3){
+        .x = v.x * a.m00 + v.y * a.m10 + v.z * a.m20 + a.m30,
+        .y = v.x * a.m01 + v.y * a.m11 + v.z * a.m21 + a.m31,
+        .z = v.x * a.m02 + v.y * a.m12 + v.z * a.m22 + a.m32,
+    };
+}
+
+MYM_CONSTEXPR Vec3 directionMultiplied(const Vec3& v, const Affine& a) {
+    return (Vec3){
+        .x = v.x * a.m00 + v.y * a.m10 + v.z * a.m20,
+        .y = v.x * a.m01 + v.y * a.m11 + v.z * a.m21,
+        .z = v.x * a.m02 + v.y * a.m12 + v.z * a.m22,
+    };
+}
+
+MYM_FUNCTIONS_END
+}
+
+#endif //AFFINE_INL
@@ -0,0 +1,111 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vec.h"
+#include "mat4.h"
+#include "affine.h"
+#include "mym_config.h"
+
+// bounding volumes and the tests that reject work with them: frustum culling, ray picking, bvh nodes.
+// the single box functions follow MYM_HEADER_ONLY like vec.h, the batch ones at the bottom take boxes as
+// structure of arrays and test four at a time with SSE2/NEON, they are out of line either way
+
+namespace mym {
+
+typedef struct Aabb {
+    Vec3 min;
+    Vec3 max;
+} Aabb;
+
+typedef struct Sphere {
+    Vec3 center;
+    float radius;
+} Sphere;
+
+// points with dot(normal, p) + distance >= 0 are in front. normal is unit length, so that's the
+// distance to the plane
+typedef struct Plane {
+    Vec3 normal;
+    float distance;
+} Plane;
+
+// normals point inwards, a point is inside when it's in front of all six
+typedef union Frustum {
+    struct {
+        Plane left, right, bottom, top, near, far;
+    };
+    Plane planes[6];
+} Frustum;
+
+// result type for float
+typedef struct {
+    bool valid;
+    float value;
+} FloatResult;
+
+MYM_FUNCTIONS_BEGIN
+
+// min at +FLT_MAX and max at -FLT_MAX, expanding it by anything gives that thing's box
+MYM_CONSTEXPR Aabb emptyAabb();
+MYM_CONSTEXPR Aabb expanded(const Aabb& box, Vec3 point);
+MYM_CONSTEXPR Aabb merged(const Aabb& a, const Aabb& b);
+MYM_CONSTEXPR Vec3 center(const Aabb& box);
+// half the size along each axis
+MYM_CONSTEXPR Vec3 extents(const Aabb& box);
+MYM_CONSTEXPR bool contains(const Aabb& box, Vec3 point);
+MYM_CONSTEXPR bool overlaps(const Aabb& a, const Aabb& b);
+
+// the box around the transformed box, looser than the transformed corners but never smaller
+MYM_API Aabb transformed(const Aabb& box, const Mat4& m);
+MYM_API Aabb transformed(const Aabb& box, const Affine& a);
+
+MYM_API Sphere boundingSphere(const Aabb& box);
+
+MYM_CONSTEXPR float signedDistance(const Plane& plane, Vec3 point);
+
+// the frustum of a view projection matrix, multiplied(projection, view) like the renderer builds it.
+// gl clip space, z from -w to w
+MYM_API Frustum frustumFromViewProjection(const Mat4& view_projection);
+
+// conservative: false only when the volume is entirely behind one plane. a box across a corner of the
+// frustum can be outside and still pass
+MYM_API bool isVisible(const Frustum& frustum, const Aabb& box);
+MYM_API bool isVisible(const Frustum& frustum, const Sphere& sphere);
+
+// 1 / direction per axis, a zero axis becomes infinity, which the slab test handles
+MYM_API Vec3 inverseDirection(Vec3 direction);
+
+// slab test, the distance along the ray where it enters the box, 0 when the origin is inside.
+// distances are in units of the direction's length. a ray that starts exactly on a slab plane while
+// parallel to it can go either way
+MYM_API FloatResult rayIntersectsAabb(Vec3 origin, Vec3 inverse_direction, const Aabb& box);
+
+MYM_FUNCTIONS_END
+
+// boxes as structure of arrays, each array count floats
+typedef struct AabbArrays {
+    const float* min_x;
+    const float* min_y;
+    const float* min_z;
+    const float* max_x;
+    const float* max_y;
+    const float* max_z;
+} AabbArrays;
+
+// writes the index of every box isVisible would keep to visible (room for count), returns how many
+size_t cullAabbs(const Frustum& frustum, AabbArrays boxes, size_t count, uint32_t* visible);
+
+// rayIntersectsAabb for every box, distances[i] is where the ray enters box i or FLT_MAX for a miss,
+// so sorting by it puts the misses last
+void rayAabbDistances(Vec3 origin, Vec3 inverse_direction, AabbArrays boxes, size_t count, float* distances);
+
+}
+
+#ifdef MYM_HEADER_ONLY
+#include "bounds.inl"
+#endif
+
+#endif //BOUNDS_H
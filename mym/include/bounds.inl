@@ -0,0 +1,174 @@
+#ifndef BOUNDS_INL
+#define BOUNDS_INL
+
+// definitions for the single box functions in bounds.h. bounds.cpp compiles them into the library,
+// with MYM_HEADER_ONLY bounds.h includes them instead (see mym_config.h)
+
+#include <float.h>
+#include <math.h>
+
+#include "vec.h"
+#include "mat4.h"
+#include "affine.h"
+#include "bounds.h"
+
+namespace mym {
+MYM_FUNCTIONS_BEGIN
+
+// a < b ? a : b picks b when either is nan, like minps and maxps, so the scalar and simd slab tests agree
+MYM_INTERNAL MYM_CONSTEXPR float minimum(const float a, const float b) {
+    return a < b ? a : b;
+}
+
+MYM_INTERNAL MYM_CONSTEXPR float maximum(const float a, const float b) {
+    return a > b ? a : b;
+}
+
+MYM_CONSTEXPR Aabb emptyAabb() {
+    return (Aabb){
+        .min = (Vec3){ .x = FLT_MAX, .y = FLT_MAX, .z = FLT_MAX },
+        .max = (Vec3){ .x = -FLT_MAX, .y = -FLT_MAX, .z = -FLT_MAX },
+    };
+}
+
+MYM_CONSTEXPR Aabb expanded(const Aabb& box, const Vec3 point) {
+    return (Aabb){
+        .min = (Vec3){ .x = minimum(box.min.x, point.x), .y = minimum(box.min.y, point.y), .z = minimum(box.min.z, point.z) },
+        .max = (Vec3){ .x = maximum(box.max.x, point.x), .y = maximum(box.max.y, point.y), .z = maximum(box.max.z, point.z) },
+    };
+}
+
+MYM_CONSTEXPR Aabb merged(const Aabb& a, const Aabb& b) {
+    return (Aabb){
+        .min = (Vec3){ .x = minimum(a.min.x, b.min.x), .y = minimum(a.min.y, b.min.y), .z = minimum(a.min.z, b.min.z) },
+        .max = (Vec3){ .x = maximum(a.max.x, b.max.x), .y = maximum(a.max.y, b.max.y), .z = maximum(a.max.z, b.max.z) },
+    };
+}
+
+MYM_CONSTEXPR Vec3 center(const Aabb& box) {
+    return scaleVector(addVectors(box.min, box.max), 0.5f);
+}
+
+MYM_CONSTEXPR Vec3 extents(const Aabb& box) {
+    return scaleVector(subtractVectors(box.max, box.min), 0.5f);
+}
+
+MYM_CONSTEXPR bool contains(const Aabb& box, const Vec3 point) {
+    return point.x >= box.min.x && point.x <= box.max.x &&
+           point.y >= box.min.y && point.y <= box.max.y &&
+           point.z >= box.min.z && point.z <= box.max.z;
+}
+
+MYM_CONSTEXPR bool overlaps(const Aabb& a, const Aabb& b) {
+    return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+           a.min.y <= b.max.y && a.max.y >= b.min.y &&
+           a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+// arvo's method: each output axis is the translation plus, per input axis, the smaller and the larger
+// of that axis' extremes times the matrix entry. Mat4 and Affine share the row layout
+template<class Matrix>
+MYM_INTERNAL Aabb transformedBox(const Aabb& box, const Matrix& m) {
+    Aabb result = {
+        .min = (Vec3){ .x = m.m30, .y = m.m31, .z = m.m32 },
+        .max = (Vec3){ .x = m.m30, .y = m.m31, .z = m.m32 },
+    };
+    for (int row = 0; row < 3; row++) {
+        for (int column = 0; column < 3; column++) {
+            const float a = m.data[row][column] * box.min.data[row];
+            const float b = m.data[row][column] * box.max.data[row];
+            result.min.data[column] += minimum(a, b);
+            result.max.data[column] += maximum(a, b);
+        }
+    }
+    return result;
+}
+
+MYM_API Aabb transformed(const Aabb& box, const Mat4& m) {
+    return transformedBox(box, m);
+}
+
+MYM_API Aabb transformed(const Aabb& box, const Affine& a) {
+    return transformedBox(box, a);
+}
+
+MYM_API Sphere boundingSphere(const Aabb& box) {
+    return (Sphere){ .center = center(box), .radius = length(extents(box)) };
+}
+
+MYM_CONSTEXPR float signedDistance(const Plane& plane, const Vec3 point) {
+    return dot(plane.normal, point) + plane.distance;
+}
+
+// gribb and hartmann: clip = v * view_projection, so clip x is v against column 0 and so on.
+// inside is -w <= x <= w, the left plane is w + x >= 0, the right one w - x >= 0
+MYM_API Frustum frustumFromViewProjection(const Mat4& m) {
+    const float w[4] = { m.m03, m.m13, m.m23, m.m33 };
+    const float x[4] = { m.m00, m.m10, m.m20, m.m30 };
+    const float y[4] = { m.m01, m.m11, m.m21, m.m31 };
+    const float z[4] = { m.m02, m.m12, m.m22, m.m32 };
+    const float* axes[3] = { x, y, z };
+
+    Frustum frustum;
+    for (int i = 0; i < 6; i++) {
+        const float* axis = axes[i / 2];
+        const float sign = i % 2 == 0 ? 1.f : -1.f;
+        const Vec3 normal = { .x = w[0] + sign * axis[0], .y = w[1] + sign * axis[1], .z = w[2] + sign * axis[2] };
+        const float inverse_length = 1.f / length(normal);
+        frustum.planes[i] = (Plane){
+            .normal = scaleVector(normal, inverse_length),
+            .distance = (w[3] + sign * axis[3]) * inverse_length,
+        };
+    }
+    return frustum;
+}
+
+// only the corner furthest along the plane normal has to be checked, if that one is behind so is the box
+MYM_API bool isVisible(const Frustum& frustum, const Aabb& box) {
+    for (int i = 0; i < 6; i++) {
+        const Plane& plane = frustum.planes[i];
+        const Vec3 corner = {
+            .x = plane.normal.x > 0.f ? box.max.x : box.min.x,
+            .y = plane.normal.y > 0.f ? box.max.y : box.min.y,
+            .z = plane.normal.z > 0.f ? box.max.z : box.min.z,
+        };
+        if (signedDistance(plane, corner) < 0.f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+MYM_API bool isVisible(const Frustum& frustum, const Sphere& sphere) {
+    for (int i = 0; i < 6; i++) {
+        if (signedDistance(frustum.planes[i], sphere.center) < -sphere.radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+MYM_API Vec3 inverseDirection(const Vec3 direction) {
+    return (Vec3){ .x = 1.f / direction.x, .y = 1.f / direction.y, .z = 1.f / direction.z };
+}
+
+MYM_API FloatResult rayIntersectsAabb(const Vec3 origin, const Vec3 inverse_direction, const Aabb& box) {
+    // where the ray crosses the two planes of each slab, the box is where all three overlap
+    float enter = 0.f;
+    float exit = FLT_MAX;
+    for (int axis = 0; axis < 3; axis++) {
+        const float near = (box.min.data[axis] - origin.data[axis]) * inverse_direction.data[axis];
+        const float far = (box.max.data[axis] - origin.data[axis]) * inverse_direction.data[axis];
+        enter = maximum(minimum(near, far), enter);
+        exit = minimum(maximum(near, far), exit);
+    }
+    if (enter > exit) {
+        return (FloatResult){ .valid = false };
+    }
+    return (FloatResult){ .valid = true, .value = enter };
+}
+
+MYM_FUNCTIONS_END
+}
+
+#endif //BOUNDS_INL
@@ -3,10 +3,12 @@
 
 #include "math_utils.h"
 #include "vec.h"
+#include "mym_config.h"
 
 namespace mym {
 
-typedef union Mat4 { 
+// 16 byte aligned so the simd kernels can load whole rows
+typedef union alignas(16) Mat4 { 
     struct {
         float m00, m01, m02, m03;
         float m10, m11, m12, m13;
@@ -17,47 +19,64 @@ typedef union Mat4 {
 } Mat4;
 
 
-Mat4 lookAt(Vec3 camera_position, Vec3 target, Vec3 up);
-Mat4 perspective(float field_of_view_in_radians, float aspect, float near, float far);
-Mat4 orthographic(int left, int right, int bottom, int top, int near, int far);
-Mat4 projection(float width, float height, float depth);
-Mat4 fromPositionAndEuler(Vec3 position, Vec3 euler);
+enum class SimdLevel { Scalar, Sse2, Neon };
 
-void multiply(Mat4& a, const Mat4& b);
-Mat4 multiplied(Mat4 a, Mat4 b);
+MYM_FUNCTIONS_BEGIN
 
-Mat4 translation(float tx, float ty, float tz);
-Mat4 xRotation(float angle_in_radians);
-Mat4 yRotation(float angle_in_radians);
-Mat4 zRotation(float angle_in_radians);
-Mat4 scaling(float sx, float sy, float sz);
+MYM_API Mat4 lookAt(Vec3 camera_position, Vec3 target, Vec3 up);
+MYM_API Mat4 perspective(float field_of_view_in_radians, float aspect, float near, float far);
+MYM_API Mat4 orthographic(int left, int right, int bottom, int top, int near, int far);
+MYM_API Mat4 projection(float width, float height, float depth);
+MYM_API Mat4 fromPositionAndEuler(Vec3 position, Vec3 euler);
 
-void translate(Mat4& m, float tx, float ty, float tz);
-void xRotate(Mat4& m, float angle_in_radians);
-void yRotate(Mat4& m, float angle_in_radians);
-void zRotate(Mat4& m, float angle_in_radians);
-void scale(Mat4& m, float sx, float sy, float sz);
+MYM_API void multiply(Mat4& a, const Mat4& b);
+MYM_API Mat4 multiplied(Mat4 a, Mat4 b);
 
-Mat4 translated(Mat4 m, float tx, float ty, float tz);
-Mat4 xRotated(Mat4 m, float angle_in_radians);
-Mat4 yRotated(Mat4 m, float angle_in_radians);
-Mat4 zRotated(Mat4 m, float angle_in_radians);
-Mat4 scaled(Mat4 m, float sx, float sy, float sz);
+MYM_CONSTEXPR Mat4 translation(float tx, float ty, float tz);
+MYM_API Mat4 xRotation(float angle_in_radians);
+MYM_API Mat4 yRotation(float angle_in_radians);
+MYM_API Mat4 zRotation(float angle_in_radians);
+MYM_CONSTEXPR Mat4 scaling(float sx, float sy, float sz);
 
-void transpose(Mat4& m);
-Mat4 transposed(Mat4 m);
+MYM_API void translate(Mat4& m, float tx, float ty, float tz);
+MYM_API void xRotate(Mat4& m, float angle_in_radians);
+MYM_API void yRotate(Mat4& m, float angle_in_radians);
+MYM_API void zRotate(Mat4& m, float angle_in_radians);
+MYM_API void scale(Mat4& m, float sx, float sy, float sz);
 
-Mat4 inverse(Mat4 m);
+MYM_API Mat4 translated(Mat4 m, float tx, float ty, float tz);
+MYM_API Mat4 xRotated(Mat4 m, float angle_in_radians);
+MYM_API Mat4 yRotated(Mat4 m, float angle_in_radians);
+MYM_API Mat4 zRotated(Mat4 m, float angle_in_radians);
+MYM_API Mat4 scaled(Mat4 m, float sx, float sy, float sz);
 
-Vec3 getPosition(Mat4 transform);
+MYM_API void transpose(Mat4& m);
+MYM_CONSTEXPR Mat4 transposed(Mat4 m);
 
-void vectorMultiply(Vec4& v, const Mat4& m);
-void positionMultiply(Vec3& v, const Mat4& m);
-void directionMultiply(Vec3& v, const Mat4& m);
+MYM_API Mat4 inverse(Mat4 m);
+// for matrices whose last column is 0, 0, 0, 1 (rotation, scale and translation), cheaper than inverse
+MYM_API Mat4 affineInverse(const Mat4& m);
 
-Vec4 vectorMultiplied(const Vec4& v, const Mat4& m);
-Vec3 positionMultiplied(const Vec3& v, const Mat4& m);
-Vec3 directionMultiplied(const Vec3& v, const Mat4& m);
+MYM_CONSTEXPR Vec3 getPosition(Mat4 transform);
+
+MYM_API void vectorMultiply(Vec4& v, const Mat4& m);
+MYM_API void positionMultiply(Vec3& v, const Mat4& m);
+MYM_API void directionMultiply(Vec3& v, const Mat4& m);
+
+MYM_API Vec4 vectorMultiplied(const Vec4& v, const Mat4& m);
+MYM_API Vec3 positionMultiplied(const Vec3& v, const Mat4& m);
+MYM_API Vec3 directionMultiplied(const Vec3& v, const Mat4& m);
+
+// which kernels mym was built with, for the debug ui and benchmarks
+MYM_API SimdLevel simdLevel();
+MYM_API const char* simdLevelName(SimdLevel level);
+
+MYM_FUNCTIONS_END
 
 }
-#endif //MAT_4_H
\ No newline at end of file
+
+#ifdef MYM_HEADER_ONLY
+#include "mat4.inl"
+#endif
+
+#endif //MAT_4_H
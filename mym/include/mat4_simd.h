@@ -0,0 +1,290 @@
+#ifndef MAT_4_SIMD_H
+#define MAT_4_SIMD_H
+
+#include "mat4.h"
+#include "vec.h"
+#include "mym_config.h"
+
+// header only versions of the hot Mat4 kernels, so callers in other libraries can inline them.
+// SSE2 on x86-64 (every x86-64 cpu has it), NEON on arm, plain scalar otherwise or with MYM_NO_SIMD.
+// results match the out of line functions in mat4.h, the scalar:: versions are the reference
+
+#ifndef MYM_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MYM_SIMD_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MYM_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace mym {
+
+// straight scalar code, kept as the reference the simd kernels are tested against
+MYM_FUNCTIONS_BEGIN
+namespace scalar {
+    MYM_API Mat4 multiplied(const Mat4& a, const Mat4& b);
+    MYM_API Mat4 inverse(const Mat4& m);
+    MYM_API Mat4 affineInverse(const Mat4& m);
+    MYM_API Vec4 vectorMultiplied(const Vec4& v, const Mat4& m);
+    MYM_API Vec3 positionMultiplied(const Vec3& v, const Mat4& m);
+    MYM_API Vec3 directionMultiplied(const Vec3& v, const Mat4& m);
+}
+MYM_FUNCTIONS_END
+
+namespace simd {
+
+#if defined(MYM_SIMD_SSE)
+
+#define MYM_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define MYM_SWIZZLE(a, x, y, z, w) MYM_SHUFFLE(a, a, x, y, z, w)
+
+// 2x2 matrices packed row major in one register
+inline __m128 mat2Multiplied(const __m128 a, const __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, MYM_SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(MYM_SWIZZLE(a, 1, 0, 3, 2), MYM_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// adjugate(a) * b
+inline __m128 mat2AdjugateMultiplied(const __m128 a, const __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(MYM_SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(MYM_SWIZZLE(a, 1, 1, 2, 2), MYM_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// a * adjugate(b)
+inline __m128 mat2MultipliedAdjugate(const __m128 a, const __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(a, MYM_SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(MYM_SWIZZLE(a, 1, 0, 3, 2), MYM_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+#endif
+
+// same argument order as mym::multiplied, result rows are b's rows transformed by a
+inline Mat4 multiplied(const Mat4& a, const Mat4& b) {
+#if defined(MYM_SIMD_SSE)
+    const __m128 a0 = _mm_load_ps(a.data[0]);
+    const __m128 a1 = _mm_load_ps(a.data[1]);
+    const __m128 a2 = _mm_load_ps(a.data[2]);
+    const __m128 a3 = _mm_load_ps(a.data[3]);
+
+    Mat4 result;
+    for (int row = 0; row < 4; row++) {
+        const __m128 b_row = _mm_load_ps(b.data[row]);
+        __m128 sum = _mm_mul_ps(MYM_SWIZZLE(b_row, 0, 0, 0, 0), a0);
+        sum = _mm_add_ps(sum, _mm_mul_ps(MYM_SWIZZLE(b_row, 1, 1, 1, 1), a1));
+        sum = _mm_add_ps(sum, _mm_mul_ps(MYM_SWIZZLE(b_row, 2, 2, 2, 2), a2));
+        sum = _mm_add_ps(sum, _mm_mul_ps(MYM_SWIZZLE(b_row, 3, 3, 3, 3), a3));
+        _mm_store_ps(result.data[row], sum);
+    }
+    return result;
+#elif defined(MYM_SIMD_NEON)
+    const float32x4_t a0 = vld1q_f32(a.data[0]);
+    const float32x4_t a1 = vld1q_f32(a.data[1]);
+    const float32x4_t a2 = vld1q_f32(a.data[2]);
+    const float32x4_t a3 = vld1q_f32(a.data[3]);
+
+    Mat4 result;
+    for (int row = 0; row < 4; row++) {
+        float32x4_t sum = vmulq_n_f32(a0, b.data[row][0]);
+        sum = vmlaq_n_f32(sum, a1, b.data[row][1]);
+        sum = vmlaq_n_f32(sum, a2, b.data[row][2]);
+        sum = vmlaq_n_f32(sum, a3, b.data[row][3]);
+        vst1q_f32(result.data[row], sum);
+    }
+    return result;
+#else
+    return scalar::multiplied(a, b);
+#endif
+}
+
+// any invertible matrix, projections included. 2x2 block method, no branches
+inline Mat4 inverse(const Mat4& m) {
+#if defined(MYM_SIMD_SSE)
+    const __m128 r0 = _mm_load_ps(m.data[0]);
+    const __m128 r1 = _mm_load_ps(m.data[1]);
+    const __m128 r2 = _mm_load_ps(m.data[2]);
+    const __m128 r3 = _mm_load_ps(m.data[3]);
+
+    // the four 2x2 blocks
+    const __m128 a = _mm_movelh_ps(r0, r1);
+    const __m128 b = _mm_movehl_ps(r1, r0);
+    const __m128 c = _mm_movelh_ps(r2, r3);
+    const __m128 d = _mm_movehl_ps(r3, r2);
+
+    // determinants of the blocks as (|a| |b| |c| |d|)
+    const __m128 determinants = _mm_sub_ps(
+        _mm_mul_ps(MYM_SHUFFLE(r0, r2, 0, 2, 0, 2), MYM_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+        _mm_mul_ps(MYM_SHUFFLE(r0, r2, 1, 3, 1, 3), MYM_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+    const __m128 det_a = MYM_SWIZZLE(determinants, 0, 0, 0, 0);
+    const __m128 det_b = MYM_SWIZZLE(determinants, 1, 1, 1, 1);
+    const __m128 det_c = MYM_SWIZZLE(determinants, 2, 2, 2, 2);
+    const __m128 det_d = MYM_SWIZZLE(determinants, 3, 3, 3, 3);
+
+    const __m128 d_c = mat2AdjugateMultiplied(d, c);
+    const __m128 a_b = mat2AdjugateMultiplied(a, b);
+
+    __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), mat2Multiplied(b, d_c));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), mat2Multiplied(c, a_b));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), mat2MultipliedAdjugate(d, a_b));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), mat2MultipliedAdjugate(a, d_c));
+
+    // |m| = |a||d| + |b||c| - trace((a#b)(d#c))
+    __m128 trace = _mm_mul_ps(a_b, MYM_SWIZZLE(d_c, 0, 2, 1, 3));
+    trace = _mm_add_ps(trace, MYM_SWIZZLE(trace, 2, 3, 0, 1));
+    trace = _mm_add_ps(trace, MYM_SWIZZLE(trace, 1, 0, 3, 2));
+    const __m128 determinant = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), trace);
+
+    const __m128 reciprocal = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), determinant);
+    x = _mm_mul_ps(x, reciprocal);
+    y = _mm_mul_ps(y, reciprocal);
+    z = _mm_mul_ps(z, reciprocal);
+    w = _mm_mul_ps(w, reciprocal);
+
+    // the adjugate shuffle and the block layout in one go
+    Mat4 result;
+    _mm_store_ps(result.data[0], MYM_SHUFFLE(x, y, 3, 1, 3, 1));
+    _mm_store_ps(result.data[1], MYM_SHUFFLE(x, y, 2, 0, 2, 0));
+    _mm_store_ps(result.data[2], MYM_SHUFFLE(z, w, 3, 1, 3, 1));
+    _mm_store_ps(result.data[3], MYM_SHUFFLE(z, w, 2, 0, 2, 0));
+    return result;
+#else
+    return scalar::inverse(m);
+#endif
+}
+
+// only for transforms whose last column is (0, 0, 0, 1), which is every scene transform.
+// inverts the 3x3 part with cross products and carries the translation across
+inline Mat4 affineInverse(const Mat4& m) {
+#if defined(MYM_SIMD_SSE)
+    const __m128 r0 = _mm_load_ps(m.data[0]);
+    const __m128 r1 = _mm_load_ps(m.data[1]);
+    const __m128 r2 = _mm_load_ps(m.data[2]);
+    const __m128 translation = _mm_load_ps(m.data[3]);
+
+    // the columns of the adjugate
+    const __m128 c0 = _mm_sub_ps(_mm_mul_ps(MYM_SWIZZLE(r1, 1, 2, 0, 3), MYM_SWIZZLE(r2, 2, 0, 1, 3)),
+                                 _mm_mul_ps(MYM_SWIZZLE(r1, 2, 0, 1, 3), MYM_SWIZZLE(r2, 1, 2, 0, 3)));
+    const __m128 c1 = _mm_sub_ps(_mm_mul_ps(MYM_SWIZZLE(r2, 1, 2, 0, 3), MYM_SWIZZLE(r0, 2, 0, 1, 3)),
+                                 _mm_mul_ps(MYM_SWIZZLE(r2, 2, 0, 1, 3), MYM_SWIZZLE(r0, 1, 2, 0, 3)));
+    const __m128 c2 = _mm_sub_ps(_mm_mul_ps(MYM_SWIZZLE(r0, 1, 2, 0, 3), MYM_SWIZZLE(r1, 2, 0, 1, 3)),
+                                 _mm_mul_ps(MYM_SWIZZLE(r0, 2, 0, 1, 3), MYM_SWIZZLE(r1, 1, 2, 0, 3)));
+
+    // r0 . (r1 x r2)
+    const __m128 products = _mm_mul_ps(r0, c0);
+    const __m128 determinant = _mm_add_ps(_mm_add_ps(products, MYM_SWIZZLE(products, 1, 2, 0, 3)),
+                                          MYM_SWIZZLE(products, 2, 0, 1, 3));
+    const __m128 reciprocal = _mm_div_ps(_mm_set1_ps(1.f), MYM_SWIZZLE(determinant, 0, 0, 0, 0));
+
+    // the inverse's rows are the adjugate's columns transposed, w comes out 0
+    __m128 i0 = _mm_mul_ps(c0, reciprocal);
+    __m128 i1 = _mm_mul_ps(c1, reciprocal);
+    __m128 i2 = _mm_mul_ps(c2, reciprocal);
+    __m128 i3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(i0, i1, i2, i3);
+
+    __m128 inverse_translation = _mm_mul_ps(MYM_SWIZZLE(translation, 0, 0, 0, 0), i0);
+    inverse_translation = _mm_add_ps(inverse_translation, _mm_mul_ps(MYM_SWIZZLE(translation, 1, 1, 1, 1), i1));
+    inverse_translation = _mm_add_ps(inverse_translation, _mm_mul_ps(MYM_SWIZZLE(translation, 2, 2, 2, 2), i2));
+    inverse_translation = _mm_sub_ps(_mm_setr_ps(0.f, 0.f, 0.f, 1.f), inverse_translation);
+
+    Mat4 result;
+    _mm_store_ps(result.data[0], i0);
+    _mm_store_ps(result.data[1], i1);
+    _mm_store_ps(result.data[2], i2);
+    _mm_store_ps(result.data[3], inverse_translation);
+    return result;
+#else
+    return scalar::affineInverse(m);
+#endif
+}
+
+// result component i is row i of m dotted with v, like mym::vectorMultiplied
+inline Vec4 vectorMultiplied(const Vec4& v, const Mat4& m) {
+#if defined(MYM_SIMD_SSE)
+    const __m128 vector = _mm_load_ps(v.data);
+    __m128 p0 = _mm_mul_ps(_mm_load_ps(m.data[0]), vector);
+    __m128 p1 = _mm_mul_ps(_mm_load_ps(m.data[1]), vector);
+    __m128 p2 = _mm_mul_ps(_mm_load_ps(m.data[2]), vector);
+    __m128 p3 = _mm_mul_ps(_mm_load_ps(m.data[3]), vector);
+    _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+    Vec4 result;
+    _mm_store_ps(result.data, _mm_add_ps(_mm_add_ps(p0, p1), _mm_add_ps(p2, p3)));
+    return result;
+#elif defined(MYM_SIMD_NEON)
+    const float32x4_t vector = vld1q_f32(v.data);
+    const float32x4_t p0 = vmulq_f32(vld1q_f32(m.data[0]), vector);
+    const float32x4_t p1 = vmulq_f32(vld1q_f32(m.data[1]), vector);
+    const float32x4_t p2 = vmulq_f32(vld1q_f32(m.data[2]), vector);
+    const float32x4_t p3 = vmulq_f32(vld1q_f32(m.data[3]), vector);
+
+    // pairwise adds fold each row to its sum
+    const float32x2_t s01 = vpadd_f32(vpadd_f32(vget_low_f32(p0), vget_high_f32(p0)),
+                                      vpadd_f32(vget_low_f32(p1), vget_high_f32(p1)));
+    const float32x2_t s23 = vpadd_f32(vpadd_f32(vget_low_f32(p2), vget_high_f32(p2)),
+                                      vpadd_f32(vget_low_f32(p3), vget_high_f32(p3)));
+
+    Vec4 result;
+    vst1q_f32(result.data, vcombine_f32(s01, s23));
+    return result;
+#else
+    return scalar::vectorMultiplied(v, m);
+#endif
+}
+
+// v as a point (w = 1) through the rows of m, divided by w, like mym::positionMultiplied
+inline Vec3 positionMultiplied(const Vec3& v, const Mat4& m) {
+#if defined(MYM_SIMD_SSE)
+    __m128 sum = _mm_mul_ps(_mm_set1_ps(v.x), _mm_load_ps(m.data[0]));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(v.y), _mm_load_ps(m.data[1])));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(v.z), _mm_load_ps(m.data[2])));
+    sum = _mm_add_ps(sum, _mm_load_ps(m.data[3]));
+    sum = _mm_div_ps(sum, MYM_SWIZZLE(sum, 3, 3, 3, 3));
+
+    alignas(16) float out[4];
+    _mm_store_ps(out, sum);
+    return (Vec3){ out[0], out[1], out[2] };
+#elif defined(MYM_SIMD_NEON)
+    float32x4_t sum = vmulq_n_f32(vld1q_f32(m.data[0]), v.x);
+    sum = vmlaq_n_f32(sum, vld1q_f32(m.data[1]), v.y);
+    sum = vmlaq_n_f32(sum, vld1q_f32(m.data[2]), v.z);
+    sum = vaddq_f32(sum, vld1q_f32(m.data[3]));
+
+    const float w = vgetq_lane_f32(sum, 3);
+    return (Vec3){ vgetq_lane_f32(sum, 0) / w, vgetq_lane_f32(sum, 1) / w, vgetq_lane_f32(sum, 2) / w };
+#else
+    return scalar::positionMultiplied(v, m);
+#endif
+}
+
+// v as a direction (w = 0), translation doesn't apply
+inline Vec3 directionMultiplied(const Vec3& v, const Mat4& m) {
+#if defined(MYM_SIMD_SSE)
+    __m128 sum = _mm_mul_ps(_mm_set1_ps(v.x), _mm_load_ps(m.data[0]));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(v.y), _mm_load_ps(m.data[1])));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(v.z), _mm_load_ps(m.data[2])));
+
+    alignas(16) float out[4];
+    _mm_store_ps(out, sum);
+    return (Vec3){ out[0], out[1], out[2] };
+#elif defined(MYM_SIMD_NEON)
+    float32x4_t sum = vmulq_n_f32(vld1q_f32(m.data[0]), v.x);
+    sum = vmlaq_n_f32(sum, vld1q_f32(m.data[1]), v.y);
+    sum = vmlaq_n_f32(sum, vld1q_f32(m.data[2]), v.z);
+    return (Vec3){ vgetq_lane_f32(sum, 0), vgetq_lane_f32(sum, 1), vgetq_lane_f32(sum, 2) };
+#else
+    return scalar::directionMultiplied(v, m);
+#endif
+}
+
+#if defined(MYM_SIMD_SSE)
+#undef MYM_SHUFFLE
+#undef MYM_SWIZZLE
+#endif
+
+}
+
+}
+
+#endif //MAT_4_SIMD_H
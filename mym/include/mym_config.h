@@ -0,0 +1,29 @@
+#ifndef MYM_CONFIG_H
+#define MYM_CONFIG_H
+
+// mym is a shared library, so every dot or cross in a hot loop is a call into another DSO that the
+// compiler can't inline or vectorize. define MYM_HEADER_ONLY (the mym_inline cmake target does) and
+// vec.h, mat4.h, affine.h and bounds.h pull their definitions in as inline functions instead, with the
+// trivial ones constexpr.
+//
+// in that mode the functions sit in an inline namespace: mym::dot still finds them, but their
+// symbols differ from the library's exported ones, so code built either way links together.
+// the types are the same in both. helpers that aren't part of the api are MYM_INTERNAL, static in
+// the library and inline in a header. transform_batch.h and the batch calls in bounds.h are out of
+// line either way, a batch call amortizes it
+
+#ifdef MYM_HEADER_ONLY
+#define MYM_API inline
+#define MYM_INTERNAL inline
+#define MYM_CONSTEXPR constexpr
+#define MYM_FUNCTIONS_BEGIN inline namespace header_only {
+#define MYM_FUNCTIONS_END }
+#else
+#define MYM_API
+#define MYM_INTERNAL static
+#define MYM_CONSTEXPR
+#define MYM_FUNCTIONS_BEGIN
+#define MYM_FUNCTIONS_END
+#endif
+
+#endif //MYM_CONFIG_H
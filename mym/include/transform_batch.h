@@ -0,0 +1,44 @@
+#ifndef TRANSFORM_BATCH_H
+#define TRANSFORM_BATCH_H
+
+#include <stddef.h>
+
+#include "mat4.h"
+
+// one matrix over many points or directions, same row convention as positionMultiplied and
+// directionMultiplied. four at a time with SSE2/NEON and a scalar tail, so a call per mesh or per hit
+// list instead of a call per Vec3. out may be the same memory as the input.
+// for large counts split the range over threads, every element is independent (see parallelFor in lib)
+
+namespace mym {
+
+// array of structures: count Vec3s, each stride floats after the previous one. packed positions are
+// stride 3 (the fast path), a Vec3 inside a bigger struct is sizeof(struct) / sizeof(float). out is laid out the same
+
+// m is affine (last column 0, 0, 0, 1), so no divide by w. world and local transforms
+void transformPositions(const float* positions, float* out, size_t count, const Mat4& m, size_t stride = 3);
+// any matrix, divided by w like positionMultiplied. view projections
+void projectPositions(const float* positions, float* out, size_t count, const Mat4& m, size_t stride = 3);
+// w = 0, translation doesn't apply
+void transformDirections(const float* directions, float* out, size_t count, const Mat4& m, size_t stride = 3);
+
+// structure of arrays: x, y and z each in their own array of count floats
+typedef struct Vec3Arrays {
+    float* x;
+    float* y;
+    float* z;
+} Vec3Arrays;
+
+typedef struct ConstVec3Arrays {
+    const float* x;
+    const float* y;
+    const float* z;
+} ConstVec3Arrays;
+
+void transformPositions(ConstVec3Arrays positions, Vec3Arrays out, size_t count, const Mat4& m);
+void projectPositions(ConstVec3Arrays positions, Vec3Arrays out, size_t count, const Mat4& m);
+void transformDirections(ConstVec3Arrays directions, Vec3Arrays out, size_t count, const Mat4& m);
+
+}
+
+#endif //TRANSFORM_BATCH_H
@@ -3,6 +3,8 @@
 #include <math.h>
 #include <stdbool.h>
 
+#include "mym_config.h"
+
 namespace mym {
 
 typedef union Vec2 { 
@@ -29,7 +31,7 @@ typedef union Vec3 {
   float data[3];
 } Vec3;
 
-typedef union Vec4 {
+typedef union alignas(16) Vec4 {
   struct {
     float x;
     float y;
@@ -46,27 +48,35 @@ typedef struct {
     Vec3 value; 
 } Vec3Result;
 
-Vec3 scaleVector(Vec3 vec, float scalar);
+MYM_FUNCTIONS_BEGIN
+
+MYM_CONSTEXPR Vec3 scaleVector(Vec3 vec, float scalar);
 
-Vec3 addVectors(Vec3 a, Vec3 b);
+MYM_CONSTEXPR Vec3 addVectors(Vec3 a, Vec3 b);
 
-Vec3 subtractVectors(Vec3 a, Vec3 b);
+MYM_CONSTEXPR Vec3 subtractVectors(Vec3 a, Vec3 b);
 
-Vec3 normalize(Vec3 v);
+MYM_API Vec3 normalize(Vec3 v);
 
-Vec3 cross(Vec3 a, Vec3 b);
+MYM_CONSTEXPR Vec3 cross(Vec3 a, Vec3 b);
 
-float dot(Vec3 a, Vec3 b);
+MYM_CONSTEXPR float dot(Vec3 a, Vec3 b);
 
-float length(Vec3 v);
+MYM_API float length(Vec3 v);
 
-Vec3 calculateOrbitPosition(
+MYM_API Vec3 calculateOrbitPosition(
     float azimuth, 
     float elevation, 
     Vec3 orbitTarget,
     float orbitRadius
 );
 
+MYM_FUNCTIONS_END
+
 }
 
+#ifdef MYM_HEADER_ONLY
+#include "vec.inl"
+#endif
+
 #endif //VEC_H 
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include "transform_batch.h"
+#include "mat4_simd.h"
+
+namespace mym {
+
+// what the matrix does to a point: translate adds row 3, project also divides by w
+enum class Transform { Direction, Affine, Projective };
+
+template<Transform kind>
+static inline void transformOne(const float x, const float y, const float z, const Mat4& m, float* out) {
+    float ox = x * m.m00 + y * m.m10 + z * m.m20;
+    float oy = x * m.m01 + y * m.m11 + z * m.m21;
+    float oz = x * m.m02 + y * m.m12 + z * m.m22;
+    if (kind != Transform::Direction) {
+        ox += m.m30;
+        oy += m.m31;
+        oz += m.m32;
+    }
+    if (kind == Transform::Projective) {
+        const float w = x * m.m03 + y * m.m13 + z * m.m23 + m.m33;
+        ox /= w;
+        oy /= w;
+        oz /= w;
+    }
+    out[0] = ox;
+    out[1] = oy;
+    out[2] = oz;
+}
+
+#if defined(MYM_SIMD_SSE)
+
+#define MYM_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+
+// the matrix columns splatted, one register per element
+typedef struct Columns {
+    __m128 m[4][4];
+} Columns;
+
+static Columns splat(const Mat4& m) {
+    Columns columns;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            columns.m[i][j] = _mm_set1_ps(m.data[i][j]);
+        }
+    }
+    return columns;
+}
+
+// four points at once, one coordinate per register
+template<Transform kind>
+static inline void transformFour(__m128& x, __m128& y, __m128& z, const Columns& c) {
+    __m128 ox = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, c.m[0][0]), _mm_mul_ps(y, c.m[1][0])), _mm_mul_ps(z, c.m[2][0]));
+    __m128 oy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, c.m[0][1]), _mm_mul_ps(y, c.m[1][1])), _mm_mul_ps(z, c.m[2][1]));
+    __m128 oz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, c.m[0][2]), _mm_mul_ps(y, c.m[1][2])), _mm_mul_ps(z, c.m[2][2]));
+    if (kind != Transform::Direction) {
+        ox = _mm_add_ps(ox, c.m[3][0]);
+        oy = _mm_add_ps(oy, c.m[3][1]);
+        oz = _mm_add_ps(oz, c.m[3][2]);
+    }
+    if (kind == Transform::Projective) {
+        const __m128 w = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, c.m[0][3]), _mm_mul_ps(y, c.m[1][3])),
+                                    _mm_add_ps(_mm_mul_ps(z, c.m[2][3]), c.m[3][3]));
+        ox = _mm_div_ps(ox, w);
+        oy = _mm_div_ps(oy, w);
+        oz = _mm_div_ps(oz, w);
+    }
+    x = ox;
+    y = oy;
+    z = oz;
+}
+
+template<Transform kind>
+static void transformPacked(const float* in, float* out, const size_t count, const Mat4& m) {
+    const Columns c = splat(m);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3 -> x0..x3, y0..y3, z0..z3
+        const __m128 a = _mm_loadu_ps(in + i * 3);
+        const __m128 b = _mm_loadu_ps(in + i * 3 + 4);
+        const __m128 d = _mm_loadu_ps(in + i * 3 + 8);
+
+        __m128 x = MYM_SHUFFLE(a, MYM_SHUFFLE(b, d, 2, 2, 1, 1), 0, 3, 0, 2);
+        __m128 y = MYM_SHUFFLE(MYM_SHUFFLE(a, b, 1, 1, 0, 3), MYM_SHUFFLE(b, d, 3, 3, 2, 2), 0, 2, 0, 2);
+        __m128 z = MYM_SHUFFLE(MYM_SHUFFLE(a, b, 2, 2, 1, 1), d, 0, 2, 0, 3);
+
+        transformFour<kind>(x, y, z, c);
+
+        // and back
+        _mm_storeu_ps(out + i * 3, MYM_SHUFFLE(MYM_SHUFFLE(x, y, 0, 0, 0, 0), MYM_SHUFFLE(z, x, 0, 0, 1, 1), 0, 2, 0, 2));
+        _mm_storeu_ps(out + i * 3 + 4, MYM_SHUFFLE(MYM_SHUFFLE(y, z, 1, 1, 1, 1), MYM_SHUFFLE(x, y, 2, 2, 2, 2), 0, 2, 0, 2));
+        _mm_storeu_ps(out + i * 3 + 8, MYM_SHUFFLE(MYM_SHUFFLE(z, x, 2, 2, 3, 3), MYM_SHUFFLE(y, z, 3, 3, 3, 3), 0, 2, 0, 2));
+    }
+    for (; i < count; i++) {
+        transformOne<kind>(in[i * 3], in[i * 3 + 1], in[i * 3 + 2], m, out + i * 3);
+    }
+}
+
+template<Transform kind>
+static void transformArrays(const ConstVec3Arrays in, const Vec3Arrays out, const size_t count, const Mat4& m) {
+    const Columns c = splat(m);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(in.x + i);
+        __m128 y = _mm_loadu_ps(in.y + i);
+        __m128 z = _mm_loadu_ps(in.z + i);
+        transformFour<kind>(x, y, z, c);
+        _mm_storeu_ps(out.x + i, x);
+        _mm_storeu_ps(out.y + i, y);
+        _mm_storeu_ps(out.z + i, z);
+    }
+    for (; i < count; i++) {
+        float result[3];
+        transformOne<kind>(in.x[i], in.y[i], in.z[i], m, result);
+        out.x[i] = result[0];
+        out.y[i] = result[1];
+        out.z[i] = result[2];
+    }
+}
+
+#undef MYM_SHUFFLE
+
+#elif defined(MYM_SIMD_NEON)
+
+typedef struct Columns {
+    float32x4_t m[4][4];
+} Columns;
+
+static Columns splat(const Mat4& m) {
+    Columns columns;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            columns.m[i][j] = vdupq_n_f32(m.data[i][j]);
+        }
+    }
+    return columns;
+}
+
+template<Transform kind>
+static inline void transformFour(float32x4_t& x, float32x4_t& y, float32x4_t& z, const Columns& c) {
+    float32x4_t ox = vmlaq_f32(vmlaq_f32(vmulq_f32(x, c.m[0][0]), y, c.m[1][0]), z, c.m[2][0]);
+    float32x4_t oy = vmlaq_f32(vmlaq_f32(vmulq_f32(x, c.m[0][1]), y, c.m[1][1]), z, c.m[2][1]);
+    float32x4_t oz = vmlaq_f32(vmlaq_f32(vmulq_f32(x, c.m[0][2]), y, c.m[1][2]), z, c.m[2][2]);
+    if (kind != Transform::Direction) {
+        ox = vaddq_f32(ox, c.m[3][0]);
+        oy = vaddq_f32(oy, c.m[3][1]);
+        oz = vaddq_f32(oz, c.m[3][2]);
+    }
+    if (kind == Transform::Projective) {
+        const float32x4_t w = vmlaq_f32(vmlaq_f32(vmlaq_f32(c.m[3][3], x, c.m[0][3]), y, c.m[1][3]), z, c.m[2][3]);
+        // the estimate plus two newton steps is as close as a divide here
+        float32x4_t inverse_w = vrecpeq_f32(w);
+        inverse_w = vmulq_f32(inverse_w, vrecpsq_f32(w, inverse_w));
+        inverse_w = vmulq_f32(inverse_w, vrecpsq_f32(w, inverse_w));
+        ox = vmulq_f32(ox, inverse_w);
+        oy = vmulq_f32(oy, inverse_w);
+        oz = vmulq_f32(oz, inverse_w);
+    }
+    x = ox;
+    y = oy;
+    z = oz;
+}
+
+template<Transform kind>
+static void transformPacked(const float* in, float* out, const size_t count, const Mat4& m) {
+    const Columns c = splat(m);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // vld3 deinterleaves x y z on its own
+        float32x4x3_t points = vld3q_f32(in + i * 3);
+        transformFour<kind>(points.val[0], points.val[1], points.val[2], c);
+        vst3q_f32(out + i * 3, points);
+    }
+    for (; i < count; i++) {
+        transformOne<kind>(in[i * 3], in[i * 3 + 1], in[i * 3 + 2], m, out + i * 3);
+    }
+}
+
+template<Transform kind>
+static void transformArrays(const ConstVec3Arrays in, const Vec3Arrays out, const size_t count, const Mat4& m) {
+    const Columns c = splat(m);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t x = vld1q_f32(in.x + i);
+        float32x4_t y = vld1q_f32(in.y + i);
+        float32x4_t z = vld1q_f32(in.z + i);
+        transformFour<kind>(x, y, z, c);
+        vst1q_f32(out.x + i, x);
+        vst1q_f32(out.y + i, y);
+        vst1q_f32(out.z + i, z);
+    }
+    for (; i < count; i++) {
+        float result[3];
+        transformOne<kind>(in.x[i], in.y[i], in.z[i], m, result);
+        out.x[i] = result[0];
+        out.y[i] = result[1];
+        out.z[i] = result[2];
+    }
+}
+
+#else
+
+template<Transform kind>
+static void transformPacked(const float* in, float* out, const size_t count, const Mat4& m) {
+    for (size_t i = 0; i < count; i++) {
+        transformOne<kind>(in[i * 3], in[i * 3 + 1], in[i * 3 + 2], m, out + i * 3);
+    }
+}
+
+template<Transform kind>
+static void transformArrays(const ConstVec3Arrays in, const Vec3Arrays out, const size_t count, const Mat4& m) {
+    for (size_t i = 0; i < count; i++) {
+        float result[3];
+        transformOne<kind>(in.x[i], in.y[i], in.z[i], m, result);
+        out.x[i] = result[0];
+        out.y[i] = result[1];
+        out.z[i] = result[2];
+    }
+}
+
+#endif
+
+// any other stride is a Vec3 inside some struct, one at a time is all it gets
+template<Transform kind>
+static void transformStrided(const float* in, float* out, const size_t count, const Mat4& m, const size_t stride) {
+    if (stride == 3) {
+        transformPacked<kind>(in, out, count, m);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const float* point = in + i * stride;
+        transformOne<kind>(point[0], point[1], point[2], m, out + i * stride);
+    }
+}
+
+void transformPositions(const float* positions, float* out, const size_t count, const Mat4& m, const size_t stride) {
+    transformStrided<Transform::Affine>(positions, out, count, m, stride);
+}
+
+void projectPositions(const float* positions, float* out, const size_t count, const Mat4& m, const size_t stride) {
+    transformStrided<Transform::Projective>(positions, out, count, m, stride);
+}
+
+void transformDirections(const float* directions, float* out, const size_t count, const Mat4& m, const size_t stride) {
+    transformStrided<Transform::Direction>(directions, out, count, m, stride);
+}
+
+void transformPositions(const ConstVec3Arrays positions, const Vec3Arrays out, const size_t count, const Mat4& m) {
+    transformArrays<Transform::Affine>(positions, out, count, m);
+}
+
+void projectPositions(const ConstVec3Arrays positions, const Vec3Arrays out, const size_t count, const Mat4& m) {
+    transformArrays<Transform::Projective>(positions, out, count, m);
+}
+
+void transformDirections(const ConstVec3Arrays directions, const Vec3Arrays out, const size_t count, const Mat4& m) {
+    transformArrays<Transform::Direction>(directions, out, count, m);
+}
+
+}
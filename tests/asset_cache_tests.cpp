@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "asset_cache.h"
+#include "mat4.h"
+#include "material_table.h"
+#include "scene.h"
+#include "test_helpers.h"
+
+using namespace mym;
+
+static const char* TEST_CACHE_NAME = "asset_cache_test.nrc";
+
+static const char* TEST_TEXTURE_SOURCE = "asset_cache_test.glb*0";
+constexpr uint64_t TEST_TEXTURE_HASH = 0x5eed;
+
+// a root with one textured triangle child, its material and texture in the material table.
+// the texture is 2x2 with its 1x1 mip after it
+static SceneNode* cacheTestScene(unsigned char* pixels) {
+
+    MaterialTable& table = materialTable();
+    bool created = false;
+    const TextureHandle texture = table.acquireTexture(TEST_TEXTURE_SOURCE, TEST_TEXTURE_HASH, created);
+    table.setTexturePixels(texture, { .pixels = pixels, .width = 2, .height = 2, .channels = 4, .levels = 2, .needs_free = false });
+
+    Mesh mesh = {
+        .vertices = { .vertex_count = 3, .index_count = 3 },
+        .material = table.addMaterial(BasicTextureMaterial{
+            .texture = texture,
+            .wrap_u = WrapMode::Clamp,
+            .wrap_v = WrapMode::Mirror,
+            .shininess = 0.25f,
+        }),
+    };
+    table.releaseTexture(texture);
+
+    const float positions[9] = { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f };
+    for (size_t i = 0; i < 9; i++) {
+        mesh.vertices.positions.push_back(positions[i]);
+        mesh.vertices.normals.push_back(i % 3 == 2 ? 1.f : 0.f);
+    }
+    for (unsigned int i = 0; i < 3; i++) {
+        mesh.vertices.indices.push_back(i);
+    }
+
+    for (size_t i = 0; i < 6; i++) {
+        mesh.vertices.uvs.push_back(i * 0.1f);
+    }
+
+    mesh.lod.center = { 0.5f, 0.5f, 0.f };
+    mesh.lod.radius = 0.75f;
+    mesh.lod.levels.push_back({ .indices = mesh.vertices.indices, .index_count = 3, .error = 0.125f });
+
+    SceneNode* root = new SceneNode(createSceneNode(translation(1.f, 2.f, 3.f), std::nullopt, "root"));
+    SceneNode* child = new SceneNode(createSceneNode(translation(0.f, 1.f, 0.f), std::move(mesh), "child"));
+    child->parent = root;
+    root->children.push_back(child);
+    updateWorldTransform(root);
+
+    return root;
+}
+
+TestResult asset_cache_round_trip() {
+
+    unsigned char pixels[20];
+    for (size_t i = 0; i < 20; i++) {
+        pixels[i] = static_cast<unsigned char>(i * 16);
+    }
+
+    SceneNode* scene = cacheTestScene(pixels);
+    const uint64_t key = hashBytes("round trip", 10, 1);
+    const TempFile cache(TEST_CACHE_NAME);
+
+    if (!writeAssetCache(cache.path(), *scene, key)) {
+        return (TestResult){
+            .pass = false,
+            .message = "asset cache could not be written",
+        };
+    }
+
+    // with the written scene's material gone the texture has to come out of the cache
+    MaterialTable& table = materialTable();
+    const Mesh& original = scene->children[0]->mesh.value();
+    table.releaseMaterial(original.material);
+
+    std::optional<SceneNode> read = readAssetCache(cache.path(), key);
+
+    if (!read.has_value() || read.value().children.size() != 1 || !read.value().children[0]->mesh.has_value()) {
+        return (TestResult){
+            .pass = false,
+            .message = "asset cache did not read back the node hierarchy",
+        };
+    }
+
+    const SceneNode* child = read.value().children[0];
+    const Mesh& mesh = child->mesh.value();
+    const std::optional<Material> material = table.material(mesh.material);
+    const bool textured = material.has_value() && std::holds_alternative<BasicTextureMaterial>(material.value());
+    const BasicTextureMaterial textured_material = textured ? std::get<BasicTextureMaterial>(material.value()) : BasicTextureMaterial{};
+    const std::optional<TextureEntry> texture = table.texture(textured_material.texture);
+    const std::optional<TextureData> texture_pixels = table.pixelsToUpload(textured_material.texture);
+
+    const bool streams_match =
+        mesh.vertices.vertex_count == 3 && mesh.vertices.index_count == 3 &&
+        memcmp(mesh.vertices.positions.begin(), original.vertices.positions.begin(), sizeof(float) * 9) == 0 &&
+        memcmp(mesh.vertices.normals.begin(), original.vertices.normals.begin(), sizeof(float) * 9) == 0 &&
+        mesh.vertices.indices[2] == 2 && mesh.vertices.uvs.size() == 6 && floatsAreClose(mesh.vertices.uvs[5], 0.5f);
+
+    const bool lods_match = mesh.lod.levels.size() == 1 && mesh.lod.levels[0].index_count == 3 &&
+        floatsAreClose(mesh.lod.levels[0].error, 0.125f) && floatsAreClose(mesh.lod.radius, 0.75f);
+
+    // the pixels come straight out of the mapping, 64 byte aligned
+    const bool texture_matches = textured && textured_material.wrap_v == WrapMode::Mirror &&
+        texture.has_value() && texture.value().source == TEST_TEXTURE_SOURCE &&
+        texture.value().content_hash == TEST_TEXTURE_HASH && texture_pixels.has_value() &&
+        texture_pixels.value().pixels != pixels && !texture_pixels.value().needs_free &&
+        reinterpret_cast<uintptr_t>(texture_pixels.value().pixels) % 64 == 0 &&
+        texture_pixels.value().levels == 2 && memcmp(texture_pixels.value().pixels, pixels, 20) == 0;
+
+    // once the texture is on the gpu its pixels are gone and the scene can't be cached any more
+    table.textureUploaded(textured_material.texture, { .array = 1, .layer = 0 });
+    const bool uploaded_not_written = !writeAssetCache(cache.path(), read.value(), key);
+    table.releaseMaterial(mesh.material);
+    table.takeReleasedTextureLayers();
+
+    const bool node_matches = child->name.value_or("") == "child" &&
+        vec3sAreEqual(getPosition(child->world_transform), { 1.f, 3.f, 3.f });
+
+    if (streams_match && lods_match && texture_matches && uploaded_not_written && node_matches) {
+        return (TestResult){
+            .pass = true,
+            .message = "asset cache round trips a textured scene",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "asset cache lost data in the round trip",
+        };
+    }
+}
+
+TestResult asset_cache_rejects_other_keys() {
+
+    unsigned char pixels[20] = {};
+    SceneNode* scene = cacheTestScene(pixels);
+    const TempFile cache(TEST_CACHE_NAME);
+
+    writeAssetCache(cache.path(), *scene, 1);
+    const std::optional<SceneNode> read = readAssetCache(cache.path(), 2);
+
+    if (!read.has_value() && !readAssetCache("does/not/exist.nrc", 1).has_value()) {
+        return (TestResult){
+            .pass = true,
+            .message = "asset cache misses on a different key",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "asset cache returned a scene for the wrong key",
+        };
+    }
+}
+
+std::vector<TestResult> runAssetCacheTests() {
+
+    std::vector<TestResult> results;
+    results.push_back(asset_cache_round_trip());
+    results.push_back(asset_cache_rejects_other_keys());
+
+    return results;
+}
@@ -0,0 +1,210 @@
+#include <float.h>
+#include <vector>
+
+#include "bounds.h"
+#include "mat4.h"
+#include "test_helpers.h"
+
+using namespace mym;
+
+// camera at z = 10 looking at the origin, 90 degrees so the side planes are easy to reason about
+static Mat4 testViewProjection() {
+    const Mat4 view = inverse(lookAt((Vec3){ .x = 0.f, .y = 0.f, .z = 10.f }, (Vec3){ .x = 0.f, .y = 0.f, .z = 0.f },
+                                     (Vec3){ .x = 0.f, .y = 1.f, .z = 0.f }));
+    return multiplied(perspective(PI * 0.5f, 1.f, 0.1f, 100.f), view);
+}
+
+static Frustum testFrustum() {
+    return frustumFromViewProjection(testViewProjection());
+}
+
+static Aabb boxAround(const Vec3 center, const float half_size) {
+    const Vec3 half = { .x = half_size, .y = half_size, .z = half_size };
+    return (Aabb){ .min = subtractVectors(center, half), .max = addVectors(center, half) };
+}
+
+// a scatter of boxes of different sizes, some inside, some across a plane, most outside
+typedef struct BoxArrays {
+    std::vector<float> min_x, min_y, min_z, max_x, max_y, max_z;
+} BoxArrays;
+
+static BoxArrays scatteredBoxes(const size_t count) {
+    BoxArrays boxes;
+    unsigned int seed = 1;
+    const auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+    };
+    for (size_t i = 0; i < count; i++) {
+        const Aabb box = boxAround((Vec3){ .x = next() * 60.f - 30.f, .y = next() * 60.f - 30.f, .z = next() * 150.f - 120.f },
+                                   next() * 3.f);
+        boxes.min_x.push_back(box.min.x);
+        boxes.min_y.push_back(box.min.y);
+        boxes.min_z.push_back(box.min.z);
+        boxes.max_x.push_back(box.max.x);
+        boxes.max_y.push_back(box.max.y);
+        boxes.max_z.push_back(box.max.z);
+    }
+    return boxes;
+}
+
+static AabbArrays arraysOf(const BoxArrays& boxes) {
+    return (AabbArrays){
+        boxes.min_x.data(), boxes.min_y.data(), boxes.min_z.data(),
+        boxes.max_x.data(), boxes.max_y.data(), boxes.max_z.data(),
+    };
+}
+
+static Aabb boxAt(const BoxArrays& boxes, const size_t i) {
+    return (Aabb){
+        .min = (Vec3){ .x = boxes.min_x[i], .y = boxes.min_y[i], .z = boxes.min_z[i] },
+        .max = (Vec3){ .x = boxes.max_x[i], .y = boxes.max_y[i], .z = boxes.max_z[i] },
+    };
+}
+
+TestResult bounds_frustum_keeps_what_the_camera_sees() {
+
+    const Frustum frustum = testFrustum();
+
+    // the planes agree with the projection itself: a point is inside them exactly when it lands in clip space
+    const Mat4 view_projection = testViewProjection();
+    bool planes_match = true;
+    for (int i = 0; i < 200; i++) {
+        const Vec3 point = { .x = (i % 7) * 9.f - 27.f, .y = (i % 11) * 7.f - 35.f, .z = 12.f - (i % 13) * 9.f };
+        // row vector times the matrix, the way the renderer's shaders see it (vectorMultiplied goes the other way)
+        float clip[4];
+        for (int j = 0; j < 4; j++) {
+            clip[j] = point.x * view_projection.data[0][j] + point.y * view_projection.data[1][j] +
+                      point.z * view_projection.data[2][j] + view_projection.data[3][j];
+        }
+        const bool in_clip = clip[3] > 0.f && fabsf(clip[0]) <= clip[3] && fabsf(clip[1]) <= clip[3] && fabsf(clip[2]) <= clip[3];
+        float nearest = FLT_MAX;
+        for (int p = 0; p < 6; p++) {
+            const float distance = signedDistance(frustum.planes[p], point);
+            nearest = distance < nearest ? distance : nearest;
+        }
+        // points right on a plane can round either way
+        if (fabsf(nearest) > 1e-3f) {
+            planes_match = planes_match && in_clip == (nearest > 0.f);
+        }
+    }
+
+    const Vec3 origin = { .x = 0.f, .y = 0.f, .z = 0.f };
+    const bool boxes_match = isVisible(frustum, boxAround(origin, 1.f)) &&
+                             !isVisible(frustum, boxAround((Vec3){ .x = 0.f, .y = 0.f, .z = 20.f }, 1.f)) &&   // behind
+                             !isVisible(frustum, boxAround((Vec3){ .x = 30.f, .y = 0.f, .z = 0.f }, 1.f)) &&   // right
+                             !isVisible(frustum, boxAround((Vec3){ .x = 0.f, .y = 0.f, .z = -200.f }, 1.f)) && // past far
+                             isVisible(frustum, boxAround((Vec3){ .x = 11.f, .y = 0.f, .z = 0.f }, 2.f));      // across right
+    const bool spheres_match = isVisible(frustum, (Sphere){ .center = origin, .radius = 1.f }) &&
+                               !isVisible(frustum, (Sphere){ .center = (Vec3){ .x = 30.f, .y = 0.f, .z = 0.f }, .radius = 1.f }) &&
+                               isVisible(frustum, boundingSphere(boxAround((Vec3){ .x = 11.f, .y = 0.f, .z = 0.f }, 2.f)));
+
+    if (planes_match && boxes_match && spheres_match) {
+        return (TestResult){
+            .pass = true,
+            .message = "bounds frustum planes match clip space and keep boxes and spheres the camera sees",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "bounds frustum disagrees with clip space or culls a visible box or sphere",
+        };
+    }
+}
+
+TestResult bounds_batch_tests_match_single_ones() {
+
+    // 4 at a time plus a tail of 3
+    constexpr size_t COUNT = 1003;
+    const BoxArrays boxes = scatteredBoxes(COUNT);
+    const Frustum frustum = testFrustum();
+
+    std::vector<uint32_t> visible(COUNT);
+    const size_t visible_count = cullAabbs(frustum, arraysOf(boxes), COUNT, visible.data());
+    std::vector<uint32_t> expected;
+    for (size_t i = 0; i < COUNT; i++) {
+        if (isVisible(frustum, boxAt(boxes, i))) expected.push_back(static_cast<uint32_t>(i));
+    }
+    bool culls_match = visible_count == expected.size() && visible_count > 0 && visible_count < COUNT;
+    for (size_t i = 0; culls_match && i < visible_count; i++) {
+        culls_match = visible[i] == expected[i];
+    }
+
+    // one ray with a zero axis, the slabs of that axis are all or nothing
+    const Vec3 ray_origin = { .x = 0.f, .y = 0.f, .z = 10.f };
+    const Vec3 inverse_direction = inverseDirection(normalize((Vec3){ .x = 0.1f, .y = 0.f, .z = -1.f }));
+    std::vector<float> distances(COUNT);
+    rayAabbDistances(ray_origin, inverse_direction, arraysOf(boxes), COUNT, distances.data());
+    bool rays_match = true;
+    size_t hits = 0;
+    for (size_t i = 0; i < COUNT; i++) {
+        const FloatResult hit = rayIntersectsAabb(ray_origin, inverse_direction, boxAt(boxes, i));
+        rays_match = rays_match && (hit.valid ? distances[i] == hit.value : distances[i] == FLT_MAX);
+        hits += hit.valid;
+    }
+    rays_match = rays_match && hits > 0 && hits < COUNT;
+
+    if (culls_match && rays_match) {
+        return (TestResult){
+            .pass = true,
+            .message = "bounds batch frustum and ray tests match one box at a time",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "a bounds batch test disagrees with the single box one",
+        };
+    }
+}
+
+TestResult bounds_ray_and_box_helpers() {
+
+    const Aabb box = { .min = (Vec3){ .x = -1.f, .y = -1.f, .z = -1.f }, .max = (Vec3){ .x = 1.f, .y = 1.f, .z = 1.f } };
+    const Vec3 down_z = inverseDirection((Vec3){ .x = 0.f, .y = 0.f, .z = -1.f });
+
+    const FloatResult front = rayIntersectsAabb((Vec3){ .x = 0.5f, .y = 0.f, .z = 5.f }, down_z, box);
+    const FloatResult inside = rayIntersectsAabb((Vec3){ .x = 0.f, .y = 0.f, .z = 0.f }, down_z, box);
+    const FloatResult beside = rayIntersectsAabb((Vec3){ .x = 2.f, .y = 0.f, .z = 5.f }, down_z, box);
+    const FloatResult behind = rayIntersectsAabb((Vec3){ .x = 0.f, .y = 0.f, .z = -5.f }, down_z, box);
+    const bool rays = front.valid && floatsAreClose(front.value, 4.f) && inside.valid && inside.value == 0.f &&
+                      !beside.valid && !behind.valid;
+
+    // for a box arvo's method is exact, the box around the transformed corners. Mat4 and Affine agree
+    const Mat4 m = scaled(fromPositionAndEuler((Vec3){ .x = 3.f, .y = -2.f, .z = 1.f }, (Vec3){ .x = 0.4f, .y = 1.2f, .z = -0.3f }),
+                          2.f, 0.5f, 1.f);
+    const Aabb moved = transformed(box, m);
+    const Aabb moved_affine = transformed(box, toAffine(m));
+    Aabb around_corners = emptyAabb();
+    for (int i = 0; i < 8; i++) {
+        const Vec3 corner = { .x = i & 1 ? 1.f : -1.f, .y = i & 2 ? 1.f : -1.f, .z = i & 4 ? 1.f : -1.f };
+        around_corners = expanded(around_corners, positionMultiplied(corner, m));
+    }
+    const Aabb moved_box = transformed(box, translation(1.f, 2.f, 3.f));
+    const bool boxes = vec3sAreEqual(moved.min, around_corners.min) && vec3sAreEqual(moved.max, around_corners.max) &&
+                       vec3sAreEqual(moved.min, moved_affine.min) && vec3sAreEqual(moved.max, moved_affine.max) &&
+                       vec3sAreEqual(center(moved_box), (Vec3){ .x = 1.f, .y = 2.f, .z = 3.f }) &&
+                       vec3sAreEqual(extents(moved_box), (Vec3){ .x = 1.f, .y = 1.f, .z = 1.f }) &&
+                       contains(moved_box, (Vec3){ .x = 0.5f, .y = 2.5f, .z = 3.f }) && !contains(box, moved_box.max) &&
+                       overlaps(box, transformed(box, translation(1.5f, 1.5f, 1.5f))) && !overlaps(box, transformed(box, translation(3.f, 0.f, 0.f))) &&
+                       vec3sAreEqual(merged(box, moved_box).max, moved_box.max);
+
+    if (rays && boxes) {
+        return (TestResult){
+            .pass = true,
+            .message = "bounds ray slab test and box helpers give the expected boxes and distances",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "bounds ray slab test or a box helper is off",
+        };
+    }
+}
+
+std::vector<TestResult> runBoundsTests() {
+    return {
+        bounds_frustum_keeps_what_the_camera_sees(),
+        bounds_batch_tests_match_single_ones(),
+        bounds_ray_and_box_helpers(),
+    };
+}
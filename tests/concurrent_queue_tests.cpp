@@ -0,0 +1,100 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "concurrent_queue.hpp"
+#include "test_helpers.h"
+
+TestResult concurrent_queue_reports_full_and_empty() {
+
+    BoundedQueue<int> queue(4);
+
+    bool pushed = true;
+    for (int i = 0; i < 4; i++) {
+        pushed = pushed && queue.tryPush(i);
+    }
+    const bool rejected_when_full = !queue.tryPush(4);
+
+    bool in_order = true;
+    for (int i = 0; i < 4; i++) {
+        const std::optional<int> value = queue.tryPop();
+        in_order = in_order && value.has_value() && value.value() == i;
+    }
+    const bool empty = !queue.tryPop().has_value();
+
+    if (pushed && rejected_when_full && in_order && empty) {
+        return (TestResult){
+            .pass = true,
+            .message = "bounded queue fills to capacity and pops in order",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "bounded queue got its full/empty state or ordering wrong",
+        };
+    }
+}
+
+TestResult concurrent_queue_delivers_every_item_once() {
+
+    constexpr size_t producers = 4;
+    constexpr size_t items_per_producer = 20000;
+
+    // small on purpose so producers keep running into a full queue
+    BoundedQueue<size_t> queue(64);
+    std::vector<std::atomic<int>> seen(producers * items_per_producer);
+    std::atomic<size_t> popped = 0;
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, p]() {
+            for (size_t i = 0; i < items_per_producer; i++) {
+                while (!queue.tryPush(p * items_per_producer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (size_t c = 0; c < 2; c++) {
+        threads.emplace_back([&queue, &seen, &popped]() {
+            while (popped.load() < producers * items_per_producer) {
+                const std::optional<size_t> value = queue.tryPop();
+                if (value.has_value()) {
+                    seen[value.value()]++;
+                    popped++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    bool exactly_once = true;
+    for (const auto& count : seen) {
+        exactly_once = exactly_once && count.load() == 1;
+    }
+
+    if (exactly_once) {
+        return (TestResult){
+            .pass = true,
+            .message = "bounded queue delivered every item exactly once across producers and consumers",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "bounded queue lost or duplicated items under contention",
+        };
+    }
+}
+
+std::vector<TestResult> runConcurrentQueueTests() {
+
+    std::vector<TestResult> results;
+    results.push_back(concurrent_queue_reports_full_and_empty());
+    results.push_back(concurrent_queue_delivers_every_item_once());
+
+    return results;
+}
@@ -0,0 +1,193 @@
+#include <string>
+
+#include "mystl.hpp"
+#include "test_helpers.h"
+
+// counts what goes through it, has no reallocate so DArray falls back to allocate and move
+template<class T>
+struct CountingAllocator {
+    using value_type = T;
+
+    size_t* allocations;
+
+    explicit CountingAllocator(size_t* allocations) : allocations(allocations) {}
+    template<class U>
+    CountingAllocator(const CountingAllocator<U>& other) : allocations(other.allocations) {}
+
+    T* allocate(const size_t count) {
+        (*allocations)++;
+        return std::allocator<T>().allocate(count);
+    }
+    void deallocate(T* memory, const size_t count) {
+        std::allocator<T>().deallocate(memory, count);
+    }
+};
+
+// copies are counted, growing the array must only ever move
+struct CopyCounter {
+    static size_t copies;
+    int value;
+
+    CopyCounter(const int value) : value(value) {}
+    CopyCounter(const CopyCounter& other) : value(other.value) { copies++; }
+    CopyCounter(CopyCounter&& other) noexcept : value(other.value) {}
+    CopyCounter& operator=(const CopyCounter& other) { value = other.value; copies++; return *this; }
+    CopyCounter& operator=(CopyCounter&& other) noexcept { value = other.value; return *this; }
+};
+
+size_t CopyCounter::copies = 0;
+
+TestResult darray_bulk_fills() {
+
+    const float xyz[6] = { 1.f, 2.f, 3.f, 4.f, 5.f, 6.f };
+
+    DArray<float> values;
+    values.reserve(8);
+    values.push_back(0.f);
+    values.append(xyz, 6);
+
+    // a grow past the reservation keeps everything that was there
+    float* extra = values.extend(4);
+    for (size_t i = 0; i < 4; i++) {
+        extra[i] = 10.f + i;
+    }
+
+    bool values_match = values.size() == 11 && values[0] == 0.f;
+    for (size_t i = 0; i < 6; i++) {
+        values_match = values_match && values[1 + i] == xyz[i];
+    }
+    for (size_t i = 0; i < 4; i++) {
+        values_match = values_match && values[7 + i] == 10.f + i;
+    }
+
+    if (values_match) {
+        return (TestResult){
+            .pass = true,
+            .message = "darray reserve, append and extend keep every value in order",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "darray bulk fills lost or reordered values",
+        };
+    }
+}
+
+TestResult darray_moves_items_when_growing() {
+
+    CopyCounter::copies = 0;
+    DArray<CopyCounter> counters;
+    for (int i = 0; i < 1000; i++) {
+        counters.emplace_back(i);
+    }
+    counters.erase(0);
+    counters.insert(10, CopyCounter(-1));
+
+    // the one copy is insert taking its value, which could be one of the array's own items
+    bool values_match = counters.size() == 1000 && counters[0].value == 1 && counters[10].value == -1 &&
+                        counters[11].value == 11 && counters[999].value == 999;
+
+    DArray<std::string> strings;
+    for (size_t i = 0; i < 100; i++) {
+        strings.push_back(std::to_string(i));
+    }
+    strings.resize(50);
+    values_match = values_match && strings.size() == 50 && strings[49] == "49";
+
+    if (values_match && CopyCounter::copies == 1) {
+        return (TestResult){
+            .pass = true,
+            .message = "darray moves items when it grows and erases",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "darray copied items while growing or lost one",
+        };
+    }
+}
+
+TestResult darray_uses_its_allocator() {
+
+    size_t allocations = 0;
+    DArray<int, CountingAllocator<int>> values{ CountingAllocator<int>(&allocations) };
+    values.reserve(64);
+    for (int i = 0; i < 64; i++) {
+        values.push_back(i);
+    }
+
+    // reserved once, so filling it up never allocated again
+    const bool reserved_once = allocations == 1;
+
+    const DArray<int, CountingAllocator<int>> copy = values;
+    const bool copied = allocations == 2 && copy.size() == 64 && copy[63] == 63;
+
+    if (reserved_once && copied) {
+        return (TestResult){
+            .pass = true,
+            .message = "darray allocates through its allocator",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "darray allocated more often than expected or bypassed its allocator",
+        };
+    }
+}
+
+TestResult small_array_stays_inline_until_full() {
+
+    size_t allocations = 0;
+    SmallArray<int, 4, CountingAllocator<int>> values{ CountingAllocator<int>(&allocations) };
+    for (int i = 0; i < 4; i++) {
+        values.push_back(i);
+    }
+    const bool inline_while_small = allocations == 0 && !values.spilled() && values[3] == 3;
+
+    values.push_back(4);
+    const bool spilled_once = allocations == 1 && values.spilled() && values.size() == 5 && values[0] == 0;
+
+    // an inline array moves its items, a spilled one hands over its buffer
+    SmallArray<std::string, 2> strings;
+    strings.push_back("a string too long for the small string buffer");
+    SmallArray<std::string, 2> moved = std::move(strings);
+    bool moves_match = moved.size() == 1 && strings.empty() && !moved.spilled() &&
+                       moved[0] == "a string too long for the small string buffer";
+
+    for (size_t i = 0; i < 10; i++) {
+        moved.push_back(std::to_string(i));
+    }
+    const std::string* buffer = moved.begin();
+    SmallArray<std::string, 2> taken;
+    taken = std::move(moved);
+    moves_match = moves_match && taken.begin() == buffer && taken.size() == 11 && taken[10] == "9" &&
+                  moved.empty() && !moved.spilled();
+
+    const SmallArray<std::string, 2> copy = taken;
+    taken.erase(0);
+    moves_match = moves_match && copy.size() == 11 && copy[0] == "a string too long for the small string buffer" &&
+                  taken[0] == "0";
+
+    if (inline_while_small && spilled_once && moves_match) {
+        return (TestResult){
+            .pass = true,
+            .message = "small array keeps its first items inline and spills to the heap once",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "small array allocated while it had inline room or lost items when moved",
+        };
+    }
+}
+
+std::vector<TestResult> runDArrayTests() {
+
+    std::vector<TestResult> results;
+    results.push_back(darray_bulk_fills());
+    results.push_back(darray_moves_items_when_growing());
+    results.push_back(darray_uses_its_allocator());
+    results.push_back(small_array_stays_inline_until_full());
+
+    return results;
+}
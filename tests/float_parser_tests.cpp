@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "float_parser.h"
+#include "test_helpers.h"
+
+TestResult parse_floats_edge_cases() {
+
+    const std::string text = " 1.5,-2, +3e2 ,,0.25,\n";
+    const DArray<float> floats = parseFloats(text.data(), text.size());
+
+    if (floats.size() == 5 && floatsAreClose(floats[0], 1.5f) && floatsAreClose(floats[1], -2.f) &&
+        floatsAreClose(floats[2], 300.f) && floats[3] == 0.f && floatsAreClose(floats[4], 0.25f)) {
+        return (TestResult){
+            .pass = true,
+            .message = "floats with whitespace, empty fields and a trailing comma were parsed",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "floats with whitespace, empty fields and a trailing comma were misparsed",
+        };
+    }
+}
+
+TestResult parse_floats_in_parallel_chunks() {
+
+    // well past PARALLEL_PARSE_MIN_BYTES so the text is split over several threads
+    std::string text;
+    constexpr size_t count = 100000;
+    for (size_t i = 0; i < count; i++) {
+        char field[32];
+        snprintf(field, sizeof(field), "%s%f", i == 0 ? "" : ",", (static_cast<float>(i) - 5000.f) * 0.37f);
+        text += field;
+    }
+
+    const DArray<float> floats = parseFloats(text.data(), text.size());
+    if (text.size() < PARALLEL_PARSE_MIN_BYTES || floats.size() != count) {
+        return (TestResult){
+            .pass = false,
+            .message = "parallel parse produced the wrong number of floats",
+        };
+    }
+
+    // every value has to land at its own index, whichever chunk parsed it
+    const char* p = text.c_str();
+    for (size_t i = 0; i < count; i++) {
+        char* next;
+        const float expected = strtof(p, &next);
+        if (floats[i] != expected) {
+            return (TestResult){
+                .pass = false,
+                .message = "parallel parse disagrees with strtof",
+            };
+        }
+        p = next + 1;
+    }
+
+    return (TestResult){
+        .pass = true,
+        .message = "parallel parse matches strtof",
+    };
+}
+
+TestResult parse_floats_lone_trailing_plus() {
+
+    // exactly as long as the text, so reading past it is caught by the sanitizers
+    char* text = static_cast<char*>(malloc(3));
+    memcpy(text, "1,+", 3);
+    const DArray<float> floats = parseFloats(text, 3);
+    free(text);
+
+    if (floats.size() == 2 && floatsAreClose(floats[0], 1.f) && floats[1] == 0.f) {
+        return (TestResult){
+            .pass = true,
+            .message = "a lone plus at the end of the text was parsed as an empty field",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "a lone plus at the end of the text was misparsed",
+        };
+    }
+}
+
+std::vector<TestResult> runFloatParserTests() {
+
+    std::vector<TestResult> results;
+    results.push_back(parse_floats_edge_cases());
+    results.push_back(parse_floats_in_parallel_chunks());
+    results.push_back(parse_floats_lone_trailing_plus());
+
+    return results;
+}
@@ -0,0 +1,98 @@
+#include <stdint.h>
+
+#include "frame_arena.h"
+#include "test_helpers.h"
+
+TestResult frame_arena_bumps_and_grows_in_place() {
+
+    FrameArena arena(1024);
+
+    void* a = arena.allocate(10, 1);
+    void* b = arena.allocate(16, 64);
+    const bool aligned = reinterpret_cast<uintptr_t>(b) % 64 == 0 && b > a;
+
+    // b is the newest allocation so it can take the space after it
+    void* grown = arena.grow(b, 16, 128, 64);
+    // a isn't, so it has to move
+    void* moved = arena.grow(a, 10, 20, 1);
+
+    if (aligned && grown == b && moved != a && arena.stats().heap_allocations == 1) {
+        return (TestResult){
+            .pass = true,
+            .message = "frame arena bumps aligned allocations and grows the newest one in place",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "frame arena misaligned an allocation or moved one it could have grown",
+        };
+    }
+}
+
+TestResult frame_arena_stops_allocating_once_warm() {
+
+    FrameArena arena(256);
+
+    // the first frame outgrows the block and spills into more
+    for (int i = 0; i < 64; i++) {
+        arena.allocate(64, 16);
+    }
+    const FrameArenaStats first = arena.stats();
+    arena.reset();
+
+    // the next one fits in the merged block
+    for (int i = 0; i < 64; i++) {
+        arena.allocate(64, 16);
+    }
+    const FrameArenaStats second = arena.stats();
+    arena.reset();
+
+    if (first.heap_allocations > 1 && second.heap_allocations == 0 && second.high_water >= 64 * 64 &&
+        arena.stats().used == 0 && arena.stats().capacity == first.capacity) {
+        return (TestResult){
+            .pass = true,
+            .message = "frame arena folds its blocks together on reset and then stays off the heap",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "frame arena kept allocating after it had seen the frame's high water",
+        };
+    }
+}
+
+TestResult frame_array_fills_from_the_arena() {
+
+    frameArena().reset();
+    const size_t used_before = frameArena().stats().used;
+
+    FrameArray<int> values;
+    for (int i = 0; i < 1000; i++) {
+        values.push_back(i);
+    }
+    const bool filled = values.size() == 1000 && values[999] == 999 &&
+                        frameArena().stats().used >= used_before + 1000 * sizeof(int);
+    frameArena().reset();
+
+    if (filled) {
+        return (TestResult){
+            .pass = true,
+            .message = "frame array grows inside the thread's frame arena",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "frame array lost items or didn't use the frame arena",
+        };
+    }
+}
+
+std::vector<TestResult> runFrameArenaTests() {
+
+    std::vector<TestResult> results;
+    results.push_back(frame_arena_bumps_and_grows_in_place());
+    results.push_back(frame_arena_stops_allocating_once_warm());
+    results.push_back(frame_array_fills_from_the_arena());
+
+    return results;
+}
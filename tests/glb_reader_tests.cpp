@@ -0,0 +1,304 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "glb_reader.h"
+#include "material_table.h"
+#include "test_helpers.h"
+
+static const char* TEST_GLB_NAME = "glb_reader_test.glb";
+
+static void appendU32(std::string& out, const uint32_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// wraps json and binary chunks into a glb file
+static bool writeTestGlb(const TempFile& glb, std::string json, const std::string& bin) {
+
+    while (json.size() % 4 != 0) {
+        json.push_back(' ');
+    }
+
+    std::string file;
+    appendU32(file, 0x46546C67);
+    appendU32(file, 2);
+    appendU32(file, static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size()));
+    appendU32(file, static_cast<uint32_t>(json.size()));
+    appendU32(file, 0x4E4F534A);
+    file += json;
+    appendU32(file, static_cast<uint32_t>(bin.size()));
+    appendU32(file, 0x004E4942);
+    file += bin;
+
+    FILE* out = fopen(glb.path(), "wb");
+    if (out == nullptr) {
+        return false;
+    }
+    const bool written = fwrite(file.data(), 1, file.size(), out) == file.size();
+    fclose(out);
+    return written;
+}
+
+// one triangle of float positions followed by three ushort indices, padded to 4 bytes
+static std::string triangleBuffer() {
+    const float positions[9] = { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f };
+    const uint16_t indices[4] = { 0, 2, 1, 0 };
+    std::string bin(reinterpret_cast<const char*>(positions), sizeof(positions));
+    bin.append(reinterpret_cast<const char*>(indices), sizeof(indices));
+    return bin;
+}
+
+static ImportOptions plainImport() {
+    ImportOptions options;
+    options.optimize_mesh = false;
+    options.generate_lods = false;
+    options.use_asset_cache = false;
+    return options;
+}
+
+TestResult glb_reader_reads_every_primitive() {
+
+    const std::string json = R"({
+        "asset": { "version": "2.0" },
+        "scene": 0,
+        "scenes": [ { "nodes": [ 0 ] } ],
+        "nodes": [ { "name": "parent", "translation": [ 1, 2, 3 ], "mesh": 0 } ],
+        "meshes": [ { "primitives": [
+            { "attributes": { "POSITION": 0 }, "indices": 1, "material": 0 },
+            { "attributes": { "POSITION": 0 } }
+        ] } ],
+        "materials": [ { "pbrMetallicRoughness": { "baseColorFactor": [ 0.5, 0.25, 1, 1 ], "metallicFactor": 0 } } ],
+        "accessors": [
+            { "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3" },
+            { "bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR" }
+        ],
+        "bufferViews": [
+            { "buffer": 0, "byteOffset": 0, "byteLength": 36 },
+            { "buffer": 0, "byteOffset": 36, "byteLength": 6 }
+        ],
+        "buffers": [ { "byteLength": 44 } ]
+    })";
+
+    const TempFile glb(TEST_GLB_NAME);
+    if (!writeTestGlb(glb, json, triangleBuffer())) {
+        return (TestResult){ .pass = false, .message = "glb reader test couldn't write its file" };
+    }
+
+    ThreadPool pool(1);
+    std::optional<SceneNode> root = readGlb(glb.path(), plainImport(), pool);
+
+    if (!root.has_value() || root.value().children.size() != 1) {
+        return (TestResult){ .pass = false, .message = "glb reader didn't produce the node" };
+    }
+
+    const SceneNode* parent = root.value().children[0];
+    const bool transform_matches = parent->local_transform.data[3][0] == 1.f &&
+                                   parent->local_transform.data[3][1] == 2.f &&
+                                   parent->local_transform.data[3][2] == 3.f;
+
+    // two primitives, so each became a child of the node
+    bool primitives_match = !parent->mesh.has_value() && parent->children.size() == 2;
+    if (primitives_match) {
+        const Mesh& indexed = parent->children[0]->mesh.value();
+        const Mesh& unindexed = parent->children[1]->mesh.value();
+
+        primitives_match = indexed.vertices.vertex_count == 3 && indexed.vertices.index_count == 3 &&
+                           indexed.vertices.indices[1] == 2 && indexed.vertices.positions[3] == 1.f &&
+                           unindexed.vertices.index_count == 3 && unindexed.vertices.indices[2] == 2;
+
+        const std::optional<Material> material = materialTable().material(indexed.material);
+        primitives_match = primitives_match && material.has_value() &&
+                           std::holds_alternative<BasicColorMaterial>(material.value()) &&
+                           std::get<BasicColorMaterial>(material.value()).color.y == 0.25f;
+    }
+
+    if (transform_matches && primitives_match) {
+        return (TestResult){
+            .pass = true,
+            .message = "glb reader read the node transform, both primitives and the base color",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "glb reader got a transform, primitive or material wrong",
+        };
+    }
+}
+
+TestResult glb_reader_leaves_required_extensions_to_assimp() {
+
+    const std::string json = R"({
+        "asset": { "version": "2.0" },
+        "extensionsRequired": [ "KHR_draco_mesh_compression" ],
+        "nodes": [ { "mesh": 0 } ],
+        "meshes": [ { "primitives": [ { "attributes": { "POSITION": 0 } } ] } ],
+        "accessors": [ { "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3" } ],
+        "bufferViews": [ { "buffer": 0, "byteLength": 36 } ],
+        "buffers": [ { "byteLength": 44 } ]
+    })";
+
+    const TempFile glb(TEST_GLB_NAME);
+    if (!writeTestGlb(glb, json, triangleBuffer())) {
+        return (TestResult){ .pass = false, .message = "glb reader test couldn't write its file" };
+    }
+
+    ThreadPool pool(1);
+    const std::optional<SceneNode> root = readGlb(glb.path(), plainImport(), pool);
+
+    if (!root.has_value()) {
+        return (TestResult){
+            .pass = true,
+            .message = "glb reader handed a file with required extensions back to assimp",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "glb reader read a file with required extensions it doesn't support",
+        };
+    }
+}
+
+static void releaseTreeMaterials(const SceneNode* node) {
+    if (node->mesh.has_value()) {
+        materialTable().releaseMaterial(node->mesh.value().material);
+    }
+    for (const SceneNode* child : node->children) {
+        releaseTreeMaterials(child);
+    }
+}
+
+TestResult glb_reader_gives_back_materials_it_doesnt_hand_out() {
+
+    // the second node's mesh is sparse, the whole file goes to assimp after the first mesh converted
+    const std::string fallback_json = R"({
+        "asset": { "version": "2.0" },
+        "scene": 0,
+        "scenes": [ { "nodes": [ 0, 1 ] } ],
+        "nodes": [ { "mesh": 0 }, { "mesh": 1 } ],
+        "meshes": [
+            { "primitives": [ { "attributes": { "POSITION": 0 }, "material": 0 } ] },
+            { "primitives": [ { "attributes": { "POSITION": 1 } } ] }
+        ],
+        "materials": [ { "pbrMetallicRoughness": { "baseColorFactor": [ 0.125, 0.5, 0.5, 1 ] } } ],
+        "accessors": [
+            { "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3" },
+            { "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3",
+              "sparse": { "count": 1, "indices": { "bufferView": 1, "componentType": 5123 }, "values": { "bufferView": 0 } } }
+        ],
+        "bufferViews": [
+            { "buffer": 0, "byteOffset": 0, "byteLength": 36 },
+            { "buffer": 0, "byteOffset": 36, "byteLength": 6 }
+        ],
+        "buffers": [ { "byteLength": 44 } ]
+    })";
+
+    // the mesh is instanced by a node outside the default scene, the original is never taken
+    const std::string instanced_json = R"({
+        "asset": { "version": "2.0" },
+        "scene": 0,
+        "scenes": [ { "nodes": [ 0 ] } ],
+        "nodes": [ { "mesh": 0 }, { "mesh": 0 } ],
+        "meshes": [ { "primitives": [ { "attributes": { "POSITION": 0 }, "material": 0 } ] } ],
+        "materials": [ { "pbrMetallicRoughness": { "baseColorFactor": [ 0.125, 0.5, 0.5, 1 ] } } ],
+        "accessors": [ { "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3" } ],
+        "bufferViews": [ { "buffer": 0, "byteOffset": 0, "byteLength": 36 } ],
+        "buffers": [ { "byteLength": 44 } ]
+    })";
+
+    const size_t materials_before = materialTable().stats().materials;
+    ThreadPool pool(1);
+    const TempFile glb(TEST_GLB_NAME);
+
+    bool fell_back = false;
+    if (writeTestGlb(glb, fallback_json, triangleBuffer())) {
+        fell_back = !readGlb(glb.path(), plainImport(), pool).has_value();
+    }
+    const bool fallback_released = materialTable().stats().materials == materials_before;
+
+    bool read_instanced = false;
+    if (writeTestGlb(glb, instanced_json, triangleBuffer())) {
+        const std::optional<SceneNode> root = readGlb(glb.path(), plainImport(), pool);
+        if (root.has_value()) {
+            read_instanced = root.value().children.size() == 1;
+            releaseTreeMaterials(&root.value());
+        }
+    }
+    const bool instanced_released = materialTable().stats().materials == materials_before;
+
+    if (fell_back && fallback_released && read_instanced && instanced_released) {
+        return (TestResult){
+            .pass = true,
+            .message = "glb reader gives back the materials of meshes a fallback or the scene leaves behind",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "glb reader kept materials of meshes it didn't hand out",
+        };
+    }
+}
+
+// whether the reader got past its bounds checks with this accessor and buffer view
+static bool readsOutOfBounds(const std::string& accessor, const std::string& buffer_view) {
+
+    const std::string json = R"({
+        "asset": { "version": "2.0" },
+        "nodes": [ { "mesh": 0 } ],
+        "meshes": [ { "primitives": [ { "attributes": { "POSITION": 0 } } ] } ],
+        "accessors": [ )" + accessor + R"( ],
+        "bufferViews": [ )" + buffer_view + R"( ],
+        "buffers": [ { "byteLength": 44 } ]
+    })";
+
+    const TempFile glb(TEST_GLB_NAME);
+    if (!writeTestGlb(glb, json, triangleBuffer())) {
+        return true;
+    }
+
+    ThreadPool pool(1);
+    bool rejected = false;
+    try {
+        readGlb(glb.path(), plainImport(), pool);
+    } catch (const char*) {
+        rejected = true;
+    }
+    return !rejected;
+}
+
+TestResult glb_reader_rejects_wrapping_offsets() {
+
+    // each sum the old checks did comes out at 2^64 plus a few bytes, which wrapped to something in bounds
+    const bool accessor_wraps = readsOutOfBounds(
+        R"({ "bufferView": 0, "byteOffset": 18446744073709535232, "componentType": 5126, "count": 3, "type": "VEC3" })",
+        R"({ "buffer": 0, "byteLength": 36, "byteStride": 8192 })");
+    const bool view_wraps = readsOutOfBounds(
+        R"({ "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3" })",
+        R"({ "buffer": 0, "byteOffset": 18446744073709535232, "byteLength": 16424 })");
+    const bool count_wraps = readsOutOfBounds(
+        R"({ "bufferView": 0, "componentType": 5126, "count": 4294967297, "type": "VEC3" })",
+        R"({ "buffer": 0, "byteLength": 36, "byteStride": 4294967296 })");
+
+    if (!accessor_wraps && !view_wraps && !count_wraps) {
+        return (TestResult){
+            .pass = true,
+            .message = "glb reader rejects offsets, lengths and counts that wrap its bounds checks",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "glb reader let a wrapping offset, length or count through",
+        };
+    }
+}
+
+std::vector<TestResult> runGlbReaderTests() {
+
+    std::vector<TestResult> results;
+    results.push_back(glb_reader_reads_every_primitive());
+    results.push_back(glb_reader_leaves_required_extensions_to_assimp());
+    results.push_back(glb_reader_gives_back_materials_it_doesnt_hand_out());
+    results.push_back(glb_reader_rejects_wrapping_offsets());
+
+    return results;
+}
@@ -0,0 +1,130 @@
+#include <string>
+
+#include "mystl.hpp"
+#include "test_helpers.h"
+
+// keys come in runs of 64 with the same hash, robin hood has to sort them out by probing
+struct ClusteredHash {
+    size_t operator()(const int key) const { return static_cast<size_t>(key / 64); }
+};
+
+struct ConstantHash {
+    size_t operator()(const int) const { return 0; }
+};
+
+TestResult hash_map_finds_what_it_keeps() {
+
+    HashMap<int, int> map;
+    for (int i = 0; i < 10000; i++) {
+        map.insert(i, i * 2);
+    }
+    for (int i = 0; i < 10000; i += 2) {
+        map.erase(i);
+    }
+
+    bool found = map.size() == 5000 && !map.insert(1, 0) && *map.find(1) == 2;
+    for (int i = 0; i < 10000 && found; i++) {
+        const int* value = map.find(i);
+        found = (i % 2 == 0) ? value == nullptr : (value != nullptr && *value == i * 2);
+    }
+
+    long long sum = 0;
+    size_t visited = 0;
+    for (const auto& entry : map) {
+        sum += entry.value;
+        visited++;
+    }
+    found = found && visited == 5000 && sum == 2LL * 25000000;
+
+    // a long shared probe run, erased from the middle
+    HashMap<int, int, ClusteredHash> clustered;
+    for (int i = 0; i < 256; i++) {
+        clustered[i] = i;
+    }
+    clustered.erase(100);
+    bool clusters_match = clustered.size() == 255 && !clustered.contains(100);
+    for (int i = 0; i < 256 && clusters_match; i++) {
+        clusters_match = i == 100 || (clustered.find(i) != nullptr && *clustered.find(i) == i);
+    }
+
+    // more equal hashes than a probe distance can count, refused without losing what's there
+    HashMap<int, int, ConstantHash> constant;
+    bool refused = false;
+    try {
+        for (int i = 0; i < 300; i++) {
+            constant[i] = i;
+        }
+    } catch (const std::length_error&) {
+        refused = true;
+    }
+    clusters_match = clusters_match && refused && constant.size() == 255 && *constant.find(0) == 0 &&
+                     *constant.find(254) == 254;
+
+    HashMap<std::string, std::string> names;
+    names.insert("gorilla", "a long enough value to live on the heap");
+    names["bowl"] = "bowl";
+    const HashMap<std::string, std::string> copy = names;
+    names.clear();
+    const bool strings_match = names.empty() && copy.size() == 2 && *copy.find("bowl") == "bowl" &&
+                               *copy.find("gorilla") == "a long enough value to live on the heap";
+
+    if (found && clusters_match && strings_match) {
+        return (TestResult){
+            .pass = true,
+            .message = "hash map finds every key it holds and none it erased",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "hash map lost a key, kept an erased one or returned the wrong value",
+        };
+    }
+}
+
+TestResult slot_map_handles_outlive_other_items() {
+
+    SlotMap<std::string> names;
+    const SlotHandle gorilla = names.insert("gorilla");
+    const SlotHandle bowl = names.insert("bowl");
+    const SlotHandle floor = names.insert("floor");
+
+    // the last item moves into the hole, its handle has to follow it
+    names.erase(gorilla);
+    bool handles_match = names.size() == 2 && names.get(gorilla) == nullptr &&
+                         *names.get(bowl) == "bowl" && *names.get(floor) == "floor";
+
+    // the freed slot is reused, the old handle must not see the new item
+    const SlotHandle tree = names.insert("tree");
+    handles_match = handles_match && tree.index == gorilla.index && !names.contains(gorilla) &&
+                    *names.get(tree) == "tree" && !names.erase(gorilla);
+
+    size_t visited = 0;
+    for (const std::string& name : names) {
+        visited += name.empty() ? 0 : 1;
+    }
+    handles_match = handles_match && visited == 3 && names.get(names.handleAt(0)) == names.begin();
+
+    names.clear();
+    handles_match = handles_match && names.empty() && !names.contains(bowl) && names.get(SlotHandle{}) == nullptr;
+
+    if (handles_match) {
+        return (TestResult){
+            .pass = true,
+            .message = "slot map handles find their items until they are erased",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "slot map handle found the wrong item or a stale one",
+        };
+    }
+}
+
+std::vector<TestResult> runHashMapTests() {
+
+    std::vector<TestResult> results;
+    results.push_back(hash_map_finds_what_it_keeps());
+    results.push_back(slot_map_handles_outlive_other_items());
+
+    return results;
+}
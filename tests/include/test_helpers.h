@@ -2,6 +2,7 @@
 
 #include "stdbool.h"
 #include "vec.h"
+#include <string>
 #include <vector>
 
 struct TestResult {
@@ -12,6 +13,40 @@ struct TestResult {
 bool floatsAreClose(float a, float b);
 bool vec3sAreEqual(mym::Vec3 a, mym::Vec3 b);
 
+// a path in the system's temp directory, whatever is written there is removed when this goes out of
+// scope, so a test that returns early or throws doesn't leave its file behind
+class TempFile {
+
+    private:
+        std::string full_path;
+
+    public:
+        explicit TempFile(const char* name);
+        ~TempFile();
+        TempFile(const TempFile&) = delete;
+        TempFile& operator=(const TempFile&) = delete;
+
+        const char* path() const;
+};
+
 std::vector<TestResult> runTriangleTests();
 std::vector<TestResult> runVerticesTests();
-std::vector<TestResult> runSceneTests();
\ No newline at end of file
+std::vector<TestResult> runSceneTests();
+std::vector<TestResult> runRangeAllocatorTests();
+std::vector<TestResult> runVertexCompressionTests();
+std::vector<TestResult> runMeshOptimizerTests();
+std::vector<TestResult> runMeshLodTests();
+std::vector<TestResult> runMeshGeometryTests();
+std::vector<TestResult> runMaterialTableTests();
+std::vector<TestResult> runTextureMipsTests();
+std::vector<TestResult> runAssetCacheTests();
+std::vector<TestResult> runFloatParserTests();
+std::vector<TestResult> runThreadPoolTests();
+std::vector<TestResult> runConcurrentQueueTests();
+std::vector<TestResult> runDArrayTests();
+std::vector<TestResult> runFrameArenaTests();
+std::vector<TestResult> runHashMapTests();
+std::vector<TestResult> runMat4Tests();
+std::vector<TestResult> runBoundsTests();
+std::vector<TestResult> runJsonTests();
+std::vector<TestResult> runGlbReaderTests();
@@ -0,0 +1,114 @@
+#include <string.h>
+
+#include "json.h"
+#include "test_helpers.h"
+
+TestResult json_reads_nested_values() {
+
+    const char* text = "{ \"asset\": { \"version\": \"2.0\" }, \"nodes\": [ { \"mesh\": 3 }, { \"name\": \"a\\\"b\\u00e9\" } ],"
+                       " \"scale\": -1.5e2, \"flag\": true, \"nothing\": null }";
+
+    JsonDocument document;
+    const bool parsed = document.parse(text, strlen(text));
+    const JsonValue root = document.root();
+
+    const bool values_match = parsed &&
+        root["asset"]["version"].string() == "2.0" &&
+        root["nodes"].size() == 2 &&
+        root["nodes"].at(0)["mesh"].index(0) == 3 &&
+        root["nodes"].at(1)["name"].string() == "a\"b\xc3\xa9" &&
+        root["scale"].number() == -150.0 &&
+        root["flag"].boolean() &&
+        root["nothing"].type() == JsonType::Null &&
+        root["nodes"].elements().size() == 2;
+
+    // lookups that miss give Invalid values instead of failing
+    const bool misses_are_invalid = !root["missing"]["deeper"].isValid() &&
+        !root["nodes"].at(5).isValid() &&
+        root["missing"].index(7) == 7;
+
+    if (values_match && misses_are_invalid) {
+        return (TestResult){
+            .pass = true,
+            .message = "json document reads nested objects, arrays, escapes and literals",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "json document read a value wrong or failed on a missing one",
+        };
+    }
+}
+
+TestResult json_rejects_malformed_text() {
+
+    const char* malformed[] = {
+        "{ \"a\": 1, }",
+        "[1 2]",
+        "{ \"a\" 1 }",
+        "\"unterminated",
+        "01",
+        "{ \"a\": tru }",
+        "[1] x",
+    };
+
+    bool rejected = true;
+    for (const char* text : malformed) {
+        JsonDocument document;
+        rejected = rejected && !document.parse(text, strlen(text)) && !document.root().isValid();
+    }
+
+    // glb pads the json chunk with trailing spaces
+    JsonDocument padded;
+    const char* padded_text = "{}   ";
+    const bool accepts_padding = padded.parse(padded_text, strlen(padded_text));
+
+    if (rejected && accepts_padding) {
+        return (TestResult){
+            .pass = true,
+            .message = "json document rejects malformed text",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "json document accepted malformed text or rejected padding",
+        };
+    }
+}
+
+TestResult json_index_rejects_what_size_t_cant_hold() {
+
+    const char* text = "[ 18446744073709549568, 18446744073709551616, 1e300, 2.5, -1, 4 ]";
+
+    JsonDocument document;
+    const bool parsed = document.parse(text, strlen(text));
+    const JsonValues values = document.root().elements();
+
+    // the largest double below 2^64 still fits, 2^64 and anything fractional or negative doesn't
+    const bool indices_match = parsed && values.size() == 6 &&
+        values[0].index(7) == 18446744073709549568ull &&
+        values[1].index(7) == 7 && values[2].index(7) == 7 && values[3].index(7) == 7 &&
+        values[4].index(7) == 7 && values[5].index(7) == 4;
+
+    if (indices_match) {
+        return (TestResult){
+            .pass = true,
+            .message = "json index falls back for numbers that aren't a size_t",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "json index cast a number that doesn't fit a size_t",
+        };
+    }
+}
+
+std::vector<TestResult> runJsonTests() {
+
+    std::vector<TestResult> results;
+    results.push_back(json_reads_nested_values());
+    results.push_back(json_rejects_malformed_text());
+    results.push_back(json_index_rejects_what_size_t_cant_hold());
+
+    return results;
+}
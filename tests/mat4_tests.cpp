@@ -0,0 +1,216 @@
+#include <math.h>
+
+#include "affine.h"
+#include "mat4.h"
+#include "mat4_simd.h"
+#include "transform_batch.h"
+#include "test_helpers.h"
+
+using namespace mym;
+
+// a general matrix, nothing affine about it, so every term of every kernel matters
+static Mat4 generalMatrix(unsigned int seed) {
+    Mat4 m;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            seed = seed * 1664525u + 1013904223u;
+            m.data[i][j] = static_cast<float>(seed >> 8) / static_cast<float>(1u << 24) * 4.f - 2.f;
+        }
+        // keeps it well away from singular
+        m.data[i][i] += 4.f;
+    }
+    return m;
+}
+
+static bool matricesAreClose(const Mat4& a, const Mat4& b) {
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            if (fabsf(a.data[i][j] - b.data[i][j]) > 1e-4f * (1.f + fabsf(b.data[i][j]))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool isIdentity(const Mat4& m) {
+    const Mat4 identity = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    return matricesAreClose(m, identity);
+}
+
+#ifdef MYM_HEADER_ONLY
+// header only builds get the trivial functions as constexpr, these fail to compile if one isn't
+static_assert(dot(cross((Vec3){ 1.f, 0.f, 0.f }, (Vec3){ 0.f, 1.f, 0.f }), (Vec3){ 0.f, 0.f, 1.f }) == 1.f);
+static_assert(getPosition(translation(1.f, 2.f, 3.f)).y == 2.f);
+static_assert(positionMultiplied((Vec3){ 1.f, 1.f, 1.f },
+                                 fromTranslationRotationScale((Vec3){ 1.f, 0.f, 0.f }, (Vec4){ 0.f, 0.f, 0.f, 1.f },
+                                                              (Vec3){ 2.f, 2.f, 2.f })).x == 3.f);
+static_assert(toMat4(identityAffine()).m33 == 1.f);
+#endif
+
+TestResult mat4_simd_kernels_match_scalar() {
+
+    bool pass = true;
+    for (unsigned int seed = 1; seed <= 64 && pass; seed++) {
+        const Mat4 a = generalMatrix(seed);
+        const Mat4 b = generalMatrix(seed * 7919u);
+        const Vec4 v = { .x = 0.5f, .y = -1.25f, .z = 2.f, .w = 0.75f };
+        const Vec3 p = { .x = 1.5f, .y = -0.5f, .z = 3.f };
+
+        const Vec4 vector = simd::vectorMultiplied(v, a);
+        const Vec4 scalar_vector = scalar::vectorMultiplied(v, a);
+
+        // the in place multiply used to read rows it had already overwritten
+        Mat4 in_place = a;
+        multiply(in_place, b);
+
+        pass = matricesAreClose(simd::multiplied(a, b), scalar::multiplied(a, b)) &&
+               matricesAreClose(multiplied(a, b), scalar::multiplied(a, b)) &&
+               matricesAreClose(in_place, scalar::multiplied(a, b)) &&
+               matricesAreClose(simd::inverse(a), scalar::inverse(a)) &&
+               vec3sAreEqual(simd::positionMultiplied(p, a), scalar::positionMultiplied(p, a)) &&
+               vec3sAreEqual(simd::directionMultiplied(p, a), scalar::directionMultiplied(p, a)) &&
+               floatsAreClose(vector.x, scalar_vector.x) && floatsAreClose(vector.y, scalar_vector.y) &&
+               floatsAreClose(vector.z, scalar_vector.z) && floatsAreClose(vector.w, scalar_vector.w);
+    }
+
+    if (pass) {
+        return (TestResult){
+            .pass = true,
+            .message = "mat4 simd kernels and the exported ones match the scalar reference",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "a mat4 simd kernel disagrees with the scalar reference",
+        };
+    }
+}
+
+TestResult mat4_inverses_undo_the_transform() {
+
+    const Mat4 general = generalMatrix(42);
+
+    Mat4 affine = fromPositionAndEuler((Vec3){ .x = 3.f, .y = -2.f, .z = 7.f }, (Vec3){ .x = 0.3f, .y = 1.1f, .z = -0.7f });
+    scale(affine, 2.f, 0.5f, 3.f);
+
+    const bool general_inverse = isIdentity(multiplied(general, inverse(general)));
+    const bool affine_inverse = isIdentity(multiplied(affine, affineInverse(affine))) &&
+                                isIdentity(multiplied(affine, scalar::affineInverse(affine))) &&
+                                matricesAreClose(affineInverse(affine), inverse(affine));
+
+    if (general_inverse && affine_inverse) {
+        return (TestResult){
+            .pass = true,
+            .message = "mat4 inverse and affine inverse undo the matrix they came from",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "mat4 inverse or affine inverse times the matrix isn't the identity",
+        };
+    }
+}
+
+TestResult mat4_batch_transforms_match_single_ones() {
+
+    // 4 at a time plus a tail of 3
+    constexpr size_t COUNT = 23;
+    const Mat4 affine = fromPositionAndEuler((Vec3){ .x = 1.f, .y = 2.f, .z = -3.f }, (Vec3){ .x = 0.4f, .y = -0.2f, .z = 0.9f });
+    const Mat4 projective = generalMatrix(7);
+
+    float packed[COUNT * 3];
+    float xs[COUNT], ys[COUNT], zs[COUNT];
+    // a Vec3 inside a bigger struct
+    float strided[COUNT * 5];
+    for (size_t i = 0; i < COUNT; i++) {
+        for (size_t k = 0; k < 3; k++) {
+            packed[i * 3 + k] = static_cast<float>(i) * 0.25f + static_cast<float>(k) - 1.f;
+            strided[i * 5 + k] = packed[i * 3 + k];
+        }
+        strided[i * 5 + 3] = strided[i * 5 + 4] = -7.f;
+        xs[i] = packed[i * 3];
+        ys[i] = packed[i * 3 + 1];
+        zs[i] = packed[i * 3 + 2];
+    }
+
+    float positions[COUNT * 3], projected[COUNT * 3], directions[COUNT * 3];
+    transformPositions(packed, positions, COUNT, affine);
+    projectPositions(packed, projected, COUNT, projective);
+    transformDirections(packed, directions, COUNT, affine);
+
+    float soa_x[COUNT], soa_y[COUNT], soa_z[COUNT];
+    projectPositions((ConstVec3Arrays){ xs, ys, zs }, (Vec3Arrays){ soa_x, soa_y, soa_z }, COUNT, projective);
+
+    // in place
+    transformPositions(strided, strided, COUNT, affine, 5);
+
+    bool pass = true;
+    for (size_t i = 0; i < COUNT; i++) {
+        const Vec3 point = { .x = packed[i * 3], .y = packed[i * 3 + 1], .z = packed[i * 3 + 2] };
+        const Vec3 position = scalar::positionMultiplied(point, affine);
+        const Vec3 projection = scalar::positionMultiplied(point, projective);
+
+        pass = pass &&
+               vec3sAreEqual((Vec3){ positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2] }, position) &&
+               vec3sAreEqual((Vec3){ projected[i * 3], projected[i * 3 + 1], projected[i * 3 + 2] }, projection) &&
+               vec3sAreEqual((Vec3){ directions[i * 3], directions[i * 3 + 1], directions[i * 3 + 2] },
+                             scalar::directionMultiplied(point, affine)) &&
+               vec3sAreEqual((Vec3){ soa_x[i], soa_y[i], soa_z[i] }, projection) &&
+               vec3sAreEqual((Vec3){ strided[i * 5], strided[i * 5 + 1], strided[i * 5 + 2] }, position) &&
+               strided[i * 5 + 3] == -7.f && strided[i * 5 + 4] == -7.f;
+    }
+
+    if (pass) {
+        return (TestResult){
+            .pass = true,
+            .message = "mat4 batch transforms match one point at a time, packed, strided and soa",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "a mat4 batch transform disagrees with the single point one",
+        };
+    }
+}
+
+TestResult affine_matches_mat4() {
+
+    const Affine parent = fromTranslationRotationScale((Vec3){ .x = 1.f, .y = -2.f, .z = 3.f },
+                                                       (Vec4){ .x = 0.f, .y = 0.38268343f, .z = 0.f, .w = 0.92387953f },
+                                                       (Vec3){ .x = 2.f, .y = 2.f, .z = 2.f });
+    // non uniform scale and shear through composition, still affine
+    const Affine local = toAffine(scaled(fromPositionAndEuler((Vec3){ .x = 0.f, .y = 4.f, .z = -1.f },
+                                                              (Vec3){ .x = 0.7f, .y = 0.f, .z = -0.3f }), 1.f, 3.f, 0.5f));
+
+    const Affine world = multiplied(parent, local);
+    const Mat4 world_matrix = multiplied(toMat4(parent), toMat4(local));
+    const Vec3 point = { .x = 0.5f, .y = -1.f, .z = 2.f };
+
+    const bool composes = matricesAreClose(toMat4(world), world_matrix);
+    const bool inverts = matricesAreClose(toMat4(inverse(world)), inverse(world_matrix)) &&
+                         matricesAreClose(toMat4(multiplied(world, inverse(world))), toMat4(identityAffine()));
+    const bool transforms = vec3sAreEqual(positionMultiplied(point, world), positionMultiplied(point, world_matrix)) &&
+                            vec3sAreEqual(directionMultiplied(point, world), directionMultiplied(point, world_matrix));
+
+    if (composes && inverts && transforms) {
+        return (TestResult){
+            .pass = true,
+            .message = "affine compose, inverse and transforms match the mat4 ones",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "an affine operation disagrees with the mat4 one",
+        };
+    }
+}
+
+std::vector<TestResult> runMat4Tests() {
+    return {
+        mat4_simd_kernels_match_scalar(),
+        mat4_inverses_undo_the_transform(),
+        mat4_batch_transforms_match_single_ones(),
+        affine_matches_mat4(),
+    };
+}
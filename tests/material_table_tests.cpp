@@ -0,0 +1,149 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "material_table.h"
+#include "test_helpers.h"
+#include "texture_mips.h"
+
+// pixels the table frees itself, like the ones stb hands out
+static TextureData ownedPixels(const int width, const int height) {
+    const size_t bytes = static_cast<size_t>(width) * height * 4;
+    unsigned char* pixels = static_cast<unsigned char*>(malloc(bytes));
+    memset(pixels, 0x7f, bytes);
+    return { .pixels = pixels, .width = width, .height = height, .channels = 4, .levels = 1, .needs_free = true };
+}
+
+TestResult material_table_shares_equal_materials() {
+
+    MaterialTable table;
+    const BasicColorMaterial green = { .color = { 0.1f, 0.7f, 0.1f }, .specular_color = { 0.2f, 0.2f, 0.2f }, .shininess = 0.5f };
+    BasicColorMaterial greener = green;
+    greener.color.y = 0.8f;
+
+    const MaterialHandle a = table.addMaterial(green);
+    const MaterialHandle b = table.addMaterial(green);
+    const MaterialHandle c = table.addMaterial(greener);
+    const bool shared = a == b && !(a == c) && table.stats().materials == 2;
+
+    // a goes once both users have let go, its handle then finds nothing
+    table.releaseMaterial(a);
+    const bool kept = table.material(b).has_value();
+    table.releaseMaterial(b);
+    const bool released = !table.material(a).has_value() && table.material(c).has_value() &&
+                          table.stats().materials == 1 && !table.material(MaterialHandle{}).has_value();
+
+    if (shared && kept && released) {
+        return (TestResult){
+            .pass = true,
+            .message = "material table shares equal materials until their last user lets go",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "material table duplicated a material or released it early",
+        };
+    }
+}
+
+TestResult material_table_dedups_textures() {
+
+    MaterialTable table;
+
+    // the same image under another name, e.g. the same png embedded in two files
+    bool created_first = false;
+    bool created_again = true;
+    bool created_other = false;
+    const TextureHandle first = table.acquireTexture("a.glb*0", 42, created_first);
+    const TextureHandle same_content = table.acquireTexture("b.glb*3", 42, created_again);
+    const TextureHandle other = table.acquireTexture("b.glb*4", 43, created_other);
+    const bool deduplicated = created_first && !created_again && created_other && first == same_content && !(first == other);
+
+    table.setTexturePixels(first, ownedPixels(4, 2));
+    table.setTexturePixels(other, {});
+
+    // both materials sample the one texture, the loaders let go of theirs
+    const MaterialHandle wrapped = table.addMaterial(BasicTextureMaterial{
+        .texture = first, .wrap_u = WrapMode::Wrap, .wrap_v = WrapMode::Wrap, .shininess = 0.5f });
+    const MaterialHandle clamped = table.addMaterial(BasicTextureMaterial{
+        .texture = first, .wrap_u = WrapMode::Clamp, .wrap_v = WrapMode::Clamp, .shininess = 0.5f });
+    table.releaseTexture(first);
+    table.releaseTexture(same_content);
+    table.releaseTexture(other);
+
+    const std::optional<TextureEntry> decoded = table.texture(first);
+    const bool states = decoded.has_value() && decoded.value().state == TextureState::Decoded &&
+                        decoded.value().users == 2 && !table.texture(other).has_value() &&
+                        table.stats().pixel_bytes == 4 * 2 * 4;
+
+    // uploading frees the cpu copy, the id is handed back once no material samples it
+    const bool uploadable = table.pixelsToUpload(first).has_value();
+    table.textureUploaded(first, { .array = 17, .layer = 3 });
+    const bool uploaded = !table.pixelsToUpload(first).has_value() && table.stats().pixel_bytes == 0 &&
+                          table.texture(first).value().gpu.array == 17;
+
+    table.releaseMaterial(wrapped);
+    const bool still_sampled = table.takeReleasedTextureLayers().size() == 0;
+    table.releaseMaterial(clamped);
+    const DArray<TextureLayer> released = table.takeReleasedTextureLayers();
+    const bool deleted = released.size() == 1 && released[0].array == 17 && released[0].layer == 3 &&
+                         table.stats().textures == 0;
+
+    // the source is free again, a new acquire starts over
+    bool created_later = false;
+    table.releaseTexture(table.acquireTexture("a.glb*0", 42, created_later));
+
+    if (deduplicated && states && uploadable && uploaded && still_sampled && deleted && created_later) {
+        return (TestResult){
+            .pass = true,
+            .message = "material table shares textures by source and content and frees them after upload",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "material table duplicated a texture, kept its pixels or lost its layer",
+        };
+    }
+}
+
+TestResult material_table_trims_over_the_pixel_budget() {
+
+    MaterialTable table;
+    // 256x256 rgba with its mips is about 341 KiB, 100 KiB only has room for it from 128x128 down (85 KiB)
+    table.setPixelBudget(100 * 1024);
+
+    bool created = false;
+    const TextureHandle texture = table.acquireTexture("big.glb*0", 0, created);
+    table.setTexturePixels(texture, buildMipChain(ownedPixels(256, 256), 0));
+    const std::optional<TextureEntry> entry = table.texture(texture);
+    const bool trimmed = entry.has_value() && entry.value().trimmed_levels == 1 && entry.value().data.width == 128 &&
+                         entry.value().data.levels == 8 && table.stats().pixel_bytes <= 100 * 1024 &&
+                         table.stats().trimmed_textures == 1;
+
+    // the next one would only fit at 32x32, the budget stops at MIN_TRIMMED_SIZE and goes over instead
+    const TextureHandle second = table.acquireTexture("big.glb*1", 0, created);
+    table.setTexturePixels(second, buildMipChain(ownedPixels(256, 256), 0));
+    const bool floored = table.texture(second).value().data.width == MIN_TRIMMED_SIZE;
+
+    table.releaseTexture(texture);
+    table.releaseTexture(second);
+
+    if (trimmed && floored) {
+        return (TestResult){
+            .pass = true,
+            .message = "material table drops top mips of textures over the pixel budget",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "material table kept a texture over the pixel budget or trimmed it too far",
+        };
+    }
+}
+
+std::vector<TestResult> runMaterialTableTests() {
+    return {
+        material_table_shares_equal_materials(),
+        material_table_dedups_textures(),
+        material_table_trims_over_the_pixel_budget(),
+    };
+}
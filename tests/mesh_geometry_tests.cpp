@@ -0,0 +1,189 @@
+#include <math.h>
+#include <string.h>
+
+#include "mesh.h"
+#include "mesh_geometry.h"
+#include "mesh_import.h"
+#include "test_helpers.h"
+#include "thread_pool.h"
+
+// n x n quads over the xz plane, y is a few bumps. uvs follow x and z, or -x when mirrored
+static Mesh bumpyGrid(const size_t n, const bool mirrored_uvs) {
+
+    Mesh mesh = {
+        .vertices = { .vertex_count = (n + 1) * (n + 1), .index_count = n * n * 6 },
+    };
+    DArray<float>& uvs = mesh.vertices.uvs;
+
+    for (size_t z = 0; z <= n; z++) {
+        for (size_t x = 0; x <= n; x++) {
+            const float fx = static_cast<float>(x) / n;
+            const float fz = static_cast<float>(z) / n;
+            mesh.vertices.positions.push_back(fx);
+            mesh.vertices.positions.push_back(0.01f * sinf(fx * 20.f) * cosf(fz * 13.f));
+            mesh.vertices.positions.push_back(fz);
+            uvs.push_back(mirrored_uvs ? -fx : fx);
+            uvs.push_back(fz);
+        }
+    }
+
+    const unsigned int row = static_cast<unsigned int>(n + 1);
+    for (size_t z = 0; z < n; z++) {
+        for (size_t x = 0; x < n; x++) {
+            const unsigned int i = static_cast<unsigned int>(z * row + x);
+            const unsigned int quad[6] = { i, i + row, i + 1, i + 1, i + row, i + row + 1 };
+            for (const unsigned int index : quad) {
+                mesh.vertices.indices.push_back(index);
+            }
+        }
+    }
+    return mesh;
+}
+
+TestResult mesh_geometry_angle_weighted_cube_normals() {
+
+    // 8 shared corners, each face split along a different diagonal so some corners are in one
+    // triangle of a face and some in two. Only angle weighting sees every face the same
+    Mesh cube = {
+        .vertices = { .vertex_count = 9, .index_count = 36 },
+    };
+    for (int i = 0; i < 8; i++) {
+        cube.vertices.positions.push_back(i & 1 ? 1.f : -1.f);
+        cube.vertices.positions.push_back(i & 2 ? 1.f : -1.f);
+        cube.vertices.positions.push_back(i & 4 ? 1.f : -1.f);
+    }
+    // a 9th vertex no triangle uses
+    for (int i = 0; i < 3; i++) {
+        cube.vertices.positions.push_back(5.f);
+    }
+    const unsigned int faces[36] = {
+        0, 2, 3, 0, 3, 1, // -z
+        4, 5, 7, 4, 7, 6, // +z
+        0, 4, 6, 0, 6, 2, // -x
+        1, 3, 7, 1, 7, 5, // +x
+        0, 1, 5, 0, 5, 4, // -y
+        2, 6, 7, 2, 7, 3, // +y
+    };
+    for (const unsigned int index : faces) {
+        cube.vertices.indices.push_back(index);
+    }
+
+    ThreadPool pool(2);
+    generateNormals(cube.vertices, NormalWeighting::Angle, pool);
+    const float third = 1.f / sqrtf(3.f);
+    bool angle_normals = true;
+    for (int i = 0; i < 8; i++) {
+        const mym::Vec3 expected = { i & 1 ? third : -third, i & 2 ? third : -third, i & 4 ? third : -third };
+        const float* n = cube.vertices.normals.addr(i * 3);
+        angle_normals = angle_normals && vec3sAreEqual((mym::Vec3){ n[0], n[1], n[2] }, expected);
+    }
+    const float* unused = cube.vertices.normals.addr(8 * 3);
+    angle_normals = angle_normals && unused[0] == 0.f && unused[1] == 1.f && unused[2] == 0.f;
+
+    // corner 0 is in both triangles of all three of its faces, corner 1 in one of its -z triangles
+    generateNormals(cube.vertices, NormalWeighting::Area, pool);
+    const float* lopsided = cube.vertices.normals.addr(1 * 3);
+    const bool area_normals = !vec3sAreEqual((mym::Vec3){ lopsided[0], lopsided[1], lopsided[2] },
+                                             (mym::Vec3){ third, -third, -third }) &&
+                              vec3sAreEqual((mym::Vec3){ cube.vertices.normals[0], cube.vertices.normals[1], cube.vertices.normals[2] },
+                                            (mym::Vec3){ -third, -third, -third });
+
+    if (angle_normals && area_normals) {
+        return (TestResult){
+            .pass = true,
+            .message = "mesh geometry angle weighted cube normals point along the diagonals",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "mesh geometry cube normals are off the diagonals or ignore the weighting",
+        };
+    }
+}
+
+TestResult mesh_geometry_same_result_on_any_pool() {
+
+    // several chunks of triangles and vertices, split differently on each pool
+    Mesh one = bumpyGrid(160, false);
+    Mesh four = bumpyGrid(160, false);
+    ThreadPool single(1);
+    ThreadPool several(4);
+    generateMissingVertexData(one, NormalWeighting::Angle, true, single);
+    generateMissingVertexData(four, NormalWeighting::Angle, true, several);
+
+    const size_t vertex_count = one.vertices.vertex_count;
+    const bool same = one.vertices.normals.size() == vertex_count * 3 && one.vertices.tangents.size() == vertex_count * 4 &&
+                      four.vertices.normals.size() == vertex_count * 3 && four.vertices.tangents.size() == vertex_count * 4 &&
+                      memcmp(one.vertices.normals.begin(), four.vertices.normals.begin(), sizeof(float) * vertex_count * 3) == 0 &&
+                      memcmp(one.vertices.tangents.begin(), four.vertices.tangents.begin(), sizeof(float) * vertex_count * 4) == 0;
+
+    if (same) {
+        return (TestResult){
+            .pass = true,
+            .message = "mesh geometry normals and tangents are bit identical on 1 and 4 threads",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "mesh geometry normals or tangents depend on the thread count",
+        };
+    }
+}
+
+TestResult mesh_geometry_tangents_follow_u() {
+
+    bool tangents_follow_u = true;
+    for (const bool mirrored : { false, true }) {
+        // through the importer so the vertex fetch reorder has to carry the tangents along
+        Mesh mesh = bumpyGrid(24, mirrored);
+        ImportOptions options;
+        options.generate_lods = false;
+        processImportedMesh(mesh, "grid", options);
+
+        const DArray<float>& uvs = mesh.vertices.uvs;
+        const size_t vertex_count = mesh.vertices.vertex_count;
+        tangents_follow_u = tangents_follow_u && mesh.vertices.tangents.size() == vertex_count * 4;
+        for (size_t v = 0; tangents_follow_u && v < vertex_count; v++) {
+            const float* n = mesh.vertices.normals.addr(v * 3);
+            const float* t = mesh.vertices.tangents.addr(v * 4);
+            // the grid is nearly flat, u runs along +x (or -x mirrored) and v along +z
+            const float along_u = mirrored ? -t[0] : t[0];
+            const float length = sqrtf(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+            const float n_dot_t = n[0] * t[0] + n[1] * t[1] + n[2] * t[2];
+            // with n = +y, cross(n, t) points along -z for t = +x, away from v, so w flips
+            const float expected_w = mirrored ? 1.f : -1.f;
+            tangents_follow_u = along_u > 0.9f && fabsf(length - 1.f) < 1e-4f && fabsf(n_dot_t) < 1e-4f && t[3] == expected_w &&
+                                uvs.size() == vertex_count * 2;
+        }
+    }
+
+    // tangents the mesh came with are kept
+    Mesh given = bumpyGrid(4, false);
+    for (size_t v = 0; v < given.vertices.vertex_count; v++) {
+        const float tangent[4] = { 0.f, 0.f, 1.f, 1.f };
+        memcpy(given.vertices.tangents.extend(4), tangent, sizeof(tangent));
+    }
+    ThreadPool pool(1);
+    generateMissingVertexData(given, NormalWeighting::Angle, true, pool);
+    const bool kept = given.vertices.normals.size() == given.vertices.vertex_count * 3 && given.vertices.tangents[2] == 1.f;
+
+    if (tangents_follow_u && kept) {
+        return (TestResult){
+            .pass = true,
+            .message = "mesh geometry tangents follow u with the bitangent sign of mirrored uvs",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "mesh geometry tangents don't follow u, have the wrong sign or replaced given ones",
+        };
+    }
+}
+
+std::vector<TestResult> runMeshGeometryTests() {
+    return {
+        mesh_geometry_angle_weighted_cube_normals(),
+        mesh_geometry_same_result_on_any_pool(),
+        mesh_geometry_tangents_follow_u(),
+    };
+}
@@ -0,0 +1,187 @@
+#include <math.h>
+
+#include "mat4.h"
+#include "mesh.h"
+#include "mesh_lod.h"
+#include "test_helpers.h"
+
+using namespace mym;
+
+// closed uv sphere without seams, the longitude wraps around onto the first column
+static Mesh sphere(const size_t rings, const size_t segments) {
+
+    Mesh mesh = {
+        .vertices = { .vertex_count = 0, .index_count = 0 },
+    };
+
+    auto pushVertex = [&mesh](const float x, const float y, const float z) {
+        mesh.vertices.positions.push_back(x);
+        mesh.vertices.positions.push_back(y);
+        mesh.vertices.positions.push_back(z);
+        mesh.vertices.vertex_count++;
+    };
+    auto pushTriangle = [&mesh](const unsigned int a, const unsigned int b, const unsigned int c) {
+        mesh.vertices.indices.push_back(a);
+        mesh.vertices.indices.push_back(b);
+        mesh.vertices.indices.push_back(c);
+        mesh.vertices.index_count += 3;
+    };
+
+    pushVertex(0.f, 1.f, 0.f);
+    for (size_t ring = 1; ring < rings; ring++) {
+        const float phi = M_PI * ring / rings;
+        for (size_t segment = 0; segment < segments; segment++) {
+            const float theta = 2.f * M_PI * segment / segments;
+            pushVertex(sinf(phi) * cosf(theta), cosf(phi), sinf(phi) * sinf(theta));
+        }
+    }
+    pushVertex(0.f, -1.f, 0.f);
+
+    const unsigned int bottom = static_cast<unsigned int>(mesh.vertices.vertex_count - 1);
+    auto ringVertex = [segments](const size_t ring, const size_t segment) {
+        return static_cast<unsigned int>(1 + (ring - 1) * segments + segment % segments);
+    };
+
+    for (size_t segment = 0; segment < segments; segment++) {
+        pushTriangle(0, ringVertex(1, segment + 1), ringVertex(1, segment));
+        pushTriangle(bottom, ringVertex(rings - 1, segment), ringVertex(rings - 1, segment + 1));
+    }
+
+    for (size_t ring = 1; ring < rings - 1; ring++) {
+        for (size_t segment = 0; segment < segments; segment++) {
+            const unsigned int a = ringVertex(ring, segment);
+            const unsigned int b = ringVertex(ring, segment + 1);
+            const unsigned int c = ringVertex(ring + 1, segment);
+            const unsigned int d = ringVertex(ring + 1, segment + 1);
+            pushTriangle(a, b, c);
+            pushTriangle(b, d, c);
+        }
+    }
+
+    return mesh;
+}
+
+TestResult simplify_flat_grid_without_error() {
+
+    // 16 x 16 quads, all in one plane so the interior collapses for free and only the border is kept
+    constexpr size_t n = 16;
+    DArray<float> positions;
+    DArray<unsigned int> indices;
+
+    for (size_t z = 0; z <= n; z++) {
+        for (size_t x = 0; x <= n; x++) {
+            positions.push_back(static_cast<float>(x));
+            positions.push_back(0.f);
+            positions.push_back(static_cast<float>(z));
+        }
+    }
+    for (size_t z = 0; z < n; z++) {
+        for (size_t x = 0; x < n; x++) {
+            const unsigned int i = static_cast<unsigned int>(z * (n + 1) + x);
+            const unsigned int row = static_cast<unsigned int>(n + 1);
+            indices.push_back(i); indices.push_back(i + row); indices.push_back(i + 1);
+            indices.push_back(i + 1); indices.push_back(i + row); indices.push_back(i + row + 1);
+        }
+    }
+
+    DArray<unsigned int> destination(indices.size(), 0);
+    float error = 1.f;
+    const size_t count = simplifyIndices(indices.begin(), indices.size(), positions.begin(), (n + 1) * (n + 1),
+                                         0, 0.001f, destination.begin(), &error);
+
+    if (count > 0 && count < indices.size() / 4 && error < 1e-5f) {
+        return (TestResult){
+            .pass = true,
+            .message = "flat grid interior collapsed without error",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "flat grid did not collapse, or collapsed with error",
+        };
+    }
+}
+
+TestResult sphere_lods_shrink_within_error() {
+
+    Mesh mesh = sphere(32, 64);
+    generateMeshLods(mesh, DEFAULT_MAX_LODS);
+
+    if (mesh.lod.levels.size() < 2) {
+        return (TestResult){
+            .pass = false,
+            .message = "sphere produced fewer than 2 lods",
+        };
+    }
+
+    size_t previous_count = mesh.vertices.index_count;
+    float previous_error = 0.f;
+    for (const auto& level : mesh.lod.levels) {
+
+        // every level should cut roughly half, and the error can only grow
+        if (level.index_count > previous_count * 3 / 4 || level.error < previous_error ||
+            level.error > mesh.lod.radius * 0.25f * DEFAULT_MAX_LODS) {
+            return (TestResult){
+                .pass = false,
+                .message = "sphere lods do not shrink with growing bounded error",
+            };
+        }
+
+        previous_count = level.index_count;
+        previous_error = level.error;
+    }
+
+    return (TestResult){
+        .pass = true,
+        .message = "sphere lods shrink with growing bounded error",
+    };
+}
+
+TestResult lod_selection_follows_distance() {
+
+    Mesh mesh = sphere(32, 64);
+    generateMeshLods(mesh, DEFAULT_MAX_LODS);
+
+    Affine world = identityAffine();
+    size_t previous_lod = 0;
+
+    // walking away from the sphere should never pick a finer level
+    for (float distance = 2.f; distance < 2000.f; distance *= 2.f) {
+        const LodSelection selection = lodSelection({ 0.f, 0.f, distance }, M_PI / 4.f, 1400, 1.f);
+        const size_t lod = selectMeshLod(mesh, world, selection);
+
+        if (lod < previous_lod) {
+            return (TestResult){
+                .pass = false,
+                .message = "a further camera picked a finer lod",
+            };
+        }
+        previous_lod = lod;
+    }
+
+    const LodSelection near = lodSelection({ 0.f, 0.f, 1.5f }, M_PI / 4.f, 1400, 1.f);
+    const LodSelection disabled = lodSelection({ 0.f, 0.f, 2000.f }, M_PI / 4.f, 1400, 0.f);
+
+    if (selectMeshLod(mesh, world, near) == 0 && previous_lod == mesh.lod.levels.size() &&
+        selectMeshLod(mesh, world, disabled) == 0) {
+        return (TestResult){
+            .pass = true,
+            .message = "lod selection coarsens with distance",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "lod selection doesn't span full detail to the coarsest level",
+        };
+    }
+}
+
+std::vector<TestResult> runMeshLodTests() {
+
+    std::vector<TestResult> results;
+    results.push_back(simplify_flat_grid_without_error());
+    results.push_back(sphere_lods_shrink_within_error());
+    results.push_back(lod_selection_follows_distance());
+
+    return results;
+}
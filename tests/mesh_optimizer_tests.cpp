@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <array>
+#include <random>
+
+#include "mesh.h"
+#include "mesh_optimizer.h"
+#include "test_helpers.h"
+
+// n x n quad grid in the xz plane with its triangles shuffled, the worst case for the vertex cache
+static Mesh shuffledGrid(const size_t n) {
+
+    Mesh mesh = {
+        .vertices = { .vertex_count = (n + 1) * (n + 1), .index_count = n * n * 6 },
+    };
+
+    for (size_t z = 0; z <= n; z++) {
+        for (size_t x = 0; x <= n; x++) {
+            mesh.vertices.positions.push_back(static_cast<float>(x));
+            mesh.vertices.positions.push_back(0.f);
+            mesh.vertices.positions.push_back(static_cast<float>(z));
+            mesh.vertices.normals.push_back(0.f);
+            mesh.vertices.normals.push_back(1.f);
+            mesh.vertices.normals.push_back(0.f);
+        }
+    }
+
+    std::vector<std::array<unsigned int, 3>> triangles;
+    for (size_t z = 0; z < n; z++) {
+        for (size_t x = 0; x < n; x++) {
+            const unsigned int i = static_cast<unsigned int>(z * (n + 1) + x);
+            const unsigned int row = static_cast<unsigned int>(n + 1);
+            triangles.push_back({ i, i + row, i + 1 });
+            triangles.push_back({ i + 1, i + row, i + row + 1 });
+        }
+    }
+
+    std::mt19937 rng(7);
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+
+    for (const auto& triangle : triangles) {
+        for (const unsigned int index : triangle) {
+            mesh.vertices.indices.push_back(index);
+        }
+    }
+
+    return mesh;
+}
+
+// triangles as position triples, sorted so two meshes can be compared regardless of order
+static std::vector<std::array<float, 9>> sortedTriangles(Mesh& mesh) {
+
+    std::vector<std::array<float, 9>> triangles;
+    for (size_t t = 0; t < mesh.vertices.index_count / 3; t++) {
+        std::array<float, 9> triangle;
+        for (size_t k = 0; k < 3; k++) {
+            const unsigned int v = mesh.vertices.indices[t * 3 + k];
+            for (size_t axis = 0; axis < 3; axis++) {
+                triangle[k * 3 + axis] = mesh.vertices.positions[v * 3 + axis];
+            }
+        }
+        triangles.push_back(triangle);
+    }
+
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+TestResult vertex_cache_improves_acmr() {
+
+    Mesh mesh = shuffledGrid(32);
+    const MeshOptimizationReport report = optimizeMesh(mesh, false);
+
+    // a shuffled grid misses on nearly every vertex (~3), a well ordered one should get close to 1
+    if (report.before.acmr > 2.f && report.after.acmr < 1.f && report.after.atvr < 1.5f) {
+        return (TestResult){
+            .pass = true,
+            .message = "vertex cache optimization brings a shuffled grid under 1 ACMR",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "vertex cache optimization did not improve a shuffled grid enough",
+        };
+    }
+}
+
+TestResult optimization_preserves_triangles() {
+
+    Mesh original = shuffledGrid(8);
+    Mesh mesh = shuffledGrid(8);
+    optimizeMesh(mesh, true);
+
+    if (sortedTriangles(original) == sortedTriangles(mesh)) {
+        return (TestResult){
+            .pass = true,
+            .message = "optimized mesh has the same triangles",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "optimized mesh lost or changed triangles",
+        };
+    }
+}
+
+TestResult vertex_fetch_follows_index_order() {
+
+    Mesh mesh = shuffledGrid(4);
+    optimizeVertexFetch(mesh);
+
+    // every index must be at most one past the largest index seen before it
+    unsigned int next = 0;
+    for (size_t i = 0; i < mesh.vertices.index_count; i++) {
+        const unsigned int index = mesh.vertices.indices[i];
+        if (index > next) {
+            return (TestResult){
+                .pass = false,
+                .message = "vertices are not in first use order",
+            };
+        }
+        if (index == next) {
+            next++;
+        }
+    }
+
+    return (TestResult){
+        .pass = true,
+        .message = "vertices are in first use order",
+    };
+}
+
+std::vector<TestResult> runMeshOptimizerTests() {
+
+    std::vector<TestResult> results;
+    results.push_back(vertex_cache_improves_acmr());
+    results.push_back(optimization_preserves_triangles());
+    results.push_back(vertex_fetch_follows_index_order());
+
+    return results;
+}
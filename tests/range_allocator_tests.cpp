@@ -0,0 +1,119 @@
+#include "range_allocator.h"
+#include "test_helpers.h"
+
+TestResult allocate_is_first_fit() {
+
+    RangeAllocator allocator(100);
+
+    auto a = allocator.allocate(10);
+    auto b = allocator.allocate(20);
+
+    if (!a.has_value() || !b.has_value()) {
+        return (TestResult){
+            .pass = false,
+            .message = "allocation failed with free space left",
+        };
+    }
+
+    if (a.value() == 0 && b.value() == 10 && allocator.used() == 30) {
+        return (TestResult){
+            .pass = true,
+            .message = "ranges were allocated first fit",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "ranges were not allocated first fit",
+        };
+    }
+}
+
+TestResult allocate_fails_when_full() {
+
+    RangeAllocator allocator(16);
+
+    allocator.allocate(10);
+    auto result = allocator.allocate(10);
+
+    if (result.has_value()) {
+        return (TestResult){
+            .pass = false,
+            .message = "allocation succeeded without enough free space",
+        };
+    } else {
+        return (TestResult){
+            .pass = true,
+            .message = "allocation failed without enough free space, correctly",
+        };
+    }
+}
+
+TestResult release_coalesces_neighbours() {
+
+    RangeAllocator allocator(30);
+
+    auto a = allocator.allocate(10);
+    auto b = allocator.allocate(10);
+    auto c = allocator.allocate(10);
+
+    allocator.release(a.value(), 10);
+    allocator.release(c.value(), 10);
+
+    // two separate holes either side of b
+    if (allocator.freeRangeCount() != 2 || !floatsAreClose(allocator.fragmentation(), 0.5f)) {
+        return (TestResult){
+            .pass = false,
+            .message = "released ranges were not tracked separately",
+        };
+    }
+
+    allocator.release(b.value(), 10);
+
+    if (allocator.freeRangeCount() == 1 &&
+        allocator.largestFreeRange() == 30 &&
+        floatsAreClose(allocator.fragmentation(), 0.f)) {
+        return (TestResult){
+            .pass = true,
+            .message = "released ranges were coalesced",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "released ranges were not coalesced",
+        };
+    }
+}
+
+TestResult allocate_reuses_released_hole() {
+
+    RangeAllocator allocator(30);
+
+    auto a = allocator.allocate(10);
+    allocator.allocate(10);
+
+    allocator.release(a.value(), 10);
+    auto reused = allocator.allocate(5);
+
+    if (reused.has_value() && reused.value() == 0) {
+        return (TestResult){
+            .pass = true,
+            .message = "released hole was reused",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "released hole was not reused",
+        };
+    }
+}
+
+std::vector<TestResult> runRangeAllocatorTests() {
+
+    std::vector<TestResult> results;
+    results.push_back(allocate_is_first_fit());
+    results.push_back(allocate_fails_when_full());
+    results.push_back(release_coalesces_neighbours());
+    results.push_back(allocate_reuses_released_hole());
+
+    return results;
+}
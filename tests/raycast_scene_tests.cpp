@@ -1,5 +1,6 @@
 #include <vector>
 
+#include "material_table.h"
 #include "mesh.h"
 #include "scene.h"
 #include "test_helpers.h"
@@ -41,12 +42,6 @@ Vertices setupVertices() {
     return vertices;
 }
 
-   
-const BasicColorMaterial irrelevant = {
-            .color = { .r = 0.1, .g = 0.7, .b = 0.1},
-            .specular_color = { .r = 0.2, .g = 0.2, .b = 0.2},
-            .shininess = 0.5f
-        };
 
 TestResult intersect_node_with_position_transform() {
    
@@ -60,7 +55,6 @@ TestResult intersect_node_with_position_transform() {
             transform,
             (Mesh){
                 .vertices = vertices,
-                .material = irrelevant
             },
             "node"
         );
@@ -115,7 +109,6 @@ TestResult intersect_node_with_multiple_position_transform() {
             transform,
             (Mesh){
                 .vertices = vertices,
-                .material = irrelevant
             },
             "node"
         );
@@ -180,7 +173,6 @@ TestResult intersect_node_with_roation_transform() {
             transform,
             (Mesh){
                 .vertices = vertices,
-                .material = irrelevant
             },
             "node"
         );
@@ -223,12 +215,52 @@ TestResult intersect_node_with_roation_transform() {
 
 }
 
+TestResult copied_mesh_holds_its_own_material() {
+
+    MaterialTable& table = materialTable();
+    const size_t materials_before = table.stats().materials;
+
+    Mesh mesh = {
+        .vertices = setupVertices(),
+        .material = table.addMaterial(BasicColorMaterial{
+            .color = { 0.25f, 0.125f, 0.0625f },
+            .specular_color = { 0.f, 0.f, 0.f },
+            .shininess = 0.75f,
+        }),
+    };
+    const MaterialHandle material = mesh.material;
+
+    SceneNode* copy = new SceneNode(createSceneNode(translation(1.f, 0.f, 0.f), copyMesh(mesh), "copy"));
+    SceneNode* original = new SceneNode(createSceneNode(translation(0.f, 0.f, 0.f), std::move(mesh), "original"));
+    const bool deep = copy->mesh.value().vertices.positions.begin() != original->mesh.value().vertices.positions.begin() &&
+                      copy->mesh.value().material == material;
+
+    // each node gives back its own user, the material goes with the second
+    deleteSceneTree(original);
+    const bool kept = table.material(material).has_value();
+    deleteSceneTree(copy);
+    const bool released = !table.material(material).has_value() && table.stats().materials == materials_before;
+
+    if (deep && kept && released) {
+        return (TestResult){
+            .pass = true,
+            .message = "a copied mesh holds its own user of the material",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "a copied mesh shared its original's user of the material",
+        };
+    }
+}
+
 std::vector<TestResult> runSceneTests() {
      
     std::vector<TestResult> results;
     results.push_back(intersect_node_with_position_transform());
     results.push_back(intersect_node_with_multiple_position_transform());
     results.push_back(intersect_node_with_roation_transform());
+    results.push_back(copied_mesh_holds_its_own_material());
 
     return results;
 }
\ No newline at end of file
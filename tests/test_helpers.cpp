@@ -1,4 +1,8 @@
+#include <stdio.h>
+#include <filesystem>
+
 #include "stdbool.h"
+#include "test_helpers.h"
 #include "vec.h"
 
 bool floatsAreClose(float a, float b) {
@@ -11,3 +15,13 @@ bool vec3sAreEqual(mym::Vec3 a, mym::Vec3 b) {
             floatsAreClose(a.z, b.z));
 }
 
+
+TempFile::TempFile(const char* name) : full_path((std::filesystem::temp_directory_path() / name).string()) {}
+
+TempFile::~TempFile() {
+    remove(full_path.c_str());
+}
+
+const char* TempFile::path() const {
+    return full_path.c_str();
+}
@@ -23,6 +23,96 @@ int main(int argc, char** argv) {
         results.push_back(result);
     }
 
+    // geometry pool allocator tests
+    for (const auto &result : runRangeAllocatorTests()) {
+        results.push_back(result);
+    }
+
+    // vertex compression tests
+    for (const auto &result : runVertexCompressionTests()) {
+        results.push_back(result);
+    }
+
+    // mesh optimizer tests
+    for (const auto &result : runMeshOptimizerTests()) {
+        results.push_back(result);
+    }
+
+    // mesh lod tests
+    for (const auto &result : runMeshLodTests()) {
+        results.push_back(result);
+    }
+
+    // asset cache tests
+    for (const auto &result : runAssetCacheTests()) {
+        results.push_back(result);
+    }
+
+    // float parser tests
+    for (const auto &result : runFloatParserTests()) {
+        results.push_back(result);
+    }
+
+    // thread pool tests
+    for (const auto &result : runThreadPoolTests()) {
+        results.push_back(result);
+    }
+
+    // concurrent queue tests
+    for (const auto &result : runConcurrentQueueTests()) {
+        results.push_back(result);
+    }
+
+    // darray tests
+    for (const auto &result : runDArrayTests()) {
+        results.push_back(result);
+    }
+
+    // frame arena tests
+    for (const auto &result : runFrameArenaTests()) {
+        results.push_back(result);
+    }
+
+    // hash map tests
+    for (const auto &result : runHashMapTests()) {
+        results.push_back(result);
+    }
+
+    // mat4 tests
+    for (const auto &result : runMat4Tests()) {
+        results.push_back(result);
+    }
+
+    // bounds tests
+    for (const auto &result : runBoundsTests()) {
+        results.push_back(result);
+    }
+
+    // mesh geometry tests
+    for (const auto &result : runMeshGeometryTests()) {
+        results.push_back(result);
+    }
+
+    // material table tests
+    for (const auto &result : runMaterialTableTests()) {
+        results.push_back(result);
+    }
+
+    // texture mips tests
+    for (const auto &result : runTextureMipsTests()) {
+        results.push_back(result);
+    }
+
+    // json tests
+    for (const auto &result : runJsonTests()) {
+        results.push_back(result);
+    }
+
+    // glb reader tests
+    for (const auto &result : runGlbReaderTests()) {
+        results.push_back(result);
+    }
+
     int total = 0;
     int passed = 0;
     int failed = 0;
@@ -0,0 +1,137 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "texture_mips.h"
+#include "test_helpers.h"
+
+// malloced like stb_image's, so the chain builder can take them over
+static TextureData ownedPixels(const int width, const int height, const int channels, const unsigned char value) {
+    const size_t bytes = static_cast<size_t>(width) * height * channels;
+    unsigned char* pixels = static_cast<unsigned char*>(malloc(bytes));
+    memset(pixels, value, bytes);
+    return { .pixels = pixels, .width = width, .height = height, .channels = channels, .levels = 1, .needs_free = true };
+}
+
+TestResult texture_mips_chain_layout() {
+
+    // odd and non square, the levels go 5x3, 2x1, 1x1
+    TextureData level0 = ownedPixels(5, 3, 3, 0x40);
+    level0.pixels[0] = 0x41;
+    const TextureData chain = buildMipChain(level0, 0);
+
+    const bool layout = chain.levels == 3 && chain.width == 5 && chain.height == 3 &&
+                        mipLevelOffset(5, 3, 3, 1) == 45 && mipLevelOffset(5, 3, 3, 2) == 51 &&
+                        mipChainBytes(chain) == 54 && chain.needs_free;
+    // level 0 is kept as it was, a flat colour stays the same colour all the way down
+    const bool pixels = chain.pixels[0] == 0x41 && chain.pixels[1] == 0x40 &&
+                        chain.pixels[45 + 3] == 0x40 && chain.pixels[51 + 2] == 0x40;
+
+    free(chain.pixels);
+
+    if (layout && pixels) {
+        return (TestResult){
+            .pass = true,
+            .message = "texture mips pack every level after level 0 down to 1x1",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "texture mips have the wrong sizes or offsets",
+        };
+    }
+}
+
+TestResult texture_mips_average_in_linear_space() {
+
+    // grey + alpha checkerboard, black transparent next to white opaque
+    TextureData level0 = ownedPixels(2, 2, 2, 0);
+    const unsigned char texels[8] = { 0, 0, 255, 255, 255, 255, 0, 0 };
+    memcpy(level0.pixels, texels, sizeof(texels));
+    const TextureData chain = buildMipChain(level0, 0);
+
+    // half the light of white is srgb 188, not 128 the way averaging the bytes would darken it.
+    // alpha isn't a colour and averages as it is
+    const unsigned char grey = chain.pixels[8];
+    const unsigned char alpha = chain.pixels[9];
+    free(chain.pixels);
+
+    if (abs(grey - 188) <= 1 && alpha == 128) {
+        return (TestResult){
+            .pass = true,
+            .message = "texture mips average colours in linear space and alpha as it is",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "texture mips averaged the srgb bytes or gamma corrected alpha",
+        };
+    }
+}
+
+TestResult texture_mips_clamp_and_drop() {
+
+    // 16x8 clamped to 4 starts at level 2, 4x2
+    const TextureData chain = buildMipChain(ownedPixels(16, 8, 4, 0x80), 4);
+    const bool clamped = chain.width == 4 && chain.height == 2 && chain.levels == 3 && mipChainBytes(chain) == (8 + 2 + 1) * 4;
+
+    // borrowed pixels aren't moved, just pointed past
+    TextureData borrowed = chain;
+    borrowed.needs_free = false;
+    const TextureData skipped = dropTopMips(borrowed, 1);
+    const bool pointed = skipped.pixels == chain.pixels + 8 * 4 && skipped.width == 2 && skipped.height == 1 &&
+                         skipped.levels == 2;
+
+    // owned ones move down, and the last level always stays
+    const TextureData dropped = dropTopMips(chain, 5);
+    const bool kept_last = dropped.levels == 1 && dropped.width == 1 && dropped.height == 1 && dropped.pixels[0] == 0x80;
+    free(dropped.pixels);
+
+    if (clamped && pointed && kept_last) {
+        return (TestResult){
+            .pass = true,
+            .message = "texture mips clamp to a max size and drop top levels",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "texture mips kept levels over the clamp or dropped the wrong ones",
+        };
+    }
+}
+
+TestResult texture_mips_take_over_moved_pixels() {
+
+    // a block right behind the pixels keeps realloc from growing them in place, the chain has to move.
+    // the old block is gone after that and mustn't be freed again (run under asan to see it)
+    TextureData level0 = ownedPixels(4, 4, 4, 0x20);
+    unsigned char* behind = static_cast<unsigned char*>(malloc(64));
+    const TextureData chain = buildMipChain(level0, 0);
+    const bool moved = chain.pixels != level0.pixels;
+
+    const bool intact = chain.levels == 3 && chain.needs_free && chain.pixels[0] == 0x20 &&
+                        chain.pixels[mipLevelOffset(4, 4, 4, 2)] == 0x20;
+    free(chain.pixels);
+    free(behind);
+
+    if (intact) {
+        return (TestResult){
+            .pass = true,
+            .message = moved ? "texture mips take over pixels realloc moved" : "texture mips take over pixels grown in place",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "texture mips lost level 0 when realloc moved the pixels",
+        };
+    }
+}
+
+std::vector<TestResult> runTextureMipsTests() {
+    return {
+        texture_mips_chain_layout(),
+        texture_mips_take_over_moved_pixels(),
+        texture_mips_average_in_linear_space(),
+        texture_mips_clamp_and_drop(),
+    };
+}
@@ -0,0 +1,104 @@
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include "test_helpers.h"
+#include "thread_pool.h"
+
+TestResult thread_pool_runs_every_job() {
+
+    std::atomic<size_t> ran = 0;
+    std::vector<std::future<size_t>> results;
+
+    {
+        ThreadPool pool(4);
+        for (size_t i = 0; i < 100; i++) {
+            results.push_back(pool.submit([i, &ran]() {
+                ran++;
+                return i * i;
+            }));
+        }
+        // the destructor drains the queue
+    }
+
+    bool results_match = ran == 100;
+    for (size_t i = 0; i < results.size(); i++) {
+        results_match = results_match && results[i].get() == i * i;
+    }
+
+    if (results_match) {
+        return (TestResult){
+            .pass = true,
+            .message = "thread pool ran every job and returned its result",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "thread pool lost a job or mixed up results",
+        };
+    }
+}
+
+TestResult thread_pool_forwards_exceptions() {
+
+    ThreadPool pool(2);
+    std::future<int> failing = pool.submit([]() -> int {
+        throw "loader failed";
+    });
+
+    try {
+        failing.get();
+    } catch (const char* message) {
+        return (TestResult){
+            .pass = true,
+            .message = "thread pool forwarded a job's exception to get()",
+        };
+    }
+
+    return (TestResult){
+        .pass = false,
+        .message = "thread pool swallowed a job's exception",
+    };
+}
+
+TestResult parallel_for_covers_the_range_once() {
+
+    ThreadPool pool(3);
+    std::vector<int> visits(10007, 0);
+    parallelFor(pool, visits.size(), 100, [&visits](const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            visits[i]++;
+        }
+    });
+
+    bool once = true;
+    for (const int count : visits) {
+        once = once && count == 1;
+    }
+
+    // too little work to split, it all runs on the caller
+    size_t calls = 0;
+    parallelFor(pool, 50, 100, [&calls](size_t, size_t) { calls++; });
+
+    if (once && calls == 1) {
+        return (TestResult){
+            .pass = true,
+            .message = "parallel for visited every index exactly once",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "parallel for skipped or repeated an index",
+        };
+    }
+}
+
+std::vector<TestResult> runThreadPoolTests() {
+
+    std::vector<TestResult> results;
+    results.push_back(thread_pool_runs_every_job());
+    results.push_back(thread_pool_forwards_exceptions());
+    results.push_back(parallel_for_covers_the_range_once());
+
+    return results;
+}
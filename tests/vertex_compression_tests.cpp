@@ -0,0 +1,182 @@
+#include <math.h>
+
+#include "mesh.h"
+#include "raycast.h"
+#include "test_helpers.h"
+#include "vertex_compression.h"
+
+using namespace mym;
+
+// angle between two unit vectors in degrees, done in double so float rounding doesn't swamp the result
+static double angleBetween(const Vec3 a, const Vec3 b) {
+    const Vec3 c = cross(a, b);
+    const double sin_angle = sqrt((double)c.x * c.x + (double)c.y * c.y + (double)c.z * c.z);
+    return atan2(sin_angle, (double)dot(a, b)) * 180.0 / M_PI;
+}
+
+static double worstOctahedronError(const NormalEncoding encoding) {
+
+    // fibonacci sphere, evenly covers every octant
+    constexpr size_t count = 20000;
+    const double golden_angle = M_PI * (3.0 - sqrt(5.0));
+    double worst = 0.0;
+
+    for (size_t i = 0; i < count; i++) {
+        const double y = 1.0 - 2.0 * (i + 0.5) / count;
+        const double radius = sqrt(1.0 - y * y);
+        const double theta = golden_angle * i;
+        const Vec3 normal = { (float)(cos(theta) * radius), (float)y, (float)(sin(theta) * radius) };
+
+        unsigned char encoded[4];
+        octahedronEncode(normal, encoding, encoded);
+        const double error = angleBetween(normalize(normal), octahedronDecode(encoded, encoding));
+        worst = fmax(worst, error);
+    }
+
+    return worst;
+}
+
+TestResult octahedron_oct16_error_bound() {
+
+    if (worstOctahedronError(NormalEncoding::Oct16) < 0.01) {
+        return (TestResult){
+            .pass = true,
+            .message = "oct16 normals are within 0.01 degrees",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "oct16 normals exceed 0.01 degrees of error",
+        };
+    }
+}
+
+TestResult octahedron_oct8_error_bound() {
+
+    if (worstOctahedronError(NormalEncoding::Oct8) < 0.7) {
+        return (TestResult){
+            .pass = true,
+            .message = "oct8 normals are within 0.7 degrees",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "oct8 normals exceed 0.7 degrees of error",
+        };
+    }
+}
+
+TestResult half_float_round_trip() {
+
+    const float values[6] = { 0.f, 1.f, -1.f, 0.333333f, 0.999f, 3.75f };
+
+    for (size_t i = 0; i < 6; i++) {
+        const float round_trip = halfToFloat(floatToHalf(values[i]));
+        if (fabsf(round_trip - values[i]) > fabsf(values[i]) * 0.00049f) {
+            return (TestResult){
+                .pass = false,
+                .message = "half float round trip exceeds 2^-11 relative error",
+            };
+        }
+    }
+
+    return (TestResult){
+        .pass = true,
+        .message = "half float round trip is within 2^-11 relative error",
+    };
+}
+
+TestResult compressed_positions_error_bound() {
+
+    float positions[18] = {
+        -10.f, 0.f, -10.f,
+        -10.f, 0.f, 10.f,
+        10.f, 0.3f, -10.f,
+        -10.f, 0.f, 10.f,
+        10.f, 0.1f, 10.f,
+        10.f, 0.2f, -10.f,
+    };
+
+    Mesh mesh = {
+        .vertices = { .vertex_count = 6, .index_count = 0 },
+    };
+
+    for (size_t i = 0; i < 18; i++) {
+        mesh.vertices.positions.push_back(positions[i]);
+        mesh.vertices.normals.push_back(i % 3 == 1 ? 1.f : 0.f);
+    }
+
+    compressVertices(mesh, NormalEncoding::Oct16);
+
+    if (!hasCompressedVertices(mesh) || mesh.vertices.positions.size() != 0) {
+        return (TestResult){
+            .pass = false,
+            .message = "float positions were not replaced by compressed ones",
+        };
+    }
+
+    const CompressedVertices& compressed = mesh.vertices.compressed.value();
+    auto decoded = decodePositions(compressed, 6);
+
+    for (size_t i = 0; i < 18; i++) {
+        const float bound = compressed.position_extent.data[i % 3] * 0.5f / 65535.f + 1e-6f;
+        if (fabsf(decoded[i] - positions[i]) > bound) {
+            return (TestResult){
+                .pass = false,
+                .message = "decoded positions exceed half a quantization step",
+            };
+        }
+    }
+
+    return (TestResult){
+        .pass = true,
+        .message = "decoded positions are within half a quantization step",
+    };
+}
+
+TestResult intersect_compressed_vertices() {
+
+    Vertices vertices = { .vertex_count = 3, .index_count = 0 };
+    const float positions[9] = {
+        1.f, 0.f, 0.1f,
+        0.f, 1.f, 0.1f,
+        -1.f, 0.f, 0.1f,
+    };
+    for (size_t i = 0; i < 9; i++) {
+        vertices.positions.push_back(positions[i]);
+    }
+
+    Mesh mesh = { .vertices = vertices };
+    compressVertices(mesh, NormalEncoding::Oct8);
+
+    const Ray ray = {
+        .origin = { 0.5f, 0.5f, 0.f },
+        .direction = { 0.f, 0.f, 1.f }
+    };
+
+    auto result = rayIntersectsVertices(ray, mesh.vertices);
+
+    if (result.size() == 1 && vec3sAreEqual(result[0].point, { 0.5f, 0.5f, 0.1f })) {
+        return (TestResult){
+            .pass = true,
+            .message = "compressed vertices were intersected",
+        };
+    } else {
+        return (TestResult){
+            .pass = false,
+            .message = "compressed vertices were not intersected",
+        };
+    }
+}
+
+std::vector<TestResult> runVertexCompressionTests() {
+
+    std::vector<TestResult> results;
+    results.push_back(octahedron_oct16_error_bound());
+    results.push_back(octahedron_oct8_error_bound());
+    results.push_back(half_float_round_trip());
+    results.push_back(compressed_positions_error_bound());
+    results.push_back(intersect_compressed_vertices());
+
+    return results;
+}